@@ -0,0 +1,101 @@
+//
+//  DemosaicDiskCache.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreVideo
+
+// Demosaiced buffers kept on disk by the C++ cache (ColorForge/Engine/Cache/DemosaicDiskCache),
+// so reopening a catalogue skips LibRaw and the GPU demosaic for every raw it has seen. Entries
+// are keyed on a content hash of the raw, so renamed or moved files still hit, and on the
+// demosaic settings that produced them. The orientation and chromaticity the callers would
+// otherwise read from LibRaw are stored inside each entry as JSON.
+final class DemosaicDiskCache {
+    static let shared = DemosaicDiskCache()
+
+    private let capacityBytes: UInt64 = 32 << 30
+
+    struct Info: Codable {
+        let orientation: Int
+        let chromaticityX: Double
+        let chromaticityY: Double
+    }
+
+    init() {
+        let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        let directory = caches.appendingPathComponent("ColorForge/Demosaic", isDirectory: true)
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        // Info used to sit beside each entry as a JSON file the engine never evicted
+        let files = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)) ?? []
+        files.filter { $0.pathExtension == "json" }.forEach { try? FileManager.default.removeItem(at: $0) }
+
+        ForgeDemosaicDiskCacheConfigure(directory.path, capacityBytes)
+    }
+
+    // Hash of the raw as it is on disk; take it before anything rewrites the file (modifyRAWModel).
+    func contentHash(_ url: URL) -> UInt64 {
+        ForgeHashFileContent(url.path)
+    }
+
+    // The stored demosaic of the raw hashing to `content` as a new RGBA half buffer, or nil on a
+    // miss. Corrupt entries are deleted by the engine and report a miss.
+    func load(_ content: UInt64, _ settings: MetalDemosaicProcessor.Settings) -> (CVPixelBuffer, Info)? {
+        guard content != 0 else { return nil }
+        let params = paramsHash(settings)
+
+        var width: Int32 = 0, height: Int32 = 0
+        var metadata = [UInt8](repeating: 0, count: 1024)
+        var metadataSize = 0
+        guard ForgeDemosaicDiskCacheLookup(content, params, &width, &height, &metadata, metadata.count, &metadataSize),
+              metadataSize <= metadata.count,
+              let info = try? JSONDecoder().decode(Info.self, from: Data(metadata.prefix(metadataSize))) else { return nil }
+
+        let attributes: [String: Any] = [
+            kCVPixelBufferPixelFormatTypeKey as String: kCVPixelFormatType_64RGBAHalf,
+            kCVPixelBufferMetalCompatibilityKey as String: true
+        ]
+        var buffer: CVPixelBuffer?
+        guard CVPixelBufferCreate(kCFAllocatorDefault, Int(width), Int(height), kCVPixelFormatType_64RGBAHalf,
+                                  attributes as CFDictionary, &buffer) == kCVReturnSuccess, let buffer else { return nil }
+
+        CVPixelBufferLockBaseAddress(buffer, [])
+        defer { CVPixelBufferUnlockBaseAddress(buffer, []) }
+        guard let base = CVPixelBufferGetBaseAddress(buffer),
+              ForgeDemosaicDiskCacheRead(content, params, base, CVPixelBufferGetBytesPerRow(buffer), true) else { return nil }
+        return (buffer, info)
+    }
+
+    // Stores processDemosaic's output (RGBA half) for the raw hashing to `content`.
+    func store(_ buffer: CVPixelBuffer, _ info: Info, _ content: UInt64, _ settings: MetalDemosaicProcessor.Settings) {
+        guard content != 0, CVPixelBufferGetPixelFormatType(buffer) == kCVPixelFormatType_64RGBAHalf,
+              let data = try? JSONEncoder().encode(info) else { return }
+
+        CVPixelBufferLockBaseAddress(buffer, .readOnly)
+        defer { CVPixelBufferUnlockBaseAddress(buffer, .readOnly) }
+        guard let base = CVPixelBufferGetBaseAddress(buffer) else { return }
+
+        let stored = data.withUnsafeBytes { bytes in
+            ForgeDemosaicDiskCacheStore(content, paramsHash(settings), base, CVPixelBufferGetBytesPerRow(buffer),
+                                        Int32(CVPixelBufferGetWidth(buffer)), Int32(CVPixelBufferGetHeight(buffer)), true,
+                                        bytes.baseAddress, bytes.count)
+        }
+        if !stored {
+            LogModel.shared.log("Demosaic cache store failed for \(String(content, radix: 16))")
+        }
+    }
+
+    func removeAll() {
+        ForgeDemosaicDiskCacheRemoveAll()
+    }
+
+    private func paramsHash(_ settings: MetalDemosaicProcessor.Settings) -> UInt64 {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = .sortedKeys
+        let encoded = (try? encoder.encode(settings)) ?? Data()
+        return encoded.withUnsafeBytes { ForgeDemosaicDiskCacheParamsHash($0.baseAddress, $0.count) }
+    }
+}
@@ -120,10 +120,13 @@ final class PixelBufferCache: NSObject {
 	}
 
     func set(_ pixelBuffer: CVPixelBuffer, for id: UUID) async { // ADD async
+        RenderCache.shared.removeSource(id)
+        TilePyramidCache.shared.register(pixelBuffer, for: id, fullRes: false)
         await set(pixelBuffer, for: id.uuidString) // ADD await
     }
 
 	func remove(_ id: UUID) async {
+		RenderCache.shared.removeSource(id)
 		await remove(id.uuidString)
 	}
 
@@ -215,6 +218,7 @@ final class PixelBufferCache: NSObject {
 //	}
     
     func removeAll() async {
+        RenderCache.shared.removeAll()
         cache.removeAll()
         await cacheState.removeAllCosts() // CHANGED
     }
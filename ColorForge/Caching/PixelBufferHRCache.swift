@@ -111,10 +111,14 @@ final class PixelBufferHRCache: NSObject {
     }
 
     func set(_ pixelBuffer: CVPixelBuffer, for id: UUID) async { // ADD async
+        RenderCache.shared.removeSource(id)
+        TilePyramidCache.shared.register(pixelBuffer, for: id, fullRes: true)
         await set(pixelBuffer, for: id.uuidString) // ADD await
     }
 
     func remove(_ id: UUID) async { // ADD async
+        RenderCache.shared.removeSource(id)
+        TilePyramidCache.shared.remove(id)
         await remove(id.uuidString) // ADD await
     }
 
@@ -167,6 +171,8 @@ final class PixelBufferHRCache: NSObject {
     }
 
     func removeAll() async {
+        RenderCache.shared.removeAll()
+        TilePyramidCache.shared.removeAll()
         cache.removeAll()
         await cacheState.removeAllCosts() // CHANGED
     }
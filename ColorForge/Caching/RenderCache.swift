@@ -0,0 +1,113 @@
+//
+//  RenderCache.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+
+/*
+
+   ************** USAGE ****************
+
+
+ // ------------- Store ---------------- //
+ // Renders the stage's output once and hands back an image reading the stored pixels
+ result = RenderCache.shared.store(result, for: key)
+
+ // ---------- Retrive Image ---------- //
+ if let cached = RenderCache.shared.get(key) {
+    // resume the chain from `cached`
+ }
+
+ // ------------- Remove --------------- //
+ RenderCache.shared.removeSource(item.id)
+
+ // ----------- Clear All -------------- //
+ RenderCache.shared.removeAll()
+
+ */
+
+
+import Foundation
+import CoreImage
+import CoreVideo
+import LRUCache
+
+// Stage outputs of FilterPipeline.applyPipelineV2Sync, keyed on the chain of node parameters
+// that produced them, so an edit re-renders from the deepest stage it doesn't change.
+final class RenderCache {
+    static let shared = RenderCache(limitBytes: Int(ProcessInfo.processInfo.physicalMemory / 16))
+
+    struct Key: Hashable {
+        // The item whose demosaiced buffers the chain started from
+        let source: UUID
+        // Hash of the stage's parameters chained with those of every stage before it
+        let chain: Int
+        // The rect of the source the chain was evaluated over, and its scale against the display buffer
+        let roi: CGRect
+        let scale: CGFloat
+
+        // The key of an image `chain` further down the same run
+        func chained(_ chain: Int) -> Key {
+            Key(source: source, chain: chain, roi: roi, scale: scale)
+        }
+
+        func hash(into hasher: inout Hasher) {
+            hasher.combine(source)
+            hasher.combine(chain)
+            hasher.combine(roi.origin.x)
+            hasher.combine(roi.origin.y)
+            hasher.combine(roi.width)
+            hasher.combine(roi.height)
+            hasher.combine(scale)
+        }
+    }
+
+    private let cache: LRUCache<Key, CIImage>
+
+    private init(limitBytes: Int) {
+        self.cache = LRUCache<Key, CIImage>(totalCostLimit: limitBytes)
+    }
+
+    func get(_ key: Key) -> CIImage? {
+        cache.value(forKey: key)
+    }
+
+    // Renders `image` into a buffer of its own and keeps that. Returns the image reading it, placed
+    // where `image` was, or `image` itself when its extent can't be stored.
+    func store(_ image: CIImage, for key: Key) -> CIImage {
+        let extent = image.extent
+        guard !extent.isInfinite, !extent.isEmpty, extent == extent.integral else { return image }
+
+        let width = Int(extent.width)
+        let height = Int(extent.height)
+        let attrs: [CFString: Any] = [
+            kCVPixelBufferMetalCompatibilityKey: true,
+            kCVPixelBufferIOSurfacePropertiesKey: [:] as CFDictionary
+        ]
+
+        var pixelBuffer: CVPixelBuffer?
+        let status = CVPixelBufferCreate(kCFAllocatorDefault, width, height,
+                                         kCVPixelFormatType_128RGBAFloat, attrs as CFDictionary, &pixelBuffer)
+        guard status == kCVReturnSuccess, let buffer = pixelBuffer else { return image }
+
+        RenderingManager.shared.cacheContext.render(image, to: buffer, bounds: extent, colorSpace: nil)
+
+        let stored = CIImage(cvPixelBuffer: buffer)
+            .transformed(by: CGAffineTransform(translationX: extent.minX, y: extent.minY))
+        cache.setValue(stored, forKey: key, cost: CVPixelBufferGetDataSize(buffer))
+        return stored
+    }
+
+    // Drops everything rendered from `id`'s buffers, for when they are replaced
+    func removeSource(_ id: UUID) {
+        for key in cache.keys where key.source == id {
+            _ = cache.removeValue(forKey: key)
+        }
+    }
+
+    func removeAll() {
+        cache.removeAll()
+    }
+}
@@ -0,0 +1,192 @@
+//
+//  TilePyramidCache.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+
+/*
+
+   ************** USAGE ****************
+
+
+ // ------------- Register ---------------- //
+ // The demosaic output; tiles are built from it the first time they are fetched
+ TilePyramidCache.shared.register(buffer, for: item.id, fullRes: true)
+
+ // ---------- Retrive Image ---------- //
+ // `region` of the full-resolution frame at `scale` output pixels per full-resolution pixel
+ if let ciImage = TilePyramidCache.shared.image(item.id, region: rect, nativeLongEdge: edge, scale: 0.05) {
+    // use ciImage
+ }
+
+ // ------------- Remove --------------- //
+ TilePyramidCache.shared.remove(item.id)
+
+ */
+
+
+import Foundation
+import CoreImage
+import CoreVideo
+import LRUCache
+
+// One mip pyramid (Engine/Cache/TilePyramid) per item over its demosaiced buffer: the
+// full-resolution one once getHR has made it, the display one until then. The zoomed viewport
+// and the thumbnail strip fetch from it at their own scale; its tiles are built on first use
+// and evicted one at a time from the engine's TileStore.
+final class TilePyramidCache {
+    static let shared = TilePyramidCache(limitBytes: Int(ProcessInfo.processInfo.physicalMemory / 8))
+
+    // Keeps its base buffer locked while the pyramid can still read from it
+    private final class Entry {
+        let pyramid: OpaquePointer
+        let base: CVPixelBuffer
+        let imageId: UInt64
+        let fullRes: Bool
+
+        var width: Int { CVPixelBufferGetWidth(base) }
+        var height: Int { CVPixelBufferGetHeight(base) }
+
+        init?(_ base: CVPixelBuffer, imageId: UInt64, fullRes: Bool) {
+            let format = CVPixelBufferGetPixelFormatType(base)
+            guard format == kCVPixelFormatType_64RGBAHalf || format == kCVPixelFormatType_128RGBAFloat else { return nil }
+
+            CVPixelBufferLockBaseAddress(base, .readOnly)
+            guard let address = CVPixelBufferGetBaseAddress(base),
+                  let pyramid = ForgeTilePyramidCreate(imageId, Int32(CVPixelBufferGetWidth(base)),
+                                                       Int32(CVPixelBufferGetHeight(base)), address,
+                                                       CVPixelBufferGetBytesPerRow(base),
+                                                       format == kCVPixelFormatType_64RGBAHalf) else {
+                CVPixelBufferUnlockBaseAddress(base, .readOnly)
+                return nil
+            }
+            self.pyramid = pyramid
+            self.base = base
+            self.imageId = imageId
+            self.fullRes = fullRes
+        }
+
+        deinit {
+            ForgeTilePyramidRelease(pyramid)
+            ForgeTileStoreRemoveImage(imageId)
+            CVPixelBufferUnlockBaseAddress(base, .readOnly)
+        }
+    }
+
+    private let cache: LRUCache<UUID, Entry>
+
+    // The last region fetched, which a zoomed view asks for again on every edit
+    private let lock = NSLock()
+    private var lastFetch: (id: UUID, level: Int32, rect: ForgeRect, image: CIImage)?
+
+    private init(limitBytes: Int) {
+        self.cache = LRUCache<UUID, Entry>(totalCostLimit: limitBytes)
+    }
+
+    // A full-resolution buffer replaces whatever the item had; a display one only stands in
+    // until getHR has made the full-resolution one.
+    func register(_ buffer: CVPixelBuffer, for id: UUID, fullRes: Bool) {
+        if !fullRes, cache.value(forKey: id)?.fullRes == true { return }
+
+        var imageId: UInt64 = 0
+        withUnsafeBytes(of: id.uuid) { bytes in
+            imageId = bytes.loadUnaligned(fromByteOffset: 0, as: UInt64.self) ^ bytes.loadUnaligned(fromByteOffset: 8, as: UInt64.self)
+        }
+        imageId ^= UInt64(CVPixelBufferGetWidth(buffer)) << 1 | (fullRes ? 1 : 0)
+
+        remove(id)
+        guard let entry = Entry(buffer, imageId: imageId, fullRes: fullRes) else { return }
+        cache.setValue(entry, forKey: id, cost: CVPixelBufferGetDataSize(buffer))
+    }
+
+    func remove(_ id: UUID) {
+        _ = cache.removeValue(forKey: id)
+        lock.lock()
+        if lastFetch?.id == id { lastFetch = nil }
+        lock.unlock()
+    }
+
+    func removeAll() {
+        cache.removeAll()
+        lock.lock()
+        lastFetch = nil
+        lock.unlock()
+    }
+
+    // The full-resolution frame, with its long edge `nativeLongEdge`, that the item's base covers
+    func frame(_ id: UUID, nativeLongEdge: Int) -> CGRect? {
+        guard let entry = cache.value(forKey: id), nativeLongEdge > 0 else { return nil }
+        let toNative = CGFloat(nativeLongEdge) / CGFloat(max(entry.width, entry.height))
+        return CGRect(x: 0, y: 0, width: (CGFloat(entry.width) * toNative).rounded(),
+                      height: (CGFloat(entry.height) * toNative).rounded())
+    }
+
+    // `region` of the frame above at `scale` output pixels per full-resolution pixel, placed at
+    // `region`'s position times `scale`. Read from the coarsest level that is still at least as
+    // sharp as `scale` needs.
+    func image(_ id: UUID, region: CGRect, nativeLongEdge: Int, scale: CGFloat) -> CIImage? {
+        guard let entry = cache.value(forKey: id), nativeLongEdge > 0, scale > 0 else { return nil }
+
+        // Base pixels per full-resolution pixel
+        let toBase = CGFloat(max(entry.width, entry.height)) / CGFloat(nativeLongEdge)
+        let level = ForgeTilePyramidLevelForScale(entry.pyramid, Float(scale / toBase))
+        let step = CGFloat(1 << level)
+        let levelWidth = (entry.width + (1 << level) - 1) >> level
+        let levelHeight = (entry.height + (1 << level) - 1) >> level
+
+        // In level pixels, top down as the engine's rects run
+        let base = CGRect(x: region.minX * toBase, y: region.minY * toBase,
+                          width: region.width * toBase, height: region.height * toBase)
+        let x0 = max(0, Int((base.minX / step).rounded(.down)))
+        let x1 = min(levelWidth, Int((base.maxX / step).rounded(.up)))
+        let y0 = max(0, Int(((CGFloat(entry.height) - base.maxY) / step).rounded(.down)))
+        let y1 = min(levelHeight, Int(((CGFloat(entry.height) - base.minY) / step).rounded(.up)))
+        guard x1 > x0, y1 > y0 else { return nil }
+        let rect = ForgeRect(x: Int32(x0), y: Int32(y0), width: Int32(x1 - x0), height: Int32(y1 - y0))
+
+        let fetched: CIImage
+        lock.lock()
+        let last = lastFetch
+        lock.unlock()
+        if let last, last.id == id, last.level == level, last.rect.x == rect.x, last.rect.y == rect.y,
+           last.rect.width == rect.width, last.rect.height == rect.height {
+            fetched = last.image
+        } else {
+            guard let buffer = fetch(entry, level, rect) else { return nil }
+            fetched = CIImage(cvPixelBuffer: buffer)
+            lock.lock()
+            lastFetch = (id, level, rect, fetched)
+            lock.unlock()
+        }
+
+        // Level pixels to base pixels (bottom up), then to output pixels
+        let placed = fetched
+            .transformed(by: CGAffineTransform(scaleX: step, y: step))
+            .transformed(by: CGAffineTransform(translationX: CGFloat(x0) * step,
+                                               y: CGFloat(entry.height) - CGFloat(y1) * step))
+            .transformed(by: CGAffineTransform(scaleX: scale / toBase, y: scale / toBase))
+        let output = CGRect(x: region.minX * scale, y: region.minY * scale,
+                            width: region.width * scale, height: region.height * scale).integral
+        return placed.cropped(to: output)
+    }
+
+    private func fetch(_ entry: Entry, _ level: Int32, _ rect: ForgeRect) -> CVPixelBuffer? {
+        let attrs: [CFString: Any] = [
+            kCVPixelBufferMetalCompatibilityKey: true,
+            kCVPixelBufferIOSurfacePropertiesKey: [:] as CFDictionary
+        ]
+        var pixelBuffer: CVPixelBuffer?
+        let status = CVPixelBufferCreate(kCFAllocatorDefault, Int(rect.width), Int(rect.height),
+                                         kCVPixelFormatType_128RGBAFloat, attrs as CFDictionary, &pixelBuffer)
+        guard status == kCVReturnSuccess, let buffer = pixelBuffer else { return nil }
+
+        CVPixelBufferLockBaseAddress(buffer, [])
+        defer { CVPixelBufferUnlockBaseAddress(buffer, []) }
+        guard let address = CVPixelBufferGetBaseAddress(buffer) else { return nil }
+        ForgeTilePyramidFetch(entry.pyramid, level, rect, address.assumingMemoryBound(to: Float.self),
+                              CVPixelBufferGetBytesPerRow(buffer))
+        return buffer
+    }
+}
@@ -140,6 +140,12 @@ class DataModel: ObservableObject {
                     }
                 }
                 
+                // Step 4b: Graded thumbnails straight from the raws, alongside the rest of the
+                // import rather than ahead of it; they only fill items still without a thumbnail.
+                let gradedThumbnails = Task(priority: .userInitiated) {
+                    await self.renderGradedThumbnails(newItems)
+                }
+                
                 // Step 5: Extract metadata and get camera support info
                 let cameraSupportInfo = await self.getMetaData(allItems)
                 
@@ -160,6 +166,7 @@ class DataModel: ObservableObject {
                     ImageViewModel.shared.processingFullyComplete = true
                 }
                 
+                await gradedThumbnails.value
                 await updateManifest(allItems)
                 
             } catch {
@@ -173,39 +180,15 @@ class DataModel: ObservableObject {
     
     @discardableResult
     func getHR(_ item: ImageItem) async -> CIImage? {
-
-        
-//        let cameraModel = tiff?[kCGImagePropertyTIFFModel] as? String ?? "Unknown"
-        let cameraModel = try? await getModel(item)
-        try? await Task.sleep(nanoseconds: 10_000_000)
-        
-        let originalModel = cameraModel
-        
-        if let cameraModel = cameraModel,
-           let targetModel = CameraModelMapper.getTargetModel(for: cameraModel) {
-            try? await modifyRAWModel(item, targetModel)
-            try? await Task.sleep(nanoseconds: 10_000_000)
-        }
-        
-        guard let data = await getData(at: item.url) else {
-            print("Failed to get data")
-            return nil
-        }
-        
-        guard data.cfaPattern == 0 else {
-            print("CFA pattern for \(item.url.lastPathComponent) is not RGGB, skipping GPU Demosaic")
-            return nil
-        }
-        
-        guard let fullBuffer = await demosaicGPU(data, 1) else {
-            print("Failed to Demosaic \(item.url.lastPathComponent)")
+        guard let demosaiced = await demosaicRaw(item, model: nil, queueIndex: 1) else {
             return nil
         }
+        let (fullBuffer, info) = demosaiced
         
 
         var fullRes = CIImage(cvPixelBuffer: fullBuffer)
         
-        let orientation = data.orientation
+        let orientation = info.orientation
         switch orientation {
         case 0:
             fullRes = fullRes.oriented(.up)
@@ -241,56 +224,20 @@ class DataModel: ObservableObject {
         
         await PixelBufferHRCache.shared.set(fullResBuffer, for: item.id)
         
-        
-        // Later, restore the original model
-        if let original = originalModel,
-           CameraModelMapper.needsModelChange(for: original) {
-            try? await modifyRAWModel(item, original)
-            try? await Task.sleep(nanoseconds: 10_000_000)
-        }
-        
         return CIImage(cvPixelBuffer: fullResBuffer)
     }
     
     
     @discardableResult
     func getDisplay(_ item: ImageItem) async -> CIImage? {
-        
-//        let cameraModel = tiff?[kCGImagePropertyTIFFModel] as? String ?? "Unknown"
-        let cameraModel = try? await getModel(item)
-        try? await Task.sleep(nanoseconds: 10_000_000)
-        
-        let originalModel = cameraModel
-        
-        // Change to target model if needed
-        if let model = cameraModel,
-           let targetModel = CameraModelMapper.getTargetModel(for: model) {
-            try? await modifyRAWModel(item, targetModel)
-            try? await Task.sleep(nanoseconds: 10_000_000)
-        }
-        
-        guard let data = await getData(at: item.url) else {
-            print("Failed to get data")
-            return nil
-        }
-        
-        guard data.cfaPattern == 0 else {
-            print("CFA pattern for \(item.url.lastPathComponent) is not RGGB, skipping GPU Demosaic")
-            return nil
-        }
-        
-        guard let fullBuffer = await demosaicGPU(data, 1) else {
-            print("Failed to Demosaic \(item.url.lastPathComponent)")
+        guard let demosaiced = await demosaicRaw(item, model: nil, queueIndex: 1) else {
             return nil
         }
+        let (fullBuffer, info) = demosaiced
         
-
-        
-
-
         var display = CIImage(cvPixelBuffer: fullBuffer)
         
-        let orientation = data.orientation
+        let orientation = info.orientation
         switch orientation {
         case 0:
             display = display.oriented(.up)
@@ -320,12 +267,6 @@ class DataModel: ObservableObject {
         
         await PixelBufferCache.shared.set(displayBuffer, for: item.id)
         
-        if let original = originalModel,
-           CameraModelMapper.needsModelChange(for: original) {
-            try? await modifyRAWModel(item, original)
-            try? await Task.sleep(nanoseconds: 10_000_000)
-        }
-        
         return CIImage(cvPixelBuffer: displayBuffer)
     }
     
@@ -437,7 +378,7 @@ class DataModel: ObservableObject {
     }
     
     
-    func demosaicGPU(_ rawData: RawImageData, _ index: Int) async -> CVPixelBuffer? {
+    func demosaicGPU(_ rawData: RawImageData, _ settings: MetalDemosaicProcessor.Settings, _ index: Int) async -> CVPixelBuffer? {
         
         do {
             // Process with Metal
@@ -446,7 +387,7 @@ class DataModel: ObservableObject {
                 return nil
             }
             
-            let processedBuffer = try metalProcessor.processDemosaic(rawData: rawData, coreSize: 16, queueIndex: index)
+            let processedBuffer = try metalProcessor.processDemosaic(rawData: rawData, settings: settings, queueIndex: index)
             print("Successfully processed with Metal")
             
             return processedBuffer
@@ -458,6 +399,66 @@ class DataModel: ObservableObject {
     }
     
     
+    // Demosaiced buffer for `item` and the orientation and chromaticity read with it. Served from
+    // DemosaicDiskCache when this raw has been developed before; otherwise decoded, demosaiced on
+    // the GPU and stored. `model` is the camera model if the caller already knows it; unsupported
+    // models are renamed for LibRaw and restored as soon as the raw is decoded.
+    func demosaicRaw(_ item: ImageItem, model: String?, queueIndex: Int) async -> (CVPixelBuffer, DemosaicDiskCache.Info)? {
+        let diskCache = DemosaicDiskCache.shared
+        let settings = MetalDemosaicProcessor.Settings()
+        let content = diskCache.contentHash(item.url)
+        if let cached = diskCache.load(content, settings) {
+            return cached
+        }
+        
+        var cameraModel = model
+        if cameraModel == nil {
+            cameraModel = try? await getModel(item)
+            try? await Task.sleep(nanoseconds: 10_000_000)
+        }
+        
+        if let cameraModel,
+           let targetModel = CameraModelMapper.getTargetModel(for: cameraModel) {
+            try? await modifyRAWModel(item, targetModel)
+            try? await Task.sleep(nanoseconds: 10_000_000)
+        }
+        
+        let data = await getData(at: item.url)
+        
+        if let cameraModel,
+           CameraModelMapper.needsModelChange(for: cameraModel) {
+            try? await modifyRAWModel(item, cameraModel)
+            try? await Task.sleep(nanoseconds: 10_000_000)
+        }
+        
+        guard let data else {
+            print("Failed to extract data for \(item.url.lastPathComponent)")
+            LogModel.shared.log("Failed to extract data for \(item.url.lastPathComponent)")
+            return nil
+        }
+        
+        guard data.cfaPattern == 0 else {
+            print("CFA pattern for \(item.url.lastPathComponent) is not RGGB, skipping GPU Demosaic")
+            return nil
+        }
+        
+        guard let buffer = await demosaicGPU(data, settings, queueIndex) else {
+            print("Failed to Demosaic \(item.url.lastPathComponent)")
+            LogModel.shared.log("Failed to Demosaic \(item.url.lastPathComponent)")
+            return nil
+        }
+        
+        let info = DemosaicDiskCache.Info(orientation: data.orientation,
+                                          chromaticityX: data.chromaticity_x,
+                                          chromaticityY: data.chromaticity_y)
+        // Nothing writes to the buffer after this, so the store runs behind the caller
+        Task.detached(priority: .utility) {
+            diskCache.store(buffer, info, content, settings)
+        }
+        return (buffer, info)
+    }
+    
+    
     func getDataForImages(_ items: [ImageItem], supportInfo: [CameraSupportInfo], restoredItems: [ImageItem] = []) async {
         
         // Create a lookup dictionary for restored items
@@ -504,45 +505,19 @@ class DataModel: ObservableObject {
            
            for (item, support) in itemSupportPairs {
                
-               
-
-               let cameraModel = support.model
-               
-               let originalModel = cameraModel
-               
-               // Modify the model for those not supported
-               if let targetModel = CameraModelMapper.getTargetModel(for: cameraModel) {
-                   try? await modifyRAWModel(item, targetModel)
-                   try? await Task.sleep(nanoseconds: 10_000_000)
-               }
-               
-
-               
-               guard let data = await getData(at: item.url) else {
-                   print("Failed to extract data for \(item.url.lastPathComponent)")
-                   LogModel.shared.log("Failed to extract data for \(item.url.lastPathComponent)")
+               guard let demosaiced = await demosaicRaw(item, model: support.model, queueIndex: groupIndex) else {
                    continue
                }
+               let (fullBuffer, info) = demosaiced
                
-               guard data.cfaPattern == 0 else {
-                   print("CFA pattern for \(item.url.lastPathComponent) is not RGGB, skipping GPU Demosaic")
-                   continue
-               }
-               
-               let chromX = Float(data.chromaticity_x)
-               let chromY = Float(data.chromaticity_y)
-               
-               guard let fullBuffer = await demosaicGPU(data, groupIndex) else {
-                   print("Failed to Demosaic \(item.url.lastPathComponent)")
-                   LogModel.shared.log("Failed to Demosaic \(item.url.lastPathComponent)")
-                   continue
-               }
+               let chromX = Float(info.chromaticityX)
+               let chromY = Float(info.chromaticityY)
                
                var fullRes = CIImage(cvPixelBuffer: fullBuffer)
                
 
                
-               let orientation = data.orientation
+               let orientation = info.orientation
                switch orientation {
                case 0:
                    fullRes = fullRes.oriented(.up)
@@ -673,12 +648,6 @@ class DataModel: ObservableObject {
                    }
                }
 
-               
-               // Later, restore the original model
-               if CameraModelMapper.needsModelChange(for: originalModel) {
-                   try? await modifyRAWModel(item, originalModel)
-                   try? await Task.sleep(nanoseconds: 10_000_000)
-               }
            }
        }
     
@@ -1230,6 +1199,31 @@ class DataModel: ObservableObject {
     
     
     
+    // MARK: - Graded thumbs
+    
+    // New items share the default settings, so one LUT grades them all. The per-item pipeline
+    // replaces these as it reaches each item.
+    private func renderGradedThumbnails(_ items: [ImageItem]) async {
+        guard !items.isEmpty, !pipeline.tiffScanMode else { return }
+        
+        let engine = ThumbnailEngine.shared
+        let lut = engine.bakeGrade(items[0], pipeline)
+        let images = await Task.detached(priority: .userInitiated) {
+            engine.render(items, lut: lut)
+        }.value
+        
+        await MainActor.run {
+            for (id, image) in images {
+                self.updateItem(id: id) { item in
+                    if item.thumbnailImage == nil {
+                        item.thumbnailImage = image
+                    }
+                }
+            }
+        }
+    }
+    
+    
     // MARK: - Extract thumbs
     
     private func extractThumbs(_ items: [ImageItem]) async {
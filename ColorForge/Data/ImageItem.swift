@@ -1005,6 +1005,11 @@ struct ImageItem: Identifiable, Equatable {
         self.applyTom = applyTom
 	}
 
+	// MARK: - Texture
+	// Seed for the item's procedural textures (smallPerlin): fixed per file, so previews and
+	// exports of one image match while different images get different textures.
+	var textureSeed: UInt64 { ForgeRandomSeed(url.path) }
+
 	// MARK: - Equatable
 	static func == (lhs: ImageItem, rhs: ImageItem) -> Bool {
 		lhs.id == rhs.id  && lhs.url == rhs.url
@@ -399,13 +399,16 @@ extension AiMask: Codable {
     init(from decoder: Decoder) throws {
         let container = try decoder.container(keyedBy: CodingKeys.self)
         id = try container.decode(UUID.self, forKey: .id)
-        maskUrl = try container.decode(URL.self, forKey: .maskUrl)
+        maskUrl = try container.decodeIfPresent(URL.self, forKey: .maskUrl)
         maskImageLoaded = try container.decode(Bool.self, forKey: .maskImageLoaded)
         name = try container.decode(String.self, forKey: .name)
         feather = try container.decode(Float.self, forKey: .feather)
         invert = try container.decode(Bool.self, forKey: .invert)
         opacity = try container.decode(Float.self, forKey: .opacity)
-        if let url = maskUrl,
+        // Stored masks are mapped, not decoded; older image files still load whole.
+        if let url = maskUrl, url.pathExtension == SegmentationMaskStore.fileExtension {
+            maskImage = SegmentationMaskStore.load(url)
+        } else if let url = maskUrl,
            FileManager.default.fileExists(atPath: url.path),
            let ciImage = CIImage(contentsOf: url) {
             maskImage = ciImage
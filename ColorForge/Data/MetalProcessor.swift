@@ -125,6 +125,19 @@ struct Masks {
 }
 
 class MetalDemosaicProcessor {
+	// Everything besides the raw itself that decides processDemosaic's output; DemosaicDiskCache
+	// keys its entries on it. Bump `revision` when Demosaic.metal, Params or ColorMatrix change.
+	struct Settings: Encodable {
+		let revision = 1
+		let kernel = "demosaic_linear"
+		var coreSize: UInt32 = 16
+		var leftMargin: UInt32 = 0
+		var topMargin: UInt32 = 0
+		// What LibRaw reads from the file, and the models it is told a raw is (modifyRAWModel)
+		var decoderVersion = RawDecoderVersion()
+		var modelMappings = CameraModelMapper.mappings.map { "\($0.originalModel)=\($0.targetModel)" }
+	}
+
 	static let shared: MetalDemosaicProcessor? = {
 		do {
 			return try MetalDemosaicProcessor()
@@ -171,8 +184,9 @@ class MetalDemosaicProcessor {
 			throw MetalError.libraryCreationFailed
 		}
 		
-		guard let function = library.makeFunction(name: "demosaic_linear") else {
-			throw MetalError.functionNotFound("demosaic_linear")
+		let kernel = Settings().kernel
+		guard let function = library.makeFunction(name: kernel) else {
+			throw MetalError.functionNotFound(kernel)
 		}
 		
 		do {
@@ -183,7 +197,8 @@ class MetalDemosaicProcessor {
 	}
 	
 
-    func processDemosaic(rawData: RawImageData, coreSize: UInt32 = 16, queueIndex: Int = 0) throws -> CVPixelBuffer {
+    func processDemosaic(rawData: RawImageData, settings: Settings = Settings(), queueIndex: Int = 0) throws -> CVPixelBuffer {
+		let coreSize = settings.coreSize
 		let width = Int(rawData.width)
 		let height = Int(rawData.height)
     
@@ -205,8 +220,8 @@ class MetalDemosaicProcessor {
 		// Create parameter buffers
 		var params = Params(from: rawData, coreSize: coreSize)
 		var masks = Masks()
-		var leftMargin: UInt32 = 0  // Adjust if needed
-		var topMargin: UInt32 = 0   // Adjust if needed
+		var leftMargin = settings.leftMargin
+		var topMargin = settings.topMargin
 		
 		print("Params: CFA=\(params.cfaPattern), coreSize=\(params.coreSize)")
 		print("Black levels: R=\(params.blackLevelRed), G=\(params.blackLevelGreen), B=\(params.blackLevelBlue)")
@@ -10,6 +10,8 @@ import Foundation
 
 class Preferences {
     private static let bookmarksKey = "WorkingDirectoryBookmarks"
+    private static let batchMemoryBudgetKey = "BatchMemoryBudgetBytes"
+    private static let batchThreadBudgetKey = "BatchThreadBudget"
 
     static var bookmarkedDirectories: [Data] {
         get {
@@ -27,4 +29,16 @@ class Preferences {
             }
         }
     }
+
+    // Memory batch renders may plan for at once, bytes; 0 lets the engine use half of RAM.
+    static var batchMemoryBudget: UInt64 {
+        get { UInt64(max(0, UserDefaults.standard.integer(forKey: batchMemoryBudgetKey))) }
+        set { UserDefaults.standard.set(Int(clamping: newValue), forKey: batchMemoryBudgetKey) }
+    }
+
+    // Batch jobs running at once; 0 means one per core.
+    static var batchThreadBudget: Int {
+        get { max(0, UserDefaults.standard.integer(forKey: batchThreadBudgetKey)) }
+        set { UserDefaults.standard.set(newValue, forKey: batchThreadBudgetKey) }
+    }
 }
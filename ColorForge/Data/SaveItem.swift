@@ -52,14 +52,15 @@ extension ImageItem {
             return
         }
         
-        let allMaskIDs =
+        let gradientMaskIDs =
         self.maskSettings.linearGradients.map(\.id) +
-        self.maskSettings.radialGradients.map(\.id) +
-        self.maskSettings.aiMasks.map(\.id)
+        self.maskSettings.radialGradients.map(\.id)
         
-        let maskEntries: [MaskManifest] = allMaskIDs.map { id in
+        let maskEntries: [MaskManifest] = gradientMaskIDs.map { id in
             let url = maskCacheFolder.appendingPathComponent("\(id.uuidString).jpeg")
             return MaskManifest(maskURL: url)
+        } + self.maskSettings.aiMasks.compactMap { mask in
+            mask.maskUrl.map { MaskManifest(maskURL: $0) }
         }
         
         let newEntry = ImageManifest(
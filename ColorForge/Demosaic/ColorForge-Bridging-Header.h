@@ -3,3 +3,4 @@
 //
 
 #import "DemosaicerBridge.h"
+#import "EngineBridge.h"
@@ -19,6 +19,7 @@
 #include "ColorMatrix.hpp"
 #include <CoreFoundation/CoreFoundation.h>
 #include "DemosaicerBridge.h"
+#include "ThumbnailEngine.hpp"
 
 
 
@@ -294,7 +295,62 @@ static RawImageData* ExtractRawImageDataCPP(const std::filesystem::path& path) {
 	return data;
 }
 
+// MARK: - Thumbnails
+
+// Opens `path` and hands its visible mosaic, with the same levels, CFA phase, matrix and
+// multipliers the GPU demosaic gets, to `use` while LibRaw still holds the pixels. Bayer sensors
+// only: X-Trans and linear DNGs report false and keep their embedded previews.
+static bool LoadRawMosaic(const char* path, const std::function<void(const forge::RawMosaic&)>& use) {
+	auto raw = std::make_unique<LibRaw>();
+	if (raw->open_file(path) != LIBRAW_SUCCESS) return false;
+	if (raw->unpack() != LIBRAW_SUCCESS || !raw->imgdata.rawdata.raw_image ||
+		raw->imgdata.idata.filters == 0 || raw->imgdata.idata.filters == 9) {
+		raw->recycle();
+		return false;
+	}
+
+	const auto& sizes = raw->imgdata.sizes;
+	const uint32_t LM = sizes.left_margin;
+	const uint32_t TM = sizes.top_margin;
+	const size_t stride = sizes.raw_pitch ? sizes.raw_pitch / sizeof(uint16_t) : sizes.raw_width;
+
+	forge::RawMosaic mosaic;
+	mosaic.pixels = raw->imgdata.rawdata.raw_image + TM * stride + LM;
+	mosaic.width = sizes.width;
+	mosaic.height = sizes.height;
+	mosaic.rowStride = stride;
+	mosaic.cfaPattern = int(deduce_cfa_pattern_at(*raw, LM, TM));
+	mosaic.orientation = sizes.flip;
+
+	const BlackRGB bl = compute_black_levels(*raw, LM, TM);
+	mosaic.blackLevel[0] = bl.r;
+	mosaic.blackLevel[1] = bl.g;
+	mosaic.blackLevel[2] = bl.b;
+
+	const auto& c = raw->imgdata.color;
+	float linearMax = float(std::min({c.linear_max[0], c.linear_max[1], c.linear_max[2]}));
+	if (linearMax == 0.0f) linearMax = 65535.0f;
+	mosaic.whiteLevel = std::min(float(c.maximum), linearMax);
+
+	auto [camToAWG3, camMul, chrom_x, chrom_y] = getCamToAWG3(raw->imgdata.color, raw->imgdata.idata);
+	for (int r = 0; r < 3; r++) {
+		for (int col = 0; col < 3; col++) {
+			mosaic.camToAWG3[r * 3 + col] = float(camToAWG3[r][col]);
+		}
+	}
+	mosaic.rMul = float(camMul[0]);
+	mosaic.bMul = float(camMul[2]);
+
+	use(mosaic);
+	raw->recycle();
+	return true;
+}
+
 extern "C" {
+	int32_t RawDecoderVersion(void) {
+		return int32_t(libraw_versionNumber());
+	}
+
 	// Bridge function for Swift
 	CFDictionaryRef ExtractRawImageData(CFURLRef url) {
 		std::string p = PathFromCFURL(url);
@@ -389,4 +445,30 @@ extern "C" {
 		
 		return dict; // Transferred to Swift
 	}
+
+	ForgeThumbnailBatchStats RenderRawThumbnails(const char* const* rawPaths, const char* const* outputPaths, int32_t count,
+												  ForgeThumbnailSettings settings, const float* lutRGBA, int32_t lutDimension,
+												  bool* results) {
+		if (!rawPaths || !outputPaths || count <= 0) return {};
+
+		forge::ThumbnailSettings s;
+		if (settings.maxSize > 0) s.maxSize = settings.maxSize;
+		if (settings.quality > 0) s.quality = settings.quality;
+
+		forge::GradeLut lut;
+		if (lutRGBA && lutDimension >= 2) {
+			lut.dimension = lutDimension;
+			lut.rgba.assign(lutRGBA, lutRGBA + size_t(lutDimension) * lutDimension * lutDimension * 4);
+		}
+
+		std::vector<std::string> outputs(outputPaths, outputPaths + count);
+		std::vector<uint8_t> ok;
+		const forge::ThumbnailBatchStats stats = forge::renderThumbnailBatch(size_t(count), [&](size_t i, const std::function<void(const forge::RawMosaic&)>& use) {
+			return rawPaths[i] && LoadRawMosaic(rawPaths[i], use);
+		}, outputs, s, lut.valid() ? &lut : nullptr, &ok);
+		if (results) {
+			for (int32_t i = 0; i < count; ++i) results[i] = ok[size_t(i)] != 0;
+		}
+		return { stats.images, stats.failed, stats.seconds, stats.loadSeconds, stats.renderSeconds, stats.encodeSeconds, stats.imagesPerSecond };
+	}
 }
@@ -9,6 +9,7 @@
 #pragma once
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreVideo/CoreVideo.h>
+#include "EngineBridge.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,18 @@ extern "C" {
 // Returns CFDictionary with all raw data and processing parameters
 CFDictionaryRef _Nullable ExtractRawImageData(CFURLRef _Nonnull url) CF_RETURNS_RETAINED;
 
+// LibRaw's version number; what ExtractRawImageData returns for a file can change with it.
+int32_t RawDecoderVersion(void);
+
+// Graded JPEG thumbnails of `count` raws, one file per worker, each decoded straight from its
+// mosaic (ColorForge/Engine/Pipeline/ThumbnailEngine). `lutRGBA` is a baked grade of
+// `lutDimension`³ RGBA floats in CIColorCube order, or null for the LogC image. `results`, if
+// given, gets a flag per file; non-Bayer raws fail and keep whatever thumbnail they had.
+ForgeThumbnailBatchStats RenderRawThumbnails(const char* _Nonnull const* _Nonnull rawPaths,
+											 const char* _Nonnull const* _Nonnull outputPaths, int32_t count,
+											 ForgeThumbnailSettings settings, const float* _Nullable lutRGBA,
+											 int32_t lutDimension, bool* _Nullable results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,155 @@
+//
+//  CacheDirectory.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "CacheDirectory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace forge {
+
+// Milliseconds, so entries written within the same second still evict in the order they were used.
+static int64_t nowMillis() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+CacheDirectory::CacheDirectory(std::string directory, uint64_t capacityBytes, std::string extension)
+	: directory_(std::move(directory)), extension_(std::move(extension)), capacity_(capacityBytes) {}
+
+void CacheDirectory::configure(std::string directory, uint64_t capacityBytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	directory_ = std::move(directory);
+	capacity_ = capacityBytes;
+	indexLoaded_ = false;
+	entries_.clear();
+	total_ = 0;
+}
+
+void CacheDirectory::setCapacity(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	capacity_ = bytes;
+	loadIndex();
+	evictToCap();
+}
+
+bool CacheDirectory::enabled() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return !directory_.empty() && capacity_ > 0;
+}
+
+std::string CacheDirectory::path(const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (directory_.empty() || capacity_ == 0) return {};
+	loadIndex();
+	return (fs::path(directory_) / name).string();
+}
+
+void CacheDirectory::loadIndex() {
+	if (indexLoaded_ || directory_.empty()) return;
+	indexLoaded_ = true;
+	std::error_code ec;
+	fs::create_directories(directory_, ec);
+
+	const auto now = fs::file_time_type::clock::now();
+	for (const auto& item : fs::directory_iterator(directory_, ec)) {
+		if (!item.is_regular_file(ec)) continue;
+		const std::string name = item.path().filename().string();
+		const auto modified = item.last_write_time(ec);
+
+		// Temporaries left behind by a crash. Recent ones may belong to a write in progress.
+		if (name.find(".tmp.") != std::string::npos) {
+			if (now - modified > std::chrono::hours(1)) fs::remove(item.path(), ec);
+			continue;
+		}
+		if (item.path().extension() != extension_) continue;
+
+		EntryInfo info;
+		info.bytes = item.file_size(ec);
+		info.lastUse = std::chrono::duration_cast<std::chrono::milliseconds>(modified.time_since_epoch()).count();
+		entries_[name] = info;
+		total_ += info.bytes;
+	}
+}
+
+void CacheDirectory::evictToCap() {
+	if (total_ <= capacity_) return;
+	std::vector<std::pair<int64_t, std::string>> byAge;
+	byAge.reserve(entries_.size());
+	for (const auto& [name, info] : entries_) byAge.emplace_back(info.lastUse, name);
+	std::sort(byAge.begin(), byAge.end());
+
+	std::error_code ec;
+	for (const auto& [lastUse, name] : byAge) {
+		if (total_ <= capacity_) break;
+		fs::remove(fs::path(directory_) / name, ec);
+		total_ -= entries_[name].bytes;
+		entries_.erase(name);
+	}
+}
+
+bool CacheDirectory::contains(const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	loadIndex();
+	return entries_.count(name) != 0;
+}
+
+bool CacheDirectory::touch(const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	loadIndex();
+	auto it = entries_.find(name);
+	if (it == entries_.end()) return false;
+	it->second.lastUse = nowMillis();
+
+	// Touch the file so the LRU order survives restarts.
+	std::error_code ec;
+	fs::last_write_time(fs::path(directory_) / name, fs::file_time_type::clock::now(), ec);
+	return true;
+}
+
+void CacheDirectory::added(const std::string& name, uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	loadIndex();
+	auto& info = entries_[name];
+	total_ -= info.bytes;
+	info.bytes = bytes;
+	info.lastUse = nowMillis();
+	total_ += bytes;
+	evictToCap();
+}
+
+void CacheDirectory::remove(const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (directory_.empty()) return;
+	std::error_code ec;
+	fs::remove(fs::path(directory_) / name, ec);
+	auto it = entries_.find(name);
+	if (it != entries_.end()) {
+		total_ -= it->second.bytes;
+		entries_.erase(it);
+	}
+}
+
+void CacheDirectory::removeAll() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	loadIndex();
+	std::error_code ec;
+	for (const auto& [name, info] : entries_) fs::remove(fs::path(directory_) / name, ec);
+	entries_.clear();
+	total_ = 0;
+}
+
+uint64_t CacheDirectory::totalBytes() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	loadIndex();
+	return total_;
+}
+
+} // namespace forge
@@ -0,0 +1,60 @@
+//
+//  CacheDirectory.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace forge {
+
+// Bookkeeping for a directory of cache files with one extension and a byte cap: which entries
+// exist, how big they are and when each was last used. The least recently used entries are
+// deleted first. Use times are file modification times, so the order survives restarts.
+// The directory is scanned lazily on first use; temporaries left by a crash are removed then.
+class CacheDirectory {
+public:
+	CacheDirectory(std::string directory, uint64_t capacityBytes, std::string extension);
+
+	void configure(std::string directory, uint64_t capacityBytes);
+	void setCapacity(uint64_t bytes);
+
+	// False until configured with a directory and a non-zero capacity.
+	bool enabled();
+	// Full path for `name`; empty when disabled.
+	std::string path(const std::string& name);
+
+	bool contains(const std::string& name);
+	// Marks `name` as just used. False if there is no such entry.
+	bool touch(const std::string& name);
+	// Records a newly written entry, then evicts down to the cap.
+	void added(const std::string& name, uint64_t bytes);
+	void remove(const std::string& name);
+	void removeAll();
+	uint64_t totalBytes();
+
+private:
+	struct EntryInfo {
+		uint64_t bytes = 0;
+		int64_t lastUse = 0;
+	};
+
+	void loadIndex();  // requires mutex_
+	void evictToCap(); // requires mutex_
+
+	std::mutex mutex_;
+	std::string directory_;
+	std::string extension_;
+	uint64_t capacity_ = 0;
+	uint64_t total_ = 0;
+	bool indexLoaded_ = false;
+	std::unordered_map<std::string, EntryInfo> entries_;
+};
+
+} // namespace forge
@@ -0,0 +1,407 @@
+//
+//  DemosaicDiskCache.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "DemosaicDiskCache.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "TileCodec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace forge {
+
+static constexpr char kMagic[4] = { 'C', 'F', 'D', 'C' };
+static constexpr uint32_t kVersion = 2;
+static constexpr int kDiskTileSize = 256;
+static constexpr const char* kExtension = ".cfdc";
+
+struct DiskCacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t content;
+	uint64_t params;
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileSize;
+	uint32_t tilesAcross;
+	uint32_t tilesDown;
+	uint32_t indexCrc;
+	uint64_t indexOffset;
+	uint32_t metadataSize;
+	uint32_t metadataCrc;
+};
+static_assert(sizeof(DiskCacheHeader) == 64, "DiskCacheHeader layout changed");
+
+struct DiskTileEntry {
+	uint64_t offset;
+	uint32_t size;
+	uint32_t crc;
+};
+static_assert(sizeof(DiskTileEntry) == 16, "DiskTileEntry layout changed");
+
+std::string DiskCacheKey::fileName() const {
+	char name[48];
+	std::snprintf(name, sizeof(name), "%016llx-%016llx", (unsigned long long)content, (unsigned long long)params);
+	return std::string(name) + kExtension;
+}
+
+// MARK: - CachedImage
+
+bool CachedImage::readTile(int tx, int ty, half_t* dst) const {
+	if (tx < 0 || ty < 0 || tx >= tilesAcross_ || ty >= tilesDown_) return false;
+	DiskTileEntry e;
+	std::memcpy(&e, index_ + (size_t(ty) * size_t(tilesAcross_) + size_t(tx)) * sizeof(DiskTileEntry), sizeof(e));
+	if (e.offset + e.size > file_.size()) return false;
+
+	const uint8_t* blob = file_.data() + e.offset;
+	if (crc32Bytes(blob, e.size) != e.crc) return false;
+
+	const int w = std::min(tileSize_, width_ - tx * tileSize_);
+	const int h = std::min(tileSize_, height_ - ty * tileSize_);
+	return decodeHalfBlock(blob, e.size, w, h, 4, dst);
+}
+
+template <typename Writer>
+bool CachedImage::readRegion(const Rect& region, Writer&& write) const {
+	const Rect r = region.intersect({ 0, 0, width_, height_ });
+	if (r.empty()) return false;
+
+	const int tx0 = r.x / tileSize_, tx1 = (r.right() - 1) / tileSize_;
+	const int ty0 = r.y / tileSize_, ty1 = (r.bottom() - 1) / tileSize_;
+	const int across = tx1 - tx0 + 1;
+	std::atomic<bool> ok{ true };
+
+	parallelFor(size_t(across) * size_t(ty1 - ty0 + 1), [&](size_t i) {
+		const int tx = tx0 + int(i % size_t(across));
+		const int ty = ty0 + int(i / size_t(across));
+		const Rect tileRect{ tx * tileSize_, ty * tileSize_,
+							 std::min(tileSize_, width_ - tx * tileSize_), std::min(tileSize_, height_ - ty * tileSize_) };
+		std::vector<half_t> tile(size_t(tileRect.width) * size_t(tileRect.height) * 4);
+		if (!readTile(tx, ty, tile.data())) {
+			ok = false;
+			return;
+		}
+		const Rect part = tileRect.intersect(r);
+		for (int y = part.y; y < part.bottom(); ++y) {
+			const half_t* src = &tile[(size_t(y - tileRect.y) * size_t(tileRect.width) + size_t(part.x - tileRect.x)) * 4];
+			write(part.x - region.x, y - region.y, src, part.width);
+		}
+	});
+	return ok;
+}
+
+bool CachedImage::read(const Rect& region, const ImageView& dst) const {
+	if (!dst.valid() || dst.channels != 4) return false;
+	return readRegion(region, [&](int x, int y, const half_t* src, int count) {
+		halfToFloat(src, dst.pixel(x, y), size_t(count) * 4);
+	});
+}
+
+bool CachedImage::readHalf(const Rect& region, half_t* dst, size_t dstRowStride) const {
+	if (!dst) return false;
+	return readRegion(region, [&](int x, int y, const half_t* src, int count) {
+		std::memcpy(dst + size_t(y) * dstRowStride + size_t(x) * 4, src, size_t(count) * 4 * sizeof(half_t));
+	});
+}
+
+// MARK: - DemosaicDiskCache
+
+DemosaicDiskCache::DemosaicDiskCache(std::string directory, uint64_t capacityBytes)
+	: directory_(std::move(directory), capacityBytes, kExtension) {}
+
+DemosaicDiskCache& DemosaicDiskCache::shared() {
+	static DemosaicDiskCache cache("", 0);
+	return cache;
+}
+
+void DemosaicDiskCache::configure(std::string directory, uint64_t capacityBytes) {
+	directory_.configure(std::move(directory), capacityBytes);
+}
+
+uint64_t DemosaicDiskCache::hashFileContent(const std::string& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return 0;
+	struct stat st {};
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return 0;
+	}
+
+	constexpr size_t kWindow = 64 * 1024;
+	constexpr int kWindows = 16;
+	const uint64_t size = uint64_t(st.st_size);
+	uint64_t h = hashCombine(0x43464443ull, size);
+	std::vector<uint8_t> buffer(kWindow);
+
+	for (int i = 0; i < kWindows; ++i) {
+		// First window at 0, last one flush with the end of the file.
+		const uint64_t span = size > kWindow ? size - kWindow : 0;
+		const uint64_t offset = span * uint64_t(i) / uint64_t(kWindows - 1);
+		const ssize_t n = pread(fd, buffer.data(), kWindow, off_t(offset));
+		if (n <= 0) break;
+		h = hashCombine(h, hashBytes(buffer.data(), size_t(n)));
+		if (size <= kWindow) break;
+	}
+	::close(fd);
+	return h;
+}
+
+bool DemosaicDiskCache::contains(const DiskCacheKey& key) {
+	return directory_.contains(key.fileName());
+}
+
+std::unique_ptr<CachedImage> DemosaicDiskCache::open(const DiskCacheKey& key) {
+	if (!directory_.touch(key.fileName())) return nullptr;
+	const std::string path = directory_.path(key.fileName());
+
+	auto image = std::make_unique<CachedImage>();
+	DiskCacheHeader header{};
+	bool ok = image->file_.open(path) && image->file_.size() >= sizeof(header);
+	if (ok) {
+		std::memcpy(&header, image->file_.data(), sizeof(header));
+		const uint64_t tiles = uint64_t(header.tilesAcross) * header.tilesDown;
+		ok = std::memcmp(header.magic, kMagic, 4) == 0 && header.version == kVersion &&
+			 header.content == key.content && header.params == key.params && header.tileSize > 0 &&
+			 sizeof(header) + uint64_t(header.metadataSize) <= image->file_.size() &&
+			 header.indexOffset + tiles * sizeof(DiskTileEntry) <= image->file_.size();
+		if (ok) {
+			image->metadata_ = image->file_.data() + sizeof(header);
+			image->metadataSize_ = header.metadataSize;
+			image->index_ = image->file_.data() + header.indexOffset;
+			ok = crc32Bytes(image->metadata_, image->metadataSize_) == header.metadataCrc &&
+				 crc32Bytes(image->index_, size_t(tiles * sizeof(DiskTileEntry))) == header.indexCrc;
+		}
+	}
+
+	if (!ok) {
+		remove(key);
+		return nullptr;
+	}
+
+	image->width_ = int(header.width);
+	image->height_ = int(header.height);
+	image->tileSize_ = int(header.tileSize);
+	image->tilesAcross_ = int(header.tilesAcross);
+	image->tilesDown_ = int(header.tilesDown);
+	return image;
+}
+
+bool DemosaicDiskCache::store(const DiskCacheKey& key, const ImageView& image, std::string_view metadata) {
+	if (!image.valid() || image.channels != 4) return false;
+	return storeTiles(key, image.width, image.height, metadata, [&](const Rect& t, half_t* dst) {
+		for (int y = 0; y < t.height; ++y) {
+			floatToHalf(image.pixel(t.x, t.y + y), dst + size_t(y) * size_t(t.width) * 4, size_t(t.width) * 4);
+		}
+	});
+}
+
+bool DemosaicDiskCache::store(const DiskCacheKey& key, const half_t* pixels, size_t rowStride, int width, int height,
+							  std::string_view metadata) {
+	if (!pixels || width <= 0 || height <= 0) return false;
+	return storeTiles(key, width, height, metadata, [&](const Rect& t, half_t* dst) {
+		for (int y = 0; y < t.height; ++y) {
+			std::memcpy(dst + size_t(y) * size_t(t.width) * 4, pixels + size_t(t.y + y) * rowStride + size_t(t.x) * 4,
+						size_t(t.width) * 4 * sizeof(half_t));
+		}
+	});
+}
+
+bool DemosaicDiskCache::storeTiles(const DiskCacheKey& key, int width, int height, std::string_view metadata,
+								   const TileFiller& fill) {
+	const std::string path = directory_.path(key.fileName());
+	if (path.empty() || metadata.size() > UINT32_MAX) return false;
+
+	const int across = (width + kDiskTileSize - 1) / kDiskTileSize;
+	const int down = (height + kDiskTileSize - 1) / kDiskTileSize;
+	std::vector<DiskTileEntry> index(size_t(across) * size_t(down));
+
+	AtomicFileWriter writer(path);
+	DiskCacheHeader header{};
+	if (!writer.write(&header, sizeof(header))) return false; // placeholder, rewritten on completion
+	if (!writer.write(metadata.data(), metadata.size())) return false;
+
+	// One row of tiles at a time: encode in parallel, append in order. Peak memory is one tile row.
+	std::vector<std::vector<uint8_t>> blobs(static_cast<size_t>(across));
+	for (int ty = 0; ty < down; ++ty) {
+		parallelFor(size_t(across), [&](size_t tx) {
+			const Rect t{ int(tx) * kDiskTileSize, ty * kDiskTileSize,
+						  std::min(kDiskTileSize, width - int(tx) * kDiskTileSize), std::min(kDiskTileSize, height - ty * kDiskTileSize) };
+			std::vector<half_t> tile(size_t(t.width) * size_t(t.height) * 4);
+			fill(t, tile.data());
+			blobs[tx].clear();
+			encodeHalfBlock(tile.data(), t.width, t.height, 4, blobs[tx]);
+		});
+		for (int tx = 0; tx < across; ++tx) {
+			auto& e = index[size_t(ty) * size_t(across) + size_t(tx)];
+			e.offset = writer.offset();
+			e.size = uint32_t(blobs[size_t(tx)].size());
+			e.crc = crc32Bytes(blobs[size_t(tx)].data(), e.size);
+			if (!writer.write(blobs[size_t(tx)].data(), e.size)) return false;
+		}
+	}
+
+	std::memcpy(header.magic, kMagic, 4);
+	header.version = kVersion;
+	header.content = key.content;
+	header.params = key.params;
+	header.width = uint32_t(width);
+	header.height = uint32_t(height);
+	header.tileSize = kDiskTileSize;
+	header.tilesAcross = uint32_t(across);
+	header.tilesDown = uint32_t(down);
+	header.indexOffset = writer.offset();
+	header.indexCrc = crc32Bytes(index.data(), index.size() * sizeof(DiskTileEntry));
+	header.metadataSize = uint32_t(metadata.size());
+	header.metadataCrc = crc32Bytes(metadata.data(), metadata.size());
+
+	if (!writer.write(index.data(), index.size() * sizeof(DiskTileEntry))) return false;
+	if (!writer.writeAt(0, &header, sizeof(header))) return false;
+	const uint64_t bytes = writer.offset();
+	if (!writer.commit()) return false;
+
+	directory_.added(key.fileName(), bytes);
+	return true;
+}
+
+void DemosaicDiskCache::remove(const DiskCacheKey& key) {
+	directory_.remove(key.fileName());
+}
+
+void DemosaicDiskCache::removeAll() {
+	directory_.removeAll();
+}
+
+void DemosaicDiskCache::setCapacity(uint64_t bytes) {
+	directory_.setCapacity(bytes);
+}
+
+uint64_t DemosaicDiskCache::totalBytes() {
+	return directory_.totalBytes();
+}
+
+// MARK: - Benchmark
+
+DemosaicDiskCacheBenchmark benchmarkDemosaicDiskCache(int width, int height) {
+	namespace fs = std::filesystem;
+	using Clock = std::chrono::steady_clock;
+	width = std::max(1, width);
+	height = std::max(1, height);
+
+	std::error_code ec;
+	const fs::path directory = fs::temp_directory_path(ec) / ("ColorForgeDemosaicCacheBenchmark-" + std::to_string(getpid()));
+	fs::remove_all(directory, ec);
+
+	// Smooth gradients with a fine pattern on top, like a demosaic: compressible but not trivially.
+	const size_t stride = size_t(width) * 4;
+	std::vector<half_t> pixels(stride * size_t(height));
+	parallelFor(size_t(height), [&](size_t y) {
+		half_t* row = &pixels[y * stride];
+		for (int x = 0; x < width; ++x) {
+			row[x * 4 + 0] = floatToHalf(float(x) / float(width) + float((x * 7 + int(y) * 13) % 17) * 1e-3f);
+			row[x * 4 + 1] = floatToHalf(float(y) / float(height));
+			row[x * 4 + 2] = floatToHalf(float((x / 8 + int(y) / 8) % 3) * 0.3f);
+			row[x * 4 + 3] = floatToHalf(1.0f);
+		}
+	});
+
+	DemosaicDiskCacheBenchmark result;
+	const DiskCacheKey key{ 0x1234, 1 };
+	const std::string metadata = R"({"orientation":6,"chromaticityX":0.3127,"chromaticityY":0.329})";
+	DemosaicDiskCache cache(directory.string(), uint64_t(1) << 40);
+
+	auto start = Clock::now();
+	const bool stored = cache.store(key, pixels.data(), stride, width, height, metadata);
+	result.storeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Read back: open the entry and decode every tile.
+	if (stored) {
+		std::vector<half_t> back(pixels.size());
+		start = Clock::now();
+		if (auto image = cache.open(key)) image->readHalf({ 0, 0, width, height }, back.data(), stride);
+		result.readSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	fs::remove_all(directory, ec);
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	void ForgeDemosaicDiskCacheConfigure(const char* directory, uint64_t capacityBytes) {
+		forge::DemosaicDiskCache::shared().configure(directory ? directory : "", capacityBytes);
+	}
+
+	uint64_t ForgeHashFileContent(const char* path) {
+		return path ? forge::DemosaicDiskCache::hashFileContent(path) : 0;
+	}
+
+	uint64_t ForgeDemosaicDiskCacheParamsHash(const void* bytes, size_t size) {
+		return forge::hashBytes(bytes, bytes ? size : 0);
+	}
+
+	bool ForgeDemosaicDiskCacheLookup(uint64_t contentHash, uint64_t paramsHash, int32_t* width, int32_t* height,
+									  void* metadata, size_t metadataCapacity, size_t* metadataSize) {
+		auto image = forge::DemosaicDiskCache::shared().open({ contentHash, paramsHash });
+		if (!image) return false;
+		if (width) *width = image->width();
+		if (height) *height = image->height();
+		if (metadataSize) *metadataSize = image->metadata().size();
+		if (metadata) std::memcpy(metadata, image->metadata().data(), std::min(metadataCapacity, image->metadata().size()));
+		return true;
+	}
+
+	bool ForgeDemosaicDiskCacheRead(uint64_t contentHash, uint64_t paramsHash, void* dst, size_t rowBytes, bool dstIsHalf) {
+		auto image = forge::DemosaicDiskCache::shared().open({ contentHash, paramsHash });
+		if (!image || !dst) return false;
+		const forge::Rect all{ 0, 0, image->width(), image->height() };
+		bool ok;
+		if (dstIsHalf) {
+			ok = image->readHalf(all, static_cast<forge::half_t*>(dst), rowBytes / sizeof(forge::half_t));
+		} else {
+			const forge::ImageView view{ static_cast<float*>(dst), image->width(), image->height(), 4, rowBytes / sizeof(float) };
+			ok = image->read(all, view);
+		}
+		// A damaged tile: drop the entry so the next load decodes the raw and stores it afresh.
+		if (!ok) forge::DemosaicDiskCache::shared().remove({ contentHash, paramsHash });
+		return ok;
+	}
+
+	bool ForgeDemosaicDiskCacheStore(uint64_t contentHash, uint64_t paramsHash, const void* pixels, size_t rowBytes,
+									 int32_t width, int32_t height, bool pixelsAreHalf, const void* metadata, size_t metadataSize) {
+		if (!pixels) return false;
+		auto& cache = forge::DemosaicDiskCache::shared();
+		const std::string_view info(static_cast<const char*>(metadata), metadata ? metadataSize : 0);
+		if (pixelsAreHalf) {
+			return cache.store({ contentHash, paramsHash }, static_cast<const forge::half_t*>(pixels),
+							   rowBytes / sizeof(forge::half_t), width, height, info);
+		}
+		const forge::ImageView view{ const_cast<float*>(static_cast<const float*>(pixels)), width, height, 4, rowBytes / sizeof(float) };
+		return cache.store({ contentHash, paramsHash }, view, info);
+	}
+
+	ForgeDemosaicDiskCacheBenchmark ForgeBenchmarkDemosaicDiskCache(int32_t width, int32_t height) {
+		const forge::DemosaicDiskCacheBenchmark b = forge::benchmarkDemosaicDiskCache(width, height);
+		return { b.storeSeconds, b.readSeconds };
+	}
+
+	void ForgeDemosaicDiskCacheRemoveAll(void) {
+		forge::DemosaicDiskCache::shared().removeAll();
+	}
+}
@@ -0,0 +1,121 @@
+//
+//  DemosaicDiskCache.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "CacheDirectory.hpp"
+#include "EngineImage.hpp"
+#include "FileIO.hpp"
+#include "Half.hpp"
+
+namespace forge {
+
+/*
+ On-disk cache of the demosaiced LogC/AWG3 intermediate, so reopening a catalogue doesn't
+ re-decode and re-demosaic every raw.
+
+ Entries are keyed by a content hash of the raw file plus a hash of the demosaic parameters
+ and stored as one file each: the caller's metadata (what it read from the raw alongside the
+ pixels), then 256² fp16 RGBA tiles, each TileCodec-compressed and CRC'd, then a tile index.
+ Keeping the metadata inside the entry means eviction can never leave one without the other. Reads go through mmap and decode only the tiles asked for.
+ Writes are atomic (temp file, fsync, rename), so a crash never leaves a torn entry. The
+ directory has a byte cap; least recently used entries are deleted first.
+
+ File layout (little-endian):
+   DiskCacheHeader                          64 bytes
+   metadata                                 header.metadataSize bytes
+   tile blobs
+   DiskTileEntry[tilesAcross * tilesDown]   at header.indexOffset
+ */
+
+struct DiskCacheKey {
+	uint64_t content = 0; // DemosaicDiskCache::hashFileContent of the raw
+	uint64_t params = 0;  // demosaic settings (algorithm, white balance source, crop, ...)
+
+	std::string fileName() const;
+};
+
+// Read-only view of one cache entry.
+class CachedImage {
+public:
+	int width() const { return width_; }
+	int height() const { return height_; }
+	int tileSize() const { return tileSize_; }
+
+	// Decodes `region` into RGBA float or half, decoding tiles in parallel. False on corruption.
+	bool read(const Rect& region, const ImageView& dst) const;
+	bool readHalf(const Rect& region, half_t* dst, size_t dstRowStride) const;
+
+	// One tile, tileSize² RGBA halfs (edge tiles are not padded beyond their valid area).
+	bool readTile(int tx, int ty, half_t* dst) const;
+
+	// The bytes stored with the entry; valid while this CachedImage lives.
+	std::string_view metadata() const { return { reinterpret_cast<const char*>(metadata_), metadataSize_ }; }
+
+private:
+	friend class DemosaicDiskCache;
+
+	template <typename Writer>
+	bool readRegion(const Rect& region, Writer&& write) const;
+
+	MappedFile file_;
+	int width_ = 0;
+	int height_ = 0;
+	int tileSize_ = 0;
+	int tilesAcross_ = 0;
+	int tilesDown_ = 0;
+	const uint8_t* index_ = nullptr;
+	const uint8_t* metadata_ = nullptr;
+	size_t metadataSize_ = 0;
+};
+
+class DemosaicDiskCache {
+public:
+	DemosaicDiskCache(std::string directory, uint64_t capacityBytes);
+
+	// Process-wide instance. Disabled (every lookup misses) until configure() is called.
+	static DemosaicDiskCache& shared();
+	void configure(std::string directory, uint64_t capacityBytes);
+
+	// Hash of the file size and sixteen 64KB windows spread over the file. Raw sensor data
+	// differs everywhere between frames, so this identifies a file as reliably as a full hash
+	// at a fraction of the I/O; a full pass over a 3,000-image catalogue would take minutes.
+	static uint64_t hashFileContent(const std::string& path);
+
+	bool contains(const DiskCacheKey& key);
+	std::unique_ptr<CachedImage> open(const DiskCacheKey& key);
+
+	bool store(const DiskCacheKey& key, const ImageView& image, std::string_view metadata = {});
+	bool store(const DiskCacheKey& key, const half_t* pixels, size_t rowStride, int width, int height,
+			   std::string_view metadata = {});
+
+	void remove(const DiskCacheKey& key);
+	void removeAll();
+	void setCapacity(uint64_t bytes);
+	uint64_t totalBytes();
+
+private:
+	using TileFiller = std::function<void(const Rect& tile, half_t* dst)>; // dst is tile-width packed
+	bool storeTiles(const DiskCacheKey& key, int width, int height, std::string_view metadata, const TileFiller& fill);
+
+	CacheDirectory directory_;
+};
+
+struct DemosaicDiskCacheBenchmark {
+	double storeSeconds = 0.0;
+	double readSeconds = 0.0;  // open and decode every tile
+};
+
+// Stores a synthetic `width` × `height` RGBA half frame in a scratch directory and reads it back.
+DemosaicDiskCacheBenchmark benchmarkDemosaicDiskCache(int width, int height);
+
+} // namespace forge
@@ -0,0 +1,395 @@
+//
+//  TilePyramid.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "TilePyramid.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "SystemInfo.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace forge {
+
+static constexpr size_t kTileHalfs = size_t(kTileSize) * kTileSize * 4;
+
+size_t TileKeyHash::operator()(const TileKey& k) const {
+	uint64_t h = hashCombine(k.image, uint64_t(uint32_t(k.level)));
+	return size_t(hashCombine(h, (uint64_t(uint32_t(k.tx)) << 32) | uint32_t(k.ty)));
+}
+
+// MARK: - TileStore
+
+TileStore::TileStore(uint64_t budgetBytes) : budget_(budgetBytes) {}
+
+TileStore& TileStore::shared() {
+	static TileStore store(physicalMemoryBytes() / 8);
+	return store;
+}
+
+std::shared_ptr<const HalfTile> TileStore::find(const TileKey& key) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key);
+	if (it == index_.end()) {
+		stats_.misses++;
+		return nullptr;
+	}
+	lru_.splice(lru_.begin(), lru_, it->second);
+	stats_.hits++;
+	return it->second->tile;
+}
+
+void TileStore::insert(const TileKey& key, std::shared_ptr<const HalfTile> tile) {
+	if (!tile) return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (auto it = index_.find(key); it != index_.end()) {
+		bytes_ -= it->second->tile->size() * sizeof(half_t);
+		lru_.erase(it->second);
+		index_.erase(it);
+	}
+	bytes_ += tile->size() * sizeof(half_t);
+	lru_.push_front({ key, std::move(tile) });
+	index_[key] = lru_.begin();
+	evictToBudget();
+}
+
+void TileStore::removeImage(uint64_t image) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto it = lru_.begin(); it != lru_.end();) {
+		if (it->key.image == image) {
+			bytes_ -= it->tile->size() * sizeof(half_t);
+			index_.erase(it->key);
+			it = lru_.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void TileStore::removeAll() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	lru_.clear();
+	index_.clear();
+	bytes_ = 0;
+}
+
+void TileStore::setBudget(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	budget_ = bytes;
+	evictToBudget();
+}
+
+TileStoreStats TileStore::stats() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	TileStoreStats s = stats_;
+	s.bytes = bytes_;
+	s.budget = budget_;
+	s.tiles = index_.size();
+	return s;
+}
+
+void TileStore::evictToBudget() {
+	// Always keep the newest tile, even if a tiny budget can't hold it.
+	while (bytes_ > budget_ && lru_.size() > 1) {
+		auto last = std::prev(lru_.end());
+		bytes_ -= last->tile->size() * sizeof(half_t);
+		index_.erase(last->key);
+		lru_.erase(last);
+		stats_.evictions++;
+	}
+}
+
+// MARK: - TilePyramid
+
+TilePyramid::TilePyramid(uint64_t image, int width, int height, BaseProvider provider, TileStore& store)
+	: image_(image), width_(std::max(1, width)), height_(std::max(1, height)), provider_(std::move(provider)), store_(store) {
+	levels_ = 1;
+	while (std::max(levelWidth(levels_ - 1), levelHeight(levels_ - 1)) > kTileSize) ++levels_;
+}
+
+int TilePyramid::levelWidth(int level) const {
+	return std::max(1, (width_ + (1 << level) - 1) >> level);
+}
+
+int TilePyramid::levelHeight(int level) const {
+	return std::max(1, (height_ + (1 << level) - 1) >> level);
+}
+
+int TilePyramid::levelForScale(float scale) const {
+	if (!(scale > 0.0f) || scale >= 1.0f) return 0;
+	const int level = int(std::floor(std::log2(1.0f / scale) + 1e-4f));
+	return std::clamp(level, 0, levels_ - 1);
+}
+
+std::shared_ptr<const HalfTile> TilePyramid::tile(int level, int tx, int ty) {
+	const TileKey key{ image_, level, tx, ty };
+	if (auto cached = store_.find(key)) return cached;
+
+	std::promise<std::shared_ptr<const HalfTile>> promise;
+	std::shared_future<std::shared_ptr<const HalfTile>> pending;
+	{
+		std::lock_guard<std::mutex> lock(inflightMutex_);
+		auto it = inflight_.find(key);
+		if (it != inflight_.end()) {
+			pending = it->second;
+		} else {
+			inflight_[key] = promise.get_future().share();
+		}
+	}
+	if (pending.valid()) return pending.get();
+
+	std::shared_ptr<const HalfTile> built;
+	try {
+		built = build(level, tx, ty);
+		store_.insert(key, built);
+		promise.set_value(built);
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+		std::lock_guard<std::mutex> lock(inflightMutex_);
+		inflight_.erase(key);
+		throw;
+	}
+
+	std::lock_guard<std::mutex> lock(inflightMutex_);
+	inflight_.erase(key);
+	return built;
+}
+
+// Repeats the last valid column and row out to the tile edge so readers never need bounds checks.
+static void padTile(HalfTile& t, int w, int h) {
+	for (int y = 0; y < h; ++y) {
+		half_t* row = &t[size_t(y) * kTileSize * 4];
+		for (int x = w; x < kTileSize; ++x) std::memcpy(row + size_t(x) * 4, row + size_t(w - 1) * 4, 4 * sizeof(half_t));
+	}
+	const half_t* last = &t[size_t(h - 1) * kTileSize * 4];
+	for (int y = h; y < kTileSize; ++y) std::memcpy(&t[size_t(y) * kTileSize * 4], last, size_t(kTileSize) * 4 * sizeof(half_t));
+}
+
+std::shared_ptr<const HalfTile> TilePyramid::build(int level, int tx, int ty) {
+	const int x0 = tx * kTileSize;
+	const int y0 = ty * kTileSize;
+	const int w = std::min(kTileSize, levelWidth(level) - x0);
+	const int h = std::min(kTileSize, levelHeight(level) - y0);
+	auto out = std::make_shared<HalfTile>(kTileHalfs);
+
+	if (level == 0) {
+		ImageBuffer pixels(w, h, 4);
+		provider_({ x0, y0, w, h }, pixels.view());
+		const ImageView v = pixels.view();
+		for (int y = 0; y < h; ++y) floatToHalf(v.row(y), &(*out)[size_t(y) * kTileSize * 4], size_t(w) * 4);
+		padTile(*out, w, h);
+		return out;
+	}
+
+	// Up to four children one level down, fetched in parallel.
+	const int child = level - 1;
+	const int cw = levelWidth(child);
+	const int ch = levelHeight(child);
+	std::shared_ptr<const HalfTile> children[2][2];
+	parallelFor(4, [&](size_t i) {
+		const int cx = 2 * tx + int(i & 1);
+		const int cy = 2 * ty + int(i >> 1);
+		if (cx < tilesAcross(child) && cy < tilesDown(child)) children[i >> 1][i & 1] = tile(child, cx, cy);
+	});
+
+	auto sample = [&](int sx, int sy, float* acc) {
+		sx = std::min(sx, cw - 1) - 2 * x0;
+		sy = std::min(sy, ch - 1) - 2 * y0;
+		const HalfTile& t = *children[sy / kTileSize][sx / kTileSize];
+		const half_t* p = &t[(size_t(sy % kTileSize) * kTileSize + size_t(sx % kTileSize)) * 4];
+		for (int k = 0; k < 4; ++k) acc[k] += halfToFloat(p[k]);
+	};
+
+	for (int y = 0; y < h; ++y) {
+		half_t* row = &(*out)[size_t(y) * kTileSize * 4];
+		const int sy = 2 * (y0 + y);
+		for (int x = 0; x < w; ++x) {
+			const int sx = 2 * (x0 + x);
+			float acc[4] = { 0, 0, 0, 0 };
+			sample(sx, sy, acc);
+			sample(sx + 1, sy, acc);
+			sample(sx, sy + 1, acc);
+			sample(sx + 1, sy + 1, acc);
+			for (int k = 0; k < 4; ++k) row[size_t(x) * 4 + k] = floatToHalf(acc[k] * 0.25f);
+		}
+	}
+	padTile(*out, w, h);
+	return out;
+}
+
+void TilePyramid::fetch(int level, const Rect& region, const ImageView& dst) {
+	level = std::clamp(level, 0, levels_ - 1);
+	const Rect r = region.intersect({ 0, 0, levelWidth(level), levelHeight(level) });
+	if (r.empty() || !dst.valid() || dst.channels != 4) return;
+
+	const int tx0 = r.x / kTileSize, tx1 = (r.right() - 1) / kTileSize;
+	const int ty0 = r.y / kTileSize, ty1 = (r.bottom() - 1) / kTileSize;
+	const int across = tx1 - tx0 + 1;
+	const size_t count = size_t(across) * size_t(ty1 - ty0 + 1);
+
+	parallelFor(count, [&](size_t i) {
+		const int tx = tx0 + int(i % size_t(across));
+		const int ty = ty0 + int(i / size_t(across));
+		const auto t = tile(level, tx, ty);
+		const Rect tileRect{ tx * kTileSize, ty * kTileSize, kTileSize, kTileSize };
+		const Rect part = tileRect.intersect(r);
+		for (int y = part.y; y < part.bottom(); ++y) {
+			const half_t* src = &(*t)[(size_t(y - tileRect.y) * kTileSize + size_t(part.x - tileRect.x)) * 4];
+			float* out = dst.pixel(part.x - region.x, y - region.y);
+			halfToFloat(src, out, size_t(part.width) * 4);
+		}
+	});
+}
+
+void TilePyramid::invalidate() {
+	store_.removeImage(image_);
+}
+
+// MARK: - Benchmark
+
+TilePyramidBenchmark benchmarkTilePyramid(int width, int height) {
+	width = std::max(1, width);
+	height = std::max(1, height);
+	ImageBuffer base(width, height, 4);
+	const ImageView src = base.view();
+	parallelFor(size_t(height), [&](size_t y) {
+		float* row = src.row(int(y));
+		for (int x = 0; x < width; ++x) {
+			row[x * 4 + 0] = float((x * 37 + int(y) * 11) % 101) / 101.0f;
+			row[x * 4 + 1] = float(y) / float(height);
+			row[x * 4 + 2] = float((x / 16 + int(y) / 16) % 2);
+			row[x * 4 + 3] = float(x) / float(width);
+		}
+	});
+
+	TileStore store(uint64_t(1) << 40);
+	TilePyramid pyramid(1, width, height, [&](const Rect& region, const ImageView& dst) {
+		copyImage(src.sub(region), dst);
+	}, store);
+
+	TilePyramidBenchmark result;
+	result.levels = pyramid.levelCount();
+
+	std::vector<ImageBuffer> fetched;
+	const auto start = std::chrono::steady_clock::now();
+	for (int level = 0; level < result.levels; ++level) {
+		fetched.emplace_back(pyramid.levelWidth(level), pyramid.levelHeight(level), 4);
+		pyramid.fetch(level, { 0, 0, pyramid.levelWidth(level), pyramid.levelHeight(level) }, fetched.back().view());
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Brute force: each level straight from the float level below, clamping at odd edges.
+	ImageBuffer expected(width, height, 4);
+	copyImage(src, expected.view());
+	for (int level = 0; level < result.levels; ++level) {
+		if (level > 0) {
+			const ImageView below = expected.view();
+			ImageBuffer next(pyramid.levelWidth(level), pyramid.levelHeight(level), 4);
+			const ImageView out = next.view();
+			for (int y = 0; y < out.height; ++y) {
+				const int y0 = std::min(2 * y, below.height - 1), y1 = std::min(2 * y + 1, below.height - 1);
+				for (int x = 0; x < out.width; ++x) {
+					const int x0 = std::min(2 * x, below.width - 1), x1 = std::min(2 * x + 1, below.width - 1);
+					for (int k = 0; k < 4; ++k) {
+						out.pixel(x, y)[k] = 0.25f * (below.pixel(x0, y0)[k] + below.pixel(x1, y0)[k] +
+													  below.pixel(x0, y1)[k] + below.pixel(x1, y1)[k]);
+					}
+				}
+			}
+			expected = std::move(next);
+		}
+
+		const ImageView want = expected.view();
+		const ImageView got = fetched[size_t(level)].view();
+		for (int y = 0; y < want.height; ++y) {
+			for (int x = 0; x < want.width * 4; ++x) {
+				result.maxError = std::max(result.maxError, double(std::fabs(want.row(y)[x] - got.row(y)[x])));
+			}
+		}
+	}
+
+	// Straddles the corner of four level-0 tiles and stops short of the frame edge.
+	const Rect region = Rect{ kTileSize - 17, kTileSize - 9, kTileSize + 40, kTileSize + 3 }
+		.intersect({ 0, 0, width, height });
+	result.unaligned = !region.empty();
+	if (result.unaligned) {
+		ImageBuffer crop(region.width, region.height, 4);
+		pyramid.fetch(0, region, crop.view());
+		const ImageView whole = fetched[0].view();
+		for (int y = 0; y < region.height; ++y) {
+			const float* want = whole.pixel(region.x, region.y + y);
+			if (std::memcmp(want, crop.view().row(y), size_t(region.width) * 4 * sizeof(float)) != 0) result.unaligned = false;
+		}
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeTilePyramid {
+	std::unique_ptr<forge::TilePyramid> pyramid;
+};
+
+extern "C" {
+	ForgeTilePyramid* ForgeTilePyramidCreate(uint64_t imageId, int32_t width, int32_t height,
+											 const void* base, size_t rowBytes, bool baseIsHalf) {
+		if (!base || width <= 0 || height <= 0) return nullptr;
+		const auto* bytes = static_cast<const uint8_t*>(base);
+
+		auto provider = [bytes, rowBytes, baseIsHalf](const forge::Rect& region, const forge::ImageView& dst) {
+			for (int y = 0; y < region.height; ++y) {
+				const uint8_t* row = bytes + size_t(region.y + y) * rowBytes;
+				if (baseIsHalf) {
+					const auto* src = reinterpret_cast<const forge::half_t*>(row) + size_t(region.x) * 4;
+					forge::halfToFloat(src, dst.row(y), size_t(region.width) * 4);
+				} else {
+					const auto* src = reinterpret_cast<const float*>(row) + size_t(region.x) * 4;
+					std::memcpy(dst.row(y), src, size_t(region.width) * 4 * sizeof(float));
+				}
+			}
+		};
+
+		auto* handle = new ForgeTilePyramid;
+		handle->pyramid = std::make_unique<forge::TilePyramid>(imageId, width, height, provider);
+		return handle;
+	}
+
+	void ForgeTilePyramidRelease(ForgeTilePyramid* pyramid) {
+		delete pyramid;
+	}
+
+	int32_t ForgeTilePyramidLevelCount(const ForgeTilePyramid* pyramid) {
+		return pyramid ? pyramid->pyramid->levelCount() : 0;
+	}
+
+	int32_t ForgeTilePyramidLevelForScale(const ForgeTilePyramid* pyramid, float scale) {
+		return pyramid ? pyramid->pyramid->levelForScale(scale) : 0;
+	}
+
+	void ForgeTilePyramidFetch(ForgeTilePyramid* pyramid, int32_t level, ForgeRect region, float* dst, size_t dstRowBytes) {
+		if (!pyramid || !dst) return;
+		const forge::ImageView view{ dst, region.width, region.height, 4, dstRowBytes / sizeof(float) };
+		pyramid->pyramid->fetch(level, { region.x, region.y, region.width, region.height }, view);
+	}
+
+	ForgeTilePyramidBenchmark ForgeBenchmarkTilePyramid(int32_t width, int32_t height) {
+		const forge::TilePyramidBenchmark b = forge::benchmarkTilePyramid(width, height);
+		return { b.seconds, b.levels, b.maxError, b.unaligned };
+	}
+
+	void ForgeTileStoreSetBudget(uint64_t bytes) {
+		forge::TileStore::shared().setBudget(bytes);
+	}
+
+	void ForgeTileStoreRemoveImage(uint64_t imageId) {
+		forge::TileStore::shared().removeImage(imageId);
+	}
+}
@@ -0,0 +1,63 @@
+//
+//  BoundedQueue.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace forge {
+
+// FIFO between threads holding at most `capacity` items: push waits while it is full, pop while
+// it is empty. After close(), push refuses and pop drains what is left, then returns false.
+template <typename T>
+class BoundedQueue {
+public:
+	explicit BoundedQueue(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+	bool push(T item) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		notFull_.wait(lock, [&] { return closed_ || items_.size() < capacity_; });
+		if (closed_) return false;
+		items_.push_back(std::move(item));
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	bool pop(T& item) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		notEmpty_.wait(lock, [&] { return closed_ || !items_.empty(); });
+		if (items_.empty()) return false;
+		item = std::move(items_.front());
+		items_.pop_front();
+		notFull_.notify_one();
+		return true;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		closed_ = true;
+		notFull_.notify_all();
+		notEmpty_.notify_all();
+	}
+
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return items_.size();
+	}
+
+private:
+	const size_t capacity_;
+	mutable std::mutex mutex_;
+	std::condition_variable notFull_, notEmpty_;
+	std::deque<T> items_;
+	bool closed_ = false;
+};
+
+} // namespace forge
@@ -0,0 +1,154 @@
+//
+//  EngineImage.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace forge {
+
+// MARK: - Rect
+
+// Integer pixel rectangle, origin top-left, half-open on the right/bottom edges.
+struct Rect {
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	int right() const { return x + width; }
+	int bottom() const { return y + height; }
+	bool empty() const { return width <= 0 || height <= 0; }
+	int64_t area() const { return empty() ? 0 : int64_t(width) * int64_t(height); }
+
+	bool contains(const Rect& r) const {
+		return r.x >= x && r.y >= y && r.right() <= right() && r.bottom() <= bottom();
+	}
+
+	Rect intersect(const Rect& r) const {
+		const int x0 = std::max(x, r.x);
+		const int y0 = std::max(y, r.y);
+		const int x1 = std::min(right(), r.right());
+		const int y1 = std::min(bottom(), r.bottom());
+		if (x1 <= x0 || y1 <= y0) return {};
+		return { x0, y0, x1 - x0, y1 - y0 };
+	}
+
+	Rect unite(const Rect& r) const {
+		if (empty()) return r;
+		if (r.empty()) return *this;
+		const int x0 = std::min(x, r.x);
+		const int y0 = std::min(y, r.y);
+		return { x0, y0, std::max(right(), r.right()) - x0, std::max(bottom(), r.bottom()) - y0 };
+	}
+
+	// Grow by `r` pixels on every side (negative shrinks).
+	Rect outset(int r) const { return { x - r, y - r, width + 2 * r, height + 2 * r }; }
+
+	bool operator==(const Rect& o) const {
+		return x == o.x && y == o.y && width == o.width && height == o.height;
+	}
+	bool operator!=(const Rect& o) const { return !(*this == o); }
+};
+
+// MARK: - ImageView
+
+// Non-owning view over interleaved float pixels. `rowStride` is in floats, not bytes,
+// so a view can address a sub-rectangle of a larger buffer without copying.
+struct ImageView {
+	float* data = nullptr;
+	int width = 0;
+	int height = 0;
+	int channels = 4;
+	size_t rowStride = 0;
+
+	bool valid() const { return data != nullptr && width > 0 && height > 0; }
+	Rect bounds() const { return { 0, 0, width, height }; }
+	size_t pixelBytes() const { return size_t(channels) * sizeof(float); }
+	size_t bytes() const { return size_t(width) * size_t(height) * pixelBytes(); }
+
+	float* row(int y) const { return data + size_t(y) * rowStride; }
+	float* pixel(int x, int y) const { return row(y) + size_t(x) * size_t(channels); }
+
+	// View of `r` (clamped to bounds) sharing this view's storage.
+	ImageView sub(const Rect& r) const {
+		const Rect c = r.intersect(bounds());
+		if (c.empty()) return {};
+		return { pixel(c.x, c.y), c.width, c.height, channels, rowStride };
+	}
+};
+
+// MARK: - ImageBuffer
+
+// Owning, 64-byte aligned interleaved float image. Rows are tightly packed.
+class ImageBuffer {
+public:
+	ImageBuffer() = default;
+	ImageBuffer(int width, int height, int channels = 4) { allocate(width, height, channels); }
+
+	ImageBuffer(ImageBuffer&&) noexcept = default;
+	ImageBuffer& operator=(ImageBuffer&&) noexcept = default;
+	ImageBuffer(const ImageBuffer&) = delete;
+	ImageBuffer& operator=(const ImageBuffer&) = delete;
+
+	void allocate(int width, int height, int channels = 4) {
+		const size_t floats = size_t(width) * size_t(height) * size_t(channels);
+		if (floats != capacity_) {
+			// aligned_alloc requires the size to be a multiple of the alignment.
+			const size_t bytes = ((floats * sizeof(float) + 63) / 64) * 64;
+			float* p = bytes ? static_cast<float*>(std::aligned_alloc(64, bytes)) : nullptr;
+			if (bytes && !p) throw std::bad_alloc();
+			storage_.reset(p);
+			capacity_ = floats;
+		}
+		width_ = width;
+		height_ = height;
+		channels_ = channels;
+	}
+
+	void clear() { if (capacity_) std::memset(storage_.get(), 0, capacity_ * sizeof(float)); }
+
+	ImageView view() const {
+		return { storage_.get(), width_, height_, channels_, size_t(width_) * size_t(channels_) };
+	}
+
+	float* data() const { return storage_.get(); }
+	int width() const { return width_; }
+	int height() const { return height_; }
+	int channels() const { return channels_; }
+	size_t bytes() const { return capacity_ * sizeof(float); }
+
+private:
+	struct FreeDeleter { void operator()(float* p) const { std::free(p); } };
+	std::unique_ptr<float[], FreeDeleter> storage_;
+	size_t capacity_ = 0;
+	int width_ = 0;
+	int height_ = 0;
+	int channels_ = 4;
+};
+
+// Copies the overlapping region of `src` into `dst`, row by row.
+inline void copyImage(const ImageView& src, const ImageView& dst) {
+	const int w = std::min(src.width, dst.width);
+	const int h = std::min(src.height, dst.height);
+	const int c = std::min(src.channels, dst.channels);
+	if (src.channels == dst.channels) {
+		for (int y = 0; y < h; ++y) std::memcpy(dst.row(y), src.row(y), size_t(w) * src.pixelBytes());
+		return;
+	}
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) std::memcpy(dst.pixel(x, y), src.pixel(x, y), size_t(c) * sizeof(float));
+	}
+}
+
+} // namespace forge
@@ -0,0 +1,94 @@
+//
+//  Half.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace forge {
+
+// IEEE 754 binary16, stored as raw bits. Same layout as kCVPixelFormatType_64RGBAHalf,
+// Metal `half` and OpenEXR HALF, so buffers can be handed across without conversion.
+using half_t = uint16_t;
+
+inline half_t floatToHalf(float f) {
+#if defined(__aarch64__)
+	__fp16 h = static_cast<__fp16>(f);
+	half_t bits;
+	std::memcpy(&bits, &h, sizeof(bits));
+	return bits;
+#else
+	uint32_t x;
+	std::memcpy(&x, &f, sizeof(x));
+	const uint32_t sign = (x >> 16) & 0x8000u;
+	const uint32_t absx = x & 0x7FFFFFFFu;
+
+	if (absx >= 0x7F800000u) { // Inf / NaN
+		return half_t(sign | 0x7C00u | (absx > 0x7F800000u ? 0x200u : 0u));
+	}
+	if (absx >= 0x477FF000u) { // rounds to >= 65520: overflow to Inf
+		return half_t(sign | 0x7C00u);
+	}
+	if (absx < 0x38800000u) { // below the smallest normal half: subnormal or zero
+		if (absx < 0x33000000u) return half_t(sign);
+		const uint32_t mant = (absx & 0x007FFFFFu) | 0x00800000u;
+		const int shift = 126 - int(absx >> 23);
+		uint32_t h = mant >> shift;
+		const uint32_t rest = mant & ((1u << shift) - 1u);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (h & 1u))) ++h;
+		return half_t(sign | h);
+	}
+	// Normal: rebias exponent, round mantissa to nearest even.
+	const uint32_t mant = absx & 0x007FFFFFu;
+	uint32_t h = ((absx >> 23) - 112u) << 10 | (mant >> 13);
+	const uint32_t rest = mant & 0x1FFFu;
+	if (rest > 0x1000u || (rest == 0x1000u && (h & 1u))) ++h;
+	return half_t(sign | h);
+#endif
+}
+
+inline float halfToFloat(half_t h) {
+#if defined(__aarch64__)
+	__fp16 v;
+	std::memcpy(&v, &h, sizeof(v));
+	return static_cast<float>(v);
+#else
+	const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+	const uint32_t exp = (h >> 10) & 0x1Fu;
+	uint32_t mant = h & 0x3FFu;
+	uint32_t bits;
+	if (exp == 0) {
+		if (mant == 0) {
+			bits = sign;
+		} else { // subnormal: normalise
+			int e = -1;
+			do { ++e; mant <<= 1; } while ((mant & 0x400u) == 0);
+			bits = sign | uint32_t(112 - e) << 23 | (mant & 0x3FFu) << 13;
+		}
+	} else if (exp == 0x1F) {
+		bits = sign | 0x7F800000u | mant << 13;
+	} else {
+		bits = sign | (exp + 112u) << 23 | mant << 13;
+	}
+	float f;
+	std::memcpy(&f, &bits, sizeof(f));
+	return f;
+#endif
+}
+
+inline void floatToHalf(const float* src, half_t* dst, size_t count) {
+	for (size_t i = 0; i < count; ++i) dst[i] = floatToHalf(src[i]);
+}
+
+inline void halfToFloat(const half_t* src, float* dst, size_t count) {
+	for (size_t i = 0; i < count; ++i) dst[i] = halfToFloat(src[i]);
+}
+
+} // namespace forge
@@ -0,0 +1,54 @@
+//
+//  Hash.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace forge {
+
+// 64-bit finaliser from SplitMix64. Cheap and well mixed, which is all the caches need.
+inline uint64_t mix64(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+	return mix64(seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2)));
+}
+
+// FNV-1a over raw bytes.
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xCBF29CE484222325ull) {
+	const auto* p = static_cast<const uint8_t*>(data);
+	uint64_t h = seed;
+	for (size_t i = 0; i < size; ++i) {
+		h ^= p[i];
+		h *= 0x100000001B3ull;
+	}
+	return h;
+}
+
+inline uint64_t hashString(std::string_view s) { return hashBytes(s.data(), s.size()); }
+
+inline uint64_t hashFloat(uint64_t seed, float v) {
+	uint32_t bits;
+	std::memcpy(&bits, &v, sizeof(bits));
+	return hashCombine(seed, bits);
+}
+
+template <typename... Floats>
+inline uint64_t hashParams(uint64_t seed, Floats... values) {
+	((seed = hashFloat(seed, float(values))), ...);
+	return seed;
+}
+
+} // namespace forge
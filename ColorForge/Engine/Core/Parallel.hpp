@@ -0,0 +1,68 @@
+//
+//  Parallel.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#endif
+
+namespace forge {
+
+inline unsigned workerCount() {
+	const unsigned n = std::thread::hardware_concurrency();
+	return n ? n : 4;
+}
+
+// Runs fn(i) for every i in [0, count). On Apple platforms the work goes through GCD so
+// engine jobs share the system thread pool with Core Image and the rest of the app.
+template <typename Fn>
+void parallelFor(size_t count, Fn&& fn) {
+	if (count == 0) return;
+	if (count == 1) { fn(size_t(0)); return; }
+
+#if defined(__APPLE__)
+	using F = std::remove_reference_t<Fn>;
+	dispatch_apply_f(count, DISPATCH_APPLY_AUTO, const_cast<void*>(static_cast<const void*>(&fn)), [](void* ctx, size_t i) {
+		(*static_cast<F*>(ctx))(i);
+	});
+#else
+	std::atomic<size_t> next{ 0 };
+	auto worker = [&] {
+		for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+	};
+	const size_t threads = std::min<size_t>(workerCount(), count);
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+	worker();
+	for (auto& t : pool) t.join();
+#endif
+}
+
+// Splits [0, count) into at most `chunks` contiguous ranges and calls fn(chunk, begin, end).
+// The chunk index is stable, which makes it a natural slot for per-thread accumulators.
+template <typename Fn>
+void parallelChunks(size_t count, size_t chunks, Fn&& fn) {
+	if (count == 0) return;
+	chunks = std::max<size_t>(1, std::min(chunks, count));
+	const size_t step = (count + chunks - 1) / chunks;
+	parallelFor(chunks, [&](size_t c) {
+		const size_t begin = c * step;
+		const size_t end = std::min(count, begin + step);
+		if (begin < end) fn(c, begin, end);
+	});
+}
+
+} // namespace forge
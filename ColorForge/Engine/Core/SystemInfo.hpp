@@ -0,0 +1,23 @@
+//
+//  SystemInfo.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <unistd.h>
+
+namespace forge {
+
+// Installed RAM in bytes (ProcessInfo.physicalMemory on the Swift side).
+inline uint64_t physicalMemoryBytes() {
+	const long pages = sysconf(_SC_PHYS_PAGES);
+	const long pageSize = sysconf(_SC_PAGE_SIZE);
+	if (pages <= 0 || pageSize <= 0) return 8ull << 30;
+	return uint64_t(pages) * uint64_t(pageSize);
+}
+
+} // namespace forge
@@ -0,0 +1,795 @@
+//
+//  EngineBridge.h
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+// EngineBridge.h
+// C entry points into the C++ render engine (ColorForge/Engine). Plain C types only so the
+// same header works from Swift, the bridging header and the C++ sources.
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	int32_t x;
+	int32_t y;
+	int32_t width;
+	int32_t height;
+} ForgeRect;
+
+// MARK: - Render graph
+
+typedef struct {
+	double fullSeconds;
+	double viewportSeconds;
+	double sourceFraction;
+	int32_t viewports;
+	double maxError;
+} ForgeViewportBenchmark;
+
+// Blur chains rendered over viewport source regions against crops of the full-frame render.
+ForgeViewportBenchmark ForgeBenchmarkViewport(int32_t width, int32_t height);
+
+// Source region (render-scale pixels) that has to be decoded to show `visible` (full-resolution
+// pixels) at `scale`, given the radii (full-resolution pixels) of the chain's neighbourhood
+// nodes in order. Zero radii are pointwise nodes.
+ForgeRect ForgeViewportSourceRegion(int32_t frameWidth, int32_t frameHeight, ForgeRect visible, float scale,
+									const int32_t* _Nullable radii, int32_t radiusCount);
+
+// MARK: - Tile pyramid
+
+typedef struct ForgeTilePyramid ForgeTilePyramid;
+
+// Lazily built fp16 mip pyramid over a demosaiced RGBA buffer (float, or half when
+// `baseIsHalf`). `base` is read whenever a level-0 tile is first needed, so it must stay
+// valid (and locked, for a CVPixelBuffer) until the pyramid is released.
+ForgeTilePyramid* _Nullable ForgeTilePyramidCreate(uint64_t imageId, int32_t width, int32_t height,
+												   const void* _Nonnull base, size_t rowBytes, bool baseIsHalf);
+void ForgeTilePyramidRelease(ForgeTilePyramid* _Nullable pyramid);
+int32_t ForgeTilePyramidLevelCount(const ForgeTilePyramid* _Nullable pyramid);
+// Level to resample from for `scale` display pixels per full-resolution pixel.
+int32_t ForgeTilePyramidLevelForScale(const ForgeTilePyramid* _Nullable pyramid, float scale);
+// Copies `region` (pixels of `level`) into `dst` as RGBA float.
+void ForgeTilePyramidFetch(ForgeTilePyramid* _Nullable pyramid, int32_t level, ForgeRect region,
+						   float* _Nonnull dst, size_t dstRowBytes);
+
+void ForgeTileStoreSetBudget(uint64_t bytes);
+void ForgeTileStoreRemoveImage(uint64_t imageId);
+
+typedef struct {
+	double seconds;
+	int32_t levels;
+	double maxError;
+	bool unaligned;
+} ForgeTilePyramidBenchmark;
+
+// Every level of a pyramid over a synthetic frame against a direct float downsample (see TilePyramid.hpp).
+ForgeTilePyramidBenchmark ForgeBenchmarkTilePyramid(int32_t width, int32_t height);
+
+// MARK: - Demosaic disk cache
+
+// Persistent cache of demosaiced images, keyed by (ForgeHashFileContent(raw), demosaic params hash).
+// Disabled until configured; `capacityBytes` caps the directory, least recently used entries go first.
+void ForgeDemosaicDiskCacheConfigure(const char* _Nonnull directory, uint64_t capacityBytes);
+// Cheap content hash of a file (size plus sampled windows); stable across renames and moves.
+uint64_t ForgeHashFileContent(const char* _Nonnull path);
+// Stable hash of the demosaic settings (encoded by the caller), for `paramsHash`.
+uint64_t ForgeDemosaicDiskCacheParamsHash(const void* _Nullable bytes, size_t size);
+// True on a hit; returns the stored dimensions and the metadata stored with the entry (up to
+// `metadataCapacity` bytes copied; `metadataSize` gets its full size). Corrupt entries are deleted
+// and report a miss.
+bool ForgeDemosaicDiskCacheLookup(uint64_t contentHash, uint64_t paramsHash, int32_t* _Nullable width, int32_t* _Nullable height,
+								  void* _Nullable metadata, size_t metadataCapacity, size_t* _Nullable metadataSize);
+// Decodes the whole entry into `dst` (RGBA half when `dstIsHalf`, otherwise RGBA float). An entry
+// with a damaged tile is deleted and reports false.
+bool ForgeDemosaicDiskCacheRead(uint64_t contentHash, uint64_t paramsHash, void* _Nonnull dst, size_t rowBytes, bool dstIsHalf);
+// `metadata` is kept inside the entry and comes back from Lookup; it is evicted with the pixels.
+bool ForgeDemosaicDiskCacheStore(uint64_t contentHash, uint64_t paramsHash, const void* _Nonnull pixels, size_t rowBytes,
+								 int32_t width, int32_t height, bool pixelsAreHalf,
+								 const void* _Nullable metadata, size_t metadataSize);
+void ForgeDemosaicDiskCacheRemoveAll(void);
+
+typedef struct {
+	double storeSeconds;
+	double readSeconds;
+} ForgeDemosaicDiskCacheBenchmark;
+
+// Store and read back of a synthetic frame in a scratch directory.
+ForgeDemosaicDiskCacheBenchmark ForgeBenchmarkDemosaicDiskCache(int32_t width, int32_t height);
+
+// MARK: - Scopes
+
+// Pixels for the scopes: RGB(A) interleaved with `channels` samples per pixel, or planar with
+// the R, G and B planes `planeBytes` apart. Samples are float, or half when `isHalf`.
+typedef struct {
+	const void* _Nullable data;
+	size_t rowBytes;
+	size_t planeBytes;
+	int32_t width;
+	int32_t height;
+	int32_t channels;
+	bool isHalf;
+	bool isPlanar;
+} ForgeScopeSource;
+
+typedef struct ForgeHistogram ForgeHistogram;
+
+// Reusable R/G/B/luma histogram; all working memory is allocated here, not per compute.
+ForgeHistogram* _Nonnull ForgeHistogramCreate(int32_t bins);
+void ForgeHistogramRelease(ForgeHistogram* _Nullable histogram);
+int32_t ForgeHistogramBinCount(const ForgeHistogram* _Nullable histogram);
+// Bins every `step`th pixel over [minValue, maxValue] into `counts` (4 × bins: R, G, B, luma).
+// Returns the number of pixels binned.
+uint64_t ForgeHistogramCompute(ForgeHistogram* _Nullable histogram, ForgeScopeSource source, int32_t step,
+							   float minValue, float maxValue, uint32_t* _Nonnull counts);
+
+typedef struct ForgeScopes ForgeScopes;
+
+// Waveform (R, G, B, luma; levels × columns) plus vectorscope (size²) accumulated together.
+ForgeScopes* _Nonnull ForgeScopesCreate(int32_t waveformColumns, int32_t waveformLevels, int32_t vectorscopeSize);
+void ForgeScopesRelease(ForgeScopes* _Nullable scopes);
+// Full rebuild, sampling every `step`th pixel.
+void ForgeScopesCompute(ForgeScopes* _Nullable scopes, ForgeScopeSource source, int32_t step);
+// Log-scaled densities in [0, 1], top row first. Channel 0-2 = R, G, B, 3 = luma.
+void ForgeScopesWaveformImage(const ForgeScopes* _Nullable scopes, int32_t channel, float* _Nonnull dst);
+void ForgeScopesVectorscopeImage(const ForgeScopes* _Nullable scopes, float* _Nonnull dst);
+
+typedef struct {
+	double computeSeconds;
+} ForgeScopesBenchmark;
+
+// Full rebuild, readouts included, on a synthetic RGBA half frame.
+ForgeScopesBenchmark ForgeBenchmarkScopes(int32_t width, int32_t height, int32_t step);
+
+// MARK: - Recursive blur
+
+// In place on float pixels with `channels` interleaved samples. Cost per pixel is independent
+// of the radius. `sigma` is the Gaussian standard deviation; `radius` the exponential 1/e distance.
+void ForgeGaussianBlur(float* _Nonnull data, int32_t width, int32_t height, int32_t channels, size_t rowBytes, float sigma);
+void ForgeExponentialBlur(float* _Nonnull data, int32_t width, int32_t height, int32_t channels, size_t rowBytes, float radius);
+
+typedef struct {
+	float radius;
+	double seconds;
+	double megapixelsPerSecond;
+	float maxError;
+} ForgeBlurBenchmark;
+
+// Times one blur of a width × height RGBA frame; maxError is against direct convolution.
+ForgeBlurBenchmark ForgeBenchmarkRecursiveBlur(int32_t width, int32_t height, float radius, bool exponential);
+
+// MARK: - Summed-area table
+
+typedef struct ForgeSummedAreaTable ForgeSummedAreaTable;
+
+// Integral images of RGB (and of `mask` and RGB × mask when given; one float per pixel).
+// After the build every query below is O(1) whatever the rectangle or radius.
+ForgeSummedAreaTable* _Nullable ForgeSummedAreaTableCreate(const float* _Nonnull pixels, int32_t width, int32_t height,
+														   int32_t channels, size_t rowBytes,
+														   const float* _Nullable mask, size_t maskRowBytes);
+void ForgeSummedAreaTableRelease(ForgeSummedAreaTable* _Nullable table);
+bool ForgeSummedAreaTableMean(const ForgeSummedAreaTable* _Nullable table, ForgeRect rect, float* _Nonnull rgb);
+// Σ(rgb · mask) / Σ mask over `rect`; false without a mask or where the mask is empty.
+bool ForgeSummedAreaTableMaskedMean(const ForgeSummedAreaTable* _Nullable table, ForgeRect rect, float* _Nonnull rgb);
+float ForgeSummedAreaTableMaskCoverage(const ForgeSummedAreaTable* _Nullable table, ForgeRect rect);
+// Clamp-to-edge box mean of RGB into `dst` (the table's size, `dstChannels` floats per pixel).
+void ForgeSummedAreaTableBoxBlur(const ForgeSummedAreaTable* _Nullable table, float* _Nonnull dst, int32_t dstChannels,
+								 size_t dstRowBytes, int32_t radius);
+typedef struct {
+	double buildSeconds;
+	double blurSeconds;
+	double maxError;
+} ForgeSummedAreaTableBenchmark;
+
+// Builds RGB + mask tables for a width × height frame; maxError is the box blur and the
+// means against direct sums (see SummedAreaTable.hpp).
+ForgeSummedAreaTableBenchmark ForgeBenchmarkSummedAreaTable(int32_t width, int32_t height);
+
+// MARK: - Film grain
+
+typedef struct {
+	float muR;         // mean grain radius, input pixels
+	float sigmaR;      // grain radius standard deviation, input pixels
+	float sigmaFilter; // Gaussian offset standard deviation, output pixels
+	int32_t samples;   // Monte Carlo offsets per pixel
+	float zoom;        // output pixels per input pixel
+	uint32_t seed;
+	bool monochrome;   // grain from the first channel on every colour channel
+} ForgeFilmGrainParams;
+
+// Boolean-model grain rendering of `region` of `dst` from `src` (values in [0, 1]). The result
+// depends only on the parameters and pixel coordinates, so regions can be rendered separately.
+void ForgeRenderFilmGrain(ForgeFilmGrainParams params,
+						  const float* _Nonnull src, int32_t srcWidth, int32_t srcHeight, int32_t srcChannels, size_t srcRowBytes,
+						  float* _Nonnull dst, int32_t dstWidth, int32_t dstHeight, int32_t dstChannels, size_t dstRowBytes,
+						  ForgeRect region);
+
+typedef struct {
+	double seconds;
+	double megapixelsPerSecond;
+	bool deterministic;
+	float meanError;
+} ForgeFilmGrainBenchmark;
+
+// Renders a width × height ramp twice with different tilings and thread counts; `deterministic`
+// is whether the two match bit for bit.
+ForgeFilmGrainBenchmark ForgeBenchmarkFilmGrain(ForgeFilmGrainParams params, int32_t width, int32_t height);
+
+// MARK: - Grain fields
+
+typedef struct {
+	uint64_t plates; // identity of the plate pair and its scale
+	int32_t gate;    // RealisticFilmGrainNode.gateWidth
+	int32_t width;
+	int32_t height;
+	uint32_t seed;
+} ForgeGrainFieldKey;
+
+typedef struct ForgeGrainField ForgeGrainField;
+
+// Directory and byte cap for stored grain fields. Until configured, open misses and build fails.
+void ForgeGrainFieldStoreConfigure(const char* _Nonnull directory, uint64_t capacityBytes);
+// The stored field for `key`, or NULL. No grain preparation happens on a hit.
+ForgeGrainField* _Nullable ForgeGrainFieldOpen(ForgeGrainFieldKey key);
+// Tiles the shadow/highlight plates (one float per pixel, already at output scale) into a
+// key.width × key.height field, stores it and opens it.
+ForgeGrainField* _Nullable ForgeGrainFieldBuild(ForgeGrainFieldKey key, const float* _Nonnull low, const float* _Nonnull high,
+												int32_t plateWidth, int32_t plateHeight, size_t rowBytes);
+void ForgeGrainFieldRelease(ForgeGrainField* _Nullable field);
+// One channel (0 shadow, 1 highlight) of `region` as half floats, top row first.
+bool ForgeGrainFieldReadRegion(const ForgeGrainField* _Nullable field, int32_t channel, ForgeRect region,
+							   uint16_t* _Nonnull dst, size_t rowBytes);
+// Rows [y0, y0 + rows) as float (shadow, highlight) pairs.
+bool ForgeGrainFieldReadRows(const ForgeGrainField* _Nullable field, int32_t y0, int32_t rows, float* _Nonnull dst, size_t rowBytes);
+// Starts paging in rows ahead of use.
+void ForgeGrainFieldPrefetchRows(const ForgeGrainField* _Nullable field, int32_t y0, int32_t rows);
+void ForgeGrainFieldStoreRemoveAll(void);
+
+typedef struct {
+	double buildSeconds;
+	double openSeconds;
+	bool reopened;
+	bool rebuilt;
+	bool corruption;
+} ForgeGrainFieldBenchmark;
+
+// Build, reopen after a "relaunch", rebuild and damaged-file checks in a scratch directory
+// (see GrainFieldStore.hpp).
+ForgeGrainFieldBenchmark ForgeBenchmarkGrainFieldStore(int32_t width, int32_t height);
+
+// MARK: - Random numbers
+
+// Counter-based variates: value i of run x0 ..< x0 + count is a pure function of
+// (seed, x0 + i, y, channel, index), so any span can be generated on its own.
+void ForgeRandomUniform(uint64_t seed, int32_t x0, int32_t y, int32_t channel, uint32_t index, int32_t count, float* _Nonnull dst);
+void ForgeRandomGaussian(uint64_t seed, int32_t x0, int32_t y, int32_t channel, uint32_t index, int32_t count, float* _Nonnull dst);
+// Seed derived from a string (e.g. an image's path), stable across launches unlike Swift's hashValue.
+uint64_t ForgeRandomSeed(const char* _Nonnull key);
+
+typedef struct {
+	double megavariatesPerSecond;
+	bool knownAnswers;
+	bool batchMatchesScalar;
+	bool tileInvariant;
+} ForgeRandomBenchmark;
+
+// Philox known answers, batch against scalar, and tiles against the whole frame (see Random.hpp).
+ForgeRandomBenchmark ForgeBenchmarkRandom(int32_t width, int32_t height);
+
+typedef struct {
+	bool simplex;    // false: Perlin
+	uint64_t seed;   // channel c uses seed + c
+	float scale;     // pixels per lattice cell
+	int32_t periodX; // lattice cells before the field repeats; 0 = never
+	int32_t periodY;
+	float z;         // Perlin slice
+	int32_t octaves; // 1 = single octave
+	float lacunarity;
+	float gain;
+} ForgeNoiseField;
+
+// Renders `region` of `dst`; values roughly in [-1, 1] that depend only on pixel coordinates.
+void ForgeRenderNoiseField(ForgeNoiseField field, float* _Nonnull dst, int32_t width, int32_t height, int32_t channels,
+						   size_t rowBytes, ForgeRect region);
+// `region` of one channel as halfs of value × gain + bias, from fp16 tiles cached in the shared
+// tile store and generated on first use.
+void ForgeNoiseFieldReadRegion(ForgeNoiseField field, int32_t channel, ForgeRect region, uint16_t* _Nonnull dst, size_t rowBytes,
+							   float gain, float bias);
+
+typedef struct {
+	double scalarMegapixelsPerSecond;
+	double rowMegapixelsPerSecond;
+	double generateMegapixelsPerSecond;
+	double cachedMegapixelsPerSecond;
+	float maxDifference;
+} ForgeNoiseFieldBenchmark;
+
+// Single-octave Perlin per pixel vs eight lanes at a time (maxDifference between them), then
+// an `octaves`-octave field generated into and read back from the tile cache.
+ForgeNoiseFieldBenchmark ForgeBenchmarkNoiseField(int32_t width, int32_t height, int32_t octaves);
+
+// MARK: - Band gains (Laplacian pyramid)
+
+// Per-band gains for the film MTF response at `pixelsPerMM`. `response` is the stock's gain at
+// 100, 50, 20 and 10 LP/mm as 4 × [r, g, b] (MTFParameters.bandResponse). Writes levels × 4
+// floats ([band][r, g, b, a], band 0 finest) to `gains` (room for 10 bands) and returns the band count.
+int32_t ForgeMTFBandGains(const float* _Nonnull response, float pixelsPerMM, int32_t width, int32_t height, float* _Nonnull gains);
+
+// Applies `levels` bands of `gains` (levels × 4 floats). `src` holds image pixels from
+// (srcX, srcY), `dst` receives image pixels from (dstX, dstY) and must lie inside src and not
+// alias it. Pixels ForgeBandGainApron(levels) inside src match a full-frame pass exactly.
+void ForgeApplyBandGains(int32_t levels, const float* _Nonnull gains,
+						 const float* _Nonnull src, int32_t srcX, int32_t srcY, int32_t srcWidth, int32_t srcHeight, size_t srcRowBytes,
+						 float* _Nonnull dst, int32_t dstX, int32_t dstY, int32_t dstWidth, int32_t dstHeight, size_t dstRowBytes,
+						 int32_t channels);
+int32_t ForgeBandGainApron(int32_t levels);
+
+typedef struct {
+	int32_t levels;
+	double seconds;
+	double megapixelsPerSecond;
+	bool tilesMatch;
+	bool identity;
+	double scratchFraction;
+} ForgeBandGainBenchmark;
+
+ForgeBandGainBenchmark ForgeBenchmarkBandGains(const float* _Nonnull response, int32_t width, int32_t height, float pixelsPerMM);
+
+// MARK: - Guided filter
+
+typedef struct {
+	int32_t radius;       // window radius in full-resolution pixels
+	float epsilon;        // regularisation, guide units squared
+	int32_t subsample;    // 1 = full resolution; 2–8 for preview
+	bool colorGuide;      // first three guide channels instead of luma
+} ForgeGuidedFilterParams;
+
+// Refines channel 0 of `mask` against `guide`, both holding image pixels from (srcX, srcY) at
+// srcWidth × srcHeight. Writes the refined mask to the first three channels of `dst` (image
+// pixels from (dstX, dstY)) and 1 to a fourth; dst may alias mask. Pixels
+// ForgeGuidedFilterApron(params) inside src match a full-frame pass.
+void ForgeGuidedFilter(ForgeGuidedFilterParams params,
+					   const float* _Nonnull guide, int32_t guideChannels, size_t guideRowBytes,
+					   const float* _Nonnull mask, int32_t maskChannels, size_t maskRowBytes,
+					   int32_t srcX, int32_t srcY, int32_t srcWidth, int32_t srcHeight,
+					   float* _Nonnull dst, int32_t dstChannels, size_t dstRowBytes,
+					   int32_t dstX, int32_t dstY, int32_t dstWidth, int32_t dstHeight);
+int32_t ForgeGuidedFilterApron(ForgeGuidedFilterParams params);
+
+typedef struct {
+	double fullSeconds;
+	double fullMegapixelsPerSecond;
+	double fastSeconds;
+	double fastMegapixelsPerSecond;
+	float edgeFractionBefore;
+	float edgeFractionAfter;
+} ForgeGuidedFilterBenchmark;
+
+ForgeGuidedFilterBenchmark ForgeBenchmarkGuidedFilter(int32_t width, int32_t height, int32_t radius);
+
+// MARK: - Mask coverage
+
+// Shapes in the same pixel coordinates as `bounds` (y down).
+typedef struct {
+	float x0, y0;     // mask 1
+	float x1, y1;     // mask 0
+} ForgeLinearMaskShape;
+
+typedef struct {
+	float cx, cy;
+	float rx, ry;     // semi-axes
+	float rotation;   // radians
+	float feather;    // 0-1 of the radius
+	float opacity;    // 0-1
+	bool invert;
+} ForgeRadialMaskShape;
+
+typedef struct ForgeMaskCoverage ForgeMaskCoverage;
+
+// Tiles of `bounds` where a mask is zero, partial or one, on a grid aligned to `tileSize`.
+// Tiles within `spread` pixels of a change become partial, for masks filtered afterwards.
+ForgeMaskCoverage* _Nonnull ForgeMaskCoverageCreateRadial(ForgeRadialMaskShape shape, ForgeRect bounds, int32_t tileSize, int32_t spread);
+// `mask`: bounds.width × bounds.height bytes, 255 = one.
+ForgeMaskCoverage* _Nonnull ForgeMaskCoverageCreateRaster(const uint8_t* _Nullable mask, size_t rowBytes, ForgeRect bounds,
+														  int32_t tileSize, int32_t spread);
+// `tiles`: columns × rows kinds (0 zero, 1 partial, 2 one) of span × span squares from the
+// top-left of `bounds`, as ForgeSegmentationMaskTiles returns them.
+ForgeMaskCoverage* _Nonnull ForgeMaskCoverageCreateTiled(const uint8_t* _Nullable tiles, int32_t columns, int32_t rows, int32_t span,
+														 ForgeRect bounds, int32_t tileSize, int32_t spread);
+void ForgeMaskCoverageRelease(ForgeMaskCoverage* _Nullable coverage);
+// Bounds of the partial and one regions; empty when the mask is zero everywhere.
+ForgeRect ForgeMaskCoverageSupport(const ForgeMaskCoverage* _Nullable coverage);
+double ForgeMaskCoverageFraction(const ForgeMaskCoverage* _Nullable coverage);
+// Merged rectangles of partial (one = false) or one tiles.
+int32_t ForgeMaskCoverageRegionCount(const ForgeMaskCoverage* _Nullable coverage, bool one);
+ForgeRect ForgeMaskCoverageRegion(const ForgeMaskCoverage* _Nullable coverage, bool one, int32_t index);
+
+// MARK: - Mask compositor
+
+typedef struct {
+	bool radial;
+	ForgeLinearMaskShape linear;
+	ForgeRadialMaskShape ellipse;
+} ForgeAnalyticMask;
+
+// Where `mask` can be non-zero, within `frame`.
+ForgeRect ForgeAnalyticMaskBounds(ForgeAnalyticMask mask, ForgeRect frame);
+
+// Blends layers[i] (image pixels layerRects[i]) under masks[i], in order, over `base` (image
+// pixels baseRect) into `dst` (image pixels dstRect, inside baseRect) in one pass. Null layers
+// are skipped; a layer need only cover ForgeAnalyticMaskBounds of its mask. dst may be base.
+void ForgeCompositeMasks(const float* _Nonnull base, ForgeRect baseRect, size_t baseRowBytes,
+						 const ForgeAnalyticMask* _Nullable masks, const float* _Nullable const* _Nullable layers,
+						 const ForgeRect* _Nullable layerRects, const size_t* _Nullable layerRowBytes, int32_t count,
+						 float* _Nonnull dst, ForgeRect dstRect, size_t dstRowBytes, int32_t channels);
+
+typedef struct {
+	int32_t masks;
+	double fusedSeconds;
+	double separateSeconds;
+	double fusedMegapixelsPerSecond;
+} ForgeMaskCompositeBenchmark;
+
+ForgeMaskCompositeBenchmark ForgeBenchmarkMaskComposite(int32_t width, int32_t height, int32_t masks);
+
+// MARK: - Segmentation masks
+
+// AI masks as empty, full and run-length coded partial tiles. Open maps the file; pixels are
+// decoded per region on demand.
+typedef struct ForgeSegmentationMask ForgeSegmentationMask;
+
+// `pixels`: width × height bytes, 255 = one.
+ForgeSegmentationMask* _Nullable ForgeSegmentationMaskCreate(const uint8_t* _Nonnull pixels, size_t rowBytes,
+															 int32_t width, int32_t height);
+// Bilinear upsampling of low-resolution logits to width × height, through a sigmoid.
+ForgeSegmentationMask* _Nullable ForgeSegmentationMaskCreateFromLogits(const float* _Nonnull logits, size_t logitRowBytes,
+																	   int32_t logitWidth, int32_t logitHeight,
+																	   int32_t width, int32_t height);
+ForgeSegmentationMask* _Nullable ForgeSegmentationMaskOpen(const char* _Nonnull path);
+// The origin (the mask's extent origin in its image) is stored with the mask.
+bool ForgeSegmentationMaskSave(const ForgeSegmentationMask* _Nullable mask, const char* _Nonnull path,
+							   int32_t originX, int32_t originY);
+void ForgeSegmentationMaskRelease(ForgeSegmentationMask* _Nullable mask);
+int32_t ForgeSegmentationMaskWidth(const ForgeSegmentationMask* _Nullable mask);
+int32_t ForgeSegmentationMaskHeight(const ForgeSegmentationMask* _Nullable mask);
+// As saved; (0, 0) for masks built in memory.
+int32_t ForgeSegmentationMaskOriginX(const ForgeSegmentationMask* _Nullable mask);
+int32_t ForgeSegmentationMaskOriginY(const ForgeSegmentationMask* _Nullable mask);
+// Encoded size, in memory or on disk.
+uint64_t ForgeSegmentationMaskBytes(const ForgeSegmentationMask* _Nullable mask);
+// Kinds of the span × span tiles, row-major (0 empty, 1 partial, 2 full); valid while the mask is.
+const uint8_t* _Nullable ForgeSegmentationMaskTiles(const ForgeSegmentationMask* _Nullable mask, int32_t* _Nullable columns,
+													int32_t* _Nullable rows, int32_t* _Nullable span);
+// Mask pixels of `region` (y down from the top-left); zero outside the mask.
+bool ForgeSegmentationMaskReadRegion(const ForgeSegmentationMask* _Nullable mask, ForgeRect region,
+									 uint8_t* _Nonnull dst, size_t rowBytes);
+
+typedef struct {
+	int32_t masks;
+	double rawMegabytes;
+	double encodedMegabytes;
+	double partialTileFraction;
+	double buildSeconds;
+	double rawLoadSeconds;
+	double loadSeconds;
+	double decodeMegapixelsPerSecond;
+} ForgeSegmentationMaskBenchmark;
+
+// Writes to and removes its files from `directory`.
+ForgeSegmentationMaskBenchmark ForgeBenchmarkSegmentationMask(int32_t width, int32_t height, int32_t masks,
+															  const char* _Nonnull directory);
+
+// MARK: - Segmentation post-processing
+
+typedef struct {
+	bool threshold;             // hard 0/1 at logit 0; otherwise a sigmoid
+	int64_t minComponentArea;   // pixels; smaller foreground components are removed (0 keeps all)
+	int64_t maxHoleArea;        // pixels; smaller enclosed holes are filled (0 fills none)
+	float feather;              // distance feather across ± this many pixels of the edge (0 = none)
+} ForgeSegmentationParams;
+
+// Low-resolution logits (logitWidth × logitHeight floats) upsampled to a width × height mask in
+// `dst`, activated, cleaned up and feathered.
+void ForgeSegmentationPostProcess(const float* _Nonnull logits, size_t logitRowBytes, int32_t logitWidth, int32_t logitHeight,
+								  ForgeSegmentationParams params, float* _Nonnull dst, size_t dstRowBytes,
+								  int32_t width, int32_t height);
+// Feathers a single-channel mask in place, thresholded at 0.5.
+void ForgeFeatherMask(float* _Nonnull mask, size_t rowBytes, int32_t width, int32_t height, float radius);
+
+typedef struct {
+	double upsampleMegapixelsPerSecond;
+	double activateMegapixelsPerSecond;
+	double componentsMegapixelsPerSecond;
+	double featherMegapixelsPerSecond;
+	int32_t componentsRemoved;
+	int32_t holesFilled;
+	int32_t specks;
+	int32_t holes;
+	bool distancesExact;
+} ForgeSegmentationBenchmark;
+
+ForgeSegmentationBenchmark ForgeBenchmarkSegmentation(int32_t width, int32_t height, float feather);
+
+// MARK: - Distance fields
+
+// Signed distance of every pixel to a mask's edge (inside positive), kept as fp16 so any
+// feather of the mask is one remap pass.
+typedef struct ForgeDistanceField ForgeDistanceField;
+
+typedef struct {
+	float offset;      // pixels the mask is grown by (negative shrinks)
+	float radius;      // half-width of the feather ramp in pixels (0 = hard edge)
+	float opacity;     // 0...1
+	bool invert;
+} ForgeFeatherRemap;
+
+// An 8-bit mask, pixels ≥ 128 inside.
+ForgeDistanceField* _Nullable ForgeDistanceFieldCreate(const uint8_t* _Nonnull mask, size_t rowBytes,
+													   int32_t width, int32_t height);
+void ForgeDistanceFieldRelease(ForgeDistanceField* _Nullable field);
+uint64_t ForgeDistanceFieldBytes(const ForgeDistanceField* _Nullable field);
+// The feathered mask into `dst`, the field's size, 8 bits per pixel.
+void ForgeDistanceFieldRemap(const ForgeDistanceField* _Nullable field, ForgeFeatherRemap remap,
+							 uint8_t* _Nonnull dst, size_t rowBytes);
+
+typedef struct {
+	double buildSeconds;
+	double buildMegapixelsPerSecond;
+	double narrowRemapSeconds;
+	double wideRemapSeconds;
+	double megabytes;
+} ForgeDistanceFieldBenchmark;
+
+ForgeDistanceFieldBenchmark ForgeBenchmarkDistanceField(int32_t width, int32_t height);
+
+// MARK: - TIFF export
+
+typedef struct {
+	int32_t width;
+	int32_t height;
+	int32_t channels;          // 1, 3 or 4 (alpha)
+	int32_t bitsPerSample;     // 8 or 16
+	int32_t compression;       // 0 none, 1 deflate, 2 LZW
+	bool predictor;            // horizontal differencing
+	bool tiled;
+	int32_t blockSize;         // rows per strip or tile edge (0 = default)
+	double dpi;
+	bool bigTiff;              // force 64-bit offsets
+} ForgeTiffInfo;
+
+typedef struct {
+	double megabytes;
+	double uncompressedMegabytesPerSecond;
+	double deflateMegabytesPerSecond;
+	double deflateSerialMegabytesPerSecond;
+	double lzwMegabytesPerSecond;
+	double deflateRatio;
+	double lzwRatio;
+	double bandMegabytes;
+	bool exact;
+} ForgeTiffWriterBenchmark;
+
+// Writes to and removes its files from `directory`.
+ForgeTiffWriterBenchmark ForgeBenchmarkTiffWriter(int32_t width, int32_t height, const char* _Nonnull directory);
+
+// MARK: - Export pipeline
+
+// Render → convert → encode → write on their own threads, joined by bounded queues of bands:
+// the caller renders float RGBA bands, the pipeline turns them into TIFF files. Images overlap,
+// so a batch runs at the pace of its slowest stage.
+typedef struct ForgeExportPipeline ForgeExportPipeline;
+typedef struct ForgeExportBand ForgeExportBand;
+
+// `depth` bands per stage boundary (0 = 2).
+ForgeExportPipeline* _Nonnull ForgeExportPipelineCreate(int32_t depth);
+// Finishes the bands already submitted first.
+void ForgeExportPipelineRelease(ForgeExportPipeline* _Nullable pipeline);
+
+// Starts a file; -1 if it can't be created. The file appears at `path` once written.
+int32_t ForgeExportPipelineBegin(ForgeExportPipeline* _Nullable pipeline, const char* _Nonnull path, ForgeTiffInfo info);
+// Entries for directory 0 (image), 1 (EXIF) or 2 (GPS): `count` values of TIFF field type
+// `type`, `size` bytes little-endian. Any time before ForgeExportPipelineEnd.
+void ForgeExportPipelineAddTag(ForgeExportPipeline* _Nullable pipeline, int32_t job, int32_t directory, uint16_t tag,
+							   uint16_t type, uint64_t count, const void* _Nullable value, size_t size);
+void ForgeExportPipelineSetICCProfile(ForgeExportPipeline* _Nullable pipeline, int32_t job,
+									  const uint8_t* _Nullable profile, size_t size);
+// IPTC-IIM records.
+void ForgeExportPipelineSetIPTC(ForgeExportPipeline* _Nullable pipeline, int32_t job,
+								const uint8_t* _Nullable records, size_t size);
+
+int32_t ForgeExportPipelineBandRows(const ForgeExportPipeline* _Nullable pipeline, int32_t job);
+// A band for up to BandRows rows of the job, waiting while every band is in flight.
+ForgeExportBand* _Nullable ForgeExportPipelineAcquire(ForgeExportPipeline* _Nullable pipeline, int32_t job);
+// Where to render the band: float RGBA rows, top to bottom.
+void* _Nonnull ForgeExportBandPixels(ForgeExportBand* _Nonnull band, size_t* _Nullable rowBytes);
+void ForgeExportPipelineSubmit(ForgeExportPipeline* _Nullable pipeline, ForgeExportBand* _Nonnull band, int32_t rows);
+// No more bands for the job.
+void ForgeExportPipelineEnd(ForgeExportPipeline* _Nullable pipeline, int32_t job);
+// Waits for the job's file; true if it was written.
+bool ForgeExportPipelineWait(ForgeExportPipeline* _Nullable pipeline, int32_t job);
+// Waits for every job begun; true if none failed.
+bool ForgeExportPipelineDrain(ForgeExportPipeline* _Nullable pipeline);
+
+typedef struct {
+	double busySeconds;
+	double utilisation;        // busy / elapsed
+} ForgeExportStageStats;
+
+typedef struct {
+	double seconds;
+	ForgeExportStageStats render;
+	ForgeExportStageStats convert;
+	ForgeExportStageStats encode;
+	ForgeExportStageStats write;
+	int64_t bands;
+	int32_t images;
+	int32_t failed;
+	uint64_t bytesWritten;
+} ForgeExportPipelineStats;
+
+ForgeExportPipelineStats ForgeExportPipelineGetStats(const ForgeExportPipeline* _Nullable pipeline);
+
+typedef struct {
+	int32_t images;
+	double megabytes;
+	double serialSeconds;
+	double pipelinedSeconds;
+	ForgeExportPipelineStats stats;
+	bool identical;
+} ForgeExportPipelineBenchmark;
+
+// Writes to and removes its files from `directory`.
+ForgeExportPipelineBenchmark ForgeBenchmarkExportPipeline(int32_t width, int32_t height, int32_t images,
+														  const char* _Nonnull directory);
+
+// MARK: - EXR export
+
+// Half-float, tiled OpenEXR, streamed band by band like the TIFF export.
+typedef struct ForgeExrWriter ForgeExrWriter;
+
+typedef struct {
+	int32_t width;
+	int32_t height;
+	int32_t channels;          // 3 RGB, 4 RGBA
+	int32_t compression;       // 0 none, 1 ZIP
+	int32_t tileSize;          // 0 = 64
+} ForgeExrInfo;
+
+// Null if the file can't be created. `chromaticities`: 8 floats, CIE xy of red, green, blue and
+// white, or null for Rec.709. `comments` is optional.
+ForgeExrWriter* _Nullable ForgeExrWriterCreate(const char* _Nonnull path, ForgeExrInfo info,
+											   const float* _Nullable chromaticities, const char* _Nullable comments);
+void ForgeExrWriterRelease(ForgeExrWriter* _Nullable writer);
+// Rows to render per call: whole bands aren't copied twice.
+int32_t ForgeExrWriterBandRows(const ForgeExrWriter* _Nullable writer);
+// `rows` rows, top to bottom, of `inputChannels` halfs per pixel (RGBAh).
+bool ForgeExrWriterAppendRows(ForgeExrWriter* _Nullable writer, const void* _Nonnull pixels, size_t rowBytes,
+							  int32_t rows, int32_t inputChannels);
+// True once the file is in place; nothing is left at the path otherwise.
+bool ForgeExrWriterFinish(ForgeExrWriter* _Nullable writer);
+
+typedef struct {
+	double float32Megabytes;
+	double float32Seconds;
+	double exrMegabytes;
+	double exrSeconds;
+	double exrSerialSeconds;
+	double sizeRatio;
+	bool exact;
+} ForgeExrWriterBenchmark;
+
+// Writes to and removes its files from `directory`.
+ForgeExrWriterBenchmark ForgeBenchmarkExrWriter(int32_t width, int32_t height, const char* _Nonnull directory);
+
+// MARK: - Batch scheduler
+
+// Admits batch jobs against a memory and thread budget from estimates of their peak working
+// set, checkpoints finished jobs so an interrupted batch resumes, and reports throughput / ETA.
+typedef struct ForgeBatchScheduler ForgeBatchScheduler;
+
+typedef struct {
+	int32_t width;             // native pixels
+	int32_t height;
+	float outputScale;
+	int32_t cachedNodes;       // nodes that keep a full-frame intermediate
+	float grainRadius;         // native pixels; 0: no grain
+	float halationRadius;      // native pixels; 0: no halation
+	int32_t outputBytesPerPixel;   // 0 = 8 (RGBA16)
+} ForgeBatchJobSpec;
+
+typedef struct {
+	int32_t total;
+	int32_t completed;         // this run
+	int32_t failed;
+	int32_t resumed;           // done by an earlier run
+	int32_t running;
+	uint64_t bytesInFlight;
+	uint64_t peakBytesInFlight;
+	double elapsedSeconds;
+	double imagesPerSecond;
+	double megapixelsPerSecond;
+	double etaSeconds;         // 0 until a job has completed
+} ForgeBatchProgress;
+
+// Peak working set of a job, bytes.
+uint64_t ForgeEstimateBatchJob(ForgeBatchJobSpec spec);
+
+// `memoryBytes` 0: half of physical memory; `threads` 0: one per core. `checkpointPath` null: no
+// checkpoint; otherwise jobs an earlier run checkpointed there are skipped.
+ForgeBatchScheduler* _Nonnull ForgeBatchSchedulerCreate(uint64_t memoryBytes, int32_t threads, const char* _Nullable checkpointPath);
+void ForgeBatchSchedulerRelease(ForgeBatchScheduler* _Nullable scheduler);
+int32_t ForgeBatchSchedulerThreads(const ForgeBatchScheduler* _Nullable scheduler);
+
+// Hash of a job's settings (encoded by the caller) for its checkpoint key; stable across launches.
+uint64_t ForgeBatchSettingsHash(const void* _Nullable bytes, size_t size);
+// The job's index. `key` names it in the checkpoint (a path, say).
+int32_t ForgeBatchSchedulerAdd(ForgeBatchScheduler* _Nullable scheduler, const char* _Nullable key, ForgeBatchJobSpec spec);
+// True if an earlier run finished the job; it won't be handed out.
+bool ForgeBatchSchedulerResumed(const ForgeBatchScheduler* _Nullable scheduler, int32_t job);
+// A job that fits the budget now, or -1: wait for a running job to finish, or, with none running,
+// the batch is done.
+int32_t ForgeBatchSchedulerNext(ForgeBatchScheduler* _Nullable scheduler);
+// The job's memory is free again.
+void ForgeBatchSchedulerFinish(ForgeBatchScheduler* _Nullable scheduler, int32_t job, bool ok);
+// The job's output is durable.
+void ForgeBatchSchedulerCheckpoint(ForgeBatchScheduler* _Nullable scheduler, int32_t job);
+void ForgeBatchSchedulerClearCheckpoint(ForgeBatchScheduler* _Nullable scheduler);
+ForgeBatchProgress ForgeBatchSchedulerGetProgress(const ForgeBatchScheduler* _Nullable scheduler);
+
+typedef struct {
+	int32_t jobs;
+	double budgetMegabytes;
+	double fixedPeakMegabytes;
+	double scheduledPeakMegabytes;
+	double fixedSeconds;
+	double scheduledSeconds;
+	bool withinBudget;
+	bool resumes;
+} ForgeBatchSchedulerBenchmark;
+
+// The checkpoint goes in, and is removed from, `directory`.
+ForgeBatchSchedulerBenchmark ForgeBenchmarkBatchScheduler(int32_t jobs, const char* _Nonnull directory);
+
+// MARK: - Thumbnails
+
+// Graded JPEG thumbnails straight from raw mosaics: 2×2 binning, area downsample, the
+// demosaic_linear develop and a baked grade LUT. The raws themselves are opened by
+// RenderRawThumbnails (DemosaicerBridge.h).
+typedef struct {
+	int32_t maxSize;           // long edge; 0 = 500
+	int32_t quality;           // 1...100; 0 = 85
+} ForgeThumbnailSettings;
+
+typedef struct {
+	int32_t images;
+	int32_t failed;
+	double seconds;
+	double loadSeconds;        // summed over workers
+	double renderSeconds;
+	double encodeSeconds;
+	double imagesPerSecond;
+} ForgeThumbnailBatchStats;
+
+typedef struct {
+	int32_t images;
+	int32_t megapixels;
+	double demosaicSeconds;
+	double thumbnailSeconds;
+	double imagesPerSecond;
+	double projectedSeconds3000;
+	double maxDifference;
+} ForgeThumbnailBenchmark;
+
+// Writes to and removes its files from `directory`.
+ForgeThumbnailBenchmark ForgeBenchmarkThumbnails(int32_t width, int32_t height, int32_t images, const char* _Nonnull directory);
+
+#ifdef __cplusplus
+}
+#endif
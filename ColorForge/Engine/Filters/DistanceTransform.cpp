@@ -0,0 +1,291 @@
+//
+//  DistanceTransform.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "DistanceTransform.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace forge {
+
+namespace {
+
+constexpr int kStrip = 64;                       // columns per task in the column pass
+constexpr uint16_t kInsideBit = 0x8000;
+constexpr uint16_t kNone = 0x7FFF;               // no opposite pixel in the column
+constexpr int64_t kFar = int64_t(1) << 50;
+constexpr float kUnreached = 1e9f;               // no opposite pixel anywhere
+
+inline bool inside(const MaskSource& m, int x, int y) {
+	return m.bytes ? m.bytes[size_t(y) * m.rowBytes + size_t(x)] >= 128 : m.floats.pixel(x, y)[0] >= 0.5f;
+}
+
+// Lower envelope of the parabolas (q − p)² + f(p), sampled at every q: d(q) = min_p of that.
+// f ≥ kFar marks no parabola.
+void envelope(const int64_t* f, int n, int64_t* d, int* v, double* z) {
+	int k = -1;
+	for (int q = 0; q < n; ++q) {
+		if (f[q] >= kFar) continue;
+		if (k < 0) {
+			k = 0;
+			v[0] = q;
+			z[0] = -std::numeric_limits<double>::infinity();
+			z[1] = std::numeric_limits<double>::infinity();
+			continue;
+		}
+		double s;
+		for (;;) {
+			const int p = v[k];
+			// Where the parabolas of p and q cross; written so q² never meets f in one sum.
+			s = (double(f[q] - f[p]) + double(q - p) * double(q + p)) / (2.0 * double(q - p));
+			if (s > z[k]) break;
+			--k;
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = std::numeric_limits<double>::infinity();
+	}
+	if (k < 0) {
+		std::fill(d, d + n, kFar);
+		return;
+	}
+	for (int q = 0, j = 0; q < n; ++q) {
+		while (z[j + 1] < double(q)) ++j;
+		const int64_t dx = q - v[j];
+		d[q] = dx * dx + f[v[j]];
+	}
+}
+
+} // namespace
+
+float FeatherRemap::operator()(float distance) const {
+	const float d = distance + offset;
+	float v;
+	if (radius > 0.0f) {
+		const float t = std::clamp(d * (0.5f / radius) + 0.5f, 0.0f, 1.0f);
+		v = t * t * (3.0f - 2.0f * t);
+	} else {
+		v = d > 0.0f ? 1.0f : 0.0f;
+	}
+	if (invert) v = 1.0f - v;
+	return v * std::clamp(opacity, 0.0f, 1.0f);
+}
+
+// MARK: - Transform
+
+void signedDistanceRows(const MaskSource& mask, const std::function<void(int, const float*)>& emit) {
+	const int width = mask.width, height = mask.height;
+	if (width <= 0 || height <= 0 || (!mask.bytes && !mask.floats.valid())) return;
+
+	// Columns: distance to the nearest pixel on the other side, with the pixel's own side in
+	// the top bit.
+	std::vector<uint16_t> column(size_t(width) * size_t(height));
+	const size_t strips = (size_t(width) + kStrip - 1) / kStrip;
+	parallelFor(strips, [&](size_t s) {
+		const int x0 = int(s) * kStrip, x1 = std::min(width, x0 + kStrip);
+		int lastIn[kStrip], lastOut[kStrip];
+		std::fill(lastIn, lastIn + kStrip, -(1 << 30));
+		std::fill(lastOut, lastOut + kStrip, -(1 << 30));
+		for (int y = 0; y < height; ++y) {
+			uint16_t* g = &column[size_t(y) * size_t(width)];
+			for (int x = x0; x < x1; ++x) {
+				const bool in = inside(mask, x, y);
+				(in ? lastIn : lastOut)[x - x0] = y;
+				const int d = std::min(y - (in ? lastOut : lastIn)[x - x0], int(kNone));
+				g[x] = uint16_t(d | (in ? kInsideBit : 0));
+			}
+		}
+		std::fill(lastIn, lastIn + kStrip, 1 << 30);
+		std::fill(lastOut, lastOut + kStrip, 1 << 30);
+		for (int y = height - 1; y >= 0; --y) {
+			uint16_t* g = &column[size_t(y) * size_t(width)];
+			for (int x = x0; x < x1; ++x) {
+				const bool in = (g[x] & kInsideBit) != 0;
+				(in ? lastIn : lastOut)[x - x0] = y;
+				const int d = std::min({ (in ? lastOut : lastIn)[x - x0] - y, int(g[x] & kNone), int(kNone) });
+				g[x] = uint16_t(d | (in ? kInsideBit : 0));
+			}
+		}
+	});
+
+	// Rows: the nearest inside pixel for pixels outside, and the nearest outside pixel for
+	// pixels inside, over the column distances of the whole row.
+	parallelChunks(size_t(height), workerCount() * 4, [&](size_t, size_t begin, size_t end) {
+		std::vector<int64_t> toInside(static_cast<size_t>(width)), toOutside(static_cast<size_t>(width));
+		std::vector<int64_t> dIn(static_cast<size_t>(width)), dOut(static_cast<size_t>(width));
+		std::vector<int> v(static_cast<size_t>(width));
+		std::vector<double> z(static_cast<size_t>(width) + 1);
+		std::vector<float> row(static_cast<size_t>(width));
+		for (size_t y = begin; y < end; ++y) {
+			const uint16_t* g = &column[y * size_t(width)];
+			for (int x = 0; x < width; ++x) {
+				const bool in = (g[x] & kInsideBit) != 0;
+				const int d = g[x] & kNone;
+				const int64_t f = d == kNone ? kFar : int64_t(d) * d;
+				toInside[size_t(x)] = in ? 0 : f;
+				toOutside[size_t(x)] = in ? f : 0;
+			}
+			envelope(toInside.data(), width, dIn.data(), v.data(), z.data());
+			envelope(toOutside.data(), width, dOut.data(), v.data(), z.data());
+			for (int x = 0; x < width; ++x) {
+				const bool in = (g[x] & kInsideBit) != 0;
+				const int64_t d2 = in ? dOut[size_t(x)] : dIn[size_t(x)];
+				const float d = d2 >= kFar ? kUnreached : float(std::sqrt(double(d2))) - 0.5f;
+				row[size_t(x)] = in ? d : -d;
+			}
+			emit(int(y), row.data());
+		}
+	});
+}
+
+// MARK: - Field
+
+void SignedDistanceField::build(const uint8_t* mask, size_t rowBytes, int width, int height) {
+	MaskSource source;
+	source.width = width;
+	source.height = height;
+	source.bytes = mask;
+	source.rowBytes = rowBytes;
+	width_ = height_ = 0;
+	distance_.clear();
+	if (!mask || width <= 0 || height <= 0) return;
+	width_ = width;
+	height_ = height;
+	distance_.resize(size_t(width) * size_t(height));
+	signedDistanceRows(source, [&](int y, const float* d) {
+		floatToHalf(d, &distance_[size_t(y) * size_t(width_)], size_t(width_));
+	});
+}
+
+void SignedDistanceField::build(const ImageView& mask) {
+	MaskSource source;
+	source.width = mask.width;
+	source.height = mask.height;
+	source.floats = mask;
+	width_ = height_ = 0;
+	distance_.clear();
+	if (!mask.valid()) return;
+	width_ = mask.width;
+	height_ = mask.height;
+	distance_.resize(size_t(width_) * size_t(height_));
+	signedDistanceRows(source, [&](int y, const float* d) {
+		floatToHalf(d, &distance_[size_t(y) * size_t(width_)], size_t(width_));
+	});
+}
+
+void SignedDistanceField::remap(const FeatherRemap& remap, uint8_t* dst, size_t rowBytes) const {
+	if (!dst || empty()) return;
+	parallelFor(size_t(height_), [&](size_t y) {
+		const half_t* d = &distance_[y * size_t(width_)];
+		uint8_t* out = dst + y * rowBytes;
+		for (int x = 0; x < width_; ++x) out[x] = uint8_t(std::lrint(255.0f * remap(halfToFloat(d[x]))));
+	});
+}
+
+void SignedDistanceField::remap(const FeatherRemap& remap, const ImageView& dst) const {
+	if (!dst.valid() || empty()) return;
+	const int width = std::min(width_, dst.width);
+	parallelFor(size_t(std::min(height_, dst.height)), [&](size_t y) {
+		const half_t* d = &distance_[y * size_t(width_)];
+		for (int x = 0; x < width; ++x) dst.pixel(x, int(y))[0] = remap(halfToFloat(d[x]));
+	});
+}
+
+// MARK: - Benchmark
+
+DistanceFieldBenchmark benchmarkDistanceField(int width, int height) {
+	using Clock = std::chrono::steady_clock;
+	auto seconds = [](Clock::time_point t0) { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+	DistanceFieldBenchmark result;
+	if (width <= 0 || height <= 0) return result;
+
+	// A few overlapping blobs, as a segmentation mask.
+	std::vector<uint8_t> mask(size_t(width) * size_t(height));
+	parallelFor(size_t(height), [&](size_t y) {
+		for (int x = 0; x < width; ++x) {
+			bool in = false;
+			for (int b = 0; b < 4 && !in; ++b) {
+				const float cx = float(width) * (0.3f + 0.15f * float(b)), cy = float(height) * (0.35f + 0.1f * float(b % 3));
+				const float r = float(std::min(width, height)) * (0.12f + 0.04f * float(b));
+				in = std::hypot(float(x) - cx, float(y) - cy) < r;
+			}
+			mask[y * size_t(width) + size_t(x)] = in ? 255 : 0;
+		}
+	});
+
+	SignedDistanceField field;
+	auto t0 = Clock::now();
+	field.build(mask.data(), size_t(width), width, height);
+	result.buildSeconds = seconds(t0);
+	result.buildMegapixelsPerSecond = double(width) * double(height) / 1e6 / std::max(result.buildSeconds, 1e-9);
+	result.megabytes = double(field.bytes()) / 1048576.0;
+
+	FeatherRemap remap;
+	remap.radius = 2.0f;
+	t0 = Clock::now();
+	field.remap(remap, mask.data(), size_t(width));
+	result.narrowRemapSeconds = seconds(t0);
+	remap.radius = 400.0f;
+	t0 = Clock::now();
+	field.remap(remap, mask.data(), size_t(width));
+	result.wideRemapSeconds = seconds(t0);
+
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeDistanceField {
+	forge::SignedDistanceField field;
+};
+
+namespace {
+
+forge::FeatherRemap featherRemap(ForgeFeatherRemap r) {
+	forge::FeatherRemap remap;
+	remap.offset = r.offset;
+	remap.radius = r.radius;
+	remap.opacity = r.opacity;
+	remap.invert = r.invert;
+	return remap;
+}
+
+} // namespace
+
+extern "C" {
+	ForgeDistanceField* ForgeDistanceFieldCreate(const uint8_t* mask, size_t rowBytes, int32_t width, int32_t height) {
+		if (!mask || width <= 0 || height <= 0) return nullptr;
+		auto* handle = new ForgeDistanceField;
+		handle->field.build(mask, rowBytes, width, height);
+		return handle;
+	}
+
+	void ForgeDistanceFieldRelease(ForgeDistanceField* field) {
+		delete field;
+	}
+
+	uint64_t ForgeDistanceFieldBytes(const ForgeDistanceField* field) {
+		return field ? field->field.bytes() : 0;
+	}
+
+	void ForgeDistanceFieldRemap(const ForgeDistanceField* field, ForgeFeatherRemap remap, uint8_t* dst, size_t rowBytes) {
+		if (field) field->field.remap(featherRemap(remap), dst, rowBytes);
+	}
+
+	ForgeDistanceFieldBenchmark ForgeBenchmarkDistanceField(int32_t width, int32_t height) {
+		const forge::DistanceFieldBenchmark b = forge::benchmarkDistanceField(width, height);
+		return { b.buildSeconds, b.buildMegapixelsPerSecond, b.narrowRemapSeconds, b.wideRemapSeconds, b.megabytes };
+	}
+}
@@ -0,0 +1,415 @@
+//
+//  GuidedFilter.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "GuidedFilter.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace forge {
+
+namespace {
+
+inline float luma(const float* p, int channels) {
+	return channels >= 3 ? 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2] : p[0];
+}
+
+inline int alignUp(int v, int step) {
+	const int r = ((v % step) + step) % step;
+	return r == 0 ? v : v + (step - r);
+}
+
+// MARK: - Box means
+
+// Means over (2r + 1)² windows cut at the plane edge, for output rows [y0, y1) of a
+// width × height plane with `channels` channels. source(y, float* row) supplies input row y;
+// sink(y, const double* means) receives each output row. Bands of rows run in parallel, each
+// keeping a ring of the 2r + 2 horizontally summed rows its vertical running sum spans.
+template <typename Source, typename Sink>
+void boxMeans(int width, int height, int channels, int radius, int y0, int y1, Source&& source, Sink&& sink) {
+	if (y1 <= y0 || width <= 0 || height <= 0) return;
+	const size_t C = size_t(channels);
+	const size_t n = size_t(width) * C;
+	const int ring = 2 * radius + 2;
+
+	std::vector<double> invCountX(static_cast<size_t>(width));
+	for (int x = 0; x < width; ++x) invCountX[size_t(x)] = 1.0 / double(std::min(x + radius, width - 1) - std::max(x - radius, 0) + 1);
+
+	const size_t rows = size_t(y1 - y0);
+	const size_t bands = std::clamp<size_t>(rows / size_t(std::max(64, 4 * radius)), 1, size_t(workerCount()) * 2);
+	parallelChunks(rows, bands, [&](size_t, size_t begin, size_t end) {
+		std::vector<float> raw(n), summed(size_t(ring) * n);
+		std::vector<double> prefix(n + C), acc(n, 0.0), out(n);
+		auto slot = [&](int y) { return &summed[size_t(y % ring) * n]; };
+
+		auto enter = [&](int y) {
+			source(y, raw.data());
+			for (size_t c = 0; c < C; ++c) prefix[c] = 0.0;
+			for (size_t i = 0; i < n; ++i) prefix[i + C] = prefix[i] + double(raw[i]);
+			float* s = slot(y);
+			for (int x = 0; x < width; ++x) {
+				const size_t lo = size_t(std::max(x - radius, 0)) * C;
+				const size_t hi = size_t(std::min(x + radius + 1, width)) * C;
+				for (size_t c = 0; c < C; ++c) s[size_t(x) * C + c] = float(prefix[hi + c] - prefix[lo + c]);
+			}
+			for (size_t i = 0; i < n; ++i) acc[i] += double(s[i]);
+		};
+
+		const int yb = y0 + int(begin), ye = y0 + int(end);
+		for (int y = std::max(yb - radius, 0); y <= std::min(yb + radius, height - 1); ++y) enter(y);
+		for (int y = yb; y < ye; ++y) {
+			const double invY = 1.0 / double(std::min(y + radius, height - 1) - std::max(y - radius, 0) + 1);
+			for (int x = 0; x < width; ++x) {
+				const double inv = invCountX[size_t(x)] * invY;
+				for (size_t c = 0; c < C; ++c) out[size_t(x) * C + c] = acc[size_t(x) * C + c] * inv;
+			}
+			sink(y, out.data());
+
+			if (y + radius + 1 < height) enter(y + radius + 1);
+			if (y - radius >= 0) {
+				const float* s = slot(y - radius);
+				for (size_t i = 0; i < n; ++i) acc[i] -= double(s[i]);
+			}
+		}
+	});
+}
+
+// MARK: - Coefficients
+
+// Per-pixel (a, b) of a width × height plane into `ab` (guideChannels + 1 channels: a…, b).
+// guideRow(y, float*) gives guideChannels values per pixel, maskRow(y, float*) one.
+template <typename GuideRow, typename MaskRow>
+void fitCoefficients(int width, int height, int guideChannels, int radius, float epsilon,
+					 GuideRow&& guideRow, MaskRow&& maskRow, const ImageView& ab) {
+	const bool color = guideChannels == 3;
+	const int channels = color ? 13 : 4;
+	const double eps = double(epsilon);
+
+	struct Rows {
+		std::vector<float> g, p;
+	};
+	auto source = [&](int y, float* raw) {
+		thread_local Rows rows;
+		rows.g.resize(size_t(width) * size_t(guideChannels));
+		rows.p.resize(size_t(width));
+		guideRow(y, rows.g.data());
+		maskRow(y, rows.p.data());
+		for (int x = 0; x < width; ++x) {
+			const float p = rows.p[size_t(x)];
+			float* r = raw + size_t(x) * size_t(channels);
+			if (!color) {
+				const float I = rows.g[size_t(x)];
+				r[0] = I;
+				r[1] = p;
+				r[2] = I * I;
+				r[3] = I * p;
+				continue;
+			}
+			const float* I = &rows.g[size_t(x) * 3];
+			r[0] = I[0]; r[1] = I[1]; r[2] = I[2]; r[3] = p;
+			r[4] = I[0] * p; r[5] = I[1] * p; r[6] = I[2] * p;
+			r[7] = I[0] * I[0]; r[8] = I[0] * I[1]; r[9] = I[0] * I[2];
+			r[10] = I[1] * I[1]; r[11] = I[1] * I[2]; r[12] = I[2] * I[2];
+		}
+	};
+
+	auto sink = [&](int y, const double* m) {
+		float* out = ab.row(y);
+		for (int x = 0; x < width; ++x) {
+			const double* v = m + size_t(x) * size_t(channels);
+			float* o = out + size_t(x) * size_t(guideChannels + 1);
+			if (!color) {
+				const double var = v[2] - v[0] * v[0];
+				const double cov = v[3] - v[0] * v[1];
+				const double a = cov / (var + eps);
+				o[0] = float(a);
+				o[1] = float(v[1] - a * v[0]);
+				continue;
+			}
+			const double s00 = v[7] - v[0] * v[0] + eps, s01 = v[8] - v[0] * v[1], s02 = v[9] - v[0] * v[2];
+			const double s11 = v[10] - v[1] * v[1] + eps, s12 = v[11] - v[1] * v[2], s22 = v[12] - v[2] * v[2] + eps;
+			const double c0 = v[4] - v[0] * v[3], c1 = v[5] - v[1] * v[3], c2 = v[6] - v[2] * v[3];
+
+			// Σ⁻¹ · cov through the symmetric cofactor matrix.
+			const double k00 = s11 * s22 - s12 * s12, k01 = s02 * s12 - s01 * s22, k02 = s01 * s12 - s02 * s11;
+			const double k11 = s00 * s22 - s02 * s02, k12 = s01 * s02 - s00 * s12, k22 = s00 * s11 - s01 * s01;
+			const double det = s00 * k00 + s01 * k01 + s02 * k02;
+			const double inv = std::fabs(det) > 1e-30 ? 1.0 / det : 0.0;
+			const double a0 = (k00 * c0 + k01 * c1 + k02 * c2) * inv;
+			const double a1 = (k01 * c0 + k11 * c1 + k12 * c2) * inv;
+			const double a2 = (k02 * c0 + k12 * c1 + k22 * c2) * inv;
+			o[0] = float(a0);
+			o[1] = float(a1);
+			o[2] = float(a2);
+			o[3] = float(v[3] - a0 * v[0] - a1 * v[1] - a2 * v[2]);
+		}
+	};
+
+	boxMeans(width, height, channels, radius, 0, height, source, sink);
+}
+
+inline void writeMask(float* dst, int dstChannels, float q) {
+	q = std::clamp(q, 0.0f, 1.0f);
+	for (int c = 0; c < dstChannels; ++c) dst[c] = c < 3 ? q : 1.0f;
+}
+
+} // namespace
+
+int guidedFilterApron(const GuidedFilterParams& params) {
+	const int s = std::max(params.subsample, 1);
+	if (s == 1) return 2 * std::max(params.radius, 1);
+	const int lowRadius = std::max(1, (params.radius + s / 2) / s);
+	return 2 * lowRadius * s + 3 * s;
+}
+
+void guidedFilter(const ImageView& guide, const ImageView& mask, int srcX, int srcY,
+				  const ImageView& dst, int dstX, int dstY, const GuidedFilterParams& params) {
+	if (!guide.valid() || !mask.valid() || !dst.valid()) return;
+	if (guide.width != mask.width || guide.height != mask.height) return;
+
+	const int w = guide.width, h = guide.height;
+	const int gc = params.mode == GuideMode::Color && guide.channels >= 3 ? 3 : 1;
+	const int radius = std::max(params.radius, 1);
+	const int s = std::max(params.subsample, 1);
+
+	auto guideRow = [&](int y, float* g) {
+		const float* row = guide.row(y);
+		if (gc == 3) {
+			for (int x = 0; x < w; ++x) {
+				const float* p = row + size_t(x) * size_t(guide.channels);
+				g[size_t(x) * 3] = p[0];
+				g[size_t(x) * 3 + 1] = p[1];
+				g[size_t(x) * 3 + 2] = p[2];
+			}
+		} else {
+			for (int x = 0; x < w; ++x) g[x] = luma(row + size_t(x) * size_t(guide.channels), guide.channels);
+		}
+	};
+	auto maskRow = [&](int y, float* p) {
+		const float* row = mask.row(y);
+		for (int x = 0; x < w; ++x) p[x] = row[size_t(x) * size_t(mask.channels)];
+	};
+
+	// Subsample grid in image coordinates; too small a window falls back to full resolution.
+	const int ax = alignUp(srcX, s), ay = alignUp(srcY, s);
+	const int lw = s > 1 ? (srcX + w - ax) / s : 0, lh = s > 1 ? (srcY + h - ay) / s : 0;
+
+	if (s == 1 || lw < 2 || lh < 2) {
+		ImageBuffer ab(w, h, gc + 1);
+		fitCoefficients(w, h, gc, radius, params.epsilon, guideRow, maskRow, ab.view());
+
+		const ImageView abv = ab.view();
+		const int y0 = std::clamp(dstY - srcY, 0, h - 1), y1 = std::clamp(dstY - srcY + dst.height, y0 + 1, h);
+		boxMeans(w, h, gc + 1, radius, y0, y1,
+				 [&](int y, float* raw) { std::copy(abv.row(y), abv.row(y) + size_t(w) * size_t(gc + 1), raw); },
+				 [&](int y, const double* m) {
+					 const int row = y - (dstY - srcY);
+					 if (row < 0 || row >= dst.height) return;
+					 thread_local std::vector<float> g;
+					 g.resize(size_t(w) * size_t(gc));
+					 guideRow(y, g.data());
+					 for (int x = 0; x < dst.width; ++x) {
+						 const int wx = std::clamp(dstX - srcX + x, 0, w - 1);
+						 const double* v = m + size_t(wx) * size_t(gc + 1);
+						 double q = v[gc];
+						 for (int c = 0; c < gc; ++c) q += v[c] * double(g[size_t(wx) * size_t(gc) + size_t(c)]);
+						 writeMask(dst.pixel(x, row), dst.channels, float(q));
+					 }
+				 });
+		// Rows of dst outside the window repeat the nearest computed row.
+		for (int row = 0; row < dst.height; ++row) {
+			const int wy = dstY - srcY + row;
+			if (wy >= y0 && wy < y1) continue;
+			const int from = std::clamp(wy, y0, y1 - 1) - (dstY - srcY);
+			if (from >= 0 && from < dst.height) std::copy(dst.row(from), dst.row(from) + size_t(dst.width) * size_t(dst.channels), dst.row(row));
+		}
+		return;
+	}
+
+	// Fast mode: block means of guide and mask on the aligned grid.
+	const int ox = ax - srcX, oy = ay - srcY;
+	ImageBuffer lowGuide(lw, lh, gc), lowMask(lw, lh, 1);
+	parallelFor(size_t(lh), [&](size_t j) {
+		std::vector<float> g(size_t(w) * size_t(gc)), p(static_cast<size_t>(w));
+		std::vector<double> gs(size_t(lw) * size_t(gc), 0.0), ps(static_cast<size_t>(lw), 0.0);
+		for (int k = 0; k < s; ++k) {
+			const int y = oy + int(j) * s + k;
+			guideRow(y, g.data());
+			maskRow(y, p.data());
+			for (int i = 0; i < lw; ++i) {
+				for (int m = 0; m < s; ++m) {
+					const int x = ox + i * s + m;
+					for (int c = 0; c < gc; ++c) gs[size_t(i) * size_t(gc) + size_t(c)] += g[size_t(x) * size_t(gc) + size_t(c)];
+					ps[size_t(i)] += p[size_t(x)];
+				}
+			}
+		}
+		const double inv = 1.0 / double(s * s);
+		float* lg = lowGuide.view().row(int(j));
+		float* lm = lowMask.view().row(int(j));
+		for (size_t i = 0; i < gs.size(); ++i) lg[i] = float(gs[i] * inv);
+		for (int i = 0; i < lw; ++i) lm[i] = float(ps[size_t(i)] * inv);
+	});
+
+	const int lowRadius = std::max(1, (radius + s / 2) / s);
+	const ImageView lgv = lowGuide.view(), lmv = lowMask.view();
+	ImageBuffer ab(lw, lh, gc + 1), meanAB(lw, lh, gc + 1);
+	fitCoefficients(lw, lh, gc, lowRadius, params.epsilon,
+					[&](int y, float* g) { std::copy(lgv.row(y), lgv.row(y) + size_t(lw) * size_t(gc), g); },
+					[&](int y, float* p) { std::copy(lmv.row(y), lmv.row(y) + size_t(lw), p); },
+					ab.view());
+	const ImageView abv = ab.view(), mv = meanAB.view();
+	boxMeans(lw, lh, gc + 1, lowRadius, 0, lh,
+			 [&](int y, float* raw) { std::copy(abv.row(y), abv.row(y) + size_t(lw) * size_t(gc + 1), raw); },
+			 [&](int y, const double* m) {
+				 float* out = mv.row(y);
+				 for (size_t i = 0; i < size_t(lw) * size_t(gc + 1); ++i) out[i] = float(m[i]);
+			 });
+
+	// q = a·I + b with (a, b) interpolated from the grid, I at full resolution.
+	parallelFor(size_t(dst.height), [&](size_t row) {
+		const int Y = dstY + int(row);
+		const int wy = std::clamp(Y - srcY, 0, h - 1);
+		std::vector<float> g(size_t(w) * size_t(gc));
+		guideRow(wy, g.data());
+
+		const float v = (float(Y - ay) + 0.5f) / float(s) - 0.5f;
+		const float fv = std::floor(v), ty = v - fv;
+		const float* r0 = mv.row(std::clamp(int(fv), 0, lh - 1));
+		const float* r1 = mv.row(std::clamp(int(fv) + 1, 0, lh - 1));
+		for (int x = 0; x < dst.width; ++x) {
+			const int X = dstX + x;
+			const int wx = std::clamp(X - srcX, 0, w - 1);
+			const float u = (float(X - ax) + 0.5f) / float(s) - 0.5f;
+			const float fu = std::floor(u), tx = u - fu;
+			const size_t i0 = size_t(std::clamp(int(fu), 0, lw - 1)) * size_t(gc + 1);
+			const size_t i1 = size_t(std::clamp(int(fu) + 1, 0, lw - 1)) * size_t(gc + 1);
+
+			float q = 0.0f;
+			for (int c = 0; c <= gc; ++c) {
+				const float top = r0[i0 + size_t(c)] + (r0[i1 + size_t(c)] - r0[i0 + size_t(c)]) * tx;
+				const float bottom = r1[i0 + size_t(c)] + (r1[i1 + size_t(c)] - r1[i0 + size_t(c)]) * tx;
+				const float coef = top + (bottom - top) * ty;
+				q += c < gc ? coef * g[size_t(wx) * size_t(gc) + size_t(c)] : coef;
+			}
+			writeMask(dst.pixel(x, int(row)), dst.channels, q);
+		}
+	});
+}
+
+void guidedFilter(const ImageView& guide, const ImageView& mask, const ImageView& dst, const GuidedFilterParams& params) {
+	guidedFilter(guide, mask, 0, 0, dst, 0, 0, params);
+}
+
+// MARK: - Benchmark
+
+GuidedFilterBenchmark benchmarkGuidedFilter(int width, int height, int radius) {
+	GuidedFilterBenchmark result;
+	ImageBuffer guide(width, height, 4), mask(width, height, 1), ideal(width, height, 1), out(width, height, 4);
+
+	// A bright disc on a textured background, and a mask whose edge ramps over 2·radius pixels,
+	// as an upscaled low-resolution segmentation does.
+	const float cx = float(width) * 0.5f, cy = float(height) * 0.5f, r = float(std::min(width, height)) * 0.3f;
+	const float soft = float(std::max(radius, 1));
+	parallelFor(size_t(height), [&](size_t yy) {
+		const int y = int(yy);
+		for (int x = 0; x < width; ++x) {
+			const float d = std::hypot(float(x) - cx, float(y) - cy);
+			const bool inside = d < r;
+			const float texture = 0.05f * std::sin(float(x) * 0.7f) * std::cos(float(y) * 0.5f);
+			float* g = guide.view().pixel(x, y);
+			g[0] = (inside ? 0.75f : 0.2f) + texture;
+			g[1] = (inside ? 0.6f : 0.25f) + texture;
+			g[2] = 0.3f + texture;
+			g[3] = 1.0f;
+			ideal.view().row(y)[x] = inside ? 1.0f : 0.0f;
+			mask.view().row(y)[x] = std::clamp(0.5f - (d - r) / (2.0f * soft), 0.0f, 1.0f);
+		}
+	});
+
+	// Share of the mask's total variation that falls across the true edge.
+	auto edgeFraction = [&](const ImageView& v) {
+		double onEdge = 0.0, total = 0.0;
+		for (int y = 0; y + 1 < height; ++y) {
+			const float* i0 = ideal.view().row(y);
+			const float* i1 = ideal.view().row(y + 1);
+			for (int x = 0; x + 1 < width; ++x) {
+				const double q = v.pixel(x, y)[0];
+				const double dx = std::fabs(double(v.pixel(x + 1, y)[0]) - q);
+				const double dy = std::fabs(double(v.pixel(x, y + 1)[0]) - q);
+				total += dx + dy;
+				if (i0[x] != i0[x + 1]) onEdge += dx;
+				if (i0[x] != i1[x]) onEdge += dy;
+			}
+		}
+		return float(onEdge / std::max(total, 1e-12));
+	};
+	result.edgeFractionBefore = edgeFraction(mask.view());
+
+	GuidedFilterParams params;
+	params.radius = radius;
+	auto t0 = std::chrono::steady_clock::now();
+	guidedFilter(guide.view(), mask.view(), out.view(), params);
+	result.fullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	result.edgeFractionAfter = edgeFraction(out.view());
+
+	params.subsample = 4;
+	t0 = std::chrono::steady_clock::now();
+	guidedFilter(guide.view(), mask.view(), out.view(), params);
+	result.fastSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	const double megapixels = double(width) * double(height) / 1e6;
+	result.fullMegapixelsPerSecond = megapixels / std::max(result.fullSeconds, 1e-9);
+	result.fastMegapixelsPerSecond = megapixels / std::max(result.fastSeconds, 1e-9);
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+namespace {
+
+forge::GuidedFilterParams guidedFilterParams(const ForgeGuidedFilterParams& p) {
+	forge::GuidedFilterParams params;
+	params.radius = p.radius;
+	params.epsilon = p.epsilon;
+	params.subsample = p.subsample;
+	params.mode = p.colorGuide ? forge::GuideMode::Color : forge::GuideMode::Luminance;
+	return params;
+}
+
+} // namespace
+
+extern "C" {
+	void ForgeGuidedFilter(ForgeGuidedFilterParams params,
+						   const float* guide, int32_t guideChannels, size_t guideRowBytes,
+						   const float* mask, int32_t maskChannels, size_t maskRowBytes,
+						   int32_t srcX, int32_t srcY, int32_t srcWidth, int32_t srcHeight,
+						   float* dst, int32_t dstChannels, size_t dstRowBytes,
+						   int32_t dstX, int32_t dstY, int32_t dstWidth, int32_t dstHeight) {
+		if (!guide || !mask || !dst) return;
+		const forge::ImageView g{ const_cast<float*>(guide), srcWidth, srcHeight, guideChannels, guideRowBytes / sizeof(float) };
+		const forge::ImageView m{ const_cast<float*>(mask), srcWidth, srcHeight, maskChannels, maskRowBytes / sizeof(float) };
+		const forge::ImageView out{ dst, dstWidth, dstHeight, dstChannels, dstRowBytes / sizeof(float) };
+		forge::guidedFilter(g, m, srcX, srcY, out, dstX, dstY, guidedFilterParams(params));
+	}
+
+	int32_t ForgeGuidedFilterApron(ForgeGuidedFilterParams params) {
+		return forge::guidedFilterApron(guidedFilterParams(params));
+	}
+
+	ForgeGuidedFilterBenchmark ForgeBenchmarkGuidedFilter(int32_t width, int32_t height, int32_t radius) {
+		const forge::GuidedFilterBenchmark b = forge::benchmarkGuidedFilter(width, height, radius);
+		return { b.fullSeconds, b.fullMegapixelsPerSecond, b.fastSeconds, b.fastMegapixelsPerSecond, b.edgeFractionBefore, b.edgeFractionAfter };
+	}
+}
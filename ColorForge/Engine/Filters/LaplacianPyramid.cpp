@@ -0,0 +1,349 @@
+//
+//  LaplacianPyramid.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "LaplacianPyramid.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace forge {
+
+namespace {
+
+inline int floorDiv2(int v) { return v >> 1; } // arithmetic shift: floor for negatives too
+
+inline int alignUp(int v, int step) {
+	const int r = ((v % step) + step) % step;
+	return r == 0 ? v : v + (step - r);
+}
+
+// One pyramid level: `view` holds level pixels from (x, y) in that level's coordinates.
+struct Level {
+	ImageBuffer buffer;
+	ImageView view;
+	int x = 0, y = 0;
+};
+
+inline float channelGain(const BandGains& gains, int band, int channel) {
+	return band < gains.levels && channel < 4 ? gains.gain[band][channel] : 1.0f;
+}
+
+// MARK: - Reduce
+
+// Level k from level k − 1: rows 2i − 2 … 2i + 2, then the same five taps across every other
+// column. Edges clamp.
+void reduce(const ImageView& src, const ImageView& dst) {
+	const int C = src.channels;
+	parallelFor(size_t(dst.height), [&](size_t row) {
+		const int i = int(row);
+		const float* r[5];
+		for (int m = 0; m < 5; ++m) r[m] = src.row(std::clamp(2 * i + m - 2, 0, src.height - 1));
+
+		const size_t n = size_t(src.width) * size_t(C);
+		std::vector<float> t(n);
+		for (size_t v = 0; v < n; ++v) t[v] = (r[0][v] + r[4][v]) + 4.0f * (r[1][v] + r[3][v]) + 6.0f * r[2][v];
+
+		float* out = dst.row(i);
+		const int last = src.width - 1;
+		for (int j = 0; j < dst.width; ++j) {
+			const float* a = &t[size_t(std::clamp(2 * j - 2, 0, last)) * size_t(C)];
+			const float* b = &t[size_t(std::clamp(2 * j - 1, 0, last)) * size_t(C)];
+			const float* c = &t[size_t(std::min(2 * j, last)) * size_t(C)];
+			const float* d = &t[size_t(std::min(2 * j + 1, last)) * size_t(C)];
+			const float* e = &t[size_t(std::min(2 * j + 2, last)) * size_t(C)];
+			for (int ch = 0; ch < C; ++ch) {
+				out[size_t(j) * size_t(C) + size_t(ch)] = ((a[ch] + e[ch]) + 4.0f * (b[ch] + d[ch]) + 6.0f * c[ch]) * (1.0f / 256.0f);
+			}
+		}
+	});
+}
+
+// MARK: - Expand
+
+// Row `y` of the next finer level, columns [x0, x0 + count) (finer-level coordinates), expanded
+// from `coarse`. Even positions take (1, 6, 1) / 8 of the coarse neighbours, odd positions the
+// mean of the two they fall between.
+void expandRow(const Level& coarse, int y, int x0, int count, std::vector<float>& t, float* out) {
+	const ImageView& v = coarse.view;
+	const int C = v.channels;
+	const int I = floorDiv2(y) - coarse.y;
+	auto row = [&](int i) { return v.row(std::clamp(i, 0, v.height - 1)); };
+
+	// Coarse columns the run reads, clamped; clamping to this span equals clamping to the level.
+	const int c0 = std::clamp(floorDiv2(x0) - 1 - coarse.x, 0, v.width - 1);
+	const int c1 = std::clamp(floorDiv2(x0 + count - 1) + 1 - coarse.x, 0, v.width - 1);
+	const size_t span = size_t(c1 - c0 + 1) * size_t(C);
+	t.resize(span);
+
+	const float* a = row(I - 1) + size_t(c0) * size_t(C);
+	const float* b = row(I) + size_t(c0) * size_t(C);
+	const float* c = row(I + 1) + size_t(c0) * size_t(C);
+	if ((y & 1) == 0) {
+		for (size_t k = 0; k < span; ++k) t[k] = (a[k] + 6.0f * b[k] + c[k]) * 0.125f;
+	} else {
+		for (size_t k = 0; k < span; ++k) t[k] = (b[k] + c[k]) * 0.5f;
+	}
+
+	auto col = [&](int j) { return &t[size_t(std::clamp(j - coarse.x, c0, c1) - c0) * size_t(C)]; };
+	for (int k = 0; k < count; ++k) {
+		const int x = x0 + k;
+		const int J = floorDiv2(x);
+		float* o = out + size_t(k) * size_t(C);
+		if ((x & 1) == 0) {
+			const float *p = col(J - 1), *q = col(J), *r = col(J + 1);
+			for (int ch = 0; ch < C; ++ch) o[ch] = (p[ch] + 6.0f * q[ch] + r[ch]) * 0.125f;
+		} else {
+			const float *p = col(J), *q = col(J + 1);
+			for (int ch = 0; ch < C; ++ch) o[ch] = (p[ch] + q[ch]) * 0.5f;
+		}
+	}
+}
+
+} // namespace
+
+int bandApron(int levels) {
+	// A clamped window edge corrupts about two samples per level on the way down and again on
+	// the way up, doubling per octave. Measured with worst-case grid alignment the reach is
+	// 4·2^L − 4 pixels.
+	return levels <= 0 ? 0 : 4 << levels;
+}
+
+void applyBandGains(const ImageView& src, int srcX, int srcY, const ImageView& dst, int dstX, int dstY, const BandGains& gains) {
+	if (!src.valid() || !dst.valid() || src.channels != dst.channels) return;
+	const int C = src.channels;
+	const int L = std::clamp(gains.levels, 0, kMaxPyramidLevels);
+
+	if (L == 0) {
+		parallelFor(size_t(dst.height), [&](size_t row) {
+			const int y = std::clamp(dstY + int(row) - srcY, 0, src.height - 1);
+			for (int x = 0; x < dst.width; ++x) {
+				std::memcpy(dst.pixel(x, int(row)), src.pixel(std::clamp(dstX + x - srcX, 0, src.width - 1), y), size_t(C) * sizeof(float));
+			}
+		});
+		return;
+	}
+
+	// Level 0 is the source window from the first aligned position.
+	const int step = 1 << L;
+	const int ax = alignUp(srcX, step), ay = alignUp(srcY, step);
+	const int w0 = srcX + src.width - ax, h0 = srcY + src.height - ay;
+	if (w0 <= 0 || h0 <= 0) return;
+
+	std::vector<Level> levels(size_t(L) + 1);
+	levels[0].view = src.sub({ ax - srcX, ay - srcY, w0, h0 });
+	levels[0].x = ax;
+	levels[0].y = ay;
+	for (int k = 1; k <= L; ++k) {
+		const Level& fine = levels[size_t(k) - 1];
+		Level& level = levels[size_t(k)];
+		level.buffer = ImageBuffer((fine.view.width + 1) / 2, (fine.view.height + 1) / 2, C);
+		level.view = level.buffer.view();
+		level.x = fine.x / 2;
+		level.y = fine.y / 2;
+		reduce(fine.view, level.view);
+	}
+
+	// Back up in place: B_L = (1 − g_{L−1}) G_L, then B_k = (g_k − g_{k−1}) G_k + E B_{k+1}.
+	for (int k = L; k >= 1; --k) {
+		Level& level = levels[size_t(k)];
+		std::vector<float> coef(static_cast<size_t>(C));
+		for (int ch = 0; ch < C; ++ch) coef[size_t(ch)] = channelGain(gains, k, ch) - channelGain(gains, k - 1, ch);
+
+		parallelFor(size_t(level.view.height), [&](size_t row) {
+			float* p = level.view.row(int(row));
+			const int w = level.view.width;
+			if (k == L) {
+				for (int x = 0; x < w; ++x) {
+					for (int ch = 0; ch < C; ++ch) p[size_t(x) * size_t(C) + size_t(ch)] *= coef[size_t(ch)];
+				}
+				return;
+			}
+			std::vector<float> t, e(size_t(w) * size_t(C));
+			expandRow(levels[size_t(k) + 1], level.y + int(row), level.x, w, t, e.data());
+			for (int x = 0; x < w; ++x) {
+				for (int ch = 0; ch < C; ++ch) {
+					const size_t i = size_t(x) * size_t(C) + size_t(ch);
+					p[i] = coef[size_t(ch)] * p[i] + e[i];
+				}
+			}
+		});
+	}
+
+	// out = g_0 G_0 + E B_1, for the requested pixels only.
+	std::vector<float> g0(static_cast<size_t>(C));
+	for (int ch = 0; ch < C; ++ch) g0[size_t(ch)] = channelGain(gains, 0, ch);
+	parallelFor(size_t(dst.height), [&](size_t row) {
+		const int y = dstY + int(row);
+		std::vector<float> t, e(size_t(dst.width) * size_t(C));
+		expandRow(levels[1], y, dstX, dst.width, t, e.data());
+		const float* s = src.row(std::clamp(y - srcY, 0, src.height - 1));
+		float* out = dst.row(int(row));
+		for (int x = 0; x < dst.width; ++x) {
+			const float* sp = s + size_t(std::clamp(dstX + x - srcX, 0, src.width - 1)) * size_t(C);
+			for (int ch = 0; ch < C; ++ch) {
+				const size_t i = size_t(x) * size_t(C) + size_t(ch);
+				out[i] = g0[size_t(ch)] * sp[ch] + e[i];
+			}
+		}
+	});
+}
+
+void applyBandGains(const ImageView& src, const ImageView& dst, const BandGains& gains) {
+	applyBandGains(src, 0, 0, dst, 0, 0, gains);
+}
+
+// MARK: - MTF
+
+BandGains mtfBandGains(const MTFResponse& response, float pixelsPerMM, int width, int height) {
+	auto gainAt = [&](float lpmm, int channel) {
+		float g = 1.0f;
+		for (int b = 0; b < 4; ++b) {
+			const float s = std::clamp(std::log2(lpmm / response.cutoff[b]) + 0.5f, 0.0f, 1.0f);
+			g *= 1.0f + (response.gain[b][channel] - 1.0f) * s * s * (3.0f - 2.0f * s);
+		}
+		return g;
+	};
+
+	BandGains gains;
+	const int shortSide = std::min(width, height);
+	for (int k = 0; k < kMaxPyramidLevels && (shortSide >> (k + 1)) >= 8; ++k) {
+		const float lpmm = std::max(pixelsPerMM, 0.0f) * 0.3536f / float(1 << k);
+		bool flat = true;
+		for (int c = 0; c < 3; ++c) {
+			gains.gain[k][c] = gainAt(lpmm, c);
+			flat = flat && gains.gain[k][c] > 0.999f;
+		}
+		gains.gain[k][3] = 1.0f;
+		if (flat) break;
+		gains.levels = k + 1;
+	}
+	return gains;
+}
+
+// MARK: - Benchmark
+
+BandGainBenchmark benchmarkBandGains(const MTFResponse& response, int width, int height, float pixelsPerMM) {
+	BandGainBenchmark result;
+	const BandGains gains = mtfBandGains(response, pixelsPerMM, width, height);
+	result.levels = gains.levels;
+
+	auto fill = [](const ImageView& v) {
+		for (int y = 0; y < v.height; ++y) {
+			for (int x = 0; x < v.width; ++x) {
+				float* p = v.pixel(x, y);
+				const float edge = ((x / 37 + y / 23) & 1) ? 0.8f : 0.2f;
+				p[0] = edge * (0.5f + 0.5f * std::sin(float(x) * 0.9f));
+				p[1] = edge * (0.5f + 0.5f * std::cos(float(y) * 0.31f));
+				p[2] = float(x + y) / float(v.width + v.height);
+				p[3] = 1.0f;
+			}
+		}
+	};
+
+	{
+		ImageBuffer src(width, height, 4), dst(width, height, 4);
+		fill(src.view());
+		const auto t0 = std::chrono::steady_clock::now();
+		applyBandGains(src.view(), dst.view(), gains);
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		result.megapixelsPerSecond = double(width) * double(height) / 1e6 / std::max(result.seconds, 1e-9);
+
+		double scratch = 0;
+		int w = width, h = height;
+		for (int k = 0; k < gains.levels; ++k) {
+			w = (w + 1) / 2;
+			h = (h + 1) / 2;
+			scratch += double(w) * double(h);
+		}
+		result.scratchFraction = scratch / (double(width) * double(height));
+	}
+
+	// Tiles from source windows with aprons against one full-frame pass. Same pixels per mm as
+	// the full frame, so the tile frame gets real bands (capped by its size) to compare.
+	const int tw = 700, th = 500;
+	const BandGains tileGains = mtfBandGains(response, pixelsPerMM, tw, th);
+	if (tileGains.levels == 0) return result;
+	ImageBuffer src(tw, th, 4), full(tw, th, 4), tiled(tw, th, 4);
+	fill(src.view());
+	applyBandGains(src.view(), full.view(), tileGains);
+
+	const int apron = bandApron(tileGains.levels);
+	for (int ty = 0; ty < th; ty += 256) {
+		for (int tx = 0; tx < tw; tx += 256) {
+			const Rect tile = Rect{ tx, ty, 256, 256 }.intersect(src.view().bounds());
+			const Rect window = Rect{ tile.x - apron, tile.y - apron, tile.width + 2 * apron, tile.height + 2 * apron }.intersect(src.view().bounds());
+			applyBandGains(src.view().sub(window), window.x, window.y, tiled.view().sub(tile), tile.x, tile.y, tileGains);
+		}
+	}
+	result.tilesMatch = true;
+	for (int y = 0; y < th && result.tilesMatch; ++y) {
+		result.tilesMatch = std::memcmp(full.view().row(y), tiled.view().row(y), size_t(tw) * 4 * sizeof(float)) == 0;
+	}
+
+	BandGains flat = tileGains;
+	for (int k = 0; k < flat.levels; ++k) std::fill(flat.gain[k], flat.gain[k] + 4, 1.0f);
+	applyBandGains(src.view(), full.view(), flat);
+	result.identity = true;
+	for (int y = 0; y < th && result.identity; ++y) {
+		result.identity = std::memcmp(full.view().row(y), src.view().row(y), size_t(tw) * 4 * sizeof(float)) == 0;
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+namespace {
+
+// 4 × [r, g, b] gains, finest cutoff first.
+forge::MTFResponse mtfResponse(const float* response) {
+	forge::MTFResponse r;
+	for (int b = 0; b < 4; ++b) std::copy(response + b * 3, response + b * 3 + 3, r.gain[b]);
+	return r;
+}
+
+} // namespace
+
+extern "C" {
+	int32_t ForgeMTFBandGains(const float* response, float pixelsPerMM, int32_t width, int32_t height, float* gains) {
+		if (!response || !gains) return 0;
+		const forge::BandGains g = forge::mtfBandGains(mtfResponse(response), pixelsPerMM, width, height);
+		for (int k = 0; k < g.levels; ++k) std::copy(g.gain[k], g.gain[k] + 4, gains + size_t(k) * 4);
+		return g.levels;
+	}
+
+	void ForgeApplyBandGains(int32_t levels, const float* gains,
+							 const float* src, int32_t srcX, int32_t srcY, int32_t srcWidth, int32_t srcHeight, size_t srcRowBytes,
+							 float* dst, int32_t dstX, int32_t dstY, int32_t dstWidth, int32_t dstHeight, size_t dstRowBytes,
+							 int32_t channels) {
+		if (!src || !dst || !gains) return;
+		forge::BandGains g;
+		g.levels = std::clamp(int(levels), 0, forge::kMaxPyramidLevels);
+		for (int k = 0; k < g.levels; ++k) std::copy(gains + size_t(k) * 4, gains + size_t(k) * 4 + 4, g.gain[k]);
+
+		const forge::ImageView in{ const_cast<float*>(src), srcWidth, srcHeight, channels, srcRowBytes / sizeof(float) };
+		const forge::ImageView out{ dst, dstWidth, dstHeight, channels, dstRowBytes / sizeof(float) };
+		forge::applyBandGains(in, srcX, srcY, out, dstX, dstY, g);
+	}
+
+	int32_t ForgeBandGainApron(int32_t levels) {
+		return forge::bandApron(levels);
+	}
+
+	ForgeBandGainBenchmark ForgeBenchmarkBandGains(const float* response, int32_t width, int32_t height, float pixelsPerMM) {
+		if (!response) return {};
+		const forge::BandGainBenchmark b = forge::benchmarkBandGains(mtfResponse(response), width, height, pixelsPerMM);
+		return { b.levels, b.seconds, b.megapixelsPerSecond, b.tilesMatch, b.identity, b.scratchFraction };
+	}
+}
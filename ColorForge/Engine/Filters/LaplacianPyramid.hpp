@@ -0,0 +1,92 @@
+//
+//  LaplacianPyramid.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Per-octave detail gains through a Laplacian pyramid, for the film MTF response.
+
+ MTFCurveNode builds four down-and-up resampled copies of the full frame (scalar100 …
+ scalar10) and chains four mtfBandKernel passes over them: at export size that is eight
+ full-resolution resamples and four full-resolution blends per render. Here the image is
+ decomposed once into octave bands (Burt & Adelson: separable [1 4 6 4 1] / 16 reduce,
+ matching expand), each band is scaled by its own gain per channel, and the result is
+ reconstructed.
+
+ The bands are never stored. With Gaussian levels G_k, expand E and gains g_k (g_L = 1 for
+ the coarsest residual), the reconstruction
+     out = Σ g_k (G_k − E G_{k+1}) + G_L
+ rearranges, by linearity of E, into
+     B_L = (1 − g_{L−1}) G_L,  B_k = (g_k − g_{k−1}) G_k + E B_{k+1},  out = g_0 G_0 + E B_1
+ so each level's buffer is overwritten in place on the way back up, and the full-resolution
+ level is the source itself. Scratch is a third of the frame, and the source is read twice
+ and the output written once. With all gains 1 every B_k is zero and the output equals the
+ input exactly, which is how channels without a gain (alpha) pass through.
+
+ Regions: a tile of the output can be computed from a source window around it. The working
+ grid is aligned to multiples of 2^levels in image coordinates, so every level decimates on
+ the same lattice as a full-frame pass. Output pixels at least bandApron(levels) inside the
+ window (or on a window edge that is the image edge) come out bit-identical to the
+ full-frame result.
+ */
+
+constexpr int kMaxPyramidLevels = 10;
+
+struct BandGains {
+	int levels = 0;                           // bands; 0 leaves the image unchanged
+	float gain[kMaxPyramidLevels][4] = {};    // [band][channel], band 0 finest; channels ≥ 4 use 1
+};
+
+// Source margin, in pixels, a region needs for exact results.
+int bandApron(int levels);
+
+// `src` holds image pixels [srcX, srcX + src.width) × [srcY, srcY + src.height), `dst` image
+// pixels from (dstX, dstY); dst must lie inside src. `dst` must not alias `src`.
+void applyBandGains(const ImageView& src, int srcX, int srcY, const ImageView& dst, int dstX, int dstY, const BandGains& gains);
+// Full frame.
+void applyBandGains(const ImageView& src, const ImageView& dst, const BandGains& gains);
+
+// MARK: - MTF
+
+/*
+ Band gains for MTFCurveNode's response. Its cascade passes detail above each band's cutoff
+ (the down-and-up scalars 0.4, 0.2, 0.12 and 0.05 at the 600 px/mm test scale put them at
+ 120, 60, 36 and 15 lp/mm) through that band's gain, so the finest detail ends up at the
+ product of all four. Each cutoff here is a soft step over an octave around it, and a pyramid
+ band takes the response at its centre frequency, 0.354 / 2^k cycles per pixel.
+
+ The gains themselves are the film stock's (MTFParameters on the Swift side) and come in
+ through the bridge; only the cutoffs, which follow from the cascade, live here.
+ */
+struct MTFResponse {
+	float cutoff[4] = { 120.0f, 60.0f, 36.0f, 15.0f };     // lp/mm
+	float gain[4][3] = {};                                // [cutoff][rgb], finest first
+};
+
+// Bands down to where the response is within 0.1% of flat, capped by the frame size.
+BandGains mtfBandGains(const MTFResponse& response, float pixelsPerMM, int width, int height);
+
+// MARK: - Benchmark
+
+struct BandGainBenchmark {
+	int levels = 0;
+	double seconds = 0.0;
+	double megapixelsPerSecond = 0.0;
+	bool tilesMatch = false;     // 256² tiles with aprons equal the full-frame pass bit for bit
+	bool identity = false;       // all gains 1 returns the input exactly
+	double scratchFraction = 0;  // scratch bytes / frame bytes
+};
+
+// Full-frame pass over a width × height RGBA frame at `pixelsPerMM`; the tile and identity
+// checks run on a smaller frame at the same `pixelsPerMM`, and fail if it yields no bands.
+BandGainBenchmark benchmarkBandGains(const MTFResponse& response, int width, int height, float pixelsPerMM);
+
+} // namespace forge
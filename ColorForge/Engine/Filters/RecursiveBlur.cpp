@@ -0,0 +1,354 @@
+//
+//  RecursiveBlur.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "RecursiveBlur.hpp"
+#include "Parallel.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace forge {
+
+// Floats per vertical strip: 64 RGBA pixels. Six double state rows of this fit easily in L1.
+static constexpr int kStripFloats = 256;
+
+// MARK: - Coefficients
+
+struct GaussianCoefficients {
+	double B = 1.0;
+	double a1 = 0.0, a2 = 0.0, a3 = 0.0; // y[n] = B x[n] + a1 y[n-1] + a2 y[n-2] + a3 y[n-3]
+	double M[3][3] = {};                 // Triggs & Sdika trailing-edge matrix
+};
+
+// Third-order Young & van Vliet recursion, built from its poles as in L. J. van Vliet,
+// I. T. Young, P. W. Verbeek, "Recursive Gaussian derivative filters" (1998): three poles
+// designed for sigma = 2 are scaled by 1/q, with q chosen so the forward-backward response
+// has exactly the requested variance. Building the taps from the poles (rather than from the
+// 1995 polynomial fit in q) keeps the response a Gaussian of the right width at any radius;
+// the fit's rounded constants drift to half the width by sigma = 500.
+static GaussianCoefficients gaussianCoefficients(double sigma) {
+	static const std::complex<double> kPoles[3] = { { 1.41650, 1.00829 }, { 1.41650, -1.00829 }, { 1.86543, 0.0 } };
+
+	// Variance of the forward-backward pair: 2 Σ d / (d - 1)² over the scaled poles d = d0^(1/q).
+	auto variance = [](double q) {
+		std::complex<double> v = 0.0;
+		for (const auto& d0 : kPoles) {
+			const std::complex<double> d = std::pow(d0, 1.0 / q);
+			v += 2.0 * d / ((d - 1.0) * (d - 1.0));
+		}
+		return v.real();
+	};
+	double lo = 0.35, hi = 2.0 * sigma + 8.0;
+	for (int i = 0; i < 80; ++i) {
+		const double mid = 0.5 * (lo + hi);
+		(variance(mid) < sigma * sigma ? lo : hi) = mid;
+	}
+	const double q = 0.5 * (lo + hi);
+
+	std::complex<double> p[3];
+	for (int i = 0; i < 3; ++i) p[i] = 1.0 / std::pow(kPoles[i], 1.0 / q);
+
+	GaussianCoefficients c;
+	c.a1 = (p[0] + p[1] + p[2]).real();
+	c.a2 = -(p[0] * p[1] + p[0] * p[2] + p[1] * p[2]).real();
+	c.a3 = (p[0] * p[1] * p[2]).real();
+	c.B = 1.0 - (c.a1 + c.a2 + c.a3);
+
+	// Anti-causal start for a signal that carries on at its last value u: y[N + j] - u is linear
+	// in the causal state w[N - 1 - i] - u. Triggs & Sdika give M in closed form; running both
+	// recursions on each unit deviation until it has decayed gives the same matrix and is
+	// simpler to trust. Costs O(sigma) once per blur, not per line.
+	const int limit = int(40.0 * sigma) + 64;
+	std::vector<double> tail;
+	tail.reserve(size_t(limit));
+	for (int i = 0; i < 3; ++i) {
+		double w1 = i == 0, w2 = i == 1, w3 = i == 2;
+		tail.clear();
+		for (int n = 0; n < limit; ++n) {
+			const double w = c.a1 * w1 + c.a2 * w2 + c.a3 * w3;
+			w3 = w2;
+			w2 = w1;
+			w1 = w;
+			tail.push_back(w);
+			if (std::fabs(w1) + std::fabs(w2) + std::fabs(w3) < 1e-15) break;
+		}
+		double y1 = 0.0, y2 = 0.0, y3 = 0.0;
+		for (size_t n = tail.size(); n-- > 0;) {
+			const double y = c.B * tail[n] + c.a1 * y1 + c.a2 * y2 + c.a3 * y3;
+			y3 = y2;
+			y2 = y1;
+			y1 = y;
+		}
+		c.M[0][i] = y1;
+		c.M[1][i] = y2;
+		c.M[2][i] = y3;
+	}
+	return c;
+}
+
+// MARK: - Line filters
+
+// Filters `lanes` independent signals of `count` samples in place. Sample n of lane k is at
+// data[n * stride + k]. `state` holds 7 × lanes doubles.
+static void gaussianLines(float* data, int count, size_t stride, int lanes, const GaussianCoefficients& c, double* state) {
+	double* p1 = state;
+	double* p2 = p1 + lanes;
+	double* p3 = p2 + lanes;
+	double* edge = p3 + lanes;
+	double* q1 = edge + lanes;
+	double* q2 = q1 + lanes;
+	double* q3 = q2 + lanes;
+	const double B = c.B, a1 = c.a1, a2 = c.a2, a3 = c.a3;
+
+	// Causal pass, started from the steady state of a constant signal equal to the first sample.
+	const float* last = data + size_t(count - 1) * stride;
+	for (int k = 0; k < lanes; ++k) {
+		p1[k] = p2[k] = p3[k] = data[k];
+		edge[k] = last[k];
+	}
+	for (int n = 0; n < count; ++n) {
+		float* x = data + size_t(n) * stride;
+		for (int k = 0; k < lanes; ++k) {
+			const double w = B * x[k] + a1 * p1[k] + a2 * p2[k] + a3 * p3[k];
+			p3[k] = p2[k];
+			p2[k] = p1[k];
+			p1[k] = w;
+			x[k] = float(w);
+		}
+	}
+
+	// Anti-causal pass, started from the exact response to the signal continuing at its last value.
+	for (int k = 0; k < lanes; ++k) {
+		const double u0 = p1[k] - edge[k], u1 = p2[k] - edge[k], u2 = p3[k] - edge[k];
+		q1[k] = c.M[0][0] * u0 + c.M[0][1] * u1 + c.M[0][2] * u2 + edge[k];
+		q2[k] = c.M[1][0] * u0 + c.M[1][1] * u1 + c.M[1][2] * u2 + edge[k];
+		q3[k] = c.M[2][0] * u0 + c.M[2][1] * u1 + c.M[2][2] * u2 + edge[k];
+	}
+	for (int n = count - 1; n >= 0; --n) {
+		float* x = data + size_t(n) * stride;
+		for (int k = 0; k < lanes; ++k) {
+			const double y = B * x[k] + a1 * q1[k] + a2 * q2[k] + a3 * q3[k];
+			q3[k] = q2[k];
+			q2[k] = q1[k];
+			q1[k] = y;
+			x[k] = float(y);
+		}
+	}
+}
+
+// First-order forward/backward pair; the combined kernel is (1-a)/(1+a) · a^|n|, which sums to one.
+// `state` holds 2 × lanes doubles.
+static void exponentialLines(float* data, int count, size_t stride, int lanes, double a, double* state) {
+	double* s = state;
+	double* edge = s + lanes;
+	const double g = 1.0 - a;
+
+	const float* last = data + size_t(count - 1) * stride;
+	for (int k = 0; k < lanes; ++k) {
+		s[k] = data[k];
+		edge[k] = last[k];
+	}
+	for (int n = 0; n < count; ++n) {
+		float* x = data + size_t(n) * stride;
+		for (int k = 0; k < lanes; ++k) {
+			s[k] = g * x[k] + a * s[k];
+			x[k] = float(s[k]);
+		}
+	}
+
+	// Past the end the causal output keeps decaying towards the edge value; summing that tail
+	// in closed form gives the anti-causal output at the last sample.
+	float* end = data + size_t(count - 1) * stride;
+	for (int k = 0; k < lanes; ++k) {
+		s[k] = edge[k] + (s[k] - edge[k]) / (1.0 + a);
+		end[k] = float(s[k]);
+	}
+	for (int n = count - 2; n >= 0; --n) {
+		float* x = data + size_t(n) * stride;
+		for (int k = 0; k < lanes; ++k) {
+			s[k] = g * x[k] + a * s[k];
+			x[k] = float(s[k]);
+		}
+	}
+}
+
+// MARK: - Separable driver
+
+// Runs `line(data, count, stride, lanes, state)` along every row and then down every strip of columns.
+template <typename LineFn>
+static void separable(const ImageView& image, size_t stateLanes, LineFn&& line) {
+	const int channels = image.channels;
+	const size_t rowFloats = size_t(image.width) * size_t(channels);
+
+	// Horizontal: one row at a time, all channels of a pixel in step.
+	parallelChunks(size_t(image.height), workerCount(), [&](size_t, size_t begin, size_t end) {
+		std::vector<double> state(stateLanes * size_t(channels));
+		for (size_t y = begin; y < end; ++y) line(image.row(int(y)), image.width, size_t(channels), channels, state.data());
+	});
+
+	// Vertical: each step of the recursion is one contiguous strip of a row.
+	const size_t strips = (rowFloats + kStripFloats - 1) / kStripFloats;
+	parallelFor(strips, [&](size_t s) {
+		const size_t first = s * kStripFloats;
+		const int lanes = int(std::min<size_t>(kStripFloats, rowFloats - first));
+		std::vector<double> state(stateLanes * size_t(lanes));
+		line(image.data + first, image.height, image.rowStride, lanes, state.data());
+	});
+}
+
+void gaussianBlur(const ImageView& image, float sigma) {
+	if (!image.valid() || !(sigma >= 0.5f)) return;
+	const GaussianCoefficients c = gaussianCoefficients(double(sigma));
+	separable(image, 7, [&c](float* data, int count, size_t stride, int lanes, double* state) {
+		gaussianLines(data, count, stride, lanes, c, state);
+	});
+}
+
+void exponentialBlur(const ImageView& image, float radius) {
+	if (!image.valid() || !(radius > 0.0f)) return;
+	const double a = std::exp(-1.0 / double(radius));
+	separable(image, 2, [a](float* data, int count, size_t stride, int lanes, double* state) {
+		exponentialLines(data, count, stride, lanes, a, state);
+	});
+}
+
+// MARK: - Reference
+
+void directBlur(const ImageView& src, const ImageView& dst, BlurKind kind, float radius) {
+	const int channels = src.channels;
+	const int reach = int(std::ceil(kind == BlurKind::Gaussian ? 6.0f * radius : 12.0f * radius));
+
+	std::vector<double> kernel(size_t(2 * reach + 1));
+	double total = 0.0;
+	for (int i = -reach; i <= reach; ++i) {
+		const double d = double(i);
+		const double w = kind == BlurKind::Gaussian ? std::exp(-0.5 * d * d / (double(radius) * radius))
+													: std::exp(-std::fabs(d) / double(radius));
+		kernel[size_t(i + reach)] = w;
+		total += w;
+	}
+	for (double& w : kernel) w /= total;
+
+	// Taps that fall beyond an edge all read the edge sample, so their weights are summed once
+	// (prefix[i] = kernel[0] + ... + kernel[i - 1]) instead of looping over them.
+	std::vector<double> prefix(kernel.size() + 1, 0.0);
+	for (size_t i = 0; i < kernel.size(); ++i) prefix[i + 1] = prefix[i] + kernel[i];
+
+	auto convolve = [&](const double* in, double* out, int n, int lanes) {
+		for (int i = 0; i < n; ++i) {
+			const int lo = std::max(0, i - reach);
+			const int hi = std::min(n - 1, i + reach);
+			const double before = prefix[size_t(lo - (i - reach))];                    // taps left of 0
+			const double after = prefix.back() - prefix[size_t(hi - (i - reach) + 1)]; // taps right of n-1
+			for (int k = 0; k < lanes; ++k) {
+				double sum = before * in[k] + after * in[size_t(n - 1) * lanes + k];
+				for (int j = lo; j <= hi; ++j) sum += kernel[size_t(j - i + reach)] * in[size_t(j) * lanes + k];
+				out[size_t(i) * lanes + k] = sum;
+			}
+		}
+	};
+
+	const int w = src.width, h = src.height;
+	std::vector<double> rows(size_t(w) * size_t(h) * size_t(channels));
+	parallelFor(size_t(h), [&](size_t y) {
+		std::vector<double> in(size_t(w) * size_t(channels));
+		const float* row = src.row(int(y));
+		for (size_t i = 0; i < in.size(); ++i) in[i] = row[i];
+		convolve(in.data(), &rows[y * size_t(w) * size_t(channels)], w, channels);
+	});
+	parallelFor(size_t(w), [&](size_t x) {
+		std::vector<double> in(size_t(h) * size_t(channels)), out(in.size());
+		for (int y = 0; y < h; ++y) {
+			for (int k = 0; k < channels; ++k) in[size_t(y) * channels + k] = rows[(size_t(y) * w + x) * channels + k];
+		}
+		convolve(in.data(), out.data(), h, channels);
+		for (int y = 0; y < h; ++y) {
+			for (int k = 0; k < channels; ++k) dst.pixel(int(x), y)[k] = float(out[size_t(y) * channels + k]);
+		}
+	});
+}
+
+// MARK: - Benchmark
+
+// Soft gradients plus hard-edged blocks, so both smooth response and edge ringing are exercised.
+static void fillTestPattern(const ImageView& image) {
+	parallelFor(size_t(image.height), [&](size_t y) {
+		float* row = image.row(int(y));
+		for (int x = 0; x < image.width; ++x) {
+			const bool block = ((x / 37) + (int(y) / 53)) % 3 == 0;
+			row[x * 4 + 0] = float(x) / float(image.width);
+			row[x * 4 + 1] = float(y) / float(image.height);
+			row[x * 4 + 2] = block ? 1.0f : 0.0f;
+			row[x * 4 + 3] = ((x * 7 + int(y) * 13) % 17) / 16.0f;
+		}
+	});
+}
+
+static void runBlur(BlurKind kind, const ImageView& image, float radius) {
+	if (kind == BlurKind::Gaussian) {
+		gaussianBlur(image, radius);
+	} else {
+		exponentialBlur(image, radius);
+	}
+}
+
+BlurBenchmark benchmarkBlur(BlurKind kind, float radius, int width, int height) {
+	BlurBenchmark result;
+	result.radius = radius;
+
+	ImageBuffer frame(width, height, 4);
+	fillTestPattern(frame.view());
+	runBlur(kind, frame.view(), radius); // warm up page faults
+	fillTestPattern(frame.view());
+	const auto start = std::chrono::steady_clock::now();
+	runBlur(kind, frame.view(), radius);
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.megapixelsPerSecond = double(width) * double(height) / 1e6 / std::max(result.seconds, 1e-9);
+
+	// The direct reference is O(radius) per pixel, so accuracy is checked on a small frame.
+	ImageBuffer source(384, 256, 4), direct(384, 256, 4);
+	fillTestPattern(source.view());
+	directBlur(source.view(), direct.view(), kind, radius);
+	runBlur(kind, source.view(), radius);
+	for (int y = 0; y < 256; ++y) {
+		const float* a = source.view().row(y);
+		const float* b = direct.view().row(y);
+		for (int i = 0; i < 384 * 4; ++i) result.maxError = std::max(result.maxError, std::fabs(a[i] - b[i]));
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	void ForgeGaussianBlur(float* data, int32_t width, int32_t height, int32_t channels, size_t rowBytes, float sigma) {
+		if (!data) return;
+		forge::gaussianBlur({ data, width, height, channels, rowBytes / sizeof(float) }, sigma);
+	}
+
+	void ForgeExponentialBlur(float* data, int32_t width, int32_t height, int32_t channels, size_t rowBytes, float radius) {
+		if (!data) return;
+		forge::exponentialBlur({ data, width, height, channels, rowBytes / sizeof(float) }, radius);
+	}
+
+	ForgeBlurBenchmark ForgeBenchmarkRecursiveBlur(int32_t width, int32_t height, float radius, bool exponential) {
+		const forge::BlurBenchmark b = forge::benchmarkBlur(exponential ? forge::BlurKind::Exponential : forge::BlurKind::Gaussian,
+															radius, width, height);
+		ForgeBlurBenchmark out{};
+		out.radius = b.radius;
+		out.seconds = b.seconds;
+		out.megapixelsPerSecond = b.megapixelsPerSecond;
+		out.maxError = b.maxError;
+		return out;
+	}
+}
@@ -0,0 +1,63 @@
+//
+//  RecursiveBlur.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Blurs whose cost does not depend on the radius.
+
+ GaussianBlurNode, BoxBlurNode, PrintHalationNode (exp_blur_linear) and the paper soften and
+ MTF stages all convolve with a kernel that grows with the radius, and at export scale the
+ halation radius reaches hundreds of pixels. These are recursive (IIR) filters instead: a
+ forward and a backward pass along each axis, a handful of multiply-adds per sample
+ whatever the radius.
+
+ - gaussianBlur: Young & van Vliet third-order recursion, with Triggs & Sdika initial
+   conditions on the trailing edge, so clamp-to-edge borders behave like CIImage
+   clampedToExtent rather than fading to black.
+ - exponentialBlur: symmetric first-order recursion, kernel exp(-|x| / radius), the same
+   falloff as exp_blur_linear in Halation.ci.metal.
+
+ The recursion state is kept in double. At large radii the Gaussian's feedback taps sum to
+ within ~1e-8 of one, which single precision cannot represent.
+
+ The vertical pass walks strips of whole rows, so each step reads and writes contiguous
+ memory and the lane loop vectorises. The horizontal pass recurses along the row with all
+ channels in step. Both passes split work across threads.
+ */
+
+// Radius is the Gaussian standard deviation in pixels, as CIGaussianBlur's inputRadius.
+// Radii below 0.5 leave the image unchanged.
+void gaussianBlur(const ImageView& image, float sigma);
+
+// Radius is the 1/e distance of the exponential falloff in pixels.
+void exponentialBlur(const ImageView& image, float radius);
+
+enum class BlurKind { Gaussian, Exponential };
+
+// Reference for tests: direct separable convolution (double precision, clamp-to-edge,
+// Gaussian truncated at 6σ, exponential at 12 radii). Cost grows with the radius.
+void directBlur(const ImageView& src, const ImageView& dst, BlurKind kind, float radius);
+
+// MARK: - Benchmark
+
+struct BlurBenchmark {
+	float radius = 0.0f;
+	double seconds = 0.0;
+	double megapixelsPerSecond = 0.0;
+	float maxError = 0.0f; // max |recursive - direct| on a test image with values in [0, 1]
+};
+
+// Times the recursive blur on a width × height RGBA frame, and checks it against directBlur
+// on a smaller frame.
+BlurBenchmark benchmarkBlur(BlurKind kind, float radius, int width, int height);
+
+} // namespace forge
@@ -0,0 +1,346 @@
+//
+//  SummedAreaTable.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "SummedAreaTable.hpp"
+#include "Parallel.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace forge {
+
+void SummedAreaTable::clear() {
+	width_ = height_ = channels_ = stride_ = 0;
+	hasMask_ = false;
+	table_.clear();
+	carry_.clear();
+}
+
+// Band-local sums; channel count and mask are template parameters so the per-pixel loops unroll.
+template <int C, bool Masked>
+void SummedAreaTable::buildBands(const ImageView& image, const ImageView* mask) {
+	constexpr int S = C + (Masked ? 1 + C : 0);
+	const size_t rowEntries = size_t(width_ + 1) * S;
+	const size_t bands = size_t((height_ + kBandRows - 1) / kBandRows);
+	const size_t inChannels = size_t(image.channels);
+	const size_t maskChannels = Masked ? size_t(mask->channels) : 0;
+
+	parallelFor(bands, [&](size_t band) {
+		const int y0 = int(band) * kBandRows;
+		const int y1 = std::min(height_, y0 + kBandRows);
+
+		for (int y = y0; y < y1; ++y) {
+			double* t = &table_[size_t(y) * rowEntries];
+			const double* above = y > y0 ? t - rowEntries : nullptr;
+			const float* px = image.row(y);
+			const float* m = Masked ? mask->row(y) : nullptr;
+			double run[S] = {};
+
+			std::fill(t, t + S, 0.0);
+			for (int x = 0; x < width_; ++x) {
+				const float* p = px + size_t(x) * inChannels;
+				for (int c = 0; c < C; ++c) run[c] += p[c];
+				if constexpr (Masked) {
+					const double mv = m[size_t(x) * maskChannels];
+					run[C] += mv;
+					for (int c = 0; c < C; ++c) run[C + 1 + c] += p[c] * mv;
+				}
+				double* e = t + size_t(x + 1) * S;
+				if (above) {
+					const double* a = above + size_t(x + 1) * S;
+					for (int k = 0; k < S; ++k) e[k] = a[k] + run[k];
+				} else {
+					for (int k = 0; k < S; ++k) e[k] = run[k];
+				}
+			}
+		}
+	});
+}
+
+void SummedAreaTable::build(const ImageView& image, int channels, const ImageView* mask) {
+	clear();
+	if (!image.valid()) return;
+
+	width_ = image.width;
+	height_ = image.height;
+	channels_ = std::min(channels <= 0 ? image.channels : std::min(channels, image.channels), 4);
+	hasMask_ = mask && mask->valid() && mask->width == image.width && mask->height == image.height;
+	stride_ = channels_ + (hasMask_ ? 1 + channels_ : 0);
+
+	const size_t rowEntries = size_t(width_ + 1) * size_t(stride_);
+	const size_t bands = size_t((height_ + kBandRows - 1) / kBandRows);
+	table_.resize(size_t(height_) * rowEntries);
+	carry_.assign(bands * rowEntries, 0.0);
+
+	switch (channels_ * 2 + (hasMask_ ? 1 : 0)) {
+		case 2: buildBands<1, false>(image, mask); break;
+		case 3: buildBands<1, true>(image, mask); break;
+		case 4: buildBands<2, false>(image, mask); break;
+		case 5: buildBands<2, true>(image, mask); break;
+		case 6: buildBands<3, false>(image, mask); break;
+		case 7: buildBands<3, true>(image, mask); break;
+		case 8: buildBands<4, false>(image, mask); break;
+		default: buildBands<4, true>(image, mask); break;
+	}
+
+	// Running total at the top of each band: the previous band's carry plus its last row.
+	for (size_t band = 1; band < bands; ++band) {
+		double* carry = &carry_[band * rowEntries];
+		const double* previous = &carry_[(band - 1) * rowEntries];
+		const double* last = &table_[size_t(band * kBandRows - 1) * rowEntries];
+		for (size_t i = 0; i < rowEntries; ++i) carry[i] = previous[i] + last[i];
+	}
+}
+
+void SummedAreaTable::addCorner(int x, int y, double weight, int first, int count, double* out) const {
+	if (y == 0 || x == 0) return;
+	const size_t rowEntries = size_t(width_ + 1) * size_t(stride_);
+	const size_t offset = size_t(x) * size_t(stride_) + size_t(first);
+	const double* t = &table_[size_t(y - 1) * rowEntries + offset];
+	const double* c = &carry_[size_t((y - 1) / kBandRows) * rowEntries + offset];
+	for (int k = 0; k < count; ++k) out[k] += weight * (t[k] + c[k]);
+}
+
+void SummedAreaTable::rectSum(int x0, int y0, int x1, int y1, double weight, int first, int count, double* out) const {
+	addCorner(x1, y1, weight, first, count, out);
+	addCorner(x0, y1, -weight, first, count, out);
+	addCorner(x1, y0, -weight, first, count, out);
+	addCorner(x0, y0, weight, first, count, out);
+}
+
+void SummedAreaTable::sum(const Rect& r, double* out) const {
+	std::fill(out, out + stride_, 0.0);
+	const Rect c = r.intersect({ 0, 0, width_, height_ });
+	if (c.empty()) return;
+	rectSum(c.x, c.y, c.right(), c.bottom(), 1.0, 0, stride_, out);
+}
+
+bool SummedAreaTable::mean(const Rect& r, float* out) const {
+	const Rect c = r.intersect({ 0, 0, width_, height_ });
+	if (c.empty()) return false;
+	double s[4] = { 0, 0, 0, 0 };
+	rectSum(c.x, c.y, c.right(), c.bottom(), 1.0, 0, channels_, s);
+	const double inv = 1.0 / double(c.area());
+	for (int k = 0; k < channels_; ++k) out[k] = float(s[k] * inv);
+	return true;
+}
+
+bool SummedAreaTable::maskedMean(const Rect& r, float* out) const {
+	const Rect c = r.intersect({ 0, 0, width_, height_ });
+	if (!hasMask_ || c.empty()) return false;
+	double s[5] = { 0, 0, 0, 0, 0 };
+	rectSum(c.x, c.y, c.right(), c.bottom(), 1.0, channels_, channels_ + 1, s);
+	if (s[0] < 1e-9) return false;
+	for (int k = 0; k < channels_; ++k) out[k] = float(s[k + 1] / s[0]);
+	return true;
+}
+
+float SummedAreaTable::maskCoverage(const Rect& r) const {
+	const Rect c = r.intersect({ 0, 0, width_, height_ });
+	if (!hasMask_ || c.empty()) return 0.0f;
+	double s = 0.0;
+	rectSum(c.x, c.y, c.right(), c.bottom(), 1.0, channels_, 1, &s);
+	return float(s / double(c.area()));
+}
+
+// Sum over [x0, x1) × [y0, y1) with out-of-range coordinates clamped to the edge pixels. Along
+// each axis the window splits into edge column/row repeats and an in-range run, so this is at
+// most nine rectangle sums.
+void SummedAreaTable::clampedSum(int x0, int y0, int x1, int y1, double* out) const {
+	struct Segment { int a, b; double weight; };
+	auto split = [](int lo, int hi, int size, Segment* segs) {
+		int n = 0;
+		const int before = std::clamp(-lo, 0, hi - lo);
+		const int after = std::clamp(hi - size, 0, hi - lo);
+		if (before > 0) segs[n++] = { 0, 1, double(before) };
+		if (std::max(lo, 0) < std::min(hi, size)) segs[n++] = { std::max(lo, 0), std::min(hi, size), 1.0 };
+		if (after > 0) segs[n++] = { size - 1, size, double(after) };
+		return n;
+	};
+	Segment xs[3], ys[3];
+	const int nx = split(x0, x1, width_, xs);
+	const int ny = split(y0, y1, height_, ys);
+	for (int j = 0; j < ny; ++j) {
+		for (int i = 0; i < nx; ++i) {
+			rectSum(xs[i].a, ys[j].a, xs[i].b, ys[j].b, xs[i].weight * ys[j].weight, 0, channels_, out);
+		}
+	}
+}
+
+void SummedAreaTable::boxBlur(const ImageView& dst, int radius) const {
+	if (empty() || !dst.valid() || dst.width != width_ || dst.height != height_ || dst.channels < channels_) return;
+	radius = std::max(0, radius);
+	const double norm = 1.0 / (double(2 * radius + 1) * double(2 * radius + 1));
+
+	parallelFor(size_t(height_), [&](size_t yy) {
+		const int y = int(yy);
+		const bool rowInside = y - radius >= 0 && y + radius + 1 <= height_;
+		float* out = dst.row(y);
+		for (int x = 0; x < width_; ++x) {
+			double s[4] = { 0, 0, 0, 0 };
+			const int x0 = x - radius, x1 = x + radius + 1;
+			if (rowInside && x0 >= 0 && x1 <= width_) {
+				rectSum(x0, y - radius, x1, y + radius + 1, 1.0, 0, channels_, s);
+			} else {
+				clampedSum(x0, y - radius, x1, y + radius + 1, s);
+			}
+			float* p = out + size_t(x) * size_t(dst.channels);
+			for (int k = 0; k < channels_; ++k) p[k] = float(s[k] * norm);
+		}
+	});
+}
+
+// MARK: - Benchmark
+
+// Clamp-to-edge (2r+1)² mean of the first three channels on row `y`, summed pixel by pixel.
+static void directBoxRow(const ImageView& v, int y, int radius, std::vector<double>& columns, double* out) {
+	columns.assign(size_t(v.width) * 3, 0.0);
+	for (int dy = -radius; dy <= radius; ++dy) {
+		const float* row = v.row(std::clamp(y + dy, 0, v.height - 1));
+		for (int x = 0; x < v.width; ++x) {
+			for (int k = 0; k < 3; ++k) columns[size_t(x) * 3 + k] += row[size_t(x) * size_t(v.channels) + k];
+		}
+	}
+	const double norm = 1.0 / (double(2 * radius + 1) * double(2 * radius + 1));
+	for (int x = 0; x < v.width; ++x) {
+		double s[3] = { 0, 0, 0 };
+		for (int dx = -radius; dx <= radius; ++dx) {
+			const double* c = &columns[size_t(std::clamp(x + dx, 0, v.width - 1)) * 3];
+			for (int k = 0; k < 3; ++k) s[k] += c[k];
+		}
+		for (int k = 0; k < 3; ++k) out[size_t(x) * 3 + k] = s[k] * norm;
+	}
+}
+
+SummedAreaTableBenchmark benchmarkSummedAreaTable(int width, int height) {
+	ImageBuffer image(width, height, 4);
+	ImageBuffer mask(width, height, 1);
+	const ImageView v = image.view();
+	const ImageView m = mask.view();
+	parallelFor(size_t(height), [&](size_t y) {
+		for (int x = 0; x < width; ++x) {
+			float* p = v.pixel(x, int(y));
+			p[0] = float(x) / float(width);
+			p[1] = float(y) / float(height);
+			p[2] = float((x * 7 + int(y) * 3) % 13) / 13.0f; // detail a drifting table would smear
+			p[3] = 1.0f;
+			m.row(int(y))[x] = (x / 64 + int(y) / 64) % 2 ? 1.0f : 0.25f;
+		}
+	});
+
+	SummedAreaTableBenchmark result;
+	SummedAreaTable table;
+	table.build(v, 3, &m); // first build pays for page faults on the table
+	auto start = std::chrono::steady_clock::now();
+	table.build(v, 3, &m);
+	result.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<int> rows;
+	for (int y = 0; y < height; y += 64) rows.push_back(y);
+	if (rows.back() != height - 1) rows.push_back(height - 1);
+	std::vector<double> rowError(rows.size(), 0.0);
+
+	ImageBuffer blurred(width, height, 3);
+	for (const int radius : { 1, 16 }) {
+		start = std::chrono::steady_clock::now();
+		table.boxBlur(blurred.view(), radius);
+		if (radius == 16) result.blurSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		parallelFor(rows.size(), [&](size_t i) {
+			std::vector<double> columns, direct(size_t(width) * 3);
+			directBoxRow(v, rows[i], radius, columns, direct.data());
+			const float* got = blurred.view().row(rows[i]);
+			for (int x = 0; x < width; ++x) {
+				for (int k = 0; k < 3; ++k) {
+					rowError[i] = std::max(rowError[i], std::fabs(double(got[size_t(x) * 3 + k]) - direct[size_t(x) * 3 + k]));
+				}
+			}
+		});
+	}
+	for (const double e : rowError) result.maxError = std::max(result.maxError, e);
+
+	// Whole frame, a bottom-right corner, a single pixel deep in the frame and a strip across it.
+	const Rect rects[] = {
+		{ 0, 0, width, height },
+		{ width - std::min(width, 300), height - std::min(height, 200), std::min(width, 300), std::min(height, 200) },
+		{ width - 1, height - 1, 1, 1 },
+		{ 0, height / 2, width, std::min(height, 3) },
+	};
+	for (const Rect& r : rects) {
+		double s[3] = { 0, 0, 0 }, ws[3] = { 0, 0, 0 }, wsum = 0.0;
+		for (int y = r.y; y < r.bottom(); ++y) {
+			for (int x = r.x; x < r.right(); ++x) {
+				const float* p = v.pixel(x, y);
+				const double w = m.row(y)[x];
+				for (int k = 0; k < 3; ++k) {
+					s[k] += p[k];
+					ws[k] += p[k] * w;
+				}
+				wsum += w;
+			}
+		}
+		float mean[3], masked[3];
+		if (!table.mean(r, mean) || !table.maskedMean(r, masked)) {
+			result.maxError = 1.0;
+			continue;
+		}
+		for (int k = 0; k < 3; ++k) {
+			result.maxError = std::max(result.maxError, std::fabs(double(mean[k]) - s[k] / double(r.area())));
+			result.maxError = std::max(result.maxError, std::fabs(double(masked[k]) - ws[k] / wsum));
+		}
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeSummedAreaTable {
+	forge::SummedAreaTable table;
+};
+
+extern "C" {
+	ForgeSummedAreaTable* ForgeSummedAreaTableCreate(const float* pixels, int32_t width, int32_t height, int32_t channels,
+													 size_t rowBytes, const float* mask, size_t maskRowBytes) {
+		if (!pixels || width <= 0 || height <= 0 || channels <= 0) return nullptr;
+		const forge::ImageView image{ const_cast<float*>(pixels), width, height, channels, rowBytes / sizeof(float) };
+		const forge::ImageView maskView{ const_cast<float*>(mask), width, height, 1, maskRowBytes / sizeof(float) };
+		auto* handle = new ForgeSummedAreaTable;
+		handle->table.build(image, std::min(channels, int32_t(3)), mask ? &maskView : nullptr);
+		return handle;
+	}
+
+	void ForgeSummedAreaTableRelease(ForgeSummedAreaTable* table) {
+		delete table;
+	}
+
+	bool ForgeSummedAreaTableMean(const ForgeSummedAreaTable* table, ForgeRect rect, float* rgb) {
+		return table && rgb && table->table.mean({ rect.x, rect.y, rect.width, rect.height }, rgb);
+	}
+
+	bool ForgeSummedAreaTableMaskedMean(const ForgeSummedAreaTable* table, ForgeRect rect, float* rgb) {
+		return table && rgb && table->table.maskedMean({ rect.x, rect.y, rect.width, rect.height }, rgb);
+	}
+
+	float ForgeSummedAreaTableMaskCoverage(const ForgeSummedAreaTable* table, ForgeRect rect) {
+		return table ? table->table.maskCoverage({ rect.x, rect.y, rect.width, rect.height }) : 0.0f;
+	}
+
+	void ForgeSummedAreaTableBoxBlur(const ForgeSummedAreaTable* table, float* dst, int32_t dstChannels, size_t dstRowBytes, int32_t radius) {
+		if (!table || !dst) return;
+		const forge::ImageView view{ dst, table->table.width(), table->table.height(), dstChannels, dstRowBytes / sizeof(float) };
+		table->table.boxBlur(view, radius);
+	}
+
+	ForgeSummedAreaTableBenchmark ForgeBenchmarkSummedAreaTable(int32_t width, int32_t height) {
+		const forge::SummedAreaTableBenchmark b = forge::benchmarkSummedAreaTable(width, height);
+		return { b.buildSeconds, b.blurSeconds, b.maxError };
+	}
+}
@@ -0,0 +1,95 @@
+//
+//  SummedAreaTable.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Integral images of the colour channels and, optionally, a mask and the mask-weighted colour,
+ so that any rectangle sum (and from it a mean, a masked mean or a box blur of any radius)
+ costs four lookups.
+
+ edgeAwareFilter needs the average source pixel (sp) and the average inside the mask (mp);
+ BoxBlurNode is a plain box. Each of these is a separate reduction or blur today; with a
+ table built once they are all O(1) per query.
+
+ Sums are kept in double: a float table loses whole units past 2^24, i.e. within the first
+ few thousand rows of a large frame. The frame is built in bands of rows in parallel, each
+ band starting from zero; one short sequential pass then records the running total at the top
+ of each band (the carry), which lookups add back. Building is therefore a single pass over
+ the pixels. Memory is 8 bytes per channel per pixel (RGB + mask: 56 bytes).
+ */
+
+class SummedAreaTable {
+public:
+	SummedAreaTable() = default;
+
+	// Tables for the first `channels` channels of `image` (0 = all of them, at most 4). When `mask` (one
+	// channel, same size) is given, also tables of the mask and of colour × mask.
+	void build(const ImageView& image, int channels = 0, const ImageView* mask = nullptr);
+	void clear();
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+	int channels() const { return channels_; }
+	bool hasMask() const { return hasMask_; }
+	bool empty() const { return width_ == 0; }
+
+	// Sums over `r` ∩ image. `out` receives channels() colour sums, then (with a mask) the mask
+	// sum and channels() weighted colour sums.
+	void sum(const Rect& r, double* out) const;
+
+	// Mean colour over `r` ∩ image. False if that is empty.
+	bool mean(const Rect& r, float* out) const;
+	// Mask-weighted mean colour Σ(c·m) / Σm over `r`. False without a mask or if Σm is ~0.
+	bool maskedMean(const Rect& r, float* out) const;
+	// Mean mask value over `r`.
+	float maskCoverage(const Rect& r) const;
+
+	// (2r+1)² box mean of the colour channels into `dst` (same size, channels() channels or
+	// more; extra channels are left alone), edges clamped as BoxBlurNode's clampedToExtent.
+	void boxBlur(const ImageView& dst, int radius) const;
+
+	size_t bytes() const { return (table_.size() + carry_.size()) * sizeof(double); }
+
+private:
+	static constexpr int kBandRows = 128;
+
+	template <int C, bool Masked>
+	void buildBands(const ImageView& image, const ImageView* mask);
+
+	// Table value at corner (x, y), 0 <= x <= width, 0 <= y <= height, accumulated into `out`
+	// with `weight`, for the channel range [first, first + count).
+	void addCorner(int x, int y, double weight, int first, int count, double* out) const;
+	void rectSum(int x0, int y0, int x1, int y1, double weight, int first, int count, double* out) const;
+	void clampedSum(int x0, int y0, int x1, int y1, double* out) const;
+
+	int width_ = 0;
+	int height_ = 0;
+	int channels_ = 0;
+	int stride_ = 0; // doubles per table entry
+	bool hasMask_ = false;
+	std::vector<double> table_; // height × (width + 1) × stride_, band-local
+	std::vector<double> carry_; // bands × (width + 1) × stride_, total above each band
+};
+
+struct SummedAreaTableBenchmark {
+	double buildSeconds = 0.0; // RGB + mask tables
+	double blurSeconds = 0.0;  // one radius-16 box blur read from them
+	// Against direct sums: box blurs at radius 1 and 16 on every 64th row and the last (where a
+	// float table would have drifted most), and plain and masked means of assorted rectangles.
+	double maxError = 0.0;
+};
+
+// Builds and checks tables for a synthetic width × height RGBA frame with a mask.
+SummedAreaTableBenchmark benchmarkSummedAreaTable(int width, int height);
+
+} // namespace forge
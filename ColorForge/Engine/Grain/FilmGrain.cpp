@@ -0,0 +1,304 @@
+//
+//  FilmGrain.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "FilmGrain.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace forge {
+
+// MARK: - Sampling
+
+namespace {
+
+constexpr int kMaxGrainsPerCell = 256;
+constexpr int kMaxTileCells = 1024; // cells across one tile's grid
+
+// Poisson draw by inversion with a single uniform; `p0` is exp(-lambda).
+inline int poisson(float lambda, float p0, float u) {
+	float p = p0;
+	float cdf = p;
+	int k = 0;
+	while (u > cdf && k < kMaxGrainsPerCell) {
+		++k;
+		p *= lambda / float(k);
+		cdf += p;
+	}
+	return k;
+}
+
+inline int floorDiv(float v, float delta) { return int(std::floor(v / delta)); }
+
+} // namespace
+
+// MARK: - Renderer
+
+FilmGrainRenderer::FilmGrainRenderer(const FilmGrainParams& params) : params_(params) {
+	params_.muR = std::max(params_.muR, 0.01f);
+	params_.sigmaR = std::max(params_.sigmaR, 0.0f);
+	params_.sigmaFilter = std::max(params_.sigmaFilter, 0.0f);
+	params_.samples = std::max(params_.samples, 1);
+	params_.zoom = params_.zoom > 0.0f ? params_.zoom : 1.0f;
+
+	const float mu = params_.muR, sigma = params_.sigmaR;
+	delta_ = 1.0f / std::ceil(1.0f / mu); // ag in applySamplerGrain
+
+	if (sigma > 0.0f) {
+		logStd_ = std::sqrt(std::log(1.0f + (sigma / mu) * (sigma / mu)));
+		logMean_ = std::log(mu) - 0.5f * logStd_ * logStd_;
+		maxRadius_ = std::exp(logMean_ + 3.0902f * logStd_); // 99.9th percentile; radii are clamped to it
+	} else {
+		maxRadius_ = mu;
+	}
+
+	// Grain density for an input value of i / 255 such that the expected coverage is that value
+	// (same table as applySamplerGrain).
+	const float area = 3.14159265f * (mu * mu + sigma * sigma);
+	for (int i = 0; i < 256; ++i) {
+		const float logTerm = std::max((255.0f - float(i)) / 255.1f, 1e-6f);
+		lambda_[i] = -(delta_ * delta_ / area) * std::log(logTerm);
+		emptyCell_[i] = std::exp(-lambda_[i]);
+	}
+
+	// The same N offsets for every pixel, drawn from their own stream so they follow the seed.
+	RandomStream offsets(CounterRandom(params_.seed), 0, 0, -1);
+	offsetX_.resize(size_t(params_.samples));
+	offsetY_.resize(size_t(params_.samples));
+	for (int k = 0; k < params_.samples; ++k) {
+		offsetX_[k] = params_.sigmaFilter * offsets.gaussian();
+		offsetY_[k] = params_.sigmaFilter * offsets.gaussian();
+	}
+	minOffsetX_ = *std::min_element(offsetX_.begin(), offsetX_.end());
+	maxOffsetX_ = *std::max_element(offsetX_.begin(), offsetX_.end());
+	minOffsetY_ = *std::min_element(offsetY_.begin(), offsetY_.end());
+	maxOffsetY_ = *std::max_element(offsetY_.begin(), offsetY_.end());
+}
+
+// Input-plane coordinate of an output pixel centre moved by `offset`. Every position, including
+// the tile bounds below, goes through here, so bounds and lookups round identically.
+float FilmGrainRenderer::inputCoord(int pixel, float offset) const {
+	return (float(pixel) + 0.5f + offset) / params_.zoom;
+}
+
+// Grains of every cell that a sample from output pixels [x0, x1) × [y0, y1) can reach.
+void FilmGrainRenderer::buildGrid(const ImageView& src, int channel, int x0, int y0, int x1, int y1, TileGrid& grid) const {
+	grid.cellX0 = floorDiv(inputCoord(x0, minOffsetX_) - maxRadius_, delta_);
+	grid.cellY0 = floorDiv(inputCoord(y0, minOffsetY_) - maxRadius_, delta_);
+	grid.cellsX = floorDiv(inputCoord(x1 - 1, maxOffsetX_) + maxRadius_, delta_) - grid.cellX0 + 1;
+	grid.cellsY = floorDiv(inputCoord(y1 - 1, maxOffsetY_) + maxRadius_, delta_) - grid.cellY0 + 1;
+	grid.cellStart.resize(size_t(grid.cellsX) * size_t(grid.cellsY) + 1);
+	grid.grains.clear();
+
+	// A cell's grains are the stream at (cell, channel), so they do not depend on which tile or
+	// thread generates them.
+	const CounterRandom cells(params_.seed);
+	const bool lognormal = logStd_ > 0.0f;
+	const float r2Fixed = params_.muR * params_.muR;
+	const float maxR2 = maxRadius_ * maxRadius_;
+	size_t index = 0;
+
+	for (int j = 0; j < grid.cellsY; ++j) {
+		const int cy = grid.cellY0 + j;
+		const int sy = std::clamp(int(std::floor((float(cy) + 0.5f) * delta_)), 0, src.height - 1);
+		const float* srcRow = src.row(sy);
+		for (int i = 0; i < grid.cellsX; ++i, ++index) {
+			const int cx = grid.cellX0 + i;
+			grid.cellStart[index] = uint32_t(grid.grains.size());
+
+			const int sx = std::clamp(int(std::floor((float(cx) + 0.5f) * delta_)), 0, src.width - 1);
+			const float u = srcRow[size_t(sx) * size_t(src.channels) + size_t(channel)];
+			const int level = u > 0.0f ? std::min(int(u * 255.0f), 255) : 0;
+
+			RandomStream random(cells, cx, cy, channel);
+			const int count = poisson(lambda_[level], emptyCell_[level], random.uniform());
+			for (int q = 0; q < count; ++q) {
+				Grain g;
+				g.x = (float(cx) + random.uniform()) * delta_;
+				g.y = (float(cy) + random.uniform()) * delta_;
+				if (lognormal) {
+					const float r = std::exp(logMean_ + logStd_ * random.gaussian());
+					g.r2 = std::min(r * r, maxR2);
+				} else {
+					g.r2 = r2Fixed;
+				}
+				grid.grains.push_back(g);
+			}
+		}
+	}
+	grid.cellStart[index] = uint32_t(grid.grains.size());
+}
+
+bool FilmGrainRenderer::covered(const TileGrid& grid, float x, float y) const {
+	// The cell range depends only on (x, y), never on the tile.
+	const int cx0 = std::max(floorDiv(x - maxRadius_, delta_) - grid.cellX0, 0);
+	const int cx1 = std::min(floorDiv(x + maxRadius_, delta_) - grid.cellX0, grid.cellsX - 1);
+	const int cy0 = std::max(floorDiv(y - maxRadius_, delta_) - grid.cellY0, 0);
+	const int cy1 = std::min(floorDiv(y + maxRadius_, delta_) - grid.cellY0, grid.cellsY - 1);
+
+	for (int j = cy0; j <= cy1; ++j) {
+		const uint32_t* start = &grid.cellStart[size_t(j) * size_t(grid.cellsX)];
+		const Grain* g = grid.grains.data() + start[cx0];
+		const Grain* end = grid.grains.data() + start[cx1 + 1];
+		for (; g < end; ++g) {
+			const float dx = x - g->x, dy = y - g->y;
+			if (dx * dx + dy * dy <= g->r2) return true;
+		}
+	}
+	return false;
+}
+
+void FilmGrainRenderer::renderTile(const ImageView& src, const ImageView& dst, const Rect& tile, TileGrid& grid) const {
+	const int colourOut = std::min(dst.channels, 3);
+	const int grainChannels = params_.monochrome ? 1 : std::min(colourOut, std::min(src.channels, 3));
+	const int samples = params_.samples;
+	const float invSamples = 1.0f / float(samples);
+
+	for (int c = 0; c < grainChannels; ++c) {
+		buildGrid(src, c, tile.x, tile.y, tile.right(), tile.bottom(), grid);
+		const bool fill = c == grainChannels - 1;
+
+		for (int y = tile.y; y < tile.bottom(); ++y) {
+			float* out = dst.row(y);
+			for (int x = tile.x; x < tile.right(); ++x) {
+				int hits = 0;
+				for (int k = 0; k < samples; ++k) {
+					hits += covered(grid, inputCoord(x, offsetX_[size_t(k)]), inputCoord(y, offsetY_[size_t(k)]));
+				}
+				float* p = out + size_t(x) * size_t(dst.channels);
+				p[c] = float(hits) * invSamples;
+				// Channels without their own grain take the last one rendered.
+				if (fill) {
+					for (int k = c + 1; k < colourOut; ++k) p[k] = p[c];
+				}
+			}
+		}
+	}
+
+	if (dst.channels > 3 && src.channels > 3) {
+		for (int y = tile.y; y < tile.bottom(); ++y) {
+			const int sy = std::clamp(int(std::floor(inputCoord(y, 0.0f))), 0, src.height - 1);
+			float* out = dst.row(y);
+			for (int x = tile.x; x < tile.right(); ++x) {
+				const int sx = std::clamp(int(std::floor(inputCoord(x, 0.0f))), 0, src.width - 1);
+				const float* s = src.pixel(sx, sy);
+				float* p = out + size_t(x) * size_t(dst.channels);
+				for (int k = 3; k < std::min(dst.channels, src.channels); ++k) p[k] = s[k];
+			}
+		}
+	}
+}
+
+void FilmGrainRenderer::render(const ImageView& src, const ImageView& dst, const Rect& region,
+							   int tileSize, unsigned maxThreads) const {
+	if (!src.valid() || !dst.valid()) return;
+	const Rect area = region.intersect(dst.bounds());
+	if (area.empty()) return;
+
+	// Small grains mean many cells per pixel; cap the grid each tile holds. Any tiling gives the
+	// same output, so this only bounds memory.
+	tileSize = std::clamp(tileSize, 1, std::max(8, int(float(kMaxTileCells) * delta_ * params_.zoom)));
+	const int across = (area.width + tileSize - 1) / tileSize;
+	const int down = (area.height + tileSize - 1) / tileSize;
+	const size_t tiles = size_t(across) * size_t(down);
+	const size_t threads = std::clamp<size_t>(maxThreads, 1, tiles);
+
+	// Tiles are dealt round-robin so neighbouring (similarly dense) tiles go to different threads.
+	parallelFor(threads, [&](size_t slot) {
+		TileGrid grid;
+		for (size_t t = slot; t < tiles; t += threads) {
+			const int tx = int(t % size_t(across)), ty = int(t / size_t(across));
+			Rect tile{ area.x + tx * tileSize, area.y + ty * tileSize, tileSize, tileSize };
+			renderTile(src, dst, tile.intersect(area), grid);
+		}
+	});
+}
+
+void FilmGrainRenderer::render(const ImageView& src, const ImageView& dst) const {
+	render(src, dst, dst.bounds());
+}
+
+// MARK: - Benchmark
+
+FilmGrainBenchmark benchmarkFilmGrain(const FilmGrainParams& params, int width, int height) {
+	ImageBuffer source(width, height, 4);
+	const ImageView src = source.view();
+	double inputSum = 0.0;
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			float* p = src.pixel(x, y);
+			p[0] = p[1] = p[2] = (float(x) + 0.5f) / float(width);
+			p[3] = 1.0f;
+			inputSum += p[0];
+		}
+	}
+
+	FilmGrainParams unzoomed = params;
+	unzoomed.zoom = 1.0f;
+	const FilmGrainRenderer renderer(unzoomed);
+	ImageBuffer first(width, height, 4), second(width, height, 4);
+
+	FilmGrainBenchmark result;
+	const auto start = std::chrono::steady_clock::now();
+	renderer.render(src, first.view());
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.megapixelsPerSecond = double(width) * double(height) / 1e6 / std::max(result.seconds, 1e-9);
+
+	renderer.render(src, second.view(), second.view().bounds(), 37, 1);
+	result.deterministic = true;
+	double outputSum = 0.0;
+	for (int y = 0; y < height; ++y) {
+		const float* a = first.view().row(y);
+		const float* b = second.view().row(y);
+		result.deterministic = result.deterministic && std::memcmp(a, b, size_t(width) * 4 * sizeof(float)) == 0;
+		for (int x = 0; x < width; ++x) outputSum += a[size_t(x) * 4];
+	}
+	result.meanError = float(std::abs(outputSum - inputSum) / (double(width) * double(height)));
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+namespace {
+
+forge::FilmGrainParams filmGrainParams(const ForgeFilmGrainParams& p) {
+	forge::FilmGrainParams params;
+	params.muR = p.muR;
+	params.sigmaR = p.sigmaR;
+	params.sigmaFilter = p.sigmaFilter;
+	params.samples = p.samples;
+	params.zoom = p.zoom;
+	params.seed = p.seed;
+	params.monochrome = p.monochrome;
+	return params;
+}
+
+} // namespace
+
+extern "C" {
+	void ForgeRenderFilmGrain(ForgeFilmGrainParams params,
+							  const float* src, int32_t srcWidth, int32_t srcHeight, int32_t srcChannels, size_t srcRowBytes,
+							  float* dst, int32_t dstWidth, int32_t dstHeight, int32_t dstChannels, size_t dstRowBytes,
+							  ForgeRect region) {
+		if (!src || !dst) return;
+		const forge::ImageView in{ const_cast<float*>(src), srcWidth, srcHeight, srcChannels, srcRowBytes / sizeof(float) };
+		const forge::ImageView out{ dst, dstWidth, dstHeight, dstChannels, dstRowBytes / sizeof(float) };
+		forge::FilmGrainRenderer(filmGrainParams(params)).render(in, out, { region.x, region.y, region.width, region.height });
+	}
+
+	ForgeFilmGrainBenchmark ForgeBenchmarkFilmGrain(ForgeFilmGrainParams params, int32_t width, int32_t height) {
+		const forge::FilmGrainBenchmark b = forge::benchmarkFilmGrain(filmGrainParams(params), width, height);
+		return { b.seconds, b.megapixelsPerSecond, b.deterministic, b.meanError };
+	}
+}
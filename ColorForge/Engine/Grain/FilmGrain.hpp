@@ -0,0 +1,102 @@
+//
+//  FilmGrain.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EngineImage.hpp"
+#include "Parallel.hpp"
+
+namespace forge {
+
+/*
+ Procedural film grain: the Boolean model of Newson et al., rendered on the CPU.
+
+ realisticFilmGrain (GrainV3.ci.metal) evaluates the same model per pixel, regenerating every
+ grain of every neighbouring cell for each of its N Monte Carlo offsets. Here the grains are
+ generated once per tile: the input plane is divided into cells of size delta, each cell
+ draws Poisson(lambda(u)) grains with uniform centres and log-normal radii (mu_r, sigma_r),
+ and the tile keeps them in a flat cell-indexed list. Each output pixel then tests its N
+ Gaussian-distributed offsets against the grains of the few cells within the maximum radius,
+ and the covered fraction is the pixel value (its expectation is the input value u).
+
+ Every random draw comes from a counter-based generator keyed by (seed, channel, cell, draw
+ index), and a cell's grains depend only on those and on the input value under the cell.
+ A pixel therefore depends only on its own coordinates and the parameters: tiles that share
+ cells generate identical copies of them, and the output is bit-identical whatever the tile
+ size, region or thread count.
+ */
+
+struct FilmGrainParams {
+	float muR = 0.1f;      // mean grain radius, input pixels
+	float sigmaR = 0.0f;   // grain radius standard deviation, input pixels
+	float sigmaFilter = 0.8f; // standard deviation of the Gaussian offsets, output pixels
+	int samples = 64;      // N Monte Carlo offsets per pixel
+	float zoom = 1.0f;     // output pixels per input pixel
+	uint32_t seed = 0;
+	bool monochrome = true; // grain from channel 0 written to every colour channel
+};
+
+class FilmGrainRenderer {
+public:
+	explicit FilmGrainRenderer(const FilmGrainParams& params);
+
+	const FilmGrainParams& params() const { return params_; }
+	float cellSize() const { return delta_; }
+	float maxRadius() const { return maxRadius_; }
+
+	// Renders `region` of `dst` from `src` (values in [0, 1]). Output pixel (x, y) samples input
+	// position ((x + 0.5 + offset) / zoom). Channels past the third are copied from the
+	// nearest source pixel. `tileSize` and `maxThreads` only change how the work is split.
+	void render(const ImageView& src, const ImageView& dst, const Rect& region,
+				int tileSize = 64, unsigned maxThreads = workerCount()) const;
+	void render(const ImageView& src, const ImageView& dst) const;
+
+private:
+	struct Grain { float x, y, r2; };
+
+	// Cells and grains of one tile: cells [cellX0, cellX0 + cellsX) × [cellY0, cellY0 + cellsY),
+	// grains of cell i at [cellStart[i], cellStart[i + 1]).
+	struct TileGrid {
+		int cellX0 = 0, cellY0 = 0, cellsX = 0, cellsY = 0;
+		std::vector<uint32_t> cellStart;
+		std::vector<Grain> grains;
+	};
+
+	float inputCoord(int pixel, float offset) const;
+	void buildGrid(const ImageView& src, int channel, int x0, int y0, int x1, int y1, TileGrid& grid) const;
+	bool covered(const TileGrid& grid, float x, float y) const;
+	void renderTile(const ImageView& src, const ImageView& dst, const Rect& tile, TileGrid& grid) const;
+
+	FilmGrainParams params_;
+	float delta_ = 1.0f;
+	float maxRadius_ = 0.0f;
+	float logMean_ = 0.0f;
+	float logStd_ = 0.0f;
+	float lambda_[256] = {};    // grains per cell for input level i / 255
+	float emptyCell_[256] = {}; // exp(-lambda): probability of a cell with no grain
+	std::vector<float> offsetX_;
+	std::vector<float> offsetY_;
+	float minOffsetX_ = 0.0f, maxOffsetX_ = 0.0f;
+	float minOffsetY_ = 0.0f, maxOffsetY_ = 0.0f;
+};
+
+// MARK: - Benchmark
+
+struct FilmGrainBenchmark {
+	double seconds = 0.0;
+	double megapixelsPerSecond = 0.0;
+	bool deterministic = false; // two renders with different tiles and thread counts match bit for bit
+	float meanError = 0.0f;     // |mean output - mean input| over a grey ramp
+};
+
+// Renders a width × height ramp, once timed with the default tiling and once single-threaded
+// with an odd tile size, and compares the two.
+FilmGrainBenchmark benchmarkFilmGrain(const FilmGrainParams& params, int width, int height);
+
+} // namespace forge
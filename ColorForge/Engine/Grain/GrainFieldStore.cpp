@@ -0,0 +1,484 @@
+//
+//  GrainFieldStore.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "GrainFieldStore.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+#include <vector>
+
+namespace forge {
+
+static constexpr char kMagic[4] = { 'C', 'F', 'G', 'F' };
+static constexpr uint32_t kVersion = 1;
+static constexpr const char* kExtension = ".cfgf";
+static constexpr size_t kDataOffset = 64;
+static constexpr int kBandRows = 64;
+
+struct GrainFieldHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t plates;
+	int32_t gate;
+	uint32_t width;
+	uint32_t height;
+	uint32_t seed;
+	uint32_t channels;
+	uint32_t reserved;
+	uint64_t dataOffset;
+};
+static_assert(sizeof(GrainFieldHeader) == 48, "GrainFieldHeader layout changed");
+
+std::string GrainFieldKey::fileName() const {
+	char name[80];
+	std::snprintf(name, sizeof(name), "%016llx-%d-%dx%d-%08x", (unsigned long long)plates, gate, width, height, seed);
+	return std::string(name) + kExtension;
+}
+
+// MARK: - Synthesis
+
+namespace {
+
+constexpr float kCellFraction = 0.5f * 0.95f; // cell spacing as a fraction of the plate's short side
+constexpr float kMaxAngle = 0.1f;             // radians, as tileAndRotateAsCGImage
+constexpr float kFeather = 0.15f;             // half-width of the cross-fade band, in cells
+
+struct Cell {
+	float cosA, sinA;
+	float offsetX, offsetY; // plate coordinates shown at the cell centre
+};
+
+struct FieldLayout {
+	float spacing = 1.0f;
+	int cellsX = 0; // cells -1 ..< cellsX - 1 along x, stored from index 0
+	std::vector<Cell> cells;
+	float mean[2] = { 0.0f, 0.0f };
+
+	const Cell& cell(int i, int j) const { return cells[size_t(j + 1) * size_t(cellsX) + size_t(i + 1)]; }
+};
+
+FieldLayout makeLayout(const GrainPlatePair& plates, uint32_t seed, int width, int height) {
+	FieldLayout layout;
+	layout.spacing = std::max(1.0f, kCellFraction * float(std::min(plates.width, plates.height)));
+	layout.cellsX = int(float(width) / layout.spacing) + 3;
+	const int cellsY = int(float(height) / layout.spacing) + 3;
+	layout.cells.resize(size_t(layout.cellsX) * size_t(cellsY));
+
+	const uint64_t base = hashCombine(0x43464746ull, seed);
+	for (int j = 0; j < cellsY; ++j) {
+		for (int i = 0; i < layout.cellsX; ++i) {
+			const uint64_t h = hashCombine(hashCombine(base, uint64_t(i)), uint64_t(j));
+			auto uniform = [h](uint64_t k) { return float(mix64(h + k) >> 40) * 0x1p-24f; };
+			const float angle = (2.0f * uniform(0) - 1.0f) * kMaxAngle;
+			Cell& c = layout.cells[size_t(j) * size_t(layout.cellsX) + size_t(i)];
+			c.cosA = std::cos(angle);
+			c.sinA = std::sin(angle);
+			c.offsetX = uniform(1) * float(plates.width);
+			c.offsetY = uniform(2) * float(plates.height);
+		}
+	}
+
+	double sums[2] = { 0.0, 0.0 };
+	for (int y = 0; y < plates.height; ++y) {
+		const float* lo = plates.low + size_t(y) * plates.rowStride;
+		const float* hi = plates.high + size_t(y) * plates.rowStride;
+		for (int x = 0; x < plates.width; ++x) {
+			sums[0] += lo[x];
+			sums[1] += hi[x];
+		}
+	}
+	const double n = double(plates.width) * double(plates.height);
+	layout.mean[0] = float(sums[0] / n);
+	layout.mean[1] = float(sums[1] / n);
+	return layout;
+}
+
+// Cells covering grid coordinate g and their weights: one cell away from borders, two within
+// kFeather of one, fading linearly across the band.
+inline int axisCells(float g, int* index, float* weight) {
+	const int i = int(std::floor(g));
+	const float t = g - float(i);
+	if (t < kFeather) {
+		const float w = 0.5f + t / (2.0f * kFeather);
+		index[0] = i - 1; weight[0] = 1.0f - w;
+		index[1] = i;     weight[1] = w;
+		return 2;
+	}
+	if (t > 1.0f - kFeather) {
+		const float w = (t - (1.0f - kFeather)) / (2.0f * kFeather);
+		index[0] = i;     weight[0] = 1.0f - w;
+		index[1] = i + 1; weight[1] = w;
+		return 2;
+	}
+	index[0] = i;
+	weight[0] = 1.0f;
+	return 1;
+}
+
+// Bilinear, wrapping at the plate edges.
+inline void samplePlates(const GrainPlatePair& p, float x, float y, float* out) {
+	const float w = float(p.width), h = float(p.height);
+	x -= std::floor(x / w) * w;
+	y -= std::floor(y / h) * h;
+	int x0 = std::min(int(x), p.width - 1), y0 = std::min(int(y), p.height - 1);
+	const float fx = x - float(x0), fy = y - float(y0);
+	const int x1 = x0 + 1 == p.width ? 0 : x0 + 1;
+	const int y1 = y0 + 1 == p.height ? 0 : y0 + 1;
+
+	const size_t r0 = size_t(y0) * p.rowStride, r1 = size_t(y1) * p.rowStride;
+	const float* planes[2] = { p.low, p.high };
+	for (int c = 0; c < 2; ++c) {
+		const float* s = planes[c];
+		const float top = s[r0 + size_t(x0)] + (s[r0 + size_t(x1)] - s[r0 + size_t(x0)]) * fx;
+		const float bottom = s[r1 + size_t(x0)] + (s[r1 + size_t(x1)] - s[r1 + size_t(x0)]) * fx;
+		out[c] = top + (bottom - top) * fy;
+	}
+}
+
+void synthesizeRow(const GrainPlatePair& plates, const FieldLayout& layout, int width, int y, float* dst) {
+	const float s = layout.spacing;
+	int yi[2], xi[2];
+	float yw[2], xw[2];
+	const float py = float(y) + 0.5f;
+	const int ny = axisCells(py / s, yi, yw);
+
+	for (int x = 0; x < width; ++x) {
+		const float px = float(x) + 0.5f;
+		const int nx = axisCells(px / s, xi, xw);
+
+		// Weighted sum of deviations from the plate mean, renormalised so overlapping cells keep
+		// the variance of a single one.
+		float acc[2] = { 0.0f, 0.0f };
+		float weights2 = 0.0f;
+		for (int b = 0; b < ny; ++b) {
+			for (int a = 0; a < nx; ++a) {
+				const float w = xw[a] * yw[b];
+				if (w <= 0.0f) continue;
+				const Cell& c = layout.cell(xi[a], yi[b]);
+				const float dx = px - (float(xi[a]) + 0.5f) * s;
+				const float dy = py - (float(yi[b]) + 0.5f) * s;
+				float v[2];
+				samplePlates(plates, c.offsetX + c.cosA * dx - c.sinA * dy, c.offsetY + c.sinA * dx + c.cosA * dy, v);
+				acc[0] += w * (v[0] - layout.mean[0]);
+				acc[1] += w * (v[1] - layout.mean[1]);
+				weights2 += w * w;
+			}
+		}
+		const float norm = 1.0f / std::sqrt(weights2);
+		dst[size_t(x) * 2] = layout.mean[0] + acc[0] * norm;
+		dst[size_t(x) * 2 + 1] = layout.mean[1] + acc[1] * norm;
+	}
+}
+
+} // namespace
+
+// MARK: - GrainField
+
+const half_t* GrainField::row(int y) const {
+	if (y < 0 || y >= height_) return nullptr;
+	return reinterpret_cast<const half_t*>(file_.data() + dataOffset_) + size_t(y) * size_t(width_) * kChannels;
+}
+
+bool GrainField::readRows(int y0, int rows, const ImageView& dst) const {
+	if (!dst.valid() || dst.channels < kChannels || dst.width < width_ || y0 < 0 || rows > dst.height || y0 + rows > height_) {
+		return false;
+	}
+	parallelFor(size_t(rows), [&](size_t r) {
+		const half_t* src = row(y0 + int(r));
+		float* out = dst.row(int(r));
+		if (dst.channels == kChannels) {
+			halfToFloat(src, out, size_t(width_) * kChannels);
+			return;
+		}
+		for (int x = 0; x < width_; ++x) {
+			out[size_t(x) * size_t(dst.channels)] = halfToFloat(src[size_t(x) * 2]);
+			out[size_t(x) * size_t(dst.channels) + 1] = halfToFloat(src[size_t(x) * 2 + 1]);
+		}
+	});
+	return true;
+}
+
+bool GrainField::readRegion(const Rect& region, int channel, half_t* dst, size_t dstStride) const {
+	const Rect r = region.intersect({ 0, 0, width_, height_ });
+	if (!dst || channel < 0 || channel >= kChannels || r.empty() || r.x != region.x || r.y != region.y) return false;
+	for (int y = 0; y < r.height; ++y) {
+		const half_t* src = row(r.y + y) + size_t(r.x) * kChannels + size_t(channel);
+		half_t* out = dst + size_t(y) * dstStride;
+		for (int x = 0; x < r.width; ++x) out[x] = src[size_t(x) * kChannels];
+	}
+	return true;
+}
+
+void GrainField::prefetchRows(int y0, int rows) const {
+	y0 = std::max(y0, 0);
+	rows = std::min(rows, height_ - y0);
+	if (rows <= 0) return;
+	const size_t rowBytes = size_t(width_) * kChannels * sizeof(half_t);
+	file_.prefetch(dataOffset_ + size_t(y0) * rowBytes, size_t(rows) * rowBytes);
+}
+
+// MARK: - GrainFieldStore
+
+GrainFieldStore::GrainFieldStore(std::string directory, uint64_t capacityBytes)
+	: directory_(std::move(directory), capacityBytes, kExtension) {}
+
+GrainFieldStore& GrainFieldStore::shared() {
+	static GrainFieldStore store("", 0);
+	return store;
+}
+
+void GrainFieldStore::configure(std::string directory, uint64_t capacityBytes) {
+	directory_.configure(std::move(directory), capacityBytes);
+	std::lock_guard<std::mutex> lock(mutex_);
+	open_.clear();
+}
+
+std::shared_ptr<const GrainField> GrainFieldStore::open(const GrainFieldKey& key) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = open_.find(key.fileName());
+		if (it != open_.end()) {
+			if (auto field = it->second.lock()) return field;
+			open_.erase(it);
+		}
+	}
+	if (!directory_.touch(key.fileName())) return nullptr;
+	return map(key);
+}
+
+std::shared_ptr<const GrainField> GrainFieldStore::map(const GrainFieldKey& key) {
+	auto field = std::make_shared<GrainField>();
+	GrainFieldHeader header{};
+	bool ok = field->file_.open(directory_.path(key.fileName())) && field->file_.size() >= kDataOffset;
+	if (ok) {
+		std::memcpy(&header, field->file_.data(), sizeof(header));
+		const uint64_t bytes = uint64_t(header.width) * header.height * GrainField::kChannels * sizeof(half_t);
+		ok = std::memcmp(header.magic, kMagic, 4) == 0 && header.version == kVersion && header.plates == key.plates &&
+			 header.gate == key.gate && int32_t(header.width) == key.width && int32_t(header.height) == key.height &&
+			 header.seed == key.seed && header.channels == uint32_t(GrainField::kChannels) &&
+			 header.dataOffset + bytes <= field->file_.size();
+	}
+	if (!ok) {
+		directory_.remove(key.fileName());
+		return nullptr;
+	}
+
+	field->width_ = int(header.width);
+	field->height_ = int(header.height);
+	field->dataOffset_ = size_t(header.dataOffset);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	open_[key.fileName()] = field;
+	return field;
+}
+
+std::shared_ptr<const GrainField> GrainFieldStore::build(const GrainFieldKey& key, const GrainPlatePair& plates) {
+	if (!plates.valid() || key.width <= 0 || key.height <= 0) return nullptr;
+	const std::string path = directory_.path(key.fileName());
+	if (path.empty()) return nullptr;
+
+	const int width = key.width, height = key.height;
+	const FieldLayout layout = makeLayout(plates, key.seed, width, height);
+	const size_t rowValues = size_t(width) * GrainField::kChannels;
+
+	AtomicFileWriter writer(path);
+	const uint8_t padding[kDataOffset] = {};
+	if (!writer.write(padding, kDataOffset)) return nullptr; // header rewritten on completion
+
+	// One band at a time: synthesise rows in parallel, convert, append. Peak memory is one band.
+	std::vector<float> band(size_t(kBandRows) * rowValues);
+	std::vector<half_t> packed(band.size());
+	for (int y0 = 0; y0 < height; y0 += kBandRows) {
+		const int rows = std::min(kBandRows, height - y0);
+		parallelFor(size_t(rows), [&](size_t r) {
+			float* row = &band[r * rowValues];
+			synthesizeRow(plates, layout, width, y0 + int(r), row);
+			floatToHalf(row, &packed[r * rowValues], rowValues);
+		});
+		if (!writer.write(packed.data(), size_t(rows) * rowValues * sizeof(half_t))) return nullptr;
+	}
+
+	GrainFieldHeader header{};
+	std::memcpy(header.magic, kMagic, 4);
+	header.version = kVersion;
+	header.plates = key.plates;
+	header.gate = key.gate;
+	header.width = uint32_t(width);
+	header.height = uint32_t(height);
+	header.seed = key.seed;
+	header.channels = GrainField::kChannels;
+	header.dataOffset = kDataOffset;
+	if (!writer.writeAt(0, &header, sizeof(header))) return nullptr;
+	const uint64_t bytes = writer.offset();
+	if (!writer.commit()) return nullptr;
+
+	{
+		// A mapping of a previous build of this key stays valid (the old inode lives on), but new
+		// callers should get the new file.
+		std::lock_guard<std::mutex> lock(mutex_);
+		open_.erase(key.fileName());
+	}
+	directory_.added(key.fileName(), bytes);
+	return map(key);
+}
+
+void GrainFieldStore::removeAll() {
+	directory_.removeAll();
+	std::lock_guard<std::mutex> lock(mutex_);
+	open_.clear();
+}
+
+// MARK: - Benchmark
+
+GrainFieldBenchmark benchmarkGrainFieldStore(int width, int height) {
+	namespace fs = std::filesystem;
+	using Clock = std::chrono::steady_clock;
+	width = std::max(1, width);
+	height = std::max(1, height);
+
+	std::error_code ec;
+	const fs::path directory = fs::temp_directory_path(ec) / ("ColorForgeGrainFieldCheck-" + std::to_string(getpid()));
+	fs::remove_all(directory, ec);
+
+	// Plates the size of a scaled 35mm pair: hashed noise, the highlight plate finer than the shadow one.
+	constexpr int kPlate = 384;
+	std::vector<float> low(size_t(kPlate) * kPlate), high(low.size());
+	for (int y = 0; y < kPlate; ++y) {
+		for (int x = 0; x < kPlate; ++x) {
+			const uint64_t h = hashCombine(uint64_t(x), uint64_t(y));
+			low[size_t(y) * kPlate + size_t(x)] = float(h & 0xFFFF) / 65535.0f;
+			high[size_t(y) * kPlate + size_t(x)] = 0.5f + 0.25f * float((h >> 16) & 0xFFFF) / 65535.0f;
+		}
+	}
+	const GrainPlatePair plates{ low.data(), high.data(), kPlate, kPlate, size_t(kPlate) };
+	const GrainFieldKey key{ 0xC0FFEE, 36, width, height, 7 };
+	const uint64_t capacity = uint64_t(1) << 40;
+
+	GrainFieldBenchmark result;
+	std::vector<half_t> first;
+	{
+		GrainFieldStore store(directory.string(), capacity);
+		auto start = Clock::now();
+		auto field = store.build(key, plates);
+		result.buildSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+		if (field) {
+			const size_t rowValues = size_t(width) * GrainField::kChannels;
+			first.assign(field->row(0), field->row(0) + rowValues * size_t(height));
+		}
+	}
+
+	if (!first.empty()) {
+		// A second store knows nothing of the first build until it scans the directory.
+		GrainFieldStore store(directory.string(), capacity);
+		auto start = Clock::now();
+		auto field = store.open(key);
+		result.openSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		const FieldLayout layout = makeLayout(plates, key.seed, width, height);
+		const size_t rowValues = size_t(width) * GrainField::kChannels;
+		std::atomic<bool> same{ field && field->width() == width && field->height() == height };
+		if (same) {
+			parallelFor(size_t(height), [&](size_t y) {
+				std::vector<float> row(rowValues);
+				std::vector<half_t> packed(rowValues);
+				synthesizeRow(plates, layout, width, int(y), row.data());
+				floatToHalf(row.data(), packed.data(), rowValues);
+				if (std::memcmp(packed.data(), field->row(int(y)), rowValues * sizeof(half_t)) != 0) same = false;
+			});
+		}
+		result.reopened = same;
+		field.reset();
+
+		auto again = store.build(key, plates);
+		result.rebuilt = again && std::memcmp(again->row(0), first.data(), first.size() * sizeof(half_t)) == 0;
+		again.reset();
+
+		GrainFieldKey other = key;
+		other.seed = key.seed + 1;
+		const fs::path path = directory / key.fileName();
+		const uint64_t size = fs::file_size(path, ec);
+		fs::resize_file(path, size / 2, ec);
+		GrainFieldStore fresh(directory.string(), capacity);
+		result.corruption = !ec && !fresh.open(other) && !fresh.open(key) && !fs::exists(path);
+	}
+
+	fs::remove_all(directory, ec);
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeGrainField {
+	std::shared_ptr<const forge::GrainField> field;
+};
+
+namespace {
+
+forge::GrainFieldKey grainFieldKey(const ForgeGrainFieldKey& k) {
+	return { k.plates, k.gate, k.width, k.height, k.seed };
+}
+
+} // namespace
+
+extern "C" {
+	void ForgeGrainFieldStoreConfigure(const char* directory, uint64_t capacityBytes) {
+		forge::GrainFieldStore::shared().configure(directory ? directory : "", capacityBytes);
+	}
+
+	ForgeGrainField* ForgeGrainFieldOpen(ForgeGrainFieldKey key) {
+		auto field = forge::GrainFieldStore::shared().open(grainFieldKey(key));
+		return field ? new ForgeGrainField{ std::move(field) } : nullptr;
+	}
+
+	ForgeGrainField* ForgeGrainFieldBuild(ForgeGrainFieldKey key, const float* low, const float* high,
+										  int32_t plateWidth, int32_t plateHeight, size_t rowBytes) {
+		const forge::GrainPlatePair plates{ low, high, plateWidth, plateHeight, rowBytes / sizeof(float) };
+		auto field = forge::GrainFieldStore::shared().build(grainFieldKey(key), plates);
+		return field ? new ForgeGrainField{ std::move(field) } : nullptr;
+	}
+
+	void ForgeGrainFieldRelease(ForgeGrainField* field) {
+		delete field;
+	}
+
+	bool ForgeGrainFieldReadRegion(const ForgeGrainField* field, int32_t channel, ForgeRect region, uint16_t* dst, size_t rowBytes) {
+		if (!field || !dst) return false;
+		return field->field->readRegion({ region.x, region.y, region.width, region.height }, channel,
+										reinterpret_cast<forge::half_t*>(dst), rowBytes / sizeof(uint16_t));
+	}
+
+	bool ForgeGrainFieldReadRows(const ForgeGrainField* field, int32_t y0, int32_t rows, float* dst, size_t rowBytes) {
+		if (!field || !dst) return false;
+		const forge::ImageView view{ dst, field->field->width(), rows, forge::GrainField::kChannels, rowBytes / sizeof(float) };
+		return field->field->readRows(y0, rows, view);
+	}
+
+	void ForgeGrainFieldPrefetchRows(const ForgeGrainField* field, int32_t y0, int32_t rows) {
+		if (field) field->field->prefetchRows(y0, rows);
+	}
+
+	void ForgeGrainFieldStoreRemoveAll(void) {
+		forge::GrainFieldStore::shared().removeAll();
+	}
+
+	ForgeGrainFieldBenchmark ForgeBenchmarkGrainFieldStore(int32_t width, int32_t height) {
+		const forge::GrainFieldBenchmark b = forge::benchmarkGrainFieldStore(width, height);
+		return { b.buildSeconds, b.openSeconds, b.reopened, b.rebuilt, b.corruption };
+	}
+}
@@ -0,0 +1,127 @@
+//
+//  GrainFieldStore.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "CacheDirectory.hpp"
+#include "EngineImage.hpp"
+#include "FileIO.hpp"
+#include "Half.hpp"
+
+namespace forge {
+
+/*
+ Prebuilt full-frame grain fields, one per (plates, gate, output size, seed).
+
+ An export currently scales the gate's shadow/highlight plates (scaleFor36mm and friends),
+ then tiles them with random rotations and offsets into a frame-sized CGImage
+ (tileAndRotateAsCGImage), twice per export and while RealisticFilmGrainNode waits on a
+ semaphore. Nothing of that depends on the picture, only on the gate and the output size.
+
+ The store builds that field once: a grid of cells half a plate wide, each showing the plate
+ rotated by up to ±0.1 rad and offset by a random amount (all drawn from a hash of the seed
+ and the cell, so a rebuild is identical). Neighbouring cells cross-fade over a narrow band
+ with variance-preserving weights, so the grain keeps its contrast across seams instead of
+ softening there. The field is written band by band as uncompressed fp16 (shadow, highlight)
+ pairs and opened with mmap: a render reads, and pages in, only the rows of its current band.
+ A repeat export at the same size opens the file and does no grain preparation at all.
+
+ File layout (little-endian):
+   GrainFieldHeader   48 bytes, padded to 64
+   rows               height × width × 2 halfs (shadow, highlight)
+ */
+
+struct GrainFieldKey {
+	uint64_t plates = 0; // identity of the plate pair and its scale, e.g. a hash of asset name and version
+	int32_t gate = 0;    // gate choice, as RealisticFilmGrainNode.gateWidth
+	int32_t width = 0;
+	int32_t height = 0;
+	uint32_t seed = 0;
+
+	std::string fileName() const;
+};
+
+// Shadow and highlight plates, one float channel each, already at output scale.
+struct GrainPlatePair {
+	const float* low = nullptr;
+	const float* high = nullptr;
+	int width = 0;
+	int height = 0;
+	size_t rowStride = 0; // floats
+
+	bool valid() const { return low && high && width > 1 && height > 1 && rowStride >= size_t(width); }
+};
+
+// Read-only mapped field.
+class GrainField {
+public:
+	static constexpr int kChannels = 2; // shadow, highlight
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+
+	// Row y, width × kChannels halfs, straight from the mapping.
+	const half_t* row(int y) const;
+
+	// Rows [y0, y0 + rows) as float into `dst` (dst.channels >= 2; extra channels untouched).
+	bool readRows(int y0, int rows, const ImageView& dst) const;
+	// `region` of one channel (0 shadow, 1 highlight) as packed halfs, `dstStride` halfs per row.
+	bool readRegion(const Rect& region, int channel, half_t* dst, size_t dstStride) const;
+	// Starts paging in rows [y0, y0 + rows), e.g. the band after the one being rendered.
+	void prefetchRows(int y0, int rows) const;
+
+private:
+	friend class GrainFieldStore;
+
+	MappedFile file_;
+	int width_ = 0;
+	int height_ = 0;
+	size_t dataOffset_ = 0;
+};
+
+class GrainFieldStore {
+public:
+	GrainFieldStore(std::string directory, uint64_t capacityBytes);
+
+	// Process-wide instance. Disabled (open misses, build fails) until configure() is called.
+	static GrainFieldStore& shared();
+	void configure(std::string directory, uint64_t capacityBytes);
+
+	// The stored field for `key`, or null. Callers asking for the same key share one mapping.
+	std::shared_ptr<const GrainField> open(const GrainFieldKey& key);
+	// Builds, stores and opens the field for `key` from `plates`.
+	std::shared_ptr<const GrainField> build(const GrainFieldKey& key, const GrainPlatePair& plates);
+
+	void removeAll();
+	uint64_t totalBytes() { return directory_.totalBytes(); }
+
+private:
+	std::shared_ptr<const GrainField> map(const GrainFieldKey& key);
+
+	CacheDirectory directory_;
+	std::mutex mutex_;
+	std::unordered_map<std::string, std::weak_ptr<const GrainField>> open_;
+};
+
+struct GrainFieldBenchmark {
+	double buildSeconds = 0.0;
+	double openSeconds = 0.0;  // reopening from a fresh store, as after a relaunch
+	bool reopened = false;     // every reopened row matches the rows synthesised directly, bit for bit
+	bool rebuilt = false;      // a second build of the key writes the same field
+	bool corruption = false;   // another seed misses; a truncated field misses and is deleted
+};
+
+// Builds a `width` × `height` field from synthetic plates in a scratch directory, then reopens
+// it from a second store over the same directory.
+GrainFieldBenchmark benchmarkGrainFieldStore(int width, int height);
+
+} // namespace forge
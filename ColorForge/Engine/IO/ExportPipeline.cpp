@@ -0,0 +1,461 @@
+//
+//  ExportPipeline.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "ExportPipeline.hpp"
+#include "FileIO.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace forge {
+
+using Clock = std::chrono::steady_clock;
+
+void convertExportRows(const float* pixels, size_t pixelRowFloats, int width, int rows, int channels,
+					   int bitsPerSample, uint8_t* samples) {
+	const size_t rowSamples = size_t(width) * size_t(channels);
+	parallelFor(size_t(rows), [&](size_t y) {
+		const float* in = pixels + y * pixelRowFloats;
+		if (bitsPerSample == 16) {
+			auto* out = reinterpret_cast<uint16_t*>(samples) + y * rowSamples;
+			for (int x = 0; x < width; ++x) {
+				for (int c = 0; c < channels; ++c) {
+					const float v = std::clamp(in[size_t(x) * 4 + size_t(c)], 0.0f, 1.0f);
+					out[size_t(x) * size_t(channels) + size_t(c)] = uint16_t(v * 65535.0f + 0.5f);
+				}
+			}
+		} else {
+			uint8_t* out = samples + y * rowSamples;
+			for (int x = 0; x < width; ++x) {
+				for (int c = 0; c < channels; ++c) {
+					const float v = std::clamp(in[size_t(x) * 4 + size_t(c)], 0.0f, 1.0f);
+					out[size_t(x) * size_t(channels) + size_t(c)] = uint8_t(v * 255.0f + 0.5f);
+				}
+			}
+		}
+	});
+}
+
+// MARK: - Pipeline
+
+ExportPipeline::ExportPipeline(int depth)
+	: free_(size_t(std::max(depth, 1)) * 3), converting_(size_t(std::max(depth, 1))),
+	  encoding_(size_t(std::max(depth, 1))), writing_(size_t(std::max(depth, 1))) {
+	for (int i = 0; i < std::max(depth, 1) * 3; ++i) {
+		pool_.push_back(std::make_unique<ExportBand>());
+		free_.push(pool_.back().get());
+	}
+	convertThread_ = std::thread([this] { convertLoop(); });
+	encodeThread_ = std::thread([this] { encodeLoop(); });
+	writeThread_ = std::thread([this] { writeLoop(); });
+}
+
+ExportPipeline::~ExportPipeline() {
+	// Bands already submitted still go through; each stage closes the next once it has drained.
+	converting_.close();
+	convertThread_.join();
+	encodeThread_.join();
+	writeThread_.join();
+	free_.close();
+}
+
+int ExportPipeline::begin(const std::string& path, const TiffInfo& info) {
+	auto writer = std::make_unique<TiffWriter>(path, info);
+	if (!writer->valid()) return -1;
+	auto job = std::make_unique<Job>();
+	job->info = info;
+	job->bandRows = TiffWriter::bandRowsFor(info);
+	job->writer = std::move(writer);
+
+	std::lock_guard<std::mutex> lock(jobsMutex_);
+	if (!started_) {
+		start_ = Clock::now();
+		started_ = true;
+	}
+	const int id = nextJob_++;
+	jobs_[id] = std::move(job);
+	return id;
+}
+
+ExportPipeline::Job* ExportPipeline::job(int id) const {
+	std::lock_guard<std::mutex> lock(jobsMutex_);
+	const auto it = jobs_.find(id);
+	return it == jobs_.end() ? nullptr : it->second.get();
+}
+
+void ExportPipeline::addTag(int id, TiffDirectory directory, TiffTag tag) {
+	if (Job* j = job(id)) j->writer->addTag(directory, std::move(tag));
+}
+
+void ExportPipeline::setIccProfile(int id, std::vector<uint8_t> profile) {
+	if (Job* j = job(id)) j->writer->setIccProfile(std::move(profile));
+}
+
+void ExportPipeline::setIptc(int id, std::vector<uint8_t> records) {
+	if (Job* j = job(id)) j->writer->setIptc(std::move(records));
+}
+
+int ExportPipeline::width(int id) const {
+	const Job* j = job(id);
+	return j ? j->info.width : 0;
+}
+
+int ExportPipeline::bandRows(int id) const {
+	const Job* j = job(id);
+	return j ? j->bandRows : 0;
+}
+
+ExportBand* ExportPipeline::acquire(int id) {
+	Job* j = job(id);
+	ExportBand* band = nullptr;
+	if (!j || !free_.pop(band)) return nullptr;
+	band->job = id;
+	band->width = j->info.width;
+	band->rows = 0;
+	band->last = false;
+	band->pixels.resize(size_t(j->bandRows) * size_t(j->info.width) * 4);
+	band->acquired = Clock::now();
+	return band;
+}
+
+void ExportPipeline::submit(ExportBand* band, int rows) {
+	if (!band) return;
+	addBusy(renderNs_, band->acquired);
+	const Job* j = job(band->job);
+	band->rows = j ? std::min(rows, j->bandRows) : 0;
+	if (band->rows <= 0) {
+		band->job = -1;
+		free_.push(band);
+		return;
+	}
+	converting_.push(band);
+}
+
+void ExportPipeline::end(int id) {
+	ExportBand* band = acquire(id);
+	if (!band) return;
+	band->last = true;
+	band->pixels.clear();
+	converting_.push(band);
+}
+
+bool ExportPipeline::wait(int id) {
+	std::unique_lock<std::mutex> lock(jobsMutex_);
+	const auto it = jobs_.find(id);
+	if (it == jobs_.end()) return false;
+	jobDone_.wait(lock, [&] { return it->second->done; });
+	const bool ok = !it->second->failed;
+	jobs_.erase(it);
+	return ok;
+}
+
+bool ExportPipeline::drain() {
+	std::unique_lock<std::mutex> lock(jobsMutex_);
+	jobDone_.wait(lock, [&] {
+		return std::all_of(jobs_.begin(), jobs_.end(), [](const auto& j) { return j.second->done; });
+	});
+	return std::none_of(jobs_.begin(), jobs_.end(), [](const auto& j) { return bool(j.second->failed); });
+}
+
+ExportPipelineStats ExportPipeline::stats() const {
+	ExportPipelineStats s;
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex_);
+		if (!started_) return s;
+		s.seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+		s.images = images_;
+		s.failed = failed_;
+	}
+	auto stage = [&](const std::atomic<int64_t>& ns) {
+		ExportStageStats t;
+		t.busySeconds = double(ns.load()) * 1e-9;
+		t.utilisation = s.seconds > 0.0 ? t.busySeconds / s.seconds : 0.0;
+		return t;
+	};
+	s.render = stage(renderNs_);
+	s.convert = stage(convertNs_);
+	s.encode = stage(encodeNs_);
+	s.write = stage(writeNs_);
+	s.bands = bands_.load();
+	s.bytesWritten = bytes_.load();
+	return s;
+}
+
+void ExportPipeline::addBusy(std::atomic<int64_t>& stage, Clock::time_point since) {
+	stage += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+// MARK: - Stages
+
+void ExportPipeline::convertLoop() {
+	ExportBand* band = nullptr;
+	while (converting_.pop(band)) {
+		const auto t0 = Clock::now();
+		const Job* j = job(band->job);
+		if (!band->last && j && !j->failed) {
+			const TiffInfo& info = j->info;
+			band->samples.resize(size_t(band->rows) * size_t(info.width) * size_t(info.channels) * size_t(info.bitsPerSample / 8));
+			convertExportRows(band->pixels.data(), size_t(info.width) * 4, info.width, band->rows, info.channels,
+							  info.bitsPerSample, band->samples.data());
+		}
+		addBusy(convertNs_, t0);
+		encoding_.push(band);
+	}
+	encoding_.close();
+}
+
+void ExportPipeline::encodeLoop() {
+	ExportBand* band = nullptr;
+	while (encoding_.pop(band)) {
+		const auto t0 = Clock::now();
+		const Job* j = job(band->job);
+		band->blockCount = 0;
+		if (!band->last && j && !j->failed) {
+			band->blockCount = TiffWriter::encodeBand(j->info, band->samples.data(), band->rows, band->blocks);
+		}
+		addBusy(encodeNs_, t0);
+		writing_.push(band);
+	}
+	writing_.close();
+}
+
+void ExportPipeline::writeLoop() {
+	ExportBand* band = nullptr;
+	while (writing_.pop(band)) {
+		const auto t0 = Clock::now();
+		if (Job* j = job(band->job)) {
+			if (band->last) {
+				finishJob(*j, !j->failed && j->writer->finish());
+			} else if (!j->failed) {
+				if (j->writer->appendBlocks(band->blocks, band->blockCount, band->rows)) {
+					for (size_t b = 0; b < band->blockCount; ++b) bytes_ += band->blocks[b].size();
+				} else {
+					j->failed = true;
+				}
+			}
+		}
+		addBusy(writeNs_, t0);
+		++bands_;
+		band->job = -1;
+		free_.push(band);
+	}
+}
+
+void ExportPipeline::finishJob(Job& job, bool ok) {
+	job.writer.reset();   // closes, and removes the temporary of a failed file
+	std::lock_guard<std::mutex> lock(jobsMutex_);
+	job.failed = job.failed || !ok;
+	job.done = true;
+	++images_;
+	if (job.failed) ++failed_;
+	jobDone_.notify_all();
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+// Stands in for a Core Image render: a smooth frame, different per image.
+void renderSynthetic(float* pixels, int width, int y0, int rows, int height, int image) {
+	for (int r = 0; r < rows; ++r) {
+		const float fy = float(y0 + r) / float(height);
+		for (int x = 0; x < width; ++x) {
+			const float fx = float(x) / float(width);
+			float* p = pixels + (size_t(r) * size_t(width) + size_t(x)) * 4;
+			p[0] = 0.5f + 0.5f * std::sin(6.0f * fx + float(image));
+			p[1] = fy;
+			p[2] = 0.5f + 0.4f * std::cos(9.0f * (fx + fy));
+			p[3] = 1.0f;
+		}
+	}
+}
+
+} // namespace
+
+ExportPipelineBenchmark benchmarkExportPipeline(int width, int height, int images, const std::string& directory) {
+	ExportPipelineBenchmark result;
+	if (width <= 0 || height <= 0 || images <= 0) return result;
+	result.images = images;
+	result.megabytes = double(width) * double(height) * 6.0 * double(images) / 1048576.0;
+
+	TiffInfo info;
+	info.width = width;
+	info.height = height;
+	auto path = [&](const char* run, int i) { return directory + "/forge_export_" + run + "_" + std::to_string(i) + ".tif"; };
+
+	// Every stage of every band in turn, as saveImage used to.
+	auto t0 = Clock::now();
+	bool ok = true;
+	{
+		const int bandRows = TiffWriter::bandRowsFor(info);
+		std::vector<float> pixels(size_t(bandRows) * size_t(width) * 4);
+		std::vector<uint8_t> samples(size_t(bandRows) * size_t(width) * 6);
+		std::vector<std::vector<uint8_t>> blocks;
+		for (int i = 0; i < images; ++i) {
+			TiffWriter writer(path("serial", i), info);
+			for (int y = 0; y < height; y += bandRows) {
+				const int rows = std::min(bandRows, height - y);
+				renderSynthetic(pixels.data(), width, y, rows, height, i);
+				convertExportRows(pixels.data(), size_t(width) * 4, width, rows, 3, 16, samples.data());
+				const size_t count = TiffWriter::encodeBand(info, samples.data(), rows, blocks);
+				ok = writer.appendBlocks(blocks, count, rows) && ok;
+			}
+			ok = writer.finish() && ok;
+		}
+	}
+	result.serialSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+	t0 = Clock::now();
+	{
+		ExportPipeline pipeline;
+		for (int i = 0; i < images; ++i) {
+			const int job = pipeline.begin(path("pipelined", i), info);
+			const int bandRows = pipeline.bandRows(job);
+			for (int y = 0; y < height; y += bandRows) {
+				ExportBand* band = pipeline.acquire(job);
+				if (!band) break;
+				const int rows = std::min(bandRows, height - y);
+				renderSynthetic(band->pixels.data(), width, y, rows, height, i);
+				pipeline.submit(band, rows);
+			}
+			pipeline.end(job);
+		}
+		ok = pipeline.drain() && ok;
+		result.pipelinedSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+		result.stats = pipeline.stats();
+	}
+
+	for (int i = 0; i < images; ++i) {
+		const MappedFile serial(path("serial", i)), pipelined(path("pipelined", i));
+		ok = ok && serial.valid() && pipelined.valid() && serial.size() == pipelined.size()
+			&& std::memcmp(serial.data(), pipelined.data(), serial.size()) == 0;
+		std::remove(path("serial", i).c_str());
+		std::remove(path("pipelined", i).c_str());
+	}
+	result.identical = ok;
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeExportPipeline {
+	forge::ExportPipeline pipeline;
+};
+
+// ForgeExportBand is never defined: the handle is the engine's band.
+namespace {
+
+forge::ExportBand* engineBand(ForgeExportBand* band) {
+	return reinterpret_cast<forge::ExportBand*>(band);
+}
+
+forge::TiffInfo tiffInfo(const ForgeTiffInfo& info) {
+	forge::TiffInfo i;
+	i.width = info.width;
+	i.height = info.height;
+	i.channels = info.channels;
+	i.bitsPerSample = info.bitsPerSample;
+	i.compression = info.compression == 0 ? forge::TiffCompression::None
+		: info.compression == 2 ? forge::TiffCompression::LZW : forge::TiffCompression::Deflate;
+	i.predictor = info.predictor;
+	i.tiled = info.tiled;
+	i.blockSize = info.blockSize > 0 ? info.blockSize : (info.tiled ? 256 : 64);
+	i.dpi = info.dpi > 0.0 ? info.dpi : 300.0;
+	i.bigTiff = info.bigTiff;
+	return i;
+}
+
+ForgeExportStageStats stageStats(const forge::ExportStageStats& s) {
+	return { s.busySeconds, s.utilisation };
+}
+
+ForgeExportPipelineStats pipelineStats(const forge::ExportPipelineStats& s) {
+	return { s.seconds, stageStats(s.render), stageStats(s.convert), stageStats(s.encode), stageStats(s.write),
+			 s.bands, s.images, s.failed, s.bytesWritten };
+}
+
+} // namespace
+
+extern "C" {
+	ForgeExportPipeline* ForgeExportPipelineCreate(int32_t depth) {
+		return new ForgeExportPipeline{ forge::ExportPipeline(depth) };
+	}
+
+	void ForgeExportPipelineRelease(ForgeExportPipeline* pipeline) {
+		delete pipeline;
+	}
+
+	int32_t ForgeExportPipelineBegin(ForgeExportPipeline* pipeline, const char* path, ForgeTiffInfo info) {
+		return pipeline && path ? pipeline->pipeline.begin(path, tiffInfo(info)) : -1;
+	}
+
+	void ForgeExportPipelineAddTag(ForgeExportPipeline* pipeline, int32_t job, int32_t directory, uint16_t tag, uint16_t type,
+								   uint64_t count, const void* value, size_t size) {
+		if (!pipeline || directory < 0 || directory > 2 || (size && !value)) return;
+		forge::TiffTag t;
+		t.tag = tag;
+		t.type = type;
+		t.count = count;
+		const auto* bytes = static_cast<const uint8_t*>(value);
+		t.value.assign(bytes, bytes + size);
+		pipeline->pipeline.addTag(job, forge::TiffDirectory(directory), std::move(t));
+	}
+
+	void ForgeExportPipelineSetICCProfile(ForgeExportPipeline* pipeline, int32_t job, const uint8_t* profile, size_t size) {
+		if (pipeline && profile) pipeline->pipeline.setIccProfile(job, std::vector<uint8_t>(profile, profile + size));
+	}
+
+	void ForgeExportPipelineSetIPTC(ForgeExportPipeline* pipeline, int32_t job, const uint8_t* records, size_t size) {
+		if (pipeline && records) pipeline->pipeline.setIptc(job, std::vector<uint8_t>(records, records + size));
+	}
+
+	int32_t ForgeExportPipelineBandRows(const ForgeExportPipeline* pipeline, int32_t job) {
+		return pipeline ? pipeline->pipeline.bandRows(job) : 0;
+	}
+
+	ForgeExportBand* ForgeExportPipelineAcquire(ForgeExportPipeline* pipeline, int32_t job) {
+		return pipeline ? reinterpret_cast<ForgeExportBand*>(pipeline->pipeline.acquire(job)) : nullptr;
+	}
+
+	void* ForgeExportBandPixels(ForgeExportBand* band, size_t* rowBytes) {
+		forge::ExportBand* b = engineBand(band);
+		if (rowBytes) *rowBytes = size_t(b->width) * 4 * sizeof(float);
+		return b->pixels.data();
+	}
+
+	void ForgeExportPipelineSubmit(ForgeExportPipeline* pipeline, ForgeExportBand* band, int32_t rows) {
+		if (pipeline) pipeline->pipeline.submit(engineBand(band), rows);
+	}
+
+	void ForgeExportPipelineEnd(ForgeExportPipeline* pipeline, int32_t job) {
+		if (pipeline) pipeline->pipeline.end(job);
+	}
+
+	bool ForgeExportPipelineWait(ForgeExportPipeline* pipeline, int32_t job) {
+		return pipeline && pipeline->pipeline.wait(job);
+	}
+
+	bool ForgeExportPipelineDrain(ForgeExportPipeline* pipeline) {
+		return pipeline && pipeline->pipeline.drain();
+	}
+
+	ForgeExportPipelineStats ForgeExportPipelineGetStats(const ForgeExportPipeline* pipeline) {
+		return pipelineStats(pipeline ? pipeline->pipeline.stats() : forge::ExportPipelineStats());
+	}
+
+	ForgeExportPipelineBenchmark ForgeBenchmarkExportPipeline(int32_t width, int32_t height, int32_t images, const char* directory) {
+		const forge::ExportPipelineBenchmark b = forge::benchmarkExportPipeline(width, height, images, directory ? directory : ".");
+		return { b.images, b.megabytes, b.serialSeconds, b.pipelinedSeconds, pipelineStats(b.stats), b.identical };
+	}
+}
@@ -0,0 +1,161 @@
+//
+//  ExportPipeline.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.hpp"
+#include "TiffWriter.hpp"
+
+namespace forge {
+
+/*
+ Overlapped export: render → convert → encode → write.
+
+ An export used to render a frame, convert it, encode it and write it one after another, so the
+ GPU sat idle while the file was compressed and the disk idle while the next image rendered.
+ Here each stage is its own thread and bands of rows flow between them:
+ - render (the caller, through Core Image): float RGBA rows into a band from acquire(), handed on
+   with submit();
+ - convert: to the file's 8- or 16-bit RGB, rows in parallel. The export contexts don't colour
+   match, so the rendered values are already the output's (AdobeRGB) encoding and this is the
+   clamp, quantise and pack Core Image did when asked for RGBA16;
+ - encode: the band's strips or tiles compressed in parallel (TiffWriter::encodeBand);
+ - write: blocks appended to the image's file; the directories once its last band arrives.
+ Stages are joined by bounded queues and the bands come from a fixed pool (a few per stage
+ boundary, so each stage can work on one band while the next is queued), which is all the pixel
+ memory an export holds and what throttles the renderer when a later stage falls behind. Bands
+ of different images flow through the same pool, so in a batch the next image renders while the
+ last one is still being compressed and written: the batch runs at the pace of its slowest
+ stage rather than the sum of all four.
+
+ Each stage's busy time is kept; busy / elapsed is its utilisation, and the stage near 100% is
+ the one limiting the export.
+ */
+
+struct ExportBand {
+	int job = -1;
+	int width = 0;
+	int rows = 0;
+	bool last = false;                            // no pixels: the job's end
+	std::vector<float> pixels;                    // RGBA as rendered, rows of width × 4
+	std::vector<uint8_t> samples;                 // converted, packed
+	std::vector<std::vector<uint8_t>> blocks;     // encoded
+	size_t blockCount = 0;
+	std::chrono::steady_clock::time_point acquired;
+};
+
+struct ExportStageStats {
+	double busySeconds = 0.0;
+	double utilisation = 0.0;                     // busy / elapsed
+};
+
+struct ExportPipelineStats {
+	double seconds = 0.0;                         // since the first image began
+	ExportStageStats render, convert, encode, write;
+	int64_t bands = 0;
+	int images = 0;
+	int failed = 0;
+	uint64_t bytesWritten = 0;
+};
+
+class ExportPipeline {
+public:
+	// `depth` bands per stage boundary.
+	explicit ExportPipeline(int depth = 2);
+	~ExportPipeline();
+
+	ExportPipeline(const ExportPipeline&) = delete;
+	ExportPipeline& operator=(const ExportPipeline&) = delete;
+
+	// Starts an image. -1 if the file can't be created or the info is invalid.
+	int begin(const std::string& path, const TiffInfo& info);
+
+	// Metadata for the image, any time before end().
+	void addTag(int job, TiffDirectory directory, TiffTag tag);
+	void setIccProfile(int job, std::vector<uint8_t> profile);
+	void setIptc(int job, std::vector<uint8_t> records);
+
+	int width(int job) const;
+	int bandRows(int job) const;
+
+	// A band to render up to bandRows(job) rows into, top to bottom; waits while every band is in
+	// flight. Null after the pipeline is closed.
+	ExportBand* acquire(int job);
+	void submit(ExportBand* band, int rows);
+	// No more bands for `job`. An image given fewer rows than its height is not written.
+	void end(int job);
+
+	// Until `job` is written or has failed. True if its file is in place. Forgets the job.
+	bool wait(int job);
+	// Until every image begun so far is done. True if none failed.
+	bool drain();
+
+	ExportPipelineStats stats() const;
+
+private:
+	struct Job {
+		std::unique_ptr<TiffWriter> writer;
+		TiffInfo info;
+		int bandRows = 0;
+		bool done = false;
+		std::atomic<bool> failed{ false };
+	};
+
+	Job* job(int id) const;
+	void convertLoop();
+	void encodeLoop();
+	void writeLoop();
+	void finishJob(Job& job, bool ok);
+	void addBusy(std::atomic<int64_t>& stage, std::chrono::steady_clock::time_point since);
+
+	BoundedQueue<ExportBand*> free_, converting_, encoding_, writing_;
+	std::vector<std::unique_ptr<ExportBand>> pool_;
+
+	mutable std::mutex jobsMutex_;
+	std::condition_variable jobDone_;
+	std::map<int, std::unique_ptr<Job>> jobs_;
+	int nextJob_ = 0;
+	int images_ = 0, failed_ = 0;
+
+	std::chrono::steady_clock::time_point start_;
+	bool started_ = false;
+	std::atomic<int64_t> renderNs_{ 0 }, convertNs_{ 0 }, encodeNs_{ 0 }, writeNs_{ 0 };
+	std::atomic<int64_t> bands_{ 0 };
+	std::atomic<uint64_t> bytes_{ 0 };
+
+	std::thread convertThread_, encodeThread_, writeThread_;
+};
+
+// Float RGBA rows to packed 8- or 16-bit samples of `channels` (≤ 4), clamped to [0, 1].
+void convertExportRows(const float* pixels, size_t pixelRowFloats, int width, int rows, int channels,
+					   int bitsPerSample, uint8_t* samples);
+
+// MARK: - Benchmark
+
+struct ExportPipelineBenchmark {
+	int images = 0;
+	double megabytes = 0.0;                       // of samples written
+	double serialSeconds = 0.0;                   // every stage of every band in turn
+	double pipelinedSeconds = 0.0;
+	ExportPipelineStats stats;                    // of the pipelined run
+	bool identical = false;                       // both runs wrote the same files
+};
+
+// Writes to and removes its files from `directory`.
+ExportPipelineBenchmark benchmarkExportPipeline(int width, int height, int images, const std::string& directory);
+
+} // namespace forge
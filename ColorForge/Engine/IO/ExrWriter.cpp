@@ -0,0 +1,419 @@
+//
+//  ExrWriter.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "ExrWriter.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
+
+namespace forge {
+
+namespace {
+
+constexpr uint32_t kMagic = 20000630;
+constexpr uint32_t kVersionTiled = 2 | 0x200;
+constexpr int32_t kPixelHalf = 1;
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+	uint8_t bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));   // little-endian host
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& s) {
+	out.insert(out.end(), s.begin(), s.end());
+	out.push_back(0);
+}
+
+// name, type, size, value.
+void attribute(std::vector<uint8_t>& out, const char* name, const char* type, const std::vector<uint8_t>& value) {
+	putString(out, name);
+	putString(out, type);
+	put<int32_t>(out, int32_t(value.size()));
+	out.insert(out.end(), value.begin(), value.end());
+}
+
+// File channel order is alphabetical: A, B, G, R. The index of each in an RGBA pixel.
+std::vector<int> fileChannels(int channels) {
+	return channels == 4 ? std::vector<int>{ 3, 2, 1, 0 } : std::vector<int>{ 2, 1, 0 };
+}
+
+std::vector<uint8_t> header(const ExrInfo& info) {
+	std::vector<uint8_t> h;
+	put<uint32_t>(h, kMagic);
+	put<uint32_t>(h, kVersionTiled);
+
+	std::vector<uint8_t> v;
+	for (int c : fileChannels(info.channels)) {
+		putString(v, std::string(1, "RGBA"[c]));
+		put<int32_t>(v, kPixelHalf);
+		put<uint8_t>(v, 0);                  // pLinear
+		put<uint8_t>(v, 0);
+		put<uint8_t>(v, 0);
+		put<uint8_t>(v, 0);
+		put<int32_t>(v, 1);                  // x, y sampling
+		put<int32_t>(v, 1);
+	}
+	v.push_back(0);
+	attribute(h, "channels", "chlist", v);
+
+	if (info.chromaticities.size() == 8) {
+		v.clear();
+		for (float f : info.chromaticities) put<float>(v, f);
+		attribute(h, "chromaticities", "chromaticities", v);
+	}
+	if (!info.comments.empty()) attribute(h, "comments", "string", std::vector<uint8_t>(info.comments.begin(), info.comments.end()));
+
+	attribute(h, "compression", "compression", { uint8_t(info.compression) });
+	v.clear();
+	for (int32_t i : { 0, 0, info.width - 1, info.height - 1 }) put<int32_t>(v, i);
+	attribute(h, "dataWindow", "box2i", v);
+	attribute(h, "displayWindow", "box2i", v);
+	attribute(h, "lineOrder", "lineOrder", { 0 });   // increasing y
+	v.clear();
+	put<float>(v, 1.0f);
+	attribute(h, "pixelAspectRatio", "float", v);
+	v.clear();
+	put<float>(v, 0.0f);
+	put<float>(v, 0.0f);
+	attribute(h, "screenWindowCenter", "v2f", v);
+	v.clear();
+	put<float>(v, 1.0f);
+	attribute(h, "screenWindowWidth", "float", v);
+	v.clear();
+	put<uint32_t>(v, uint32_t(info.tileSize));
+	put<uint32_t>(v, uint32_t(info.tileSize));
+	put<uint8_t>(v, 0);                      // one level, round down
+	attribute(h, "tiles", "tiledesc", v);
+	h.push_back(0);
+	return h;
+}
+
+// One tile as a chunk: tile x, y, level 0, 0, size, then per scanline each channel's halfs.
+void encodeTile(const ExrInfo& info, const half_t* band, int rows, int tileX, int tileY,
+				std::vector<uint8_t>& raw, std::vector<uint8_t>& scratch, std::vector<uint8_t>& chunk) {
+	const int x0 = tileX * info.tileSize, columns = std::min(info.tileSize, info.width - x0);
+	const std::vector<int> channels = fileChannels(info.channels);
+	raw.resize(size_t(rows) * channels.size() * size_t(columns) * sizeof(half_t));
+	auto* out = reinterpret_cast<half_t*>(raw.data());
+	for (int y = 0; y < rows; ++y) {
+		const half_t* row = band + (size_t(y) * size_t(info.width) + size_t(x0)) * size_t(info.channels);
+		for (int c : channels) {
+			for (int x = 0; x < columns; ++x) *out++ = row[size_t(x) * size_t(info.channels) + size_t(c)];
+		}
+	}
+
+	std::vector<uint8_t> data;
+	const std::vector<uint8_t>* payload = &raw;
+	if (info.compression == ExrCompression::Zip) {
+		encodeExrZip(raw.data(), raw.size(), info.zipLevel, scratch, data);
+		payload = &data;
+	}
+	chunk.clear();
+	put<int32_t>(chunk, tileX);
+	put<int32_t>(chunk, tileY);
+	put<int32_t>(chunk, 0);
+	put<int32_t>(chunk, 0);
+	put<int32_t>(chunk, int32_t(payload->size()));
+	chunk.insert(chunk.end(), payload->begin(), payload->end());
+}
+
+} // namespace
+
+void encodeExrZip(const uint8_t* raw, size_t size, int level, std::vector<uint8_t>& scratch, std::vector<uint8_t>& out) {
+	// Even bytes, then odd: the high bytes of halves change slowly and compress together.
+	scratch.resize(size);
+	uint8_t* t1 = scratch.data();
+	uint8_t* t2 = scratch.data() + (size + 1) / 2;
+	for (size_t i = 0; i < size; ++i) {
+		if (i & 1) *t2++ = raw[i];
+		else *t1++ = raw[i];
+	}
+	// Differences to the previous byte, biased by 128.
+	int previous = size ? scratch[0] : 0;
+	for (size_t i = 1; i < size; ++i) {
+		const int d = int(scratch[i]) - previous + (128 + 256);
+		previous = scratch[i];
+		scratch[i] = uint8_t(d);
+	}
+
+	uLongf bound = compressBound(uLong(size));
+	out.resize(bound);
+	if (compress2(out.data(), &bound, scratch.data(), uLong(size), std::clamp(level, 1, 9)) != Z_OK || bound >= size) {
+		out.assign(raw, raw + size);
+		return;
+	}
+	out.resize(bound);
+}
+
+// MARK: - Writer
+
+ExrWriter::ExrWriter(std::string path, const ExrInfo& info) : info_(info), file_(std::move(path)) {
+	const bool shape = info_.width > 0 && info_.height > 0 && (info_.channels == 3 || info_.channels == 4)
+		&& info_.tileSize > 0 && (info_.chromaticities.empty() || info_.chromaticities.size() == 8)
+		&& (info_.compression == ExrCompression::None || info_.compression == ExrCompression::Zip);
+	if (!shape || !file_.valid()) {
+		ok_ = false;
+		return;
+	}
+	tilesX_ = (info_.width + info_.tileSize - 1) / info_.tileSize;
+	tilesY_ = (info_.height + info_.tileSize - 1) / info_.tileSize;
+
+	// Header, then the offset table: one per tile, row by row, filled in by finish().
+	const std::vector<uint8_t> h = header(info_);
+	ok_ = file_.write(h.data(), h.size());
+	tableOffset_ = file_.offset();
+	const std::vector<uint8_t> table(size_t(tilesX_) * size_t(tilesY_) * sizeof(uint64_t), 0);
+	ok_ = ok_ && file_.write(table.data(), table.size());
+	offsets_.reserve(size_t(tilesX_) * size_t(tilesY_));
+}
+
+bool ExrWriter::appendRows(const half_t* pixels, size_t rowHalfs, int rows, int inputChannels) {
+	if (!valid() || finished_ || !pixels || inputChannels < info_.channels) return false;
+	rows = std::min(rows, info_.height - rowsWritten_ - bandFilled_);
+	const size_t rowSize = size_t(info_.width) * size_t(info_.channels);
+	if (band_.empty()) band_.resize(rowSize * size_t(info_.tileSize));
+	for (int r = 0; r < rows; ++r) {
+		const half_t* in = pixels + size_t(r) * rowHalfs;
+		half_t* out = &band_[size_t(bandFilled_) * rowSize];
+		if (inputChannels == info_.channels) {
+			std::memcpy(out, in, rowSize * sizeof(half_t));
+		} else {
+			for (int x = 0; x < info_.width; ++x) {
+				std::memcpy(out + size_t(x) * size_t(info_.channels), in + size_t(x) * size_t(inputChannels), size_t(info_.channels) * sizeof(half_t));
+			}
+		}
+		if (++bandFilled_ == info_.tileSize || rowsWritten_ + bandFilled_ == info_.height) {
+			if (!flushBand()) return false;
+		}
+	}
+	return valid();
+}
+
+bool ExrWriter::flushBand() {
+	const int rows = bandFilled_, tileY = rowsWritten_ / info_.tileSize;
+	if (chunks_.size() < size_t(tilesX_)) chunks_.resize(size_t(tilesX_));
+	parallelFor(size_t(tilesX_), [&](size_t x) {
+		std::vector<uint8_t> raw, scratch;
+		encodeTile(info_, band_.data(), rows, int(x), tileY, raw, scratch, chunks_[x]);
+	});
+	for (int x = 0; x < tilesX_ && ok_; ++x) {
+		offsets_.push_back(file_.offset());
+		ok_ = file_.write(chunks_[size_t(x)].data(), chunks_[size_t(x)].size());
+	}
+	bandFilled_ = 0;
+	rowsWritten_ += rows;
+	return ok_;
+}
+
+bool ExrWriter::finish() {
+	if (finished_) return false;
+	finished_ = true;
+	if (!valid() || rowsWritten_ != info_.height || offsets_.size() != size_t(tilesX_) * size_t(tilesY_)) {
+		file_.abort();
+		return false;
+	}
+	if (!file_.writeAt(tableOffset_, offsets_.data(), offsets_.size() * sizeof(uint64_t))) {
+		file_.abort();
+		return false;
+	}
+	return file_.commit();
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+template <typename T>
+T get(const uint8_t* p) {
+	T v;
+	std::memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+// Reads back a ZIP or uncompressed file this writer made and compares it with `expected`
+// (interleaved, `channels` per pixel).
+bool matches(const std::string& path, const std::vector<half_t>& expected, const ExrInfo& info) {
+	MappedFile file(path);
+	if (!file.valid() || file.size() < 8 || get<uint32_t>(file.data()) != kMagic) return false;
+	const uint8_t* d = file.data();
+	// Skip the header's attributes: name, type, size, value, until an empty name.
+	size_t at = 8;
+	while (at < file.size() && d[at] != 0) {
+		at += std::strlen(reinterpret_cast<const char*>(d + at)) + 1;
+		at += std::strlen(reinterpret_cast<const char*>(d + at)) + 1;
+		at += 4 + size_t(get<int32_t>(d + at));
+	}
+	++at;
+
+	const int tile = info.tileSize;
+	const int tilesX = (info.width + tile - 1) / tile, tilesY = (info.height + tile - 1) / tile;
+	const std::vector<int> channels = fileChannels(info.channels);
+	std::vector<uint8_t> raw, unpacked;
+	for (int i = 0; i < tilesX * tilesY; ++i) {
+		const uint64_t offset = get<uint64_t>(d + at + size_t(i) * 8);
+		if (offset + 20 > file.size()) return false;
+		const int tx = get<int32_t>(d + offset), ty = get<int32_t>(d + offset + 4);
+		const int32_t size = get<int32_t>(d + offset + 16);
+		if (tx != i % tilesX || ty != i / tilesX) return false;
+		const int x0 = tx * tile, y0 = ty * tile;
+		const int columns = std::min(tile, info.width - x0), rows = std::min(tile, info.height - y0);
+		const size_t rawSize = size_t(rows) * channels.size() * size_t(columns) * 2;
+		const uint8_t* data = d + offset + 20;
+		if (size_t(size) == rawSize) {
+			raw.assign(data, data + rawSize);
+		} else {
+			unpacked.resize(rawSize);
+			uLongf length = uLongf(rawSize);
+			if (uncompress(unpacked.data(), &length, data, uLong(size)) != Z_OK || length != rawSize) return false;
+			for (size_t j = 1; j < rawSize; ++j) unpacked[j] = uint8_t(int(unpacked[j - 1]) + int(unpacked[j]) - 128);
+			raw.resize(rawSize);
+			const uint8_t* t1 = unpacked.data();
+			const uint8_t* t2 = unpacked.data() + (rawSize + 1) / 2;
+			for (size_t j = 0; j < rawSize; ++j) raw[j] = (j & 1) ? *t2++ : *t1++;
+		}
+		const auto* halfs = reinterpret_cast<const half_t*>(raw.data());
+		for (int y = 0; y < rows; ++y) {
+			for (int c : channels) {
+				for (int x = 0; x < columns; ++x) {
+					const half_t want = expected[(size_t(y0 + y) * size_t(info.width) + size_t(x0 + x)) * size_t(info.channels) + size_t(c)];
+					if (*halfs++ != want) return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+ExrWriterBenchmark benchmarkExrWriter(int width, int height, const std::string& directory) {
+	using Clock = std::chrono::steady_clock;
+	ExrWriterBenchmark result;
+	if (width <= 0 || height <= 0) return result;
+
+	// A LogC-like intermediate: smooth tonal ramps under fine grain, RGBA as Core Image renders it.
+	std::vector<float> pixels(size_t(width) * size_t(height) * 4);
+	parallelFor(size_t(height), [&](size_t y) {
+		uint32_t state = uint32_t(y) * 2654435761u + 1u;
+		for (int x = 0; x < width; ++x) {
+			state = state * 1664525u + 1013904223u;
+			const float grain = (float(state >> 8) / 16777216.0f - 0.5f) * 0.01f;
+			float* p = &pixels[(y * size_t(width) + size_t(x)) * 4];
+			p[0] = 0.2f + 0.5f * float(x) / float(width) + grain;
+			p[1] = 0.25f + 0.4f * float(y) / float(height) + grain;
+			p[2] = 0.4f + 0.15f * std::sin(0.01f * float(x + int(y))) + grain;
+			p[3] = 1.0f;
+		}
+	});
+	std::vector<half_t> halfs(pixels.size());
+	floatToHalf(pixels.data(), halfs.data(), pixels.size());
+
+	// The bytes the ImageIO path wrote, straight to disk.
+	result.float32Megabytes = double(pixels.size() * sizeof(float)) / 1048576.0;
+	const std::string floatPath = directory + "/forge_exr_benchmark.raw";
+	auto t0 = Clock::now();
+	{
+		AtomicFileWriter file(floatPath);
+		const size_t rowBytes = size_t(width) * 4 * sizeof(float);
+		for (int y = 0; y < height; ++y) file.write(&pixels[size_t(y) * size_t(width) * 4], rowBytes);
+		file.commit();
+	}
+	result.float32Seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+	std::remove(floatPath.c_str());
+
+	ExrInfo info;
+	info.width = width;
+	info.height = height;
+	const std::string path = directory + "/forge_exr_benchmark.exr";
+	t0 = Clock::now();
+	ExrWriter writer(path, info);
+	for (int y = 0; y < height; y += writer.bandRows()) {
+		writer.appendRows(&halfs[size_t(y) * size_t(width) * 4], size_t(width) * 4, std::min(writer.bandRows(), height - y), 4);
+	}
+	const uint64_t size = writer.bytesWritten();
+	const bool written = writer.finish();
+	result.exrSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+	result.exrMegabytes = double(size) / 1048576.0;
+	result.sizeRatio = result.exrMegabytes / result.float32Megabytes;
+
+	std::vector<half_t> rgb(size_t(width) * size_t(height) * 3);
+	for (size_t i = 0; i < size_t(width) * size_t(height); ++i) std::memcpy(&rgb[i * 3], &halfs[i * 4], 3 * sizeof(half_t));
+	result.exact = written && matches(path, rgb, info);
+	std::remove(path.c_str());
+
+	// The same tiles on this thread alone, for the scaling.
+	std::vector<uint8_t> raw, scratch, chunk;
+	t0 = Clock::now();
+	for (int y = 0; y < height; y += info.tileSize) {
+		const int rows = std::min(info.tileSize, height - y);
+		for (int x = 0; x < (width + info.tileSize - 1) / info.tileSize; ++x) {
+			encodeTile(info, &rgb[size_t(y) * size_t(width) * 3], rows, x, y / info.tileSize, raw, scratch, chunk);
+		}
+	}
+	result.exrSerialSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeExrWriter {
+	forge::ExrWriter writer;
+
+	ForgeExrWriter(const char* path, const forge::ExrInfo& info) : writer(path, info) {}
+};
+
+extern "C" {
+	ForgeExrWriter* ForgeExrWriterCreate(const char* path, ForgeExrInfo info, const float* chromaticities, const char* comments) {
+		if (!path) return nullptr;
+		forge::ExrInfo i;
+		i.width = info.width;
+		i.height = info.height;
+		i.channels = info.channels;
+		i.compression = info.compression == 0 ? forge::ExrCompression::None : forge::ExrCompression::Zip;
+		if (info.tileSize > 0) i.tileSize = info.tileSize;
+		if (chromaticities) i.chromaticities.assign(chromaticities, chromaticities + 8);
+		if (comments) i.comments = comments;
+		auto* writer = new ForgeExrWriter(path, i);
+		if (!writer->writer.valid()) {
+			delete writer;
+			return nullptr;
+		}
+		return writer;
+	}
+
+	void ForgeExrWriterRelease(ForgeExrWriter* writer) {
+		delete writer;
+	}
+
+	int32_t ForgeExrWriterBandRows(const ForgeExrWriter* writer) {
+		return writer ? writer->writer.bandRows() : 0;
+	}
+
+	bool ForgeExrWriterAppendRows(ForgeExrWriter* writer, const void* pixels, size_t rowBytes, int32_t rows, int32_t inputChannels) {
+		return writer && writer->writer.appendRows(static_cast<const forge::half_t*>(pixels), rowBytes / sizeof(forge::half_t), rows, inputChannels);
+	}
+
+	bool ForgeExrWriterFinish(ForgeExrWriter* writer) {
+		return writer && writer->writer.finish();
+	}
+
+	ForgeExrWriterBenchmark ForgeBenchmarkExrWriter(int32_t width, int32_t height, const char* directory) {
+		const forge::ExrWriterBenchmark b = forge::benchmarkExrWriter(width, height, directory ? directory : ".");
+		return { b.float32Megabytes, b.float32Seconds, b.exrMegabytes, b.exrSeconds, b.exrSerialSeconds, b.sizeRatio, b.exact };
+	}
+}
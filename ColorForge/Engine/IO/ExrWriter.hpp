@@ -0,0 +1,106 @@
+//
+//  ExrWriter.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FileIO.hpp"
+#include "Half.hpp"
+
+namespace forge {
+
+/*
+ Streaming half-float OpenEXR writer (single part, tiled, one level).
+
+ saveImage32BitFloat and saveImage32BitDebug rendered the whole frame as 32-bit float RGBA and
+ had ImageIO write it as an uncompressed TIFF on one thread: 16 bytes a pixel, the padding
+ channel included. Intermediates (LogC / AWG3 and the like) don't need more than half
+ precision, so this writes what OpenEXR readers expect of a scene-linear archive:
+ - HALF channels, R G B and optionally A, stored in the file's alphabetical order;
+ - tiles of tileSize², each one chunk, compressed with OpenEXR's ZIP (bytes split into two
+   halves, delta predictor, zlib) or stored raw when that isn't smaller;
+ - rows are handed over as they are rendered; a band is one row of tiles and its tiles are
+   compressed in parallel, then appended in order. The tile offset table, reserved behind the
+   header, is filled in at finish().
+ So the writer holds one band of half pixels and its compressed tiles, never the image, and the
+ file is renamed into place only once complete (AtomicFileWriter).
+
+ PIZ (wavelet + Huffman) isn't written: ZIP is lossless too, every reader has it and it is the
+ cheaper of the two to encode.
+ */
+
+enum class ExrCompression : uint8_t { None = 0, Zip = 3 };   // values as in the file
+
+struct ExrInfo {
+	int width = 0, height = 0;
+	int channels = 3;                   // 3 RGB, 4 RGBA
+	ExrCompression compression = ExrCompression::Zip;
+	int tileSize = 64;
+	int zipLevel = 1;                   // ~3% larger than OpenEXR's default of 4, a third faster
+	// CIE xy of red, green, blue and white; written when set. Empty: the reader assumes Rec.709.
+	std::vector<float> chromaticities;
+	std::string comments;
+};
+
+// OpenEXR ZIP for one chunk into `out`, replacing its contents: the raw bytes again if
+// compressing them doesn't save anything. `scratch` is reused between calls.
+void encodeExrZip(const uint8_t* raw, size_t size, int level, std::vector<uint8_t>& scratch, std::vector<uint8_t>& out);
+
+class ExrWriter {
+public:
+	ExrWriter(std::string path, const ExrInfo& info);
+
+	ExrWriter(const ExrWriter&) = delete;
+	ExrWriter& operator=(const ExrWriter&) = delete;
+
+	bool valid() const { return file_.valid() && ok_; }
+	int bandRows() const { return info_.tileSize; }
+	int rowsWritten() const { return rowsWritten_; }
+	uint64_t bytesWritten() const { return file_.offset(); }
+
+	// `rows` rows, top to bottom, of `inputChannels` halfs per pixel (RGBA as Core Image renders
+	// them). Channels past `channels` are dropped. False once the writer has failed.
+	bool appendRows(const half_t* pixels, size_t rowHalfs, int rows, int inputChannels);
+
+	// Offset table, rename into place. False (and no file) unless every row was given.
+	bool finish();
+
+private:
+	bool flushBand();
+
+	ExrInfo info_;
+	AtomicFileWriter file_;
+	bool ok_ = true;
+	bool finished_ = false;
+	int tilesX_ = 0, tilesY_ = 0;
+	int bandFilled_ = 0;
+	int rowsWritten_ = 0;
+	uint64_t tableOffset_ = 0;
+	std::vector<half_t> band_;                    // interleaved, `channels` per pixel
+	std::vector<std::vector<uint8_t>> chunks_;    // per tile of the band, header included
+	std::vector<uint64_t> offsets_;
+};
+
+// MARK: - Benchmark
+
+struct ExrWriterBenchmark {
+	double float32Megabytes = 0.0;                // what the ImageIO path wrote: RGBA float
+	double float32Seconds = 0.0;                  // those bytes streamed to disk, nothing else
+	double exrMegabytes = 0.0;
+	double exrSeconds = 0.0;
+	double exrSerialSeconds = 0.0;                // the same tiles compressed on one thread
+	double sizeRatio = 0.0;                       // exr / float32
+	bool exact = false;                           // the file decodes to the halves given
+};
+
+// Writes to and removes its files from `directory`.
+ExrWriterBenchmark benchmarkExrWriter(int width, int height, const std::string& directory);
+
+} // namespace forge
@@ -0,0 +1,139 @@
+//
+//  FileIO.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "FileIO.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace forge {
+
+// MARK: - MappedFile
+
+MappedFile::MappedFile(MappedFile&& o) noexcept : data_(o.data_), size_(o.size_) {
+	o.data_ = nullptr;
+	o.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+	if (this != &o) {
+		close();
+		data_ = o.data_;
+		size_ = o.size_;
+		o.data_ = nullptr;
+		o.size_ = 0;
+	}
+	return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps its own reference
+	if (p == MAP_FAILED) return false;
+
+	data_ = static_cast<const uint8_t*>(p);
+	size_ = size_t(st.st_size);
+	return true;
+}
+
+void MappedFile::close() {
+	if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+	data_ = nullptr;
+	size_ = 0;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+	if (!data_ || offset >= size_) return;
+	const size_t page = size_t(sysconf(_SC_PAGESIZE));
+	const size_t begin = offset / page * page;
+	const size_t end = std::min(size_, offset + size);
+	madvise(const_cast<uint8_t*>(data_) + begin, end - begin, MADV_WILLNEED);
+}
+
+// MARK: - AtomicFileWriter
+
+AtomicFileWriter::AtomicFileWriter(std::string path) : path_(std::move(path)) {
+	static std::atomic<uint32_t> counter{ 0 };
+	tempPath_ = path_ + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter.fetch_add(1));
+	fd_ = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ok_ = fd_ >= 0;
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+	abort();
+}
+
+bool AtomicFileWriter::write(const void* data, size_t size) {
+	if (!writeAt(offset_, data, size)) return false;
+	offset_ += size;
+	return true;
+}
+
+bool AtomicFileWriter::writeAt(uint64_t offset, const void* data, size_t size) {
+	if (!valid()) return false;
+	const auto* p = static_cast<const uint8_t*>(data);
+	while (size > 0) {
+		const ssize_t n = pwrite(fd_, p, size, off_t(offset));
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) {
+			ok_ = false;
+			return false;
+		}
+		p += n;
+		offset += uint64_t(n);
+		size -= size_t(n);
+	}
+	return true;
+}
+
+bool AtomicFileWriter::commit() {
+	if (!valid()) {
+		abort();
+		return false;
+	}
+#if defined(__APPLE__)
+	// fsync only reaches the drive cache on macOS; F_FULLFSYNC reaches the platter/NAND.
+	const bool synced = fcntl(fd_, F_FULLFSYNC) == 0 || fsync(fd_) == 0;
+#else
+	const bool synced = fsync(fd_) == 0;
+#endif
+	const bool closed = ::close(fd_) == 0;
+	fd_ = -1;
+	if (!synced || !closed || std::rename(tempPath_.c_str(), path_.c_str()) != 0) {
+		::unlink(tempPath_.c_str());
+		ok_ = false;
+		return false;
+	}
+	ok_ = false; // nothing left to clean up
+	return true;
+}
+
+void AtomicFileWriter::abort() {
+	if (fd_ >= 0) {
+		::close(fd_);
+		fd_ = -1;
+		::unlink(tempPath_.c_str());
+	}
+	ok_ = false;
+}
+
+} // namespace forge
@@ -0,0 +1,73 @@
+//
+//  FileIO.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace forge {
+
+// Read-only memory map of a whole file. Pages are faulted in on access, so opening a large
+// cache entry costs nothing until its tiles are read.
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(MappedFile&& o) noexcept;
+	MappedFile& operator=(MappedFile&& o) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	bool valid() const { return data_ != nullptr; }
+	const uint8_t* data() const { return data_; }
+	size_t size() const { return size_; }
+
+	// Hints that [offset, offset + size) will be read soon, so the kernel can start paging it in
+	// while the caller works on the previous range.
+	void prefetch(size_t offset, size_t size) const;
+
+private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+};
+
+// Writes to a temporary file next to `path` and only renames it into place on commit(), after
+// an fsync. A crash at any point leaves either the old file or no file, never a torn one.
+// Uncommitted temporaries are removed by the destructor.
+class AtomicFileWriter {
+public:
+	explicit AtomicFileWriter(std::string path);
+	~AtomicFileWriter();
+
+	AtomicFileWriter(const AtomicFileWriter&) = delete;
+	AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+	bool valid() const { return fd_ >= 0 && ok_; }
+
+	bool write(const void* data, size_t size);
+	bool writeAt(uint64_t offset, const void* data, size_t size); // does not move the append offset
+	uint64_t offset() const { return offset_; }
+
+	bool commit();
+	void abort();
+
+private:
+	std::string path_;
+	std::string tempPath_;
+	int fd_ = -1;
+	uint64_t offset_ = 0;
+	bool ok_ = false;
+};
+
+} // namespace forge
@@ -0,0 +1,310 @@
+//
+//  JpegWriter.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "JpegWriter.hpp"
+#include "FileIO.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace forge {
+
+namespace {
+
+// Natural (row-major) index of each coefficient in zig-zag order.
+constexpr uint8_t kZigZag[64] = {
+	0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// Annex K.1, row-major.
+constexpr uint8_t kLumaQuant[64] = {
+	16, 11, 10, 16, 24, 40, 51, 61,
+	12, 12, 14, 19, 26, 58, 60, 55,
+	14, 13, 16, 24, 40, 57, 69, 56,
+	14, 17, 22, 29, 51, 87, 80, 62,
+	18, 22, 37, 56, 68, 109, 103, 77,
+	24, 35, 55, 64, 81, 104, 113, 92,
+	49, 64, 78, 87, 103, 121, 120, 101,
+	72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+constexpr uint8_t kChromaQuant[64] = {
+	17, 18, 24, 47, 99, 99, 99, 99,
+	18, 21, 26, 66, 99, 99, 99, 99,
+	24, 26, 56, 99, 99, 99, 99, 99,
+	47, 66, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+// Annex K.3: code counts per length (1...16 bits), then the symbols in code order.
+constexpr uint8_t kDcLumaBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+constexpr uint8_t kDcChromaBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+constexpr uint8_t kDcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+constexpr uint8_t kAcLumaBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+constexpr uint8_t kAcLumaValues[162] = {
+	0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+	0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+	0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+	0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+	0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+	0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+	0xf9, 0xfa,
+};
+
+constexpr uint8_t kAcChromaBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+constexpr uint8_t kAcChromaValues[162] = {
+	0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+	0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+	0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+	0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+	0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+	0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+	0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+	0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+	0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+	0xf9, 0xfa,
+};
+
+struct HuffmanTable {
+	uint16_t code[256] = {};
+	uint8_t length[256] = {};
+};
+
+// Canonical codes from the counts per length (Annex C).
+HuffmanTable buildTable(const uint8_t bits[16], const uint8_t* values) {
+	HuffmanTable table;
+	uint16_t code = 0;
+	int k = 0;
+	for (int length = 1; length <= 16; ++length) {
+		for (int i = 0; i < bits[length - 1]; ++i, ++k) {
+			table.code[values[k]] = code++;
+			table.length[values[k]] = uint8_t(length);
+		}
+		code <<= 1;
+	}
+	return table;
+}
+
+struct Tables {
+	HuffmanTable dcLuma = buildTable(kDcLumaBits, kDcValues);
+	HuffmanTable dcChroma = buildTable(kDcChromaBits, kDcValues);
+	HuffmanTable acLuma = buildTable(kAcLumaBits, kAcLumaValues);
+	HuffmanTable acChroma = buildTable(kAcChromaBits, kAcChromaValues);
+	float dct[8][8] = {};   // dct[u][x] = C(u) / 2 · cos((2x + 1)uπ / 16)
+
+	Tables() {
+		for (int u = 0; u < 8; ++u) {
+			const double c = u == 0 ? std::sqrt(0.5) : 1.0;
+			for (int x = 0; x < 8; ++x) dct[u][x] = float(0.5 * c * std::cos((2 * x + 1) * u * M_PI / 16.0));
+		}
+	}
+};
+
+const Tables& tables() {
+	static const Tables t;
+	return t;
+}
+
+// libjpeg's quality scaling of the example tables.
+void scaleQuant(const uint8_t base[64], int quality, uint8_t out[64]) {
+	quality = std::clamp(quality, 1, 100);
+	const int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+	for (int i = 0; i < 64; ++i) out[i] = uint8_t(std::clamp((int(base[i]) * scale + 50) / 100, 1, 255));
+}
+
+class BitWriter {
+public:
+	explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+	void put(uint32_t bits, int count) {
+		buffer_ = (buffer_ << count) | (bits & ((1u << count) - 1u));
+		filled_ += count;
+		while (filled_ >= 8) {
+			const uint8_t byte = uint8_t(buffer_ >> (filled_ - 8));
+			out_.push_back(byte);
+			if (byte == 0xFF) out_.push_back(0);   // stuffing
+			filled_ -= 8;
+		}
+	}
+
+	// Pads the last byte with ones.
+	void flush() {
+		if (filled_ > 0) put(0x7F, 8 - filled_);
+	}
+
+private:
+	std::vector<uint8_t>& out_;
+	uint32_t buffer_ = 0;
+	int filled_ = 0;
+};
+
+// Magnitude category of a coefficient and its low bits as the standard codes them.
+inline int category(int value) {
+	int magnitude = value < 0 ? -value : value, bits = 0;
+	while (magnitude) { ++bits; magnitude >>= 1; }
+	return bits;
+}
+
+inline uint32_t valueBits(int value, int bits) {
+	return uint32_t(value < 0 ? value + (1 << bits) - 1 : value);
+}
+
+// Forward DCT, quantisation and entropy coding of one level-shifted 8×8 block. `dc` carries the
+// predictor of the block's component.
+void encodeBlock(BitWriter& writer, const float block[64], const uint8_t quant[64], const HuffmanTable& dcTable,
+				 const HuffmanTable& acTable, int& dc) {
+	const Tables& t = tables();
+	float rows[64];
+	for (int y = 0; y < 8; ++y) {
+		for (int u = 0; u < 8; ++u) {
+			float sum = 0.0f;
+			for (int x = 0; x < 8; ++x) sum += t.dct[u][x] * block[y * 8 + x];
+			rows[y * 8 + u] = sum;
+		}
+	}
+	int coefficients[64];
+	for (int v = 0; v < 8; ++v) {
+		for (int u = 0; u < 8; ++u) {
+			float sum = 0.0f;
+			for (int y = 0; y < 8; ++y) sum += t.dct[v][y] * rows[y * 8 + u];
+			coefficients[v * 8 + u] = int(std::lround(sum / float(quant[v * 8 + u])));
+		}
+	}
+
+	const int diff = coefficients[0] - dc;
+	dc = coefficients[0];
+	const int dcBits = category(diff);
+	writer.put(dcTable.code[dcBits], dcTable.length[dcBits]);
+	if (dcBits) writer.put(valueBits(diff, dcBits), dcBits);
+
+	int run = 0;
+	for (int k = 1; k < 64; ++k) {
+		const int value = coefficients[kZigZag[k]];
+		if (value == 0) {
+			++run;
+			continue;
+		}
+		while (run > 15) {
+			writer.put(acTable.code[0xF0], acTable.length[0xF0]);
+			run -= 16;
+		}
+		const int bits = category(value);
+		const int symbol = (run << 4) | bits;
+		writer.put(acTable.code[symbol], acTable.length[symbol]);
+		writer.put(valueBits(value, bits), bits);
+		run = 0;
+	}
+	if (run > 0) writer.put(acTable.code[0x00], acTable.length[0x00]);
+}
+
+void marker(std::vector<uint8_t>& out, uint8_t code, size_t length) {
+	out.insert(out.end(), { 0xFF, code, uint8_t((length + 2) >> 8), uint8_t(length + 2) });
+}
+
+void huffmanSegment(std::vector<uint8_t>& out, uint8_t classAndId, const uint8_t bits[16], const uint8_t* values, size_t count) {
+	out.push_back(classAndId);
+	out.insert(out.end(), bits, bits + 16);
+	out.insert(out.end(), values, values + count);
+}
+
+} // namespace
+
+bool encodeJpeg(const uint8_t* rgb, size_t rowBytes, const JpegInfo& info, std::vector<uint8_t>& out) {
+	out.clear();
+	if (!rgb || info.width <= 0 || info.height <= 0 || info.width > 65535 || info.height > 65535) return false;
+	const Tables& t = tables();
+	uint8_t lumaQuant[64], chromaQuant[64];
+	scaleQuant(kLumaQuant, info.quality, lumaQuant);
+	scaleQuant(kChromaQuant, info.quality, chromaQuant);
+	const int sub = info.subsampleChroma ? 2 : 1;
+
+	out.reserve(size_t(info.width) * size_t(info.height) / 4 + 1024);
+	out.insert(out.end(), { 0xFF, 0xD8 });
+	// JFIF 1.01, square pixels.
+	marker(out, 0xE0, 14);
+	out.insert(out.end(), { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 });
+	marker(out, 0xDB, 2 * 65);
+	out.push_back(0);
+	for (int k = 0; k < 64; ++k) out.push_back(lumaQuant[kZigZag[k]]);
+	out.push_back(1);
+	for (int k = 0; k < 64; ++k) out.push_back(chromaQuant[kZigZag[k]]);
+	marker(out, 0xC0, 15);
+	out.insert(out.end(), { 8, uint8_t(info.height >> 8), uint8_t(info.height), uint8_t(info.width >> 8), uint8_t(info.width), 3,
+							1, uint8_t((sub << 4) | sub), 0, 2, 0x11, 1, 3, 0x11, 1 });
+	marker(out, 0xC4, 4 * 17 + 12 + 12 + 162 + 162);
+	huffmanSegment(out, 0x00, kDcLumaBits, kDcValues, 12);
+	huffmanSegment(out, 0x10, kAcLumaBits, kAcLumaValues, 162);
+	huffmanSegment(out, 0x01, kDcChromaBits, kDcValues, 12);
+	huffmanSegment(out, 0x11, kAcChromaBits, kAcChromaValues, 162);
+	marker(out, 0xDA, 10);
+	out.insert(out.end(), { 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0 });
+
+	// One MCU at a time: sub² luma blocks, then one block each of Cb and Cr averaged over sub².
+	const int mcu = 8 * sub;
+	BitWriter writer(out);
+	int dcY = 0, dcCb = 0, dcCr = 0;
+	float y[16 * 16], cb[16 * 16], cr[16 * 16], block[64];
+	for (int my = 0; my < info.height; my += mcu) {
+		for (int mx = 0; mx < info.width; mx += mcu) {
+			for (int j = 0; j < mcu; ++j) {
+				const uint8_t* row = rgb + size_t(std::min(my + j, info.height - 1)) * rowBytes;
+				for (int i = 0; i < mcu; ++i) {
+					const uint8_t* p = row + size_t(std::min(mx + i, info.width - 1)) * 3;
+					const float r = p[0], g = p[1], b = p[2];
+					y[j * mcu + i] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+					cb[j * mcu + i] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+					cr[j * mcu + i] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+				}
+			}
+			for (int by = 0; by < sub; ++by) {
+				for (int bx = 0; bx < sub; ++bx) {
+					for (int j = 0; j < 8; ++j) {
+						for (int i = 0; i < 8; ++i) block[j * 8 + i] = y[(by * 8 + j) * mcu + bx * 8 + i];
+					}
+					encodeBlock(writer, block, lumaQuant, t.dcLuma, t.acLuma, dcY);
+				}
+			}
+			const float norm = 1.0f / float(sub * sub);
+			for (float* plane : { cb, cr }) {
+				for (int j = 0; j < 8; ++j) {
+					for (int i = 0; i < 8; ++i) {
+						float sum = 0.0f;
+						for (int dy = 0; dy < sub; ++dy) {
+							for (int dx = 0; dx < sub; ++dx) sum += plane[(j * sub + dy) * mcu + i * sub + dx];
+						}
+						block[j * 8 + i] = sum * norm;
+					}
+				}
+				encodeBlock(writer, block, chromaQuant, t.dcChroma, t.acChroma, plane == cb ? dcCb : dcCr);
+			}
+		}
+	}
+	writer.flush();
+	out.insert(out.end(), { 0xFF, 0xD9 });
+	return true;
+}
+
+bool writeJpeg(const std::string& path, const uint8_t* rgb, size_t rowBytes, const JpegInfo& info) {
+	std::vector<uint8_t> bytes;
+	if (!encodeJpeg(rgb, rowBytes, info, bytes)) return false;
+	AtomicFileWriter file(path);
+	return file.valid() && file.write(bytes.data(), bytes.size()) && file.commit();
+}
+
+} // namespace forge
@@ -0,0 +1,43 @@
+//
+//  JpegWriter.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace forge {
+
+/*
+ Baseline JPEG encoder for thumbnails.
+
+ Thumbnails are small (a 500 px long edge) and made by the thousand on import, one per worker,
+ so what matters is that an encode is cheap and needs no shared state, not that it squeezes out
+ the last few percent. This writes what every decoder reads:
+ - JFIF, 8-bit YCbCr (BT.601 full range), chroma 2×2 subsampled or not;
+ - the example quantisation tables of the standard (Annex K), scaled by quality the way libjpeg
+   does, and its example Huffman tables, so nothing is gathered per image;
+ - a separable float DCT per 8×8 block; edges are padded by repeating the last row and column.
+ The pixels are taken as already display-encoded; no colour profile is embedded.
+ */
+
+struct JpegInfo {
+	int width = 0, height = 0;
+	int quality = 85;                   // 1...100, as libjpeg
+	bool subsampleChroma = true;        // 4:2:0; false: 4:4:4
+};
+
+// JPEG of `info.width` × `info.height` 8-bit RGB pixels, rows `rowBytes` apart, into `out`
+// (replacing its contents). False for an empty image.
+bool encodeJpeg(const uint8_t* rgb, size_t rowBytes, const JpegInfo& info, std::vector<uint8_t>& out);
+
+// The same, written atomically to `path`.
+bool writeJpeg(const std::string& path, const uint8_t* rgb, size_t rowBytes, const JpegInfo& info);
+
+} // namespace forge
@@ -0,0 +1,610 @@
+//
+//  TiffWriter.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "TiffWriter.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <zlib.h>
+
+namespace forge {
+
+namespace {
+
+constexpr uint64_t kClassicLimit = 0xFFFFFFFFull;
+
+int typeSize(uint16_t type) {
+	switch (type) {
+	case 3: case 8: return 2;
+	case 4: case 9: case 11: case 13: return 4;
+	case 5: case 10: case 12: case 16: case 17: case 18: return 8;
+	default: return 1;
+	}
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+	uint8_t bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));   // little-endian host
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+TiffTag makeTag(uint16_t tag, uint16_t type, const std::vector<T>& values) {
+	TiffTag t;
+	t.tag = tag;
+	t.type = type;
+	t.count = values.size();
+	for (T v : values) put(t.value, v);
+	return t;
+}
+
+TiffTag bytesTag(uint16_t tag, uint16_t type, const std::vector<uint8_t>& bytes) {
+	TiffTag t;
+	t.tag = tag;
+	t.type = type;
+	t.count = bytes.size();
+	t.value = bytes;
+	return t;
+}
+
+TiffTag rationalTag(uint16_t tag, double value) {
+	TiffTag t = makeTag<uint32_t>(tag, kTiffRational, { uint32_t(std::lround(value * 100.0)), 100u });
+	t.count = 1;
+	return t;
+}
+
+// Sample-wise differences along each row, last to first so every difference uses the original
+// left neighbour.
+template <typename T>
+void predict(T* samples, int width, int rows, int channels) {
+	const size_t rowSamples = size_t(width) * size_t(channels);
+	for (int y = 0; y < rows; ++y) {
+		T* row = samples + size_t(y) * rowSamples;
+		for (size_t i = rowSamples; i-- > size_t(channels);) row[i] = T(row[i] - row[i - size_t(channels)]);
+	}
+}
+
+// MARK: - LZW
+
+class CodeWriter {
+public:
+	explicit CodeWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+	void put(uint32_t code, int bits) {
+		acc_ = (acc_ << bits) | code;
+		pending_ += bits;
+		while (pending_ >= 8) {
+			pending_ -= 8;
+			out_.push_back(uint8_t(acc_ >> pending_));
+		}
+	}
+
+	void flush() {
+		if (pending_ > 0) out_.push_back(uint8_t(acc_ << (8 - pending_)));
+		pending_ = 0;
+	}
+
+private:
+	std::vector<uint8_t>& out_;
+	uint32_t acc_ = 0;
+	int pending_ = 0;
+};
+
+constexpr uint32_t kClear = 256, kEnd = 257, kFirst = 258, kMaxCode = 4095;
+constexpr int kHashBits = 13;
+
+} // namespace
+
+void lzwEncode(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+	CodeWriter codes(out);
+	// (prefix code << 8 | byte) → code, open addressing; at most 4094 entries in 8192 slots.
+	std::vector<int32_t> keys(size_t(1) << kHashBits), values(size_t(1) << kHashBits);
+	std::fill(keys.begin(), keys.end(), -1);
+	int bits = 9;
+	uint32_t next = kFirst;
+	codes.put(kClear, bits);
+	if (size == 0) {
+		codes.put(kEnd, bits);
+		codes.flush();
+		return;
+	}
+
+	// After a code is added: a full table is cleared, otherwise the width grows once the next
+	// code no longer fits (the reader, one code behind, switches a code earlier).
+	auto added = [&] {
+		++next;
+		if (next == kMaxCode - 1) {
+			codes.put(kClear, bits);
+			std::fill(keys.begin(), keys.end(), -1);
+			next = kFirst;
+			bits = 9;
+		} else if (next > (1u << bits) - 1) {
+			++bits;
+		}
+	};
+
+	uint32_t prefix = src[0];
+	for (size_t i = 1; i < size; ++i) {
+		const int32_t key = int32_t(prefix << 8 | src[i]);
+		size_t slot = (uint32_t(key) * 2654435761u) >> (32 - kHashBits);
+		while (keys[slot] >= 0 && keys[slot] != key) slot = (slot + 1) & ((size_t(1) << kHashBits) - 1);
+		if (keys[slot] == key) {
+			prefix = uint32_t(values[slot]);
+			continue;
+		}
+		codes.put(prefix, bits);
+		keys[slot] = key;
+		values[slot] = int32_t(next);
+		added();
+		prefix = src[i];
+	}
+	codes.put(prefix, bits);
+	added();
+	codes.put(kEnd, bits);
+	codes.flush();
+}
+
+void encodeTiffBlock(uint8_t* samples, int width, int rows, const TiffInfo& info, std::vector<uint8_t>& out) {
+	const size_t bytes = size_t(width) * size_t(rows) * size_t(info.channels) * size_t(info.bitsPerSample / 8);
+	out.clear();
+	if (info.compression == TiffCompression::None) {
+		out.assign(samples, samples + bytes);
+		return;
+	}
+	if (info.predictor) {
+		if (info.bitsPerSample == 16) predict(reinterpret_cast<uint16_t*>(samples), width, rows, info.channels);
+		else predict(samples, width, rows, info.channels);
+	}
+	if (info.compression == TiffCompression::LZW) {
+		lzwEncode(samples, bytes, out);
+		return;
+	}
+	uLongf bound = compressBound(uLong(bytes));
+	out.resize(bound);
+	if (compress2(out.data(), &bound, samples, uLong(bytes), std::clamp(info.deflateLevel, 1, 9)) != Z_OK) bound = 0;
+	out.resize(bound);
+}
+
+// MARK: - Writer
+
+TiffWriter::TiffWriter(std::string path, const TiffInfo& info) : info_(info), file_(std::move(path)) {
+	const bool shape = info_.width > 0 && info_.height > 0 && (info_.bitsPerSample == 8 || info_.bitsPerSample == 16)
+		&& (info_.channels == 1 || info_.channels == 3 || info_.channels == 4) && info_.blockSize > 0
+		&& (!info_.tiled || info_.blockSize % 16 == 0);
+	if (!shape || !file_.valid()) {
+		ok_ = false;
+		return;
+	}
+	rowBytes_ = size_t(info_.width) * size_t(info_.channels) * size_t(info_.bitsPerSample / 8);
+	const uint64_t raw = uint64_t(rowBytes_) * uint64_t(info_.height);
+	big_ = info_.bigTiff || raw + raw / 64 + (uint64_t(1) << 24) > kClassicLimit;
+
+	bandRows_ = bandRowsFor(info_);
+
+	// Header; the first directory's offset is patched in by finish().
+	std::vector<uint8_t> header = { 'I', 'I' };
+	if (big_) {
+		put<uint16_t>(header, 43);
+		put<uint16_t>(header, 8);
+		put<uint16_t>(header, 0);
+		put<uint64_t>(header, 0);
+	} else {
+		put<uint16_t>(header, 42);
+		put<uint32_t>(header, 0);
+	}
+	ok_ = file_.write(header.data(), header.size());
+}
+
+void TiffWriter::addTag(TiffDirectory directory, TiffTag tag) {
+	tags_[size_t(directory)].push_back(std::move(tag));
+}
+
+bool TiffWriter::appendRows(const void* pixels, size_t rowBytes, int rows, int inputChannels) {
+	if (!valid() || finished_ || !pixels || inputChannels < info_.channels) return false;
+	rows = std::min(rows, info_.height - rowsWritten_ - bandFilled_);
+	if (band_.empty()) band_.resize(rowBytes_ * size_t(bandRows_));
+	const size_t bytesPerSample = size_t(info_.bitsPerSample / 8);
+	const auto* src = static_cast<const uint8_t*>(pixels);
+	for (int r = 0; r < rows; ++r) {
+		const uint8_t* in = src + size_t(r) * rowBytes;
+		uint8_t* out = &band_[size_t(bandFilled_) * rowBytes_];
+		if (inputChannels == info_.channels) {
+			std::memcpy(out, in, rowBytes_);
+		} else {
+			const size_t pixelIn = size_t(inputChannels) * bytesPerSample, pixelOut = size_t(info_.channels) * bytesPerSample;
+			for (int x = 0; x < info_.width; ++x) std::memcpy(out + size_t(x) * pixelOut, in + size_t(x) * pixelIn, pixelOut);
+		}
+		if (++bandFilled_ == bandRows_ || rowsWritten_ + bandFilled_ == info_.height) {
+			if (!flushBand()) return false;
+		}
+	}
+	return valid();
+}
+
+int TiffWriter::bandRowsFor(const TiffInfo& info) {
+	if (info.blockSize <= 0 || info.height <= 0) return 0;
+	if (info.tiled) return info.blockSize;
+	const int strips = (info.height + info.blockSize - 1) / info.blockSize;
+	return info.blockSize * std::clamp(int(workerCount()), 1, strips);
+}
+
+size_t TiffWriter::encodeBand(const TiffInfo& info, uint8_t* band, int rows, std::vector<std::vector<uint8_t>>& blocks) {
+	const int block = info.blockSize;
+	const size_t bytesPerPixel = size_t(info.channels) * size_t(info.bitsPerSample / 8);
+	const size_t rowBytes = size_t(info.width) * bytesPerPixel;
+	const size_t count = info.tiled ? size_t((info.width + block - 1) / block) : size_t((rows + block - 1) / block);
+	if (blocks.size() < count) blocks.resize(count);
+
+	parallelFor(count, [&](size_t b) {
+		if (!info.tiled) {
+			const int y0 = int(b) * block;
+			encodeTiffBlock(band + size_t(y0) * rowBytes, info.width, std::min(block, rows - y0), info, blocks[b]);
+			return;
+		}
+		// A full tile, the last column and row repeated past the image's edge.
+		std::vector<uint8_t> tile(size_t(block) * size_t(block) * bytesPerPixel);
+		const int x0 = int(b) * block, columns = std::min(block, info.width - x0);
+		for (int y = 0; y < block; ++y) {
+			const uint8_t* in = band + size_t(std::min(y, rows - 1)) * rowBytes + size_t(x0) * bytesPerPixel;
+			uint8_t* out = &tile[size_t(y) * size_t(block) * bytesPerPixel];
+			std::memcpy(out, in, size_t(columns) * bytesPerPixel);
+			for (int x = columns; x < block; ++x) std::memcpy(out + size_t(x) * bytesPerPixel, in + size_t(columns - 1) * bytesPerPixel, bytesPerPixel);
+		}
+		encodeTiffBlock(tile.data(), block, block, info, blocks[b]);
+	});
+	return count;
+}
+
+bool TiffWriter::appendBlocks(const std::vector<std::vector<uint8_t>>& blocks, size_t count, int rows) {
+	if (!valid() || finished_ || bandFilled_ != 0 || rows <= 0 || rowsWritten_ + rows > info_.height) return false;
+	for (size_t b = 0; b < count && ok_; ++b) {
+		if (blocks[b].empty() || (!big_ && file_.offset() + blocks[b].size() > kClassicLimit)) {
+			ok_ = false;
+			break;
+		}
+		offsets_.push_back(file_.offset());
+		byteCounts_.push_back(blocks[b].size());
+		ok_ = file_.write(blocks[b].data(), blocks[b].size());
+	}
+	rowsWritten_ += rows;
+	return ok_;
+}
+
+bool TiffWriter::flushBand() {
+	const int rows = bandFilled_;
+	const size_t count = encodeBand(info_, band_.data(), rows, encoded_);
+	bandFilled_ = 0;
+	return appendBlocks(encoded_, count, rows);
+}
+
+bool TiffWriter::writeDirectories() {
+	const uint16_t offsetType = big_ ? kTiffLong8 : kTiffLong;
+	auto offsetsTag = [&](uint16_t tag, const std::vector<uint64_t>& values) {
+		if (big_) return makeTag<uint64_t>(tag, kTiffLong8, values);
+		return makeTag<uint32_t>(tag, kTiffLong, std::vector<uint32_t>(values.begin(), values.end()));
+	};
+
+	// Serialises a directory at `at`: entries, then the values that don't fit in an entry.
+	auto directory = [&](std::vector<TiffTag> tags, uint64_t at) {
+		std::stable_sort(tags.begin(), tags.end(), [](const TiffTag& a, const TiffTag& b) { return a.tag < b.tag; });
+		tags.erase(std::unique(tags.begin(), tags.end(), [](const TiffTag& a, const TiffTag& b) { return a.tag == b.tag; }), tags.end());
+		const size_t inline_ = big_ ? 8 : 4;
+		const size_t entries = big_ ? 8 + tags.size() * 20 + 8 : 2 + tags.size() * 12 + 4;
+		std::vector<uint8_t> ifd, values;
+		if (big_) put<uint64_t>(ifd, tags.size());
+		else put<uint16_t>(ifd, uint16_t(tags.size()));
+		for (const TiffTag& t : tags) {
+			put<uint16_t>(ifd, t.tag);
+			put<uint16_t>(ifd, t.type);
+			if (big_) put<uint64_t>(ifd, t.count);
+			else put<uint32_t>(ifd, uint32_t(t.count));
+			std::vector<uint8_t> field(inline_, 0);
+			if (t.value.size() <= inline_) {
+				std::copy(t.value.begin(), t.value.end(), field.begin());
+			} else {
+				if (values.size() % 2) values.push_back(0);
+				const uint64_t offset = at + entries + values.size();
+				std::memcpy(field.data(), &offset, inline_);
+				values.insert(values.end(), t.value.begin(), t.value.end());
+			}
+			ifd.insert(ifd.end(), field.begin(), field.end());
+		}
+		if (big_) put<uint64_t>(ifd, 0);
+		else put<uint32_t>(ifd, 0);
+		ifd.insert(ifd.end(), values.begin(), values.end());
+		return ifd;
+	};
+	auto append = [&](const std::vector<uint8_t>& bytes) {
+		if (!big_ && file_.offset() + bytes.size() > kClassicLimit) return false;
+		return file_.write(bytes.data(), bytes.size());
+	};
+	auto align = [&] {
+		const uint8_t zero[8] = {};
+		const uint64_t pad = (big_ ? 8 : 2) - file_.offset() % (big_ ? 8 : 2);
+		return pad == (big_ ? 8u : 2u) || file_.write(zero, size_t(pad));
+	};
+
+	std::vector<TiffTag> image;
+	auto sub = [&](TiffDirectory which, uint16_t pointerTag) {
+		if (tags_[size_t(which)].empty()) return true;
+		if (!align()) return false;
+		const uint64_t at = file_.offset();
+		if (!append(directory(tags_[size_t(which)], at))) return false;
+		image.push_back(big_ ? makeTag<uint64_t>(pointerTag, offsetType, { at })
+							 : makeTag<uint32_t>(pointerTag, offsetType, { uint32_t(at) }));
+		return true;
+	};
+	if (!sub(TiffDirectory::Exif, 34665) || !sub(TiffDirectory::Gps, 34853)) return false;
+
+	const uint16_t compression = info_.compression == TiffCompression::None ? 1 : info_.compression == TiffCompression::LZW ? 5 : 8;
+	image.push_back(makeTag<uint32_t>(256, kTiffLong, { uint32_t(info_.width) }));
+	image.push_back(makeTag<uint32_t>(257, kTiffLong, { uint32_t(info_.height) }));
+	image.push_back(makeTag<uint16_t>(258, kTiffShort, std::vector<uint16_t>(size_t(info_.channels), uint16_t(info_.bitsPerSample))));
+	image.push_back(makeTag<uint16_t>(259, kTiffShort, { compression }));
+	image.push_back(makeTag<uint16_t>(262, kTiffShort, { uint16_t(info_.channels == 1 ? 1 : 2) }));
+	image.push_back(makeTag<uint16_t>(277, kTiffShort, { uint16_t(info_.channels) }));
+	image.push_back(rationalTag(282, info_.dpi));
+	image.push_back(rationalTag(283, info_.dpi));
+	image.push_back(makeTag<uint16_t>(284, kTiffShort, { 1 }));
+	image.push_back(makeTag<uint16_t>(296, kTiffShort, { 2 }));
+	if (info_.tiled) {
+		image.push_back(makeTag<uint32_t>(322, kTiffLong, { uint32_t(info_.blockSize) }));
+		image.push_back(makeTag<uint32_t>(323, kTiffLong, { uint32_t(info_.blockSize) }));
+		image.push_back(offsetsTag(324, offsets_));
+		image.push_back(offsetsTag(325, byteCounts_));
+	} else {
+		image.push_back(offsetsTag(273, offsets_));
+		image.push_back(makeTag<uint32_t>(278, kTiffLong, { uint32_t(info_.blockSize) }));
+		image.push_back(offsetsTag(279, byteCounts_));
+	}
+	if (info_.predictor && info_.compression != TiffCompression::None) image.push_back(makeTag<uint16_t>(317, kTiffShort, { 2 }));
+	if (info_.channels == 4) image.push_back(makeTag<uint16_t>(338, kTiffShort, { 2 }));
+	image.push_back(makeTag<uint16_t>(339, kTiffShort, std::vector<uint16_t>(size_t(info_.channels), 1)));
+	if (!iptc_.empty()) image.push_back(bytesTag(33723, kTiffUndefined, iptc_));
+	if (!icc_.empty()) image.push_back(bytesTag(34675, kTiffUndefined, icc_));
+	// Ours first, so the stable sort and unique keep them over the caller's.
+	image.insert(image.end(), tags_[size_t(TiffDirectory::Image)].begin(), tags_[size_t(TiffDirectory::Image)].end());
+
+	if (!align()) return false;
+	const uint64_t at = file_.offset();
+	if (!append(directory(std::move(image), at))) return false;
+	return big_ ? file_.writeAt(8, &at, 8) : file_.writeAt(4, &at, 4);
+}
+
+bool TiffWriter::finish() {
+	if (finished_) return false;
+	finished_ = true;
+	if (!valid() || rowsWritten_ != info_.height || !writeDirectories()) {
+		file_.abort();
+		ok_ = false;
+		return false;
+	}
+	ok_ = file_.commit();
+	return ok_;
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+template <typename T>
+T get(const uint8_t* p) {
+	T v;
+	std::memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+// TIFF LZW, for reading back what lzwEncode wrote.
+bool lzwDecode(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+	std::vector<uint32_t> prefix(4096);
+	std::vector<uint8_t> suffix(4096), first(4096);
+	std::vector<uint8_t> stack;
+	for (uint32_t i = 0; i < 256; ++i) suffix[i] = first[i] = uint8_t(i);
+	uint32_t next = kFirst, previous = kClear;
+	int bits = 9;
+	uint64_t acc = 0;
+	int available = 0;
+	size_t at = 0;
+	auto emit = [&](uint32_t code) {
+		stack.clear();
+		while (code >= kFirst) {
+			stack.push_back(suffix[code]);
+			code = prefix[code];
+		}
+		stack.push_back(uint8_t(code));
+		out.insert(out.end(), stack.rbegin(), stack.rend());
+	};
+	for (;;) {
+		while (available < bits) {
+			if (at == size) return false;
+			acc = (acc << 8) | src[at++];
+			available += 8;
+		}
+		available -= bits;
+		const uint32_t code = uint32_t(acc >> available) & ((1u << bits) - 1);
+		if (code == kEnd) return true;
+		if (code == kClear) {
+			next = kFirst;
+			bits = 9;
+			previous = kClear;
+			continue;
+		}
+		if (previous == kClear) {
+			if (code > 255) return false;
+			emit(code);
+			previous = code;
+			continue;
+		}
+		if (code > next || next > kMaxCode) return false;
+		prefix[next] = previous;
+		first[next] = first[previous];
+		suffix[next] = code == next ? first[previous] : first[code];
+		++next;
+		emit(code);
+		previous = code;
+		if (next == (1u << bits) - 1 && bits < 12) ++bits;
+	}
+}
+
+// Reads back a file this writer made and compares its samples with `expected`.
+bool matches(const std::string& path, const std::vector<uint16_t>& expected, int width, int height) {
+	MappedFile file(path);
+	if (!file.valid() || file.size() < 16) return false;
+	const uint8_t* d = file.data();
+	const bool big = get<uint16_t>(d + 2) == 43;
+	uint64_t ifd = big ? get<uint64_t>(d + 8) : get<uint32_t>(d + 4);
+	const uint64_t count = big ? get<uint64_t>(d + ifd) : get<uint16_t>(d + ifd);
+	const uint8_t* entry = d + ifd + (big ? 8 : 2);
+
+	std::vector<uint64_t> offsets, counts;
+	uint32_t tileSize = 0, rowsPerStrip = 0, compression = 1, predictor = 1;
+	for (uint64_t i = 0; i < count; ++i, entry += big ? 20 : 12) {
+		const uint16_t tag = get<uint16_t>(entry), type = get<uint16_t>(entry + 2);
+		const uint64_t n = big ? get<uint64_t>(entry + 4) : get<uint32_t>(entry + 4);
+		const uint8_t* field = entry + (big ? 12 : 8);
+		const size_t bytes = size_t(n) * size_t(typeSize(type));
+		const uint8_t* value = bytes <= (big ? 8u : 4u) ? field : d + (big ? get<uint64_t>(field) : get<uint32_t>(field));
+		auto scalar = [&](uint64_t k) -> uint64_t {
+			return type == kTiffShort ? get<uint16_t>(value + 2 * k) : type == kTiffLong ? get<uint32_t>(value + 4 * k) : get<uint64_t>(value + 8 * k);
+		};
+		std::vector<uint64_t>* list = tag == 273 || tag == 324 ? &offsets : tag == 279 || tag == 325 ? &counts : nullptr;
+		if (list) for (uint64_t k = 0; k < n; ++k) list->push_back(scalar(k));
+		if (tag == 322) tileSize = uint32_t(scalar(0));
+		if (tag == 278) rowsPerStrip = uint32_t(scalar(0));
+		if (tag == 259) compression = uint32_t(scalar(0));
+		if (tag == 317) predictor = uint32_t(scalar(0));
+	}
+	if (offsets.empty() || offsets.size() != counts.size()) return false;
+
+	const int blockW = tileSize ? int(tileSize) : width, blockH = tileSize ? int(tileSize) : int(rowsPerStrip);
+	const int across = tileSize ? (width + blockW - 1) / blockW : 1;
+	std::vector<uint8_t> raw;
+	for (size_t b = 0; b < offsets.size(); ++b) {
+		const int bx = int(b) % across * blockW, by = int(b) / across * blockH;
+		const int rows = tileSize ? blockH : std::min(blockH, height - by);
+		const size_t bytes = size_t(blockW) * size_t(rows) * 6;
+		raw.clear();
+		if (compression == 8) {
+			raw.resize(bytes);
+			uLongf length = uLongf(bytes);
+			if (uncompress(raw.data(), &length, d + offsets[b], uLong(counts[b])) != Z_OK || length != bytes) return false;
+		} else if (compression == 5) {
+			if (!lzwDecode(d + offsets[b], size_t(counts[b]), raw) || raw.size() != bytes) return false;
+		} else {
+			raw.assign(d + offsets[b], d + offsets[b] + counts[b]);
+			if (raw.size() != bytes) return false;
+		}
+		auto* s = reinterpret_cast<uint16_t*>(raw.data());
+		for (int y = 0; y < rows; ++y) {
+			uint16_t* row = s + size_t(y) * size_t(blockW) * 3;
+			if (predictor == 2) for (size_t i = 3; i < size_t(blockW) * 3; ++i) row[i] = uint16_t(row[i] + row[i - 3]);
+			for (int x = 0; x < blockW && bx + x < width && by + y < height; ++x) {
+				if (std::memcmp(&row[size_t(x) * 3], &expected[(size_t(by + y) * size_t(width) + size_t(bx + x)) * 4], 6) != 0) return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TiffWriterBenchmark benchmarkTiffWriter(int width, int height, const std::string& directory) {
+	using Clock = std::chrono::steady_clock;
+	TiffWriterBenchmark result;
+	if (width <= 0 || height <= 0) return result;
+
+	// 16-bit RGBA, as saveImage renders it: smooth gradients with a little noise.
+	std::vector<uint16_t> pixels(size_t(width) * size_t(height) * 4);
+	parallelFor(size_t(height), [&](size_t y) {
+		uint32_t state = uint32_t(y) * 2654435761u + 1u;
+		for (int x = 0; x < width; ++x) {
+			state = state * 1664525u + 1013904223u;
+			const int noise = int(state >> 26) - 32;
+			uint16_t* p = &pixels[(y * size_t(width) + size_t(x)) * 4];
+			p[0] = uint16_t(std::clamp(int(65535.0 * x / width) + noise, 0, 65535));
+			p[1] = uint16_t(std::clamp(int(65535.0 * y / height) + noise, 0, 65535));
+			p[2] = uint16_t(std::clamp(int(32768.0 + 20000.0 * std::sin(0.01 * (x + y))) + noise, 0, 65535));
+			p[3] = 65535;
+		}
+	});
+	const size_t rowBytes = size_t(width) * 8;
+	const double megabytes = double(width) * double(height) * 6.0 / 1048576.0;
+	result.megabytes = megabytes;
+
+	struct Run { TiffCompression compression; bool tiled; bool big; double* speed; double* ratio; };
+	double uncompressedRatio = 0.0, tiledSpeed = 0.0, tiledRatio = 0.0;
+	const Run runs[] = {
+		{ TiffCompression::None, false, true, &result.uncompressedMegabytesPerSecond, &uncompressedRatio },
+		{ TiffCompression::Deflate, false, false, &result.deflateMegabytesPerSecond, &result.deflateRatio },
+		{ TiffCompression::LZW, false, false, &result.lzwMegabytesPerSecond, &result.lzwRatio },
+		{ TiffCompression::Deflate, true, false, &tiledSpeed, &tiledRatio },
+	};
+	bool exact = true;
+	int index = 0;
+	for (const Run& run : runs) {
+		const std::string path = directory + "/forge_tiff_benchmark_" + std::to_string(index++) + ".tif";
+		TiffInfo info;
+		info.width = width;
+		info.height = height;
+		info.compression = run.compression;
+		info.tiled = run.tiled;
+		info.blockSize = run.tiled ? 256 : 64;
+		info.bigTiff = run.big;
+		const auto t0 = Clock::now();
+		TiffWriter writer(path, info);
+		writer.addTag(TiffDirectory::Image, bytesTag(305, kTiffAscii, { 'C', 'o', 'l', 'o', 'r', 'F', 'o', 'r', 'g', 'e', 0 }));
+		writer.addTag(TiffDirectory::Exif, makeTag<uint16_t>(34855, kTiffShort, { 400 }));
+		for (int y = 0; y < height; y += writer.bandRows()) {
+			writer.appendRows(&pixels[size_t(y) * size_t(width) * 4], rowBytes, std::min(writer.bandRows(), height - y), 4);
+		}
+		result.bandMegabytes = std::max(result.bandMegabytes, double(writer.bandBytes()) / 1048576.0);
+		const uint64_t size = writer.bytesWritten();
+		const bool written = writer.finish();
+		const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+		*run.speed = megabytes / std::max(seconds, 1e-9);
+		*run.ratio = double(size) / (megabytes * 1048576.0);
+		exact = exact && written && matches(path, pixels, width, height);
+		std::remove(path.c_str());
+	}
+
+	// The deflate blocks on this thread alone, for the scaling.
+	TiffInfo info;
+	info.width = width;
+	info.height = height;
+	std::vector<uint8_t> strip(size_t(width) * 64 * 6), out;
+	const auto t0 = Clock::now();
+	for (int y = 0; y < height; y += 64) {
+		const int rows = std::min(64, height - y);
+		for (int r = 0; r < rows; ++r) {
+			for (int x = 0; x < width; ++x) std::memcpy(&strip[(size_t(r) * size_t(width) + size_t(x)) * 6], &pixels[(size_t(y + r) * size_t(width) + size_t(x)) * 4], 6);
+		}
+		encodeTiffBlock(strip.data(), width, rows, info, out);
+	}
+	result.deflateSerialMegabytesPerSecond = megabytes / std::max(std::chrono::duration<double>(Clock::now() - t0).count(), 1e-9);
+	result.exact = exact;
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	ForgeTiffWriterBenchmark ForgeBenchmarkTiffWriter(int32_t width, int32_t height, const char* directory) {
+		const forge::TiffWriterBenchmark b = forge::benchmarkTiffWriter(width, height, directory ? directory : ".");
+		return { b.megabytes, b.uncompressedMegabytesPerSecond, b.deflateMegabytesPerSecond, b.deflateSerialMegabytesPerSecond,
+				 b.lzwMegabytesPerSecond, b.deflateRatio, b.lzwRatio, b.bandMegabytes, b.exact };
+	}
+}
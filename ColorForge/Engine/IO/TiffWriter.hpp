@@ -0,0 +1,150 @@
+//
+//  TiffWriter.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FileIO.hpp"
+
+namespace forge {
+
+/*
+ Streaming TIFF / BigTIFF writer.
+
+ saveImage rendered the whole frame to a CGImage, drew it again into a 16-bit CGContext and
+ let ImageIO encode the file into memory on one thread before writing it: three full-frame
+ copies and a serial encode. Here rows are handed over as they are rendered and go out in
+ bands:
+ - a band is a few strips (RowsPerStrip rows each, one per worker) or one row of tiles;
+ - its blocks are compressed in parallel (deflate through zlib, or TIFF LZW), each after the
+   horizontal predictor, then appended to the file in order;
+ - the directories (image, EXIF, GPS) and every out-of-line value go after the pixel data at
+   finish(), and the header is patched to point at them.
+ So the writer holds one band and its compressed blocks, never the image. The file is written
+ beside its destination and renamed into place on finish() (AtomicFileWriter).
+
+ Output is little-endian, chunky, unsigned 8- or 16-bit samples. BigTIFF (64-bit offsets) is
+ used when asked, or when the uncompressed image alone could pass 4 GB.
+ */
+
+enum class TiffCompression : uint8_t { None, Deflate, LZW };
+
+// One directory entry: `value` holds `count` values of TIFF field type `type`, little-endian.
+struct TiffTag {
+	uint16_t tag = 0;
+	uint16_t type = 0;
+	uint64_t count = 0;
+	std::vector<uint8_t> value;
+};
+
+enum class TiffDirectory : uint8_t { Image, Exif, Gps };
+
+struct TiffInfo {
+	int width = 0, height = 0;
+	int channels = 3;                   // 1 grey, 3 RGB, 4 RGB + unassociated alpha
+	int bitsPerSample = 16;             // 8 or 16
+	TiffCompression compression = TiffCompression::Deflate;
+	bool predictor = true;              // horizontal differencing before compression
+	bool tiled = false;                 // tiles of blockSize², otherwise strips of blockSize rows
+	int blockSize = 64;                 // tiles: a multiple of 16
+	int deflateLevel = 1;               // zlib's fastest: ~10% larger than level 6, four times faster
+	double dpi = 300.0;
+	bool bigTiff = false;
+};
+
+// Field types the writer itself uses.
+enum : uint16_t {
+	kTiffByte = 1, kTiffAscii = 2, kTiffShort = 3, kTiffLong = 4, kTiffRational = 5,
+	kTiffUndefined = 7, kTiffLong8 = 16,
+};
+
+// Compresses one block of packed samples (in place: the predictor overwrites `samples`) into
+// `out`, replacing its contents.
+void encodeTiffBlock(uint8_t* samples, int width, int rows, const TiffInfo& info, std::vector<uint8_t>& out);
+
+// TIFF LZW (MSB-first codes, early change), appended to `out`.
+void lzwEncode(const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+
+class TiffWriter {
+public:
+	TiffWriter(std::string path, const TiffInfo& info);
+
+	TiffWriter(const TiffWriter&) = delete;
+	TiffWriter& operator=(const TiffWriter&) = delete;
+
+	bool valid() const { return file_.valid() && ok_; }
+	bool bigTiff() const { return big_; }
+	// Rows per band: appending whole bands avoids a copy into the band buffer being split.
+	int bandRows() const { return bandRows_; }
+	int rowsWritten() const { return rowsWritten_; }
+	uint64_t bytesWritten() const { return file_.offset(); }
+	size_t bandBytes() const { return band_.size(); }   // once appendRows has been used
+
+	// Entries for the directories, written at finish(). Image tags the writer sets itself (size,
+	// layout, compression, resolution) take precedence over ones given here.
+	void addTag(TiffDirectory directory, TiffTag tag);
+	void setIccProfile(std::vector<uint8_t> profile) { icc_ = std::move(profile); }
+	void setIptc(std::vector<uint8_t> records) { iptc_ = std::move(records); }
+
+	// `rows` rows, top to bottom, of `inputChannels` samples per pixel at bitsPerSample. Samples
+	// past `channels` (a padding alpha, say) are dropped. False once the writer has failed.
+	bool appendRows(const void* pixels, size_t rowBytes, int rows, int inputChannels);
+
+	// Directories, header, rename into place. False (and no file) unless every row was given.
+	bool finish();
+
+	// The two halves of appending a band, for callers that run them on different threads
+	// (ExportPipeline). encodeBand compresses `rows` packed rows of `band` (overwriting them)
+	// into the first blocks of `blocks` and returns how many; appendBlocks writes them in order.
+	// A writer takes either appendRows or appendBlocks, not both.
+	static int bandRowsFor(const TiffInfo& info);
+	static size_t encodeBand(const TiffInfo& info, uint8_t* band, int rows, std::vector<std::vector<uint8_t>>& blocks);
+	bool appendBlocks(const std::vector<std::vector<uint8_t>>& blocks, size_t count, int rows);
+
+	const TiffInfo& info() const { return info_; }
+
+private:
+	bool flushBand();
+	bool writeDirectories();
+
+	TiffInfo info_;
+	AtomicFileWriter file_;
+	bool big_ = false;
+	bool ok_ = true;
+	bool finished_ = false;
+	int bandRows_ = 0;
+	int bandFilled_ = 0;
+	int rowsWritten_ = 0;
+	size_t rowBytes_ = 0;                         // packed
+	std::vector<uint8_t> band_;
+	std::vector<std::vector<uint8_t>> encoded_;   // per block of the band
+	std::vector<uint64_t> offsets_, byteCounts_;
+	std::vector<TiffTag> tags_[3];
+	std::vector<uint8_t> icc_, iptc_;
+};
+
+// MARK: - Benchmark
+
+struct TiffWriterBenchmark {
+	double megabytes = 0.0;                       // uncompressed samples
+	double uncompressedMegabytesPerSecond = 0.0;
+	double deflateMegabytesPerSecond = 0.0;
+	double deflateSerialMegabytesPerSecond = 0.0; // the same blocks on one thread
+	double lzwMegabytesPerSecond = 0.0;
+	double deflateRatio = 0.0;                    // file / uncompressed
+	double lzwRatio = 0.0;
+	double bandMegabytes = 0.0;                   // the writer's pixel memory
+	bool exact = false;                           // every file read back to the same samples
+};
+
+// Writes to and removes its files from `directory`.
+TiffWriterBenchmark benchmarkTiffWriter(int width, int height, const std::string& directory);
+
+} // namespace forge
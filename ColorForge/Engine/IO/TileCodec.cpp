@@ -0,0 +1,95 @@
+//
+//  TileCodec.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "TileCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+namespace forge {
+
+enum : uint8_t { kBlockRaw = 0, kBlockDeflate = 1 };
+
+void encodeHalfBlock(const half_t* src, int width, int height, int channels, std::vector<uint8_t>& out) {
+	const size_t count = size_t(width) * size_t(height) * size_t(channels);
+	const size_t rawBytes = count * sizeof(half_t);
+
+	// Delta along each row, per channel, then split into byte planes.
+	std::vector<uint8_t> planes(rawBytes);
+	uint8_t* lo = planes.data();
+	uint8_t* hi = planes.data() + count;
+	const size_t rowCount = size_t(width) * size_t(channels);
+	for (int y = 0; y < height; ++y) {
+		const half_t* row = src + size_t(y) * rowCount;
+		const size_t base = size_t(y) * rowCount;
+		for (size_t i = 0; i < rowCount; ++i) {
+			const uint16_t prev = i >= size_t(channels) ? row[i - size_t(channels)] : 0;
+			const uint16_t d = uint16_t(row[i] - prev);
+			lo[base + i] = uint8_t(d & 0xFF);
+			hi[base + i] = uint8_t(d >> 8);
+		}
+	}
+
+	uLongf bound = compressBound(uLong(rawBytes));
+	const size_t start = out.size();
+	out.resize(start + 1 + bound);
+	if (compress2(out.data() + start + 1, &bound, planes.data(), uLong(rawBytes), Z_BEST_SPEED) == Z_OK && bound < rawBytes) {
+		out[start] = kBlockDeflate;
+		out.resize(start + 1 + bound);
+		return;
+	}
+
+	out[start] = kBlockRaw;
+	out.resize(start + 1 + rawBytes);
+	std::memcpy(out.data() + start + 1, src, rawBytes);
+}
+
+bool decodeHalfBlock(const uint8_t* data, size_t size, int width, int height, int channels, half_t* dst) {
+	const size_t count = size_t(width) * size_t(height) * size_t(channels);
+	const size_t rawBytes = count * sizeof(half_t);
+	if (size < 1) return false;
+
+	if (data[0] == kBlockRaw) {
+		if (size - 1 != rawBytes) return false;
+		std::memcpy(dst, data + 1, rawBytes);
+		return true;
+	}
+	if (data[0] != kBlockDeflate) return false;
+
+	std::vector<uint8_t> planes(rawBytes);
+	uLongf length = uLongf(rawBytes);
+	if (uncompress(planes.data(), &length, data + 1, uLong(size - 1)) != Z_OK || length != rawBytes) return false;
+
+	const uint8_t* lo = planes.data();
+	const uint8_t* hi = planes.data() + count;
+	const size_t rowCount = size_t(width) * size_t(channels);
+	for (int y = 0; y < height; ++y) {
+		half_t* row = dst + size_t(y) * rowCount;
+		const size_t base = size_t(y) * rowCount;
+		for (size_t i = 0; i < rowCount; ++i) {
+			const uint16_t d = uint16_t(lo[base + i] | (uint16_t(hi[base + i]) << 8));
+			const uint16_t prev = i >= size_t(channels) ? row[i - size_t(channels)] : 0;
+			row[i] = uint16_t(prev + d);
+		}
+	}
+	return true;
+}
+
+uint32_t crc32Bytes(const void* data, size_t size) {
+	uLong crc = crc32(0L, Z_NULL, 0);
+	const auto* p = static_cast<const Bytef*>(data);
+	while (size > 0) {
+		const uInt chunk = uInt(std::min<size_t>(size, 1u << 30));
+		crc = crc32(crc, p, chunk);
+		p += chunk;
+		size -= chunk;
+	}
+	return uint32_t(crc);
+}
+
+} // namespace forge
@@ -0,0 +1,401 @@
+//
+//  BatchScheduler.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "BatchScheduler.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "SystemInfo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace forge {
+
+namespace {
+
+constexpr double kWorkingBytesPerPixel = 16.0;          // RGBAf
+constexpr double kTransientBytes = 256.0 * 1048576.0;   // Core Image's tiles in flight
+constexpr double kFixedBytes = 64.0 * 1048576.0;
+constexpr const char* kCheckpointHeader = "forge-batch 1";
+
+} // namespace
+
+uint64_t estimateBatchJob(const BatchJobSpec& spec) {
+	if (spec.width <= 0 || spec.height <= 0) return uint64_t(kFixedBytes);
+	const double apron = 2.0 * double(std::max({ spec.grainRadius, spec.halationRadius, 0.0f }));
+	const double padded = (double(spec.width) + apron) * (double(spec.height) + apron) * kWorkingBytesPerPixel;
+
+	double frames = 1.0 + double(std::max(spec.cachedNodes, 0));   // source and cached intermediates
+	if (spec.grainRadius > 0.0f) frames += 1.75;                  // plate, three single-channel noise layers
+	if (spec.halationRadius > 0.0f) frames += 2.0;                // blurred copy, cached blend
+	const double scale = std::max(double(spec.outputScale), 0.0);
+	const double output = double(spec.width) * scale * double(spec.height) * scale * double(std::max(spec.outputBytesPerPixel, 1));
+	return uint64_t(frames * padded + std::min(padded, kTransientBytes) + output + kFixedBytes);
+}
+
+// MARK: - Scheduler
+
+BatchScheduler::BatchScheduler(BatchBudget budget, std::string checkpointPath)
+	: budget_(budget), checkpointPath_(std::move(checkpointPath)) {
+	if (budget_.memoryBytes == 0) budget_.memoryBytes = physicalMemoryBytes() / 2;
+	if (budget_.threads <= 0) budget_.threads = int(workerCount());
+	if (checkpointPath_.empty()) return;
+
+	// Keys of an earlier run, if it left a checkpoint; then append to it.
+	std::ifstream in(checkpointPath_);
+	std::string line;
+	if (std::getline(in, line) && line == kCheckpointHeader) {
+		while (std::getline(in, line)) {
+			if (!line.empty()) checkpointed_.insert(line);
+		}
+	}
+	in.close();
+	checkpoint_ = std::fopen(checkpointPath_.c_str(), checkpointed_.empty() ? "w" : "a");
+	if (checkpoint_ && checkpointed_.empty()) {
+		std::fprintf(checkpoint_, "%s\n", kCheckpointHeader);
+		std::fflush(checkpoint_);
+	}
+}
+
+BatchScheduler::~BatchScheduler() {
+	if (checkpoint_) std::fclose(checkpoint_);
+}
+
+int BatchScheduler::add(const std::string& key, const BatchJobSpec& spec) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	Job job;
+	job.key = key;
+	job.bytes = estimateBatchJob(spec);
+	job.megapixels = double(std::max(spec.width, 0)) * double(std::max(spec.height, 0)) / 1e6;
+	const int index = int(jobs_.size());
+	if (!key.empty() && key.find('\n') == std::string::npos && checkpointed_.count(key)) {
+		job.state = Job::Resumed;
+		++resumed_;
+	} else {
+		pending_.push_back(index);
+		remainingMegapixels_ += job.megapixels;
+	}
+	jobs_.push_back(std::move(job));
+	return index;
+}
+
+bool BatchScheduler::resumed(int job) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return job >= 0 && job < int(jobs_.size()) && jobs_[size_t(job)].state == Job::Resumed;
+}
+
+uint64_t BatchScheduler::peakBytes(int job) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return job >= 0 && job < int(jobs_.size()) ? jobs_[size_t(job)].bytes : 0;
+}
+
+bool BatchScheduler::fits(const Job& job) const {
+	return running_ == 0 || inFlight_ + job.bytes <= budget_.memoryBytes;
+}
+
+int BatchScheduler::next() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (pending_.empty() || running_ >= budget_.threads) return -1;
+
+	// The first job that fits; the head only gets passed over `threads` times.
+	size_t pick = pending_.size();
+	if (fits(jobs_[size_t(pending_.front())])) {
+		pick = 0;
+	} else if (headSkips_ < budget_.threads) {
+		for (size_t i = 1; i < pending_.size(); ++i) {
+			if (fits(jobs_[size_t(pending_[i])])) {
+				pick = i;
+				break;
+			}
+		}
+	}
+	if (pick == pending_.size()) return -1;
+	headSkips_ = pick == 0 ? 0 : headSkips_ + 1;
+
+	const int index = pending_[pick];
+	pending_.erase(pending_.begin() + std::ptrdiff_t(pick));
+	Job& job = jobs_[size_t(index)];
+	job.state = Job::Running;
+	++running_;
+	inFlight_ += job.bytes;
+	peakInFlight_ = std::max(peakInFlight_, inFlight_);
+	if (!started_) {
+		start_ = std::chrono::steady_clock::now();
+		started_ = true;
+	}
+	return index;
+}
+
+void BatchScheduler::finish(int index, bool ok) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (index < 0 || index >= int(jobs_.size()) || jobs_[size_t(index)].state != Job::Running) return;
+	Job& job = jobs_[size_t(index)];
+	job.state = ok ? Job::Done : Job::Failed;
+	--running_;
+	inFlight_ -= job.bytes;
+	remainingMegapixels_ -= job.megapixels;
+	if (ok) {
+		++completed_;
+		completedMegapixels_ += job.megapixels;
+	} else {
+		++failed_;
+	}
+}
+
+void BatchScheduler::checkpoint(int index) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!checkpoint_ || index < 0 || index >= int(jobs_.size())) return;
+	const std::string& key = jobs_[size_t(index)].key;
+	if (key.empty() || key.find('\n') != std::string::npos) return;
+	std::fprintf(checkpoint_, "%s\n", key.c_str());
+	std::fflush(checkpoint_);
+	fsync(fileno(checkpoint_));
+}
+
+void BatchScheduler::clearCheckpoint() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (checkpoint_) std::fclose(checkpoint_);
+	checkpoint_ = nullptr;
+	if (!checkpointPath_.empty()) std::remove(checkpointPath_.c_str());
+}
+
+BatchProgress BatchScheduler::progress() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	BatchProgress p;
+	p.total = int(jobs_.size());
+	p.completed = completed_;
+	p.failed = failed_;
+	p.resumed = resumed_;
+	p.running = running_;
+	p.bytesInFlight = inFlight_;
+	p.peakBytesInFlight = peakInFlight_;
+	if (!started_) return p;
+	p.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	if (p.elapsedSeconds > 0.0) {
+		p.imagesPerSecond = double(completed_) / p.elapsedSeconds;
+		p.megapixelsPerSecond = completedMegapixels_ / p.elapsedSeconds;
+	}
+	if (p.megapixelsPerSecond > 0.0) p.etaSeconds = std::max(remainingMegapixels_, 0.0) / p.megapixelsPerSecond;
+	return p;
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+// A mix from a real job: mostly 24 MP frames, some 45 MP with grain, a few 100 MP scans with
+// grain, halation and masks.
+BatchJobSpec benchmarkSpec(int i) {
+	BatchJobSpec spec;
+	switch (i % 10) {
+	case 0:
+		spec.width = 11648;
+		spec.height = 8736;
+		spec.cachedNodes = 3;
+		spec.grainRadius = 6.0f;
+		spec.halationRadius = 40.0f;
+		break;
+	case 3: case 6: case 9:
+		spec.width = 8256;
+		spec.height = 5504;
+		spec.cachedNodes = 2;
+		spec.grainRadius = 4.0f;
+		break;
+	default:
+		spec.width = 6000;
+		spec.height = 4000;
+		spec.cachedNodes = 1;
+		break;
+	}
+	return spec;
+}
+
+// Runs the pending jobs of `scheduler` on its threads; each sleeps for its megapixels' worth of
+// work. Stops handing out jobs after `limit` of them.
+void runBatch(BatchScheduler& scheduler, const std::vector<BatchJobSpec>& specs, int limit) {
+	std::mutex mutex;
+	std::condition_variable finished;
+	std::vector<std::thread> threads;
+	int started = 0, running = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		const int job = started < limit ? scheduler.next() : -1;
+		if (job >= 0) {
+			++started;
+			++running;
+			threads.emplace_back([&, job] {
+				const double megapixels = double(specs[size_t(job)].width) * double(specs[size_t(job)].height) / 1e6;
+				std::this_thread::sleep_for(std::chrono::microseconds(int64_t(megapixels * 20.0)));
+				scheduler.finish(job, true);
+				scheduler.checkpoint(job);
+				std::lock_guard<std::mutex> guard(mutex);
+				--running;
+				finished.notify_all();
+			});
+			continue;
+		}
+		if (running == 0) break;
+		const int before = running;
+		finished.wait(lock, [&] { return running < before; });
+	}
+	lock.unlock();
+	for (std::thread& t : threads) t.join();
+}
+
+} // namespace
+
+BatchSchedulerBenchmark benchmarkBatchScheduler(int jobs, const std::string& directory) {
+	using Clock = std::chrono::steady_clock;
+	BatchSchedulerBenchmark result;
+	if (jobs <= 0) return result;
+	result.jobs = jobs;
+
+	std::vector<BatchJobSpec> specs;
+	for (int i = 0; i < jobs; ++i) specs.push_back(benchmarkSpec(i));
+	BatchBudget budget;
+	budget.memoryBytes = 16ull << 30;
+	budget.threads = 4;
+	result.budgetMegabytes = double(budget.memoryBytes) / 1048576.0;
+
+	// Four at a time whatever their size, as batchConvertToNSImage did.
+	{
+		BatchBudget unlimited = budget;
+		unlimited.memoryBytes = ~0ull;
+		BatchScheduler fixed(unlimited);
+		for (int i = 0; i < jobs; ++i) fixed.add("", specs[size_t(i)]);
+		const auto t0 = Clock::now();
+		runBatch(fixed, specs, jobs);
+		result.fixedSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+		result.fixedPeakMegabytes = double(fixed.progress().peakBytesInFlight) / 1048576.0;
+	}
+
+	{
+		BatchScheduler scheduled(budget);
+		for (int i = 0; i < jobs; ++i) scheduled.add("", specs[size_t(i)]);
+		const auto t0 = Clock::now();
+		runBatch(scheduled, specs, jobs);
+		result.scheduledSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+		const BatchProgress p = scheduled.progress();
+		result.scheduledPeakMegabytes = double(p.peakBytesInFlight) / 1048576.0;
+		result.withinBudget = p.completed == jobs && p.peakBytesInFlight <= budget.memoryBytes;
+	}
+
+	// Interrupted after half the jobs, then reopened on the same checkpoint.
+	const std::string path = directory + "/forge_batch_benchmark.checkpoint";
+	std::remove(path.c_str());
+	auto key = [](int i) { return "/images/frame_" + std::to_string(i) + ".dng"; };
+	{
+		BatchScheduler first(budget, path);
+		for (int i = 0; i < jobs; ++i) first.add(key(i), specs[size_t(i)]);
+		runBatch(first, specs, jobs / 2);
+	}
+	{
+		BatchScheduler second(budget, path);
+		for (int i = 0; i < jobs; ++i) second.add(key(i), specs[size_t(i)]);
+		int resumed = 0;
+		for (int i = 0; i < jobs; ++i) resumed += second.resumed(i) ? 1 : 0;
+		runBatch(second, specs, jobs);
+		const BatchProgress p = second.progress();
+		result.resumes = resumed == jobs / 2 && p.resumed == resumed && p.completed == jobs - resumed;
+		second.clearCheckpoint();
+	}
+	result.resumes = result.resumes && !std::ifstream(path).good();
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeBatchScheduler {
+	forge::BatchScheduler scheduler;
+
+	ForgeBatchScheduler(forge::BatchBudget budget, std::string path) : scheduler(budget, std::move(path)) {}
+};
+
+namespace {
+
+forge::BatchJobSpec jobSpec(const ForgeBatchJobSpec& s) {
+	forge::BatchJobSpec spec;
+	spec.width = s.width;
+	spec.height = s.height;
+	spec.outputScale = s.outputScale;
+	spec.cachedNodes = s.cachedNodes;
+	spec.grainRadius = s.grainRadius;
+	spec.halationRadius = s.halationRadius;
+	spec.outputBytesPerPixel = s.outputBytesPerPixel > 0 ? s.outputBytesPerPixel : 8;
+	return spec;
+}
+
+} // namespace
+
+extern "C" {
+	uint64_t ForgeEstimateBatchJob(ForgeBatchJobSpec spec) {
+		return forge::estimateBatchJob(jobSpec(spec));
+	}
+
+	ForgeBatchScheduler* ForgeBatchSchedulerCreate(uint64_t memoryBytes, int32_t threads, const char* checkpointPath) {
+		forge::BatchBudget budget;
+		budget.memoryBytes = memoryBytes;
+		budget.threads = threads;
+		return new ForgeBatchScheduler(budget, checkpointPath ? checkpointPath : "");
+	}
+
+	void ForgeBatchSchedulerRelease(ForgeBatchScheduler* scheduler) {
+		delete scheduler;
+	}
+
+	int32_t ForgeBatchSchedulerThreads(const ForgeBatchScheduler* scheduler) {
+		return scheduler ? scheduler->scheduler.budget().threads : 0;
+	}
+
+	uint64_t ForgeBatchSettingsHash(const void* bytes, size_t size) {
+		return forge::hashBytes(bytes, bytes ? size : 0);
+	}
+
+	int32_t ForgeBatchSchedulerAdd(ForgeBatchScheduler* scheduler, const char* key, ForgeBatchJobSpec spec) {
+		return scheduler ? scheduler->scheduler.add(key ? key : "", jobSpec(spec)) : -1;
+	}
+
+	bool ForgeBatchSchedulerResumed(const ForgeBatchScheduler* scheduler, int32_t job) {
+		return scheduler && scheduler->scheduler.resumed(job);
+	}
+
+	int32_t ForgeBatchSchedulerNext(ForgeBatchScheduler* scheduler) {
+		return scheduler ? scheduler->scheduler.next() : -1;
+	}
+
+	void ForgeBatchSchedulerFinish(ForgeBatchScheduler* scheduler, int32_t job, bool ok) {
+		if (scheduler) scheduler->scheduler.finish(job, ok);
+	}
+
+	void ForgeBatchSchedulerCheckpoint(ForgeBatchScheduler* scheduler, int32_t job) {
+		if (scheduler) scheduler->scheduler.checkpoint(job);
+	}
+
+	void ForgeBatchSchedulerClearCheckpoint(ForgeBatchScheduler* scheduler) {
+		if (scheduler) scheduler->scheduler.clearCheckpoint();
+	}
+
+	ForgeBatchProgress ForgeBatchSchedulerGetProgress(const ForgeBatchScheduler* scheduler) {
+		const forge::BatchProgress p = scheduler ? scheduler->scheduler.progress() : forge::BatchProgress();
+		return { p.total, p.completed, p.failed, p.resumed, p.running, p.bytesInFlight, p.peakBytesInFlight,
+				 p.elapsedSeconds, p.imagesPerSecond, p.megapixelsPerSecond, p.etaSeconds };
+	}
+
+	ForgeBatchSchedulerBenchmark ForgeBenchmarkBatchScheduler(int32_t jobs, const char* directory) {
+		const forge::BatchSchedulerBenchmark b = forge::benchmarkBatchScheduler(jobs, directory ? directory : ".");
+		return { b.jobs, b.budgetMegabytes, b.fixedPeakMegabytes, b.scheduledPeakMegabytes, b.fixedSeconds,
+				 b.scheduledSeconds, b.withinBudget, b.resumes };
+	}
+}
@@ -0,0 +1,145 @@
+//
+//  BatchScheduler.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace forge {
+
+/*
+ Memory-budgeted batch scheduling.
+
+ Batch renders and exports used to start a fixed number of jobs (four, or one per context)
+ whatever the images were: a batch of 24 MP frames left cores idle, a batch of 100 MP scans with
+ grain and halation went into swap. Here every job carries an estimate of its peak working set
+ and is admitted only while the running jobs' estimates fit the budget, and only while a thread
+ of the budget is free. Jobs are admitted in order; a job too big for the space left is passed
+ over for smaller ones behind it, but only as many times as there are threads, after which
+ nothing else starts until it fits. A job bigger than the whole budget runs on its own.
+
+ The estimate (estimateBatchJob) counts full frames in the RGBAf working format: the source,
+ each intermediate the graph caches (insertingIntermediate), Core Image's transient tiles, the
+ grain plate and its noise layers, halation's blurred copy, the rendered output, all widened by
+ the grain or halation radius the blurs read past the edge. It is a planning figure, not a
+ measurement, and deliberately errs high.
+
+ Progress is checkpointed: with a checkpoint path, each job's key is appended (and flushed) once
+ its output is durable, and a scheduler opened on the same path skips jobs already listed, so an
+ interrupted batch resumes where it stopped. Throughput and an ETA (remaining megapixels at the
+ rate seen so far) come from progress().
+ */
+
+struct BatchJobSpec {
+	int width = 0, height = 0;          // native pixels
+	float outputScale = 1.0f;
+	int cachedNodes = 0;                // nodes that keep a full-frame intermediate
+	float grainRadius = 0.0f;           // native pixels; 0: no grain
+	float halationRadius = 0.0f;        // native pixels; 0: no halation
+	int outputBytesPerPixel = 8;        // as rendered (RGBA16: 8)
+};
+
+// Peak working set of a job, bytes.
+uint64_t estimateBatchJob(const BatchJobSpec& spec);
+
+struct BatchBudget {
+	uint64_t memoryBytes = 0;           // 0: half of physical memory
+	int threads = 0;                    // 0: workerCount()
+};
+
+struct BatchProgress {
+	int total = 0;
+	int completed = 0;                  // this run
+	int failed = 0;
+	int resumed = 0;                    // done by an earlier run (checkpoint)
+	int running = 0;
+	uint64_t bytesInFlight = 0;
+	uint64_t peakBytesInFlight = 0;
+	double elapsedSeconds = 0.0;        // since the first job started
+	double imagesPerSecond = 0.0;
+	double megapixelsPerSecond = 0.0;
+	double etaSeconds = 0.0;            // 0 until a job has completed
+};
+
+class BatchScheduler {
+public:
+	// Empty `checkpointPath`: no checkpoint.
+	explicit BatchScheduler(BatchBudget budget, std::string checkpointPath = "");
+	~BatchScheduler();
+
+	BatchScheduler(const BatchScheduler&) = delete;
+	BatchScheduler& operator=(const BatchScheduler&) = delete;
+
+	const BatchBudget& budget() const { return budget_; }
+
+	// Adds a job; `key` names it in the checkpoint (a path, say; no newlines). Returns its index.
+	// A key the checkpoint lists is counted as resumed and never handed out.
+	int add(const std::string& key, const BatchJobSpec& spec);
+	bool resumed(int job) const;
+	uint64_t peakBytes(int job) const;
+
+	// A job that fits the budget now, or -1: wait for a running job to finish, or, with none
+	// running, the batch is done.
+	int next();
+	// The job's memory is free again (its output may still be on its way to disk).
+	void finish(int job, bool ok);
+	// The job's output is durable: recorded in the checkpoint.
+	void checkpoint(int job);
+	// Removes the checkpoint, once the whole batch is done.
+	void clearCheckpoint();
+
+	BatchProgress progress() const;
+
+private:
+	struct Job {
+		std::string key;
+		uint64_t bytes = 0;
+		double megapixels = 0.0;
+		enum State : uint8_t { Pending, Running, Done, Failed, Resumed } state = Pending;
+	};
+
+	bool fits(const Job& job) const;   // requires mutex_
+
+	BatchBudget budget_;
+	std::string checkpointPath_;
+	std::FILE* checkpoint_ = nullptr;
+	std::unordered_set<std::string> checkpointed_;
+
+	mutable std::mutex mutex_;
+	std::vector<Job> jobs_;
+	std::vector<int> pending_;         // in order
+	int headSkips_ = 0;
+	int running_ = 0, completed_ = 0, failed_ = 0, resumed_ = 0;
+	uint64_t inFlight_ = 0, peakInFlight_ = 0;
+	double completedMegapixels_ = 0.0, remainingMegapixels_ = 0.0;
+	std::chrono::steady_clock::time_point start_;
+	bool started_ = false;
+};
+
+// MARK: - Benchmark
+
+struct BatchSchedulerBenchmark {
+	int jobs = 0;
+	double budgetMegabytes = 0.0;
+	double fixedPeakMegabytes = 0.0;     // `threads` jobs at a time, as before
+	double scheduledPeakMegabytes = 0.0;
+	double fixedSeconds = 0.0;
+	double scheduledSeconds = 0.0;
+	bool withinBudget = false;
+	bool resumes = false;                // an interrupted run resumed without redoing a job
+};
+
+// Simulated jobs (work ∝ megapixels) of mixed sizes; the checkpoint goes in `directory`.
+BatchSchedulerBenchmark benchmarkBatchScheduler(int jobs, const std::string& directory);
+
+} // namespace forge
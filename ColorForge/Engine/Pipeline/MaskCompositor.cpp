@@ -0,0 +1,317 @@
+//
+//  MaskCompositor.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "MaskCompositor.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace forge {
+
+namespace {
+
+constexpr int kLanes = 8;
+
+// sigmoidT from MaskingKernels.ci.metal (applySigmoidSmoothing): a logistic of softness 10
+// around 0.5, rescaled so 0 and 1 map to exactly 0 and 1.
+constexpr float kSigmoidSoftness = 10.0f;
+const float kSigmoid0 = 1.0f / (1.0f + std::exp(0.5f * kSigmoidSoftness));
+const float kSigmoidScale = 1.0f / (1.0f / (1.0f + std::exp(-0.5f * kSigmoidSoftness)) - kSigmoid0);
+
+inline float smooth(float x) {
+	if (x <= 0.0f) return 0.0f;
+	if (x >= 1.0f) return 1.0f;
+	return (1.0f / (1.0f + std::exp(-kSigmoidSoftness * (x - 0.5f))) - kSigmoid0) * kSigmoidScale;
+}
+
+// Shape constants for per-pixel evaluation.
+struct Prepared {
+	bool radial = false;
+	bool invert = false;
+	bool empty = false;    // zero everywhere before invert
+	// Linear: t = (x − x0)·kx + (y − y0)·ky.
+	float x0 = 0.0f, y0 = 0.0f, kx = 0.0f, ky = 0.0f;
+	// Radial: (u, v) = A · (x − cx, y − cy), in units of the semi-axes.
+	float cx = 0.0f, cy = 0.0f, a00 = 0.0f, a01 = 0.0f, a10 = 0.0f, a11 = 0.0f;
+	float rampScale = 0.0f, opacity = 1.0f;
+};
+
+Prepared prepare(const AnalyticMask& mask) {
+	Prepared p;
+	p.radial = mask.radial;
+	if (!mask.radial) {
+		const LinearMaskShape& l = mask.linear;
+		const float dx = l.x1 - l.x0, dy = l.y1 - l.y0, length2 = dx * dx + dy * dy;
+		p.x0 = l.x0;
+		p.y0 = l.y0;
+		// A zero-length gradient is one everywhere (t = 0).
+		p.kx = length2 > 0.0f ? dx / length2 : 0.0f;
+		p.ky = length2 > 0.0f ? dy / length2 : 0.0f;
+		return p;
+	}
+	const RadialMaskShape& e = mask.ellipse;
+	p.invert = e.invert;
+	p.opacity = std::clamp(e.opacity, 0.0f, 1.0f);
+	p.empty = !(e.rx > 0.0f) || !(e.ry > 0.0f) || p.opacity == 0.0f;
+	if (p.empty) return p;
+	const float c = std::cos(e.rotation), s = std::sin(e.rotation);
+	p.cx = e.cx;
+	p.cy = e.cy;
+	p.a00 = c / e.rx;  p.a01 = s / e.rx;
+	p.a10 = -s / e.ry; p.a11 = c / e.ry;
+	const float feather = std::clamp(e.feather, 0.0f, 1.0f);
+	p.rampScale = feather > 1e-6f ? 1.0f / feather : 1e6f;
+	return p;
+}
+
+inline float linearValue(const Prepared& p, float x, float y) {
+	const float t = (x - p.x0) * p.kx + (y - p.y0) * p.ky;
+	return smooth(std::clamp(1.0f - t, 0.0f, 1.0f));
+}
+
+inline float radialValue(const Prepared& p, float x, float y) {
+	if (p.empty) return p.invert ? 1.0f : 0.0f;
+	const float dx = x - p.cx, dy = y - p.cy;
+	const float u = p.a00 * dx + p.a01 * dy, v = p.a10 * dx + p.a11 * dy;
+	const float ramp = std::clamp((1.0f - std::sqrt(u * u + v * v)) * p.rampScale, 0.0f, 1.0f);
+	const float value = smooth(p.opacity * ramp);
+	return p.invert ? 1.0f - value : value;
+}
+
+// Values for pixels x0 ..< x0 + kLanes of row y.
+inline void maskLanes(const Prepared& p, int x0, int y, float* m) {
+	const float yc = float(y) + 0.5f;
+	if (p.radial) {
+		for (int l = 0; l < kLanes; ++l) m[l] = radialValue(p, float(x0 + l) + 0.5f, yc);
+	} else {
+		for (int l = 0; l < kLanes; ++l) m[l] = linearValue(p, float(x0 + l) + 0.5f, yc);
+	}
+}
+
+// Axis-aligned bounds of the part of `frame` where t < 1 (Sutherland–Hodgman on one edge).
+Rect halfPlaneBounds(const Prepared& p, const Rect& frame) {
+	const float xs[4] = { float(frame.x), float(frame.right()), float(frame.right()), float(frame.x) };
+	const float ys[4] = { float(frame.y), float(frame.y), float(frame.bottom()), float(frame.bottom()) };
+	float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+	auto add = [&](float x, float y) {
+		x0 = std::min(x0, x); y0 = std::min(y0, y);
+		x1 = std::max(x1, x); y1 = std::max(y1, y);
+	};
+	auto t = [&](int i) { return (xs[i] - p.x0) * p.kx + (ys[i] - p.y0) * p.ky; };
+	for (int i = 0; i < 4; ++i) {
+		const int j = (i + 1) & 3;
+		const float ti = t(i), tj = t(j);
+		if (ti < 1.0f) add(xs[i], ys[i]);
+		if ((ti < 1.0f) != (tj < 1.0f)) {
+			const float f = (1.0f - ti) / (tj - ti);
+			add(xs[i] + (xs[j] - xs[i]) * f, ys[i] + (ys[j] - ys[i]) * f);
+		}
+	}
+	if (x1 < x0) return {};
+	const int ix0 = int(std::floor(x0)), iy0 = int(std::floor(y0));
+	return Rect{ ix0, iy0, int(std::ceil(x1)) - ix0, int(std::ceil(y1)) - iy0 }.intersect(frame);
+}
+
+} // namespace
+
+float analyticMaskValue(const AnalyticMask& mask, float x, float y) {
+	const Prepared p = prepare(mask);
+	return p.radial ? radialValue(p, x, y) : linearValue(p, x, y);
+}
+
+Rect analyticMaskBounds(const AnalyticMask& mask, const Rect& frame) {
+	const Prepared p = prepare(mask);
+	if (!p.radial) return halfPlaneBounds(p, frame);
+	if (p.invert) return frame;
+	if (p.empty) return {};
+	const RadialMaskShape& e = mask.ellipse;
+	const float c = std::cos(e.rotation), s = std::sin(e.rotation);
+	const float hx = std::sqrt(e.rx * e.rx * c * c + e.ry * e.ry * s * s);
+	const float hy = std::sqrt(e.rx * e.rx * s * s + e.ry * e.ry * c * c);
+	const int x0 = int(std::floor(e.cx - hx)), y0 = int(std::floor(e.cy - hy));
+	return Rect{ x0, y0, int(std::ceil(e.cx + hx)) - x0, int(std::ceil(e.cy + hy)) - y0 }.intersect(frame);
+}
+
+void compositeMasks(const ImageView& base, int baseX, int baseY, const std::vector<MaskLayer>& layers,
+					const ImageView& dst, int dstX, int dstY) {
+	if (!base.valid() || !dst.valid()) return;
+	const int C = dst.channels;
+	const Rect out{ dstX, dstY, dst.width, dst.height };
+	const bool inPlace = base.data == dst.data && baseX == dstX && baseY == dstY;
+
+	struct Active {
+		Prepared p;
+		Rect rect;
+		const MaskLayer* layer;
+	};
+	std::vector<Active> active;
+	active.reserve(layers.size());
+	for (const MaskLayer& layer : layers) {
+		if (!layer.image.valid()) continue;
+		const Rect image{ layer.x, layer.y, layer.image.width, layer.image.height };
+		const Rect rect = analyticMaskBounds(layer.mask, out).intersect(image);
+		if (!rect.empty()) active.push_back({ prepare(layer.mask), rect, &layer });
+	}
+
+	parallelFor(size_t(dst.height), [&](size_t row) {
+		const int Y = dstY + int(row);
+		float* d = dst.row(int(row));
+		if (!inPlace) std::memcpy(d, base.row(Y - baseY) + size_t(dstX - baseX) * size_t(C), size_t(dst.width) * size_t(C) * sizeof(float));
+
+		float m[kLanes];
+		for (const Active& a : active) {
+			if (Y < a.rect.y || Y >= a.rect.bottom()) continue;
+			const MaskLayer& layer = *a.layer;
+			const float* src = layer.image.row(Y - layer.y);
+			for (int X = a.rect.x; X < a.rect.right(); X += kLanes) {
+				maskLanes(a.p, X, Y, m);
+				const int n = std::min(kLanes, a.rect.right() - X);
+				float* dp = d + size_t(X - dstX) * size_t(C);
+				const float* sp = src + size_t(X - layer.x) * size_t(layer.image.channels);
+				for (int l = 0; l < n; ++l) {
+					const float w = m[l];
+					for (int c = 0; c < C; ++c) dp[c] += (sp[c] - dp[c]) * w;
+					dp += C;
+					sp += layer.image.channels;
+				}
+			}
+		}
+	});
+}
+
+// MARK: - Benchmark
+
+MaskCompositeBenchmark benchmarkMaskComposite(int width, int height, int masks) {
+	MaskCompositeBenchmark result;
+	result.masks = masks;
+
+	// A spread of masks: every fourth a linear gradient across part of the frame, the rest
+	// rotated, feathered ellipses of a few sizes.
+	auto makeMasks = [&](int w, int h) {
+		std::vector<AnalyticMask> list;
+		for (int i = 0; i < masks; ++i) {
+			AnalyticMask mask;
+			const float fx = 0.15f + 0.7f * float(i % 4) / 3.0f, fy = 0.15f + 0.7f * float((i / 4) % 4) / 3.0f;
+			if (i % 4 == 3) {
+				mask.linear = { 0.5f * float(w), fy * float(h), 0.6f * float(w), fy * float(h) + 0.1f * float(h) };
+			} else {
+				mask.radial = true;
+				const float r = float(std::min(w, h)) * (0.06f + 0.03f * float(i % 3));
+				mask.ellipse = { fx * float(w), fy * float(h), r, 0.7f * r, 0.4f * float(i), 0.5f, 1.0f, false };
+			}
+			list.push_back(mask);
+		}
+		return list;
+	};
+	auto fill = [](const ImageView& v, float phase) {
+		parallelFor(size_t(v.height), [&](size_t y) {
+			for (int x = 0; x < v.width; ++x) {
+				float* p = v.pixel(x, int(y));
+				p[0] = 0.5f + 0.4f * std::sin(float(x) * 0.01f + phase);
+				p[1] = 0.5f + 0.4f * std::cos(float(y) * 0.013f + phase);
+				p[2] = float((x + int(y)) & 255) / 255.0f;
+				p[3] = 1.0f;
+			}
+		});
+	};
+	// One rasterised mask and one blend pass per mask, as applyNodeWithMasks does today.
+	auto separate = [](const ImageView& base, const ImageView& node, const std::vector<AnalyticMask>& list,
+					   const ImageView& out, const ImageView& maskBuffer) {
+		parallelFor(size_t(out.height), [&](size_t y) {
+			std::memcpy(out.row(int(y)), base.row(int(y)), size_t(out.width) * out.pixelBytes());
+		});
+		for (const AnalyticMask& mask : list) {
+			const Prepared p = prepare(mask);
+			parallelFor(size_t(out.height), [&](size_t y) {
+				float lanes[kLanes];
+				float* m = maskBuffer.row(int(y));
+				for (int x = 0; x < out.width; x += kLanes) {
+					maskLanes(p, x, int(y), lanes);
+					std::copy(lanes, lanes + std::min(kLanes, out.width - x), m + x);
+				}
+			});
+			parallelFor(size_t(out.height), [&](size_t y) {
+				const float* m = maskBuffer.row(int(y));
+				float* d = out.row(int(y));
+				const float* s = node.row(int(y));
+				for (size_t i = 0; i < size_t(out.width) * 4; ++i) d[i] += (s[i] - d[i]) * m[i / 4];
+			});
+		}
+	};
+	auto fused = [](const ImageView& base, const ImageView& node, const std::vector<AnalyticMask>& list, const ImageView& out) {
+		std::vector<MaskLayer> layers;
+		for (const AnalyticMask& mask : list) layers.push_back({ mask, node, 0, 0 });
+		compositeMasks(base, 0, 0, layers, out, 0, 0);
+	};
+
+	ImageBuffer base(width, height, 4), node(width, height, 4), out(width, height, 4);
+	fill(base.view(), 0.0f);
+	fill(node.view(), 1.7f);
+	const auto list = makeMasks(width, height);
+	{
+		ImageBuffer maskBuffer(width, height, 1);
+		const auto t0 = std::chrono::steady_clock::now();
+		separate(base.view(), node.view(), list, out.view(), maskBuffer.view());
+		result.separateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	}
+	const auto t0 = std::chrono::steady_clock::now();
+	fused(base.view(), node.view(), list, out.view());
+	result.fusedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	result.fusedMegapixelsPerSecond = double(width) * double(height) / 1e6 / std::max(result.fusedSeconds, 1e-9);
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+namespace {
+
+forge::AnalyticMask analyticMask(const ForgeAnalyticMask& m) {
+	forge::AnalyticMask mask;
+	mask.radial = m.radial;
+	mask.linear = { m.linear.x0, m.linear.y0, m.linear.x1, m.linear.y1 };
+	mask.ellipse = { m.ellipse.cx, m.ellipse.cy, m.ellipse.rx, m.ellipse.ry, m.ellipse.rotation,
+					 m.ellipse.feather, m.ellipse.opacity, m.ellipse.invert };
+	return mask;
+}
+
+} // namespace
+
+extern "C" {
+	ForgeRect ForgeAnalyticMaskBounds(ForgeAnalyticMask mask, ForgeRect frame) {
+		const forge::Rect r = forge::analyticMaskBounds(analyticMask(mask), { frame.x, frame.y, frame.width, frame.height });
+		return { r.x, r.y, r.width, r.height };
+	}
+
+	void ForgeCompositeMasks(const float* base, ForgeRect baseRect, size_t baseRowBytes,
+							 const ForgeAnalyticMask* masks, const float* const* layers, const ForgeRect* layerRects,
+							 const size_t* layerRowBytes, int32_t count,
+							 float* dst, ForgeRect dstRect, size_t dstRowBytes, int32_t channels) {
+		if (!base || !dst) return;
+		std::vector<forge::MaskLayer> list;
+		for (int32_t i = 0; i < count && masks && layers && layerRects && layerRowBytes; ++i) {
+			if (!layers[i]) continue;
+			const ForgeRect r = layerRects[i];
+			const forge::ImageView image{ const_cast<float*>(layers[i]), r.width, r.height, channels, layerRowBytes[i] / sizeof(float) };
+			list.push_back({ analyticMask(masks[i]), image, r.x, r.y });
+		}
+		const forge::ImageView in{ const_cast<float*>(base), baseRect.width, baseRect.height, channels, baseRowBytes / sizeof(float) };
+		const forge::ImageView out{ dst, dstRect.width, dstRect.height, channels, dstRowBytes / sizeof(float) };
+		forge::compositeMasks(in, baseRect.x, baseRect.y, list, out, dstRect.x, dstRect.y);
+	}
+
+	ForgeMaskCompositeBenchmark ForgeBenchmarkMaskComposite(int32_t width, int32_t height, int32_t masks) {
+		const forge::MaskCompositeBenchmark b = forge::benchmarkMaskComposite(width, height, masks);
+		return { b.masks, b.fusedSeconds, b.separateSeconds, b.fusedMegapixelsPerSecond };
+	}
+}
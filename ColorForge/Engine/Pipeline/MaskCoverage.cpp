@@ -0,0 +1,313 @@
+//
+//  MaskCoverage.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "MaskCoverage.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace forge {
+
+namespace {
+
+inline int floorDiv(int v, int step) {
+	return v >= 0 ? v / step : -((-v + step - 1) / step);
+}
+
+// Mask range over a tile before opacity and invert, reduced to what classification needs:
+// whether the maximum is 0 and whether the minimum is 1.
+struct Extremes {
+	bool maxZero = false;
+	bool minOne = false;
+};
+
+Coverage classify(Extremes e, float opacity, bool invert) {
+	const float o = std::clamp(opacity, 0.0f, 1.0f);
+	// Values span [o·min, o·max], or [1 − o·max, 1 − o·min] inverted.
+	const bool lowZero = e.maxZero || o == 0.0f;         // o·max == 0
+	const bool highOne = e.minOne && o == 1.0f;          // o·min == 1
+	if (!invert) return lowZero ? Coverage::Zero : highOne ? Coverage::One : Coverage::Partial;
+	return highOne ? Coverage::Zero : lowZero ? Coverage::One : Coverage::Partial;
+}
+
+} // namespace
+
+// MARK: - Grid
+
+CoverageGrid::CoverageGrid(const Rect& bounds, int tileSize, Coverage fill)
+	: bounds_(bounds), tileSize_(std::max(tileSize, 1)) {
+	if (bounds.empty()) return;
+	originX_ = floorDiv(bounds.x, tileSize_) * tileSize_;
+	originY_ = floorDiv(bounds.y, tileSize_) * tileSize_;
+	columns_ = floorDiv(bounds.right() - 1 - originX_, tileSize_) + 1;
+	rows_ = floorDiv(bounds.bottom() - 1 - originY_, tileSize_) + 1;
+	tiles_.assign(size_t(columns_) * size_t(rows_), fill);
+}
+
+Rect CoverageGrid::tileRect(int column, int row) const {
+	return Rect{ originX_ + column * tileSize_, originY_ + row * tileSize_, tileSize_, tileSize_ }.intersect(bounds_);
+}
+
+CoverageGrid CoverageGrid::dilated(int pixels) const {
+	CoverageGrid out = *this;
+	const int k = pixels > 0 ? (pixels + tileSize_ - 1) / tileSize_ : 0;
+	if (k == 0) return out;
+	for (int r = 0; r < rows_; ++r) {
+		for (int c = 0; c < columns_; ++c) {
+			const Coverage self = at(c, r);
+			if (self == Coverage::Partial) continue;
+			bool mixed = false;
+			for (int rr = std::max(r - k, 0); rr <= std::min(r + k, rows_ - 1) && !mixed; ++rr) {
+				for (int cc = std::max(c - k, 0); cc <= std::min(c + k, columns_ - 1) && !mixed; ++cc) {
+					mixed = at(cc, rr) != self;
+				}
+			}
+			if (mixed) out.set(c, r, Coverage::Partial);
+		}
+	}
+	return out;
+}
+
+CoverageRegions CoverageGrid::regions() const {
+	CoverageRegions out;
+
+	// Runs of like tiles along each row; a run matching one of the row above extends it.
+	struct Open {
+		Coverage kind;
+		int c0, c1;
+		Rect rect;
+		bool seen;
+	};
+	std::vector<Open> open;
+	auto close = [&](const Open& o) {
+		(o.kind == Coverage::One ? out.one : out.partial).push_back(o.rect);
+	};
+
+	for (int r = 0; r < rows_; ++r) {
+		for (Open& o : open) o.seen = false;
+		std::vector<Open> next;
+		for (int c = 0; c < columns_;) {
+			const Coverage kind = at(c, r);
+			int end = c + 1;
+			while (end < columns_ && at(end, r) == kind) ++end;
+			if (kind != Coverage::Zero) {
+				const Rect first = tileRect(c, r), last = tileRect(end - 1, r);
+				const Rect run{ first.x, first.y, last.right() - first.x, first.height };
+				auto match = std::find_if(open.begin(), open.end(), [&](const Open& o) {
+					return o.kind == kind && o.c0 == c && o.c1 == end;
+				});
+				if (match != open.end()) {
+					match->seen = true;
+					Open grown = *match;
+					grown.rect.height = run.bottom() - grown.rect.y;
+					next.push_back(grown);
+				} else {
+					next.push_back({ kind, c, end, run, false });
+				}
+			}
+			c = end;
+		}
+		for (const Open& o : open) {
+			if (!o.seen) close(o);
+		}
+		open = std::move(next);
+	}
+	for (const Open& o : open) close(o);
+
+	for (const auto* list : { &out.partial, &out.one }) {
+		for (const Rect& r : *list) {
+			if (out.support.empty()) {
+				out.support = r;
+				continue;
+			}
+			const int x0 = std::min(out.support.x, r.x), y0 = std::min(out.support.y, r.y);
+			const int x1 = std::max(out.support.right(), r.right()), y1 = std::max(out.support.bottom(), r.bottom());
+			out.support = { x0, y0, x1 - x0, y1 - y0 };
+		}
+	}
+	return out;
+}
+
+double CoverageGrid::coveredFraction() const {
+	if (bounds_.empty()) return 0.0;
+	int64_t covered = 0;
+	for (int r = 0; r < rows_; ++r) {
+		for (int c = 0; c < columns_; ++c) {
+			if (at(c, r) != Coverage::Zero) covered += tileRect(c, r).area();
+		}
+	}
+	return double(covered) / double(bounds_.area());
+}
+
+// MARK: - Shapes
+
+CoverageGrid linearCoverage(const LinearMaskShape& shape, const Rect& bounds, int tileSize) {
+	const float dx = shape.x1 - shape.x0, dy = shape.y1 - shape.y0;
+	const float length2 = dx * dx + dy * dy;
+	CoverageGrid grid(bounds, tileSize, Coverage::One);
+	if (!(length2 > 0.0f)) return grid;
+
+	// Gradient parameter t: 0 at the start (mask 1), 1 at the end (mask 0).
+	auto t = [&](float x, float y) { return ((x - shape.x0) * dx + (y - shape.y0) * dy) / length2; };
+	for (int r = 0; r < grid.rows(); ++r) {
+		for (int c = 0; c < grid.columns(); ++c) {
+			const Rect tile = grid.tileRect(c, r);
+			const float x0 = float(tile.x), y0 = float(tile.y), x1 = float(tile.right()), y1 = float(tile.bottom());
+			const float a = t(x0, y0), b = t(x1, y0), d = t(x0, y1), e = t(x1, y1);
+			const float lo = std::min({ a, b, d, e }), hi = std::max({ a, b, d, e });
+			grid.set(c, r, hi <= 0.0f ? Coverage::One : lo >= 1.0f ? Coverage::Zero : Coverage::Partial);
+		}
+	}
+	return grid;
+}
+
+CoverageGrid radialCoverage(const RadialMaskShape& shape, const Rect& bounds, int tileSize) {
+	CoverageGrid grid(bounds, tileSize, Coverage::Zero);
+	const bool degenerate = !(shape.rx > 0.0f) || !(shape.ry > 0.0f);
+	const float inner = 1.0f - std::clamp(shape.feather, 0.0f, 1.0f);
+	const float cs = std::cos(shape.rotation), sn = std::sin(shape.rotation);
+
+	for (int r = 0; r < grid.rows(); ++r) {
+		for (int c = 0; c < grid.columns(); ++c) {
+			Extremes e;
+			if (degenerate) {
+				e.maxZero = true;
+			} else {
+				const Rect tile = grid.tileRect(c, r);
+				const float xs[2] = { float(tile.x) - shape.cx, float(tile.right()) - shape.cx };
+				const float ys[2] = { float(tile.y) - shape.cy, float(tile.bottom()) - shape.cy };
+				// Corners in units of the outer semi-axes, along the ellipse's axes.
+				float u0 = INFINITY, u1 = -INFINITY, v0 = INFINITY, v1 = -INFINITY, far = 0.0f;
+				for (float x : xs) {
+					for (float y : ys) {
+						const float u = (x * cs + y * sn) / shape.rx, v = (y * cs - x * sn) / shape.ry;
+						u0 = std::min(u0, u); u1 = std::max(u1, u);
+						v0 = std::min(v0, v); v1 = std::max(v1, v);
+						far = std::max(far, u * u + v * v);
+					}
+				}
+				const float nu = std::clamp(0.0f, u0, u1), nv = std::clamp(0.0f, v0, v1);
+				e.maxZero = nu * nu + nv * nv >= 1.0f;
+				e.minOne = inner > 0.0f && far <= inner * inner;
+			}
+			grid.set(c, r, classify(e, shape.opacity, shape.invert));
+		}
+	}
+	return grid;
+}
+
+CoverageGrid rasterCoverage(const uint8_t* mask, size_t rowBytes, const Rect& bounds, int tileSize) {
+	CoverageGrid grid(bounds, tileSize, Coverage::Zero);
+	if (!mask) return grid;
+
+	parallelFor(size_t(grid.rows()), [&](size_t r) {
+		for (int c = 0; c < grid.columns(); ++c) {
+			const Rect tile = grid.tileRect(c, int(r));
+			uint8_t lo = 255, hi = 0;
+			for (int y = tile.y; y < tile.bottom() && !(lo == 0 && hi == 255); ++y) {
+				const uint8_t* row = mask + size_t(y - bounds.y) * rowBytes + size_t(tile.x - bounds.x);
+				for (int x = 0; x < tile.width; ++x) {
+					lo = std::min(lo, row[x]);
+					hi = std::max(hi, row[x]);
+				}
+			}
+			grid.set(c, int(r), hi == 0 ? Coverage::Zero : lo == 255 ? Coverage::One : Coverage::Partial);
+		}
+	});
+	return grid;
+}
+
+CoverageGrid tiledCoverage(const Coverage* tiles, int columns, int rows, int span, const Rect& bounds, int tileSize) {
+	CoverageGrid grid(bounds, tileSize, Coverage::Zero);
+	if (!tiles || span <= 0) return grid;
+
+	for (int r = 0; r < grid.rows(); ++r) {
+		for (int c = 0; c < grid.columns(); ++c) {
+			const Rect tile = grid.tileRect(c, r);
+			const int c0 = (tile.x - bounds.x) / span, c1 = (tile.right() - 1 - bounds.x) / span;
+			const int r0 = (tile.y - bounds.y) / span, r1 = (tile.bottom() - 1 - bounds.y) / span;
+			bool any = false, all = true;
+			for (int rr = r0; rr <= r1; ++rr) {
+				for (int cc = c0; cc <= c1; ++cc) {
+					// Squares past the mask's own extent are zero.
+					const Coverage kind = rr < rows && cc < columns ? tiles[size_t(rr) * size_t(columns) + size_t(cc)] : Coverage::Zero;
+					any = any || kind != Coverage::Zero;
+					all = all && kind == Coverage::One;
+				}
+			}
+			grid.set(c, r, all ? Coverage::One : any ? Coverage::Partial : Coverage::Zero);
+		}
+	}
+	return grid;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeMaskCoverage {
+	forge::CoverageGrid grid;
+	forge::CoverageRegions regions;
+};
+
+namespace {
+
+ForgeMaskCoverage* makeCoverage(const forge::CoverageGrid& grid, int32_t spread) {
+	auto* handle = new ForgeMaskCoverage;
+	handle->grid = grid.dilated(spread);
+	handle->regions = handle->grid.regions();
+	return handle;
+}
+
+ForgeRect forgeRect(const forge::Rect& r) {
+	return { r.x, r.y, r.width, r.height };
+}
+
+} // namespace
+
+extern "C" {
+	ForgeMaskCoverage* ForgeMaskCoverageCreateRadial(ForgeRadialMaskShape shape, ForgeRect bounds, int32_t tileSize, int32_t spread) {
+		const forge::RadialMaskShape s{ shape.cx, shape.cy, shape.rx, shape.ry, shape.rotation, shape.feather, shape.opacity, shape.invert };
+		return makeCoverage(forge::radialCoverage(s, { bounds.x, bounds.y, bounds.width, bounds.height }, tileSize), spread);
+	}
+
+	ForgeMaskCoverage* ForgeMaskCoverageCreateRaster(const uint8_t* mask, size_t rowBytes, ForgeRect bounds, int32_t tileSize, int32_t spread) {
+		return makeCoverage(forge::rasterCoverage(mask, rowBytes, { bounds.x, bounds.y, bounds.width, bounds.height }, tileSize), spread);
+	}
+
+	ForgeMaskCoverage* ForgeMaskCoverageCreateTiled(const uint8_t* tiles, int32_t columns, int32_t rows, int32_t span,
+													ForgeRect bounds, int32_t tileSize, int32_t spread) {
+		return makeCoverage(forge::tiledCoverage(reinterpret_cast<const forge::Coverage*>(tiles), columns, rows, span,
+												 { bounds.x, bounds.y, bounds.width, bounds.height }, tileSize), spread);
+	}
+
+	void ForgeMaskCoverageRelease(ForgeMaskCoverage* coverage) {
+		delete coverage;
+	}
+
+	ForgeRect ForgeMaskCoverageSupport(const ForgeMaskCoverage* coverage) {
+		return coverage ? forgeRect(coverage->regions.support) : ForgeRect{ 0, 0, 0, 0 };
+	}
+
+	double ForgeMaskCoverageFraction(const ForgeMaskCoverage* coverage) {
+		return coverage ? coverage->grid.coveredFraction() : 0.0;
+	}
+
+	int32_t ForgeMaskCoverageRegionCount(const ForgeMaskCoverage* coverage, bool one) {
+		if (!coverage) return 0;
+		return int32_t((one ? coverage->regions.one : coverage->regions.partial).size());
+	}
+
+	ForgeRect ForgeMaskCoverageRegion(const ForgeMaskCoverage* coverage, bool one, int32_t index) {
+		if (!coverage || index < 0) return { 0, 0, 0, 0 };
+		const auto& list = one ? coverage->regions.one : coverage->regions.partial;
+		return size_t(index) < list.size() ? forgeRect(list[size_t(index)]) : ForgeRect{ 0, 0, 0, 0 };
+	}
+}
@@ -0,0 +1,105 @@
+//
+//  MaskCoverage.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Where a mask is zero, partial or one, per tile, so a masked node is only evaluated where it
+ shows.
+
+ applyNodeWithMasks applies the node to the whole frame for every mask and blends the result
+ back under that mask: five small radial masks cost five full-frame evaluations of the node.
+ With the coverage of each mask the pipeline can take the blended image only on partial
+ tiles, the node output as-is on tiles where the mask is one, and leave every other tile
+ untouched; Core Image then never evaluates the node outside the masked area.
+
+ - Linear gradients are one behind the start point and zero past the end point; the mask
+   parameter is linear, so a tile's four corners bound it.
+ - Radial masks are one inside the inner (feathered) ellipse at full opacity and zero outside
+   the outer one. In ellipse space a tile's farthest point is a corner; its nearest is taken
+   from the tile's bounding box there, which is exact without rotation and conservative with.
+ - Raster (AI) masks are classified from their pixels: zero when a tile's maximum is zero,
+   one when its minimum is full scale. Stored masks (SegmentationMask) carry these kinds for
+   their own finer tiles, so their coverage needs no pixels at all.
+
+ A filter applied to the mask afterwards (the guided filter, a feather) can spread it;
+ dilated() turns tiles within that distance of a change into partial ones.
+
+ Coordinates are image pixels with y down. Tiles lie on a grid aligned to multiples of the
+ tile size, and regions() merges runs of like tiles into a few rectangles.
+ */
+
+enum class Coverage : uint8_t { Zero, Partial, One };
+
+// Mask 1 at (x0, y0), falling to 0 at (x1, y1) along the line between them.
+struct LinearMaskShape {
+	float x0 = 0.0f, y0 = 0.0f;
+	float x1 = 0.0f, y1 = 0.0f;
+};
+
+// Ellipse centred at (cx, cy) with semi-axes rx, ry, turned by `rotation` radians. `feather`
+// (0-1) is the share of the radius over which the mask falls off; `opacity` (0-1) scales the
+// inside.
+struct RadialMaskShape {
+	float cx = 0.0f, cy = 0.0f;
+	float rx = 0.0f, ry = 0.0f;
+	float rotation = 0.0f;
+	float feather = 0.0f;
+	float opacity = 1.0f;
+	bool invert = false;
+};
+
+struct CoverageRegions {
+	std::vector<Rect> partial;
+	std::vector<Rect> one;
+	Rect support;               // bounds of partial and one
+};
+
+class CoverageGrid {
+public:
+	CoverageGrid() = default;
+	CoverageGrid(const Rect& bounds, int tileSize, Coverage fill);
+
+	const Rect& bounds() const { return bounds_; }
+	int tileSize() const { return tileSize_; }
+	int columns() const { return columns_; }
+	int rows() const { return rows_; }
+
+	Coverage at(int column, int row) const { return tiles_[size_t(row) * size_t(columns_) + size_t(column)]; }
+	void set(int column, int row, Coverage c) { tiles_[size_t(row) * size_t(columns_) + size_t(column)] = c; }
+	// Tile rectangle, clipped to bounds().
+	Rect tileRect(int column, int row) const;
+
+	// Tiles within `pixels` of a tile of another kind become partial.
+	CoverageGrid dilated(int pixels) const;
+	CoverageRegions regions() const;
+	// Share of bounds() in partial and one tiles.
+	double coveredFraction() const;
+
+private:
+	Rect bounds_;
+	int tileSize_ = 0;
+	int originX_ = 0, originY_ = 0;   // top-left of tile (0, 0), a multiple of tileSize_
+	int columns_ = 0, rows_ = 0;
+	std::vector<Coverage> tiles_;
+};
+
+CoverageGrid linearCoverage(const LinearMaskShape& shape, const Rect& bounds, int tileSize);
+CoverageGrid radialCoverage(const RadialMaskShape& shape, const Rect& bounds, int tileSize);
+// `mask` holds bounds.width × bounds.height bytes, rows `rowBytes` apart, 255 = one.
+CoverageGrid rasterCoverage(const uint8_t* mask, size_t rowBytes, const Rect& bounds, int tileSize);
+// `tiles`: columns × rows kinds of span × span squares, the first at the top-left of bounds, as
+// a SegmentationMask keeps them. A grid tile is zero or one only if every square it touches is.
+CoverageGrid tiledCoverage(const Coverage* tiles, int columns, int rows, int span, const Rect& bounds, int tileSize);
+
+} // namespace forge
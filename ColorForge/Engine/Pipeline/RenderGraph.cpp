@@ -0,0 +1,252 @@
+//
+//  RenderGraph.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "RenderGraph.hpp"
+#include "Parallel.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace forge {
+
+// MARK: - Nodes
+
+RenderNode RenderNode::makePointwise(std::string name) {
+	RenderNode n;
+	n.name = std::move(name);
+	n.kind = NodeKind::Pointwise;
+	return n;
+}
+
+RenderNode RenderNode::makeNeighbourhood(std::string name, int radius) {
+	RenderNode n;
+	n.name = std::move(name);
+	n.kind = NodeKind::Neighbourhood;
+	n.radius = std::max(0, radius);
+	return n;
+}
+
+RenderNode RenderNode::makeReduction(std::string name) {
+	RenderNode n;
+	n.name = std::move(name);
+	n.kind = NodeKind::Reduction;
+	return n;
+}
+
+Rect RenderNode::inputRegion(const Rect& output, float scale) const {
+	if (roiCallback) return roiCallback(output, scale);
+	if (kind != NodeKind::Neighbourhood) return output;
+	return output.outset(int(std::ceil(float(radius) * scale)));
+}
+
+size_t RenderGraph::add(RenderNode node) {
+	nodes_.push_back(std::move(node));
+	return nodes_.size() - 1;
+}
+
+// MARK: - Viewport
+
+int ViewportRequest::scaledWidth() const {
+	return std::max(1, int(std::ceil(float(frameWidth) * scale)));
+}
+
+int ViewportRequest::scaledHeight() const {
+	return std::max(1, int(std::ceil(float(frameHeight) * scale)));
+}
+
+Rect ViewportRequest::scaledVisible() const {
+	const int x0 = int(std::floor(float(visible.x) * scale));
+	const int y0 = int(std::floor(float(visible.y) * scale));
+	const int x1 = int(std::ceil(float(visible.right()) * scale));
+	const int y1 = int(std::ceil(float(visible.bottom()) * scale));
+	return Rect{ x0, y0, x1 - x0, y1 - y0 }.intersect({ 0, 0, scaledWidth(), scaledHeight() });
+}
+
+std::vector<Rect> RenderGraph::viewportRegions(const ViewportRequest& request) const {
+	const Rect frame{ 0, 0, request.scaledWidth(), request.scaledHeight() };
+
+	std::vector<Rect> regions(nodes_.size() + 1);
+	Rect need = request.scaledVisible();
+	for (size_t i = nodes_.size(); i-- > 0;) {
+		const RenderNode& node = nodes_[i];
+		if (node.kind == NodeKind::Reduction) {
+			need = frame; // a reduction reads, and passes on, the whole frame
+		}
+		regions[i + 1] = need;
+		need = node.inputRegion(need, request.scale).intersect(frame);
+	}
+	regions[0] = need;
+	return regions;
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+// Edge-clamped box blur of `src` into `dst` (same size), the clampedToExtent behaviour of
+// BoxBlurNode. Separable running sums, accumulated in double.
+void boxBlur(const ImageView& src, const ImageView& dst, int radius) {
+	const int width = src.width, height = src.height;
+	const double norm = 1.0 / double(2 * radius + 1);
+	ImageBuffer rows(width, height, 4);
+	const ImageView tmp = rows.view();
+
+	parallelFor(size_t(height), [&](size_t y) {
+		const float* in = src.row(int(y));
+		float* out = tmp.row(int(y));
+		double sum[4] = { 0, 0, 0, 0 };
+		for (int i = -radius; i <= radius; ++i) {
+			const float* p = in + size_t(std::clamp(i, 0, width - 1)) * 4;
+			for (int k = 0; k < 4; ++k) sum[k] += p[k];
+		}
+		for (int x = 0; x < width; ++x) {
+			const float* add = in + size_t(std::min(x + radius + 1, width - 1)) * 4;
+			const float* drop = in + size_t(std::max(x - radius, 0)) * 4;
+			for (int k = 0; k < 4; ++k) {
+				out[size_t(x) * 4 + k] = float(sum[k] * norm);
+				sum[k] += double(add[k]) - double(drop[k]);
+			}
+		}
+	});
+
+	constexpr int kColumns = 64;
+	parallelFor(size_t((width + kColumns - 1) / kColumns), [&](size_t b) {
+		const int x0 = int(b) * kColumns;
+		const int n = std::min(kColumns, width - x0) * 4;
+		std::vector<double> sum(size_t(n), 0.0);
+		for (int i = -radius; i <= radius; ++i) {
+			const float* p = tmp.row(std::clamp(i, 0, height - 1)) + size_t(x0) * 4;
+			for (int k = 0; k < n; ++k) sum[size_t(k)] += p[k];
+		}
+		for (int y = 0; y < height; ++y) {
+			const float* add = tmp.row(std::min(y + radius + 1, height - 1)) + size_t(x0) * 4;
+			const float* drop = tmp.row(std::max(y - radius, 0)) + size_t(x0) * 4;
+			float* out = dst.row(y) + size_t(x0) * 4;
+			for (int k = 0; k < n; ++k) {
+				out[k] = float(sum[size_t(k)] * norm);
+				sum[size_t(k)] += double(add[k]) - double(drop[k]);
+			}
+		}
+	});
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ViewportBenchmark benchmarkViewport(int width, int height) {
+	constexpr int kRadii[2] = { 8, 3 };
+	RenderGraph graph;
+	graph.add(RenderNode::makePointwise("Exposure"));
+	graph.add(RenderNode::makeNeighbourhood("BoxBlur", kRadii[0]));
+	graph.add(RenderNode::makePointwise("Contrast"));
+	graph.add(RenderNode::makeNeighbourhood("BoxBlur", kRadii[1]));
+
+	ImageBuffer source(width, height, 4);
+	const ImageView src = source.view();
+	parallelFor(size_t(height), [&](size_t y) {
+		float* row = src.row(int(y));
+		for (int x = 0; x < width; ++x) {
+			row[x * 4 + 0] = float((x * 37 + int(y) * 11) % 101) / 101.0f;
+			row[x * 4 + 1] = float(y) / float(height);
+			row[x * 4 + 2] = float((x / 16 + int(y) / 16) % 2);
+			row[x * 4 + 3] = 1.0f;
+		}
+	});
+
+	// The blurs in place of the graph's neighbourhood nodes, over whatever they are given.
+	auto render = [&](const ImageView& input, ImageBuffer& output) {
+		ImageBuffer first(input.width, input.height, 4);
+		output.allocate(input.width, input.height, 4);
+		boxBlur(input, first.view(), kRadii[0]);
+		boxBlur(first.view(), output.view(), kRadii[1]);
+	};
+
+	ViewportBenchmark result;
+	ImageBuffer full;
+	auto t0 = std::chrono::steady_clock::now();
+	render(src, full);
+	result.fullSeconds = secondsSince(t0);
+
+	const int w = std::max(1, width / 4), h = std::max(1, height / 4);
+	const Rect views[] = {
+		{ (width - w) / 2, (height - h) / 2, w, h },   // centre
+		{ 0, 0, w, h },                                // corners
+		{ width - w, height - h, w, h },
+		{ 0, (height - h) / 2, w, h },                 // edges
+		{ width - w, 0, w, h },
+		{ (width - w) / 2, height - 1, w, 1 },         // one row, one column
+		{ width - 1, (height - h) / 2, 1, h },
+	};
+
+	for (const Rect& visible : views) {
+		ViewportRequest request;
+		request.frameWidth = width;
+		request.frameHeight = height;
+		request.visible = visible;
+		request.scale = 1.0f;
+
+		t0 = std::chrono::steady_clock::now();
+		const Rect region = graph.viewportRegions(request).front();
+		ImageBuffer crop(region.width, region.height, 4);
+		copyImage(src.sub(region), crop.view());
+		ImageBuffer view;
+		render(crop.view(), view);
+		if (result.viewports == 0) {
+			result.viewportSeconds = secondsSince(t0);
+			result.sourceFraction = double(region.area()) / (double(width) * double(height));
+		}
+		result.viewports++;
+
+		const ImageView got = view.view().sub({ visible.x - region.x, visible.y - region.y, visible.width, visible.height });
+		const ImageView expected = full.view().sub(visible);
+		for (int y = 0; y < visible.height; ++y) {
+			const float* a = got.row(y);
+			const float* b = expected.row(y);
+			for (int i = 0; i < visible.width * 4; ++i) {
+				result.maxError = std::max(result.maxError, double(std::fabs(a[i] - b[i])));
+			}
+		}
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	ForgeViewportBenchmark ForgeBenchmarkViewport(int32_t width, int32_t height) {
+		const forge::ViewportBenchmark b = forge::benchmarkViewport(width, height);
+		return { b.fullSeconds, b.viewportSeconds, b.sourceFraction, b.viewports, b.maxError };
+	}
+
+	ForgeRect ForgeViewportSourceRegion(int32_t frameWidth, int32_t frameHeight, ForgeRect visible, float scale,
+										const int32_t* radii, int32_t radiusCount) {
+		forge::RenderGraph graph;
+		for (int32_t i = 0; radii && i < radiusCount; ++i) {
+			if (radii[i] > 0) {
+				graph.add(forge::RenderNode::makeNeighbourhood("Radius", radii[i]));
+			} else {
+				graph.add(forge::RenderNode::makePointwise("Pointwise"));
+			}
+		}
+
+		forge::ViewportRequest request;
+		request.frameWidth = frameWidth;
+		request.frameHeight = frameHeight;
+		request.visible = { visible.x, visible.y, visible.width, visible.height };
+		request.scale = scale;
+
+		const forge::Rect r = graph.viewportRegions(request).front();
+		return { r.x, r.y, r.width, r.height };
+	}
+}
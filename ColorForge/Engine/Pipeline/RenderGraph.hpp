@@ -0,0 +1,100 @@
+//
+//  RenderGraph.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ The shape of FilterPipeline.applyPipelineV2Sync's chain, for planning a zoomed render.
+
+ Every FilterNode falls into one of three shapes:
+ - Pointwise      output pixel depends only on the same input pixel (exposure, contrast,
+                  HDR, HSD, negative decode, the enlarger colour nodes)
+ - Neighbourhood  output pixel reads a window of `radius` pixels (blurs, MTF, halation)
+ - Reduction      reads the whole frame to produce values later nodes consume
+                  (averages, histograms); the image itself passes through untouched
+
+ The nodes only carry what they read; Core Image does the rendering. FilterPipeline.viewportSource
+ describes its neighbourhood nodes through ForgeViewportSourceRegion and crops its source to the
+ region that comes back.
+ */
+
+enum class NodeKind { Pointwise, Neighbourhood, Reduction };
+
+// Input region (in render-scale pixels) needed to produce `output`, like a CIKernel roiCallback.
+using RegionFn = std::function<Rect(const Rect& output, float scale)>;
+
+struct RenderNode {
+	std::string name;
+	NodeKind kind = NodeKind::Pointwise;
+	int radius = 0;        // full-resolution pixels; scaled with the render
+	RegionFn roiCallback;  // optional; defaults to the output grown by the scaled radius
+
+	static RenderNode makePointwise(std::string name);
+	static RenderNode makeNeighbourhood(std::string name, int radius);
+	static RenderNode makeReduction(std::string name);
+
+	Rect inputRegion(const Rect& output, float scale) const;
+};
+
+// MARK: - Viewport
+
+/*
+ When the viewer is zoomed in only `visible` is on screen. Walking the graph backwards from
+ that rect, each node grows it by what it reads (blur/MTF/halation radii at the current
+ scale), which gives the one region the source has to decode and demosaic. Cost is then
+ proportional to screen pixels rather than sensor pixels.
+ */
+struct ViewportRequest {
+	int frameWidth = 0;    // full-resolution frame
+	int frameHeight = 0;
+	Rect visible;          // full-resolution pixels
+	float scale = 1.0f;    // output pixels per full-resolution pixel (1 when zoomed to 100%)
+
+	int scaledWidth() const;
+	int scaledHeight() const;
+	Rect scaledVisible() const; // visible rect in render-scale pixels, clamped to the frame
+};
+
+class RenderGraph {
+public:
+	size_t add(RenderNode node);
+	const std::vector<RenderNode>& nodes() const { return nodes_; }
+	bool empty() const { return nodes_.empty(); }
+
+	// Per node, the region it has to produce for `request` (render-scale pixels), plus the
+	// source region at index 0. Reductions force everything before them to the full frame.
+	std::vector<Rect> viewportRegions(const ViewportRequest& request) const;
+
+private:
+	std::vector<RenderNode> nodes_;
+};
+
+// MARK: - Benchmark
+
+struct ViewportBenchmark {
+	double fullSeconds = 0.0;      // the whole frame
+	double viewportSeconds = 0.0;  // a centred quarter-width, quarter-height view
+	double sourceFraction = 0.0;   // of the frame, what that view had to decode
+	int viewports = 0;
+	// Against the same crop of the full render. The box blurs accumulate in double, so only
+	// rounding differs; a missing apron would be off by tenths.
+	double maxError = 0.0;
+};
+
+// Two edge-clamped box blurs rendered whole on a synthetic `width` × `height` frame, then over
+// the source region viewportRegions gives for views in the middle, on each edge and in the corners.
+ViewportBenchmark benchmarkViewport(int width, int height);
+
+} // namespace forge
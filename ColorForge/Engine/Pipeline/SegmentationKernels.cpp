@@ -0,0 +1,363 @@
+//
+//  SegmentationKernels.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "SegmentationKernels.hpp"
+#include "DistanceTransform.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace forge {
+
+namespace {
+
+constexpr int kLanes = 8;
+
+inline bool inside(float v) {
+	return v >= 0.5f;
+}
+
+// MARK: - Run labelling
+
+struct Run {
+	int x0, x1;       // [x0, x1)
+};
+
+// Connected components of the pixels on one side of 0.5, as row runs.
+struct RunLabels {
+	std::vector<size_t> rowStart;     // runs of row y: [rowStart[y], rowStart[y + 1])
+	std::vector<Run> runs;
+	std::vector<uint32_t> component;  // per run
+	std::vector<int64_t> area;        // per component
+	std::vector<uint8_t> border;      // per component: touches the frame edge
+};
+
+uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+void unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) {
+	a = findRoot(parent, a);
+	b = findRoot(parent, b);
+	if (a < b) parent[b] = a;
+	else if (b < a) parent[a] = b;
+}
+
+// Joins the runs of row y with the runs of row y − 1 they touch.
+void joinRows(const RunLabels& l, std::vector<uint32_t>& parent, int y, bool diagonal) {
+	size_t i = l.rowStart[size_t(y) - 1], j = l.rowStart[size_t(y)];
+	const size_t iEnd = l.rowStart[size_t(y)], jEnd = l.rowStart[size_t(y) + 1];
+	const int touch = diagonal ? 1 : 0;
+	while (i < iEnd && j < jEnd) {
+		const Run& a = l.runs[i];
+		const Run& b = l.runs[j];
+		if (a.x0 < b.x1 + touch && b.x0 < a.x1 + touch) unite(parent, uint32_t(i), uint32_t(j));
+		if (a.x1 < b.x1) ++i;
+		else if (b.x1 < a.x1) ++j;
+		else { ++i; ++j; }
+	}
+}
+
+RunLabels labelRuns(const ImageView& mask, bool foreground) {
+	RunLabels l;
+	const int width = mask.width, height = mask.height;
+
+	std::vector<std::vector<Run>> rows(static_cast<size_t>(height));
+	parallelFor(size_t(height), [&](size_t y) {
+		const float* m = mask.row(int(y));
+		for (int x = 0; x < width;) {
+			if (inside(m[x]) != foreground) { ++x; continue; }
+			const int x0 = x;
+			while (x < width && inside(m[x]) == foreground) ++x;
+			rows[y].push_back({ x0, x });
+		}
+	});
+	l.rowStart.assign(size_t(height) + 1, 0);
+	for (int y = 0; y < height; ++y) l.rowStart[size_t(y) + 1] = l.rowStart[size_t(y)] + rows[size_t(y)].size();
+	l.runs.resize(l.rowStart.back());
+	parallelFor(size_t(height), [&](size_t y) {
+		std::copy(rows[y].begin(), rows[y].end(), l.runs.begin() + std::ptrdiff_t(l.rowStart[y]));
+	});
+
+	// Bands of rows join independently (their runs are disjoint index ranges), then the bands
+	// join along their borders.
+	std::vector<uint32_t> parent(l.runs.size());
+	std::iota(parent.begin(), parent.end(), 0u);
+	const size_t bands = std::min<size_t>(size_t(height), workerCount() * 2);
+	const size_t step = (size_t(height) + bands - 1) / bands;
+	parallelChunks(size_t(height), bands, [&](size_t, size_t begin, size_t end) {
+		for (size_t y = begin + 1; y < end; ++y) joinRows(l, parent, int(y), foreground);
+	});
+	for (size_t y = step; y < size_t(height); y += step) joinRows(l, parent, int(y), foreground);
+
+	l.component.resize(l.runs.size());
+	std::vector<uint32_t> id(l.runs.size(), UINT32_MAX);
+	for (size_t i = 0; i < l.runs.size(); ++i) {
+		const uint32_t root = findRoot(parent, uint32_t(i));
+		if (id[root] == UINT32_MAX) {
+			id[root] = uint32_t(l.area.size());
+			l.area.push_back(0);
+			l.border.push_back(0);
+		}
+		l.component[i] = id[root];
+	}
+	for (int y = 0; y < height; ++y) {
+		const bool edgeRow = y == 0 || y == height - 1;
+		for (size_t i = l.rowStart[size_t(y)]; i < l.rowStart[size_t(y) + 1]; ++i) {
+			const Run& r = l.runs[i];
+			l.area[l.component[i]] += r.x1 - r.x0;
+			if (edgeRow || r.x0 == 0 || r.x1 == width) l.border[l.component[i]] = 1;
+		}
+	}
+	return l;
+}
+
+// Sets every run of the flagged components to `value`.
+void paintComponents(const ImageView& mask, const RunLabels& l, const std::vector<uint8_t>& paint, float value) {
+	parallelFor(size_t(mask.height), [&](size_t y) {
+		float* m = mask.row(int(y));
+		for (size_t i = l.rowStart[y]; i < l.rowStart[y + 1]; ++i) {
+			if (paint[l.component[i]]) std::fill(m + l.runs[i].x0, m + l.runs[i].x1, value);
+		}
+	});
+}
+
+} // namespace
+
+// MARK: - Upsampling
+
+BilinearTaps bilinearTaps(int outSize, int inSize) {
+	BilinearTaps t;
+	t.i0.resize(size_t(outSize));
+	t.i1.resize(size_t(outSize));
+	t.f.resize(size_t(outSize));
+	const float scale = float(inSize) / float(outSize);
+	for (int o = 0; o < outSize; ++o) {
+		const float u = std::clamp((float(o) + 0.5f) * scale - 0.5f, 0.0f, float(inSize - 1));
+		const int i0 = std::min(int(u), inSize - 1);
+		t.i0[size_t(o)] = i0;
+		t.i1[size_t(o)] = std::min(i0 + 1, inSize - 1);
+		t.f[size_t(o)] = u - float(i0);
+	}
+	return t;
+}
+
+void upsampleLogitRow(const float* logits, size_t rowFloats, const BilinearTaps& tx, const BilinearTaps& ty,
+					  int y, int x0, int x1, float* out) {
+	const float* a = logits + size_t(ty.i0[size_t(y)]) * rowFloats;
+	const float* b = logits + size_t(ty.i1[size_t(y)]) * rowFloats;
+	const float fy = ty.f[size_t(y)];
+	const int* i0 = tx.i0.data();
+	const int* i1 = tx.i1.data();
+	const float* fx = tx.f.data();
+	for (int x = x0; x < x1; x += kLanes) {
+		const int n = std::min(kLanes, x1 - x);
+		float top[kLanes], bottom[kLanes];
+		for (int l = 0; l < n; ++l) {
+			top[l] = a[i0[x + l]] + (a[i1[x + l]] - a[i0[x + l]]) * fx[x + l];
+			bottom[l] = b[i0[x + l]] + (b[i1[x + l]] - b[i0[x + l]]) * fx[x + l];
+		}
+		for (int l = 0; l < n; ++l) out[x - x0 + l] = top[l] + (bottom[l] - top[l]) * fy;
+	}
+}
+
+void upsampleLogits(const ImageView& logits, const ImageView& dst) {
+	if (!logits.valid() || !dst.valid()) return;
+	const BilinearTaps tx = bilinearTaps(dst.width, logits.width), ty = bilinearTaps(dst.height, logits.height);
+	parallelFor(size_t(dst.height), [&](size_t y) {
+		upsampleLogitRow(logits.data, logits.rowStride, tx, ty, int(y), 0, dst.width, dst.row(int(y)));
+	});
+}
+
+// MARK: - Activation
+
+void activateMask(const ImageView& mask, MaskActivation activation) {
+	parallelFor(size_t(mask.height), [&](size_t y) {
+		float* m = mask.row(int(y));
+		if (activation == MaskActivation::Threshold) {
+			for (int x = 0; x < mask.width; ++x) m[x] = m[x] > 0.0f ? 1.0f : 0.0f;
+		} else {
+			for (int x = 0; x < mask.width; ++x) m[x] = 1.0f / (1.0f + std::exp(-m[x]));
+		}
+	});
+}
+
+// MARK: - Components
+
+int removeSmallComponents(const ImageView& mask, int64_t minArea) {
+	if (!mask.valid() || minArea <= 0) return 0;
+	const RunLabels l = labelRuns(mask, true);
+	std::vector<uint8_t> paint(l.area.size());
+	int count = 0;
+	for (size_t c = 0; c < paint.size(); ++c) {
+		paint[c] = l.area[c] < minArea;
+		count += paint[c];
+	}
+	if (count) paintComponents(mask, l, paint, 0.0f);
+	return count;
+}
+
+int fillHoles(const ImageView& mask, int64_t maxArea) {
+	if (!mask.valid() || maxArea <= 0) return 0;
+	const RunLabels l = labelRuns(mask, false);
+	std::vector<uint8_t> paint(l.area.size());
+	int count = 0;
+	for (size_t c = 0; c < paint.size(); ++c) {
+		paint[c] = !l.border[c] && l.area[c] < maxArea;
+		count += paint[c];
+	}
+	if (count) paintComponents(mask, l, paint, 1.0f);
+	return count;
+}
+
+// MARK: - Feather
+
+void featherMask(const ImageView& mask, float radius) {
+	if (!mask.valid() || !(radius > 0.0f)) return;
+	MaskSource source;
+	source.width = mask.width;
+	source.height = mask.height;
+	source.floats = mask;
+	FeatherRemap remap;
+	remap.radius = radius;
+	signedDistanceRows(source, [&](int y, const float* d) {
+		float* m = mask.row(y);
+		for (int x = 0; x < mask.width; ++x) m[x] = remap(d[x]);
+	});
+}
+
+// MARK: - Pipeline
+
+void postProcessSegmentation(const ImageView& logits, const SegmentationParams& params, const ImageView& dst) {
+	if (!logits.valid() || !dst.valid()) return;
+	upsampleLogits(logits, dst);
+	activateMask(dst, params.activation);
+	removeSmallComponents(dst, params.minComponentArea);
+	fillHoles(dst, params.maxHoleArea);
+	featherMask(dst, params.feather);
+}
+
+// MARK: - Benchmark
+
+SegmentationBenchmark benchmarkSegmentation(int width, int height, float feather) {
+	using Clock = std::chrono::steady_clock;
+	auto rate = [&](Clock::time_point t0) {
+		const double s = std::chrono::duration<double>(Clock::now() - t0).count();
+		return double(width) * double(height) / 1e6 / std::max(s, 1e-9);
+	};
+	SegmentationBenchmark result;
+	if (width <= 0 || height <= 0) return result;
+
+	// A SAM-sized logit grid: one large object with holes punched in it, and specks around it.
+	constexpr int kLogits = 256;
+	struct Disc { float x, y, r, sign; };
+	const std::vector<Disc> holes = { { 110, 120, 3, -1 }, { 150, 140, 3, -1 }, { 128, 100, 2.5f, -1 } };
+	const std::vector<Disc> specks = { { 24, 24, 3, 1 }, { 232, 24, 3, 1 }, { 24, 232, 3, 1 }, { 232, 232, 2.5f, 1 }, { 128, 240, 3, 1 } };
+	result.holes = int(holes.size());
+	result.specks = int(specks.size());
+	ImageBuffer logits(kLogits, kLogits, 1);
+	const ImageView lv = logits.view();
+	for (int y = 0; y < kLogits; ++y) {
+		for (int x = 0; x < kLogits; ++x) {
+			float v = 4.0f * (80.0f - std::hypot(float(x) - 128.0f, float(y) - 128.0f));
+			for (const Disc& d : holes) v = std::min(v, 4.0f * (std::hypot(float(x) - d.x, float(y) - d.y) - d.r));
+			for (const Disc& d : specks) v = std::max(v, 4.0f * (d.r - std::hypot(float(x) - d.x, float(y) - d.y)));
+			lv.row(y)[x] = v;
+		}
+	}
+	// Larger than any hole or speck (radius ≤ 3 cells), far smaller than the object.
+	const double cell = double(width) / kLogits * double(height) / kLogits;
+	const int64_t area = int64_t(3.14159 * 6.0 * 6.0 * cell);
+
+	ImageBuffer mask(width, height, 1);
+	const ImageView mv = mask.view();
+	auto t0 = Clock::now();
+	upsampleLogits(lv, mv);
+	result.upsampleMegapixelsPerSecond = rate(t0);
+	t0 = Clock::now();
+	activateMask(mv, MaskActivation::Threshold);
+	result.activateMegapixelsPerSecond = rate(t0);
+	t0 = Clock::now();
+	result.componentsRemoved = removeSmallComponents(mv, area);
+	result.holesFilled = fillHoles(mv, area);
+	result.componentsMegapixelsPerSecond = rate(t0);
+	t0 = Clock::now();
+	featherMask(mv, feather);
+	result.featherMegapixelsPerSecond = rate(t0);
+
+	// A small frame of scattered shapes against a brute-force signed distance.
+	constexpr int kW = 160, kH = 120;
+	constexpr float kRadius = 6.0f;
+	ImageBuffer shapes(kW, kH, 1), reference(kW, kH, 1);
+	const ImageView sv = shapes.view(), rv = reference.view();
+	for (int y = 0; y < kH; ++y) {
+		for (int x = 0; x < kW; ++x) {
+			const bool in = ((x / 9 + y / 7) % 3 == 0) || std::hypot(float(x) - 80.0f, float(y) - 60.0f) < 30.0f;
+			sv.row(y)[x] = in ? 1.0f : 0.0f;
+		}
+	}
+	for (int y = 0; y < kH; ++y) {
+		for (int x = 0; x < kW; ++x) {
+			const bool in = inside(sv.row(y)[x]);
+			float best = INFINITY;
+			for (int yy = 0; yy < kH; ++yy) {
+				for (int xx = 0; xx < kW; ++xx) {
+					if (inside(sv.row(yy)[xx]) != in) best = std::min(best, float((x - xx) * (x - xx) + (y - yy) * (y - yy)));
+				}
+			}
+			const float d = std::sqrt(best) - 0.5f;
+			const float t = std::clamp((in ? d : -d) * (0.5f / kRadius) + 0.5f, 0.0f, 1.0f);
+			rv.row(y)[x] = t * t * (3.0f - 2.0f * t);
+		}
+	}
+	featherMask(sv, kRadius);
+	float maxDifference = 0.0f;
+	for (int y = 0; y < kH; ++y) {
+		for (int x = 0; x < kW; ++x) maxDifference = std::max(maxDifference, std::abs(sv.row(y)[x] - rv.row(y)[x]));
+	}
+	result.distancesExact = maxDifference < 1e-5f;
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	void ForgeSegmentationPostProcess(const float* logits, size_t logitRowBytes, int32_t logitWidth, int32_t logitHeight,
+									  ForgeSegmentationParams params, float* dst, size_t dstRowBytes, int32_t width, int32_t height) {
+		if (!logits || !dst) return;
+		const forge::ImageView src{ const_cast<float*>(logits), logitWidth, logitHeight, 1, logitRowBytes / sizeof(float) };
+		const forge::ImageView out{ dst, width, height, 1, dstRowBytes / sizeof(float) };
+		forge::SegmentationParams p;
+		p.activation = params.threshold ? forge::MaskActivation::Threshold : forge::MaskActivation::Sigmoid;
+		p.minComponentArea = params.minComponentArea;
+		p.maxHoleArea = params.maxHoleArea;
+		p.feather = params.feather;
+		forge::postProcessSegmentation(src, p, out);
+	}
+
+	void ForgeFeatherMask(float* mask, size_t rowBytes, int32_t width, int32_t height, float radius) {
+		if (!mask) return;
+		forge::featherMask({ mask, width, height, 1, rowBytes / sizeof(float) }, radius);
+	}
+
+	ForgeSegmentationBenchmark ForgeBenchmarkSegmentation(int32_t width, int32_t height, float feather) {
+		const forge::SegmentationBenchmark b = forge::benchmarkSegmentation(width, height, feather);
+		return { b.upsampleMegapixelsPerSecond, b.activateMegapixelsPerSecond, b.componentsMegapixelsPerSecond,
+				 b.featherMegapixelsPerSecond, b.componentsRemoved, b.holesFilled, b.specks, b.holes, b.distancesExact };
+	}
+}
@@ -0,0 +1,91 @@
+//
+//  SegmentationKernels.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Post-processing of SAM logits into a full-resolution mask, on plain single-channel float
+ buffers (ImageView with one channel).
+
+ getMask used to scan the low-resolution logits element by element for their range, convert
+ them to an 8-bit CGImage, scale that up in Core Image and threshold it. Here:
+ - upsampleLogits: bilinear, pixel centres aligned (as the model's own resize), eight pixels
+   at a time in plain loops the compiler vectorises, rows in parallel;
+ - activateMask: a sigmoid, or a hard threshold at logit 0;
+ - removeSmallComponents / fillHoles: connected components of the thresholded mask (≥ 0.5)
+   by union-find over row runs. SAM masks are a few runs per row, so labelling costs little
+   more than one read of the mask and its memory is proportional to the runs, not the pixels.
+   Bands of rows are labelled in parallel and joined along their borders. The foreground is
+   8-connected and the background 4-connected, so a hole is exactly what an 8-connected
+   outline encloses; holes touching the frame edge are not holes;
+ - featherMask: the exact signed distance to the mask's edge (DistanceTransform) and a
+   smoothstep across ± radius of it; the cost does not depend on the radius.
+
+ Each step works in place on the mask, so they chain on one buffer.
+ */
+
+// Bilinear taps of one output axis onto a grid of `inSize` samples, pixel centres aligned.
+struct BilinearTaps {
+	std::vector<int> i0, i1;
+	std::vector<float> f;
+};
+
+BilinearTaps bilinearTaps(int outSize, int inSize);
+
+// Output row y, pixels x0 ..< x1, of `logits` (rows `rowFloats` apart) upsampled with tx, ty.
+void upsampleLogitRow(const float* logits, size_t rowFloats, const BilinearTaps& tx, const BilinearTaps& ty,
+					  int y, int x0, int x1, float* out);
+
+// `logits` upsampled to the size of `dst`.
+void upsampleLogits(const ImageView& logits, const ImageView& dst);
+
+enum class MaskActivation : uint8_t { Sigmoid, Threshold };
+
+void activateMask(const ImageView& mask, MaskActivation activation);
+
+// Foreground components smaller than `minArea` pixels set to 0. Returns how many.
+int removeSmallComponents(const ImageView& mask, int64_t minArea);
+// Background components enclosed by the mask and smaller than `maxArea` pixels set to 1.
+// Returns how many.
+int fillHoles(const ImageView& mask, int64_t maxArea);
+
+// The thresholded mask softened across ± radius pixels of its edge.
+void featherMask(const ImageView& mask, float radius);
+
+struct SegmentationParams {
+	MaskActivation activation = MaskActivation::Threshold;
+	int64_t minComponentArea = 0;   // 0 keeps every component
+	int64_t maxHoleArea = 0;        // 0 fills nothing
+	float feather = 0.0f;           // 0 leaves the edge as activated
+};
+
+// All of the above, in order, from `logits` into `dst`.
+void postProcessSegmentation(const ImageView& logits, const SegmentationParams& params, const ImageView& dst);
+
+// MARK: - Benchmark
+
+struct SegmentationBenchmark {
+	double upsampleMegapixelsPerSecond = 0.0;
+	double activateMegapixelsPerSecond = 0.0;
+	double componentsMegapixelsPerSecond = 0.0;   // removeSmallComponents and fillHoles together
+	double featherMegapixelsPerSecond = 0.0;
+	int componentsRemoved = 0;                    // of `specks`
+	int holesFilled = 0;                          // of `holes`
+	int specks = 0;
+	int holes = 0;
+	bool distancesExact = false;                  // featherMask against a brute-force distance
+};
+
+SegmentationBenchmark benchmarkSegmentation(int width, int height, float feather);
+
+} // namespace forge
@@ -0,0 +1,553 @@
+//
+//  SegmentationMask.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "SegmentationMask.hpp"
+#include "Parallel.hpp"
+#include "SegmentationKernels.hpp"
+#include "TileCodec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace forge {
+
+static constexpr char kMagic[4] = { 'C', 'F', 'S', 'M' };
+static constexpr uint32_t kVersion = 2;            // 1: no origin, read as (0, 0)
+static constexpr int kTilePixels = SegmentationMask::kTileSize * SegmentationMask::kTileSize;
+static constexpr int kMaxSide = 1 << 17;
+
+struct SegmentationMaskHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileSize;
+	uint32_t checksum;      // CRC-32 of the tile kinds and offsets
+	uint64_t dataBytes;
+	int32_t originX;        // where the mask sits in its image (version 2)
+	int32_t originY;
+};
+static_assert(sizeof(SegmentationMaskHeader) == 40, "SegmentationMaskHeader layout changed");
+static constexpr size_t kVersion1HeaderBytes = 32;
+
+namespace {
+
+size_t kindsBytes(size_t tiles) {
+	return (tiles + 3) & ~size_t(3);
+}
+
+// MARK: - Run-length coding
+
+// Control byte c < 128: c + 1 literal bytes follow. c ≥ 128: the next byte repeats c − 125
+// times (3-130).
+constexpr int kMinRun = 3;
+constexpr int kMaxRun = 130;
+constexpr int kMaxLiterals = 128;
+
+void encodeRuns(const uint8_t* src, size_t count, std::vector<uint8_t>& out) {
+	size_t i = 0;
+	auto runAt = [&](size_t at) {
+		size_t n = 1;
+		while (at + n < count && n < size_t(kMaxRun) && src[at + n] == src[at]) ++n;
+		return n;
+	};
+	while (i < count) {
+		const size_t run = runAt(i);
+		if (run >= size_t(kMinRun)) {
+			out.push_back(uint8_t(128 + run - kMinRun));
+			out.push_back(src[i]);
+			i += run;
+			continue;
+		}
+		const size_t start = i;
+		while (i < count && i - start < size_t(kMaxLiterals) &&
+			   !(i + 2 < count && src[i] == src[i + 1] && src[i] == src[i + 2])) {
+			++i;
+		}
+		out.push_back(uint8_t(i - start - 1));
+		out.insert(out.end(), src + start, src + i);
+	}
+}
+
+bool decodeRuns(const uint8_t* src, size_t size, uint8_t* dst, size_t count) {
+	size_t i = 0, o = 0;
+	while (i < size) {
+		const uint8_t c = src[i++];
+		if (c < 128) {
+			const size_t n = size_t(c) + 1;
+			if (i + n > size || o + n > count) return false;
+			std::memcpy(dst + o, src + i, n);
+			i += n;
+			o += n;
+		} else {
+			const size_t n = size_t(c) - 128 + kMinRun;
+			if (i >= size || o + n > count) return false;
+			std::memset(dst + o, src[i++], n);
+			o += n;
+		}
+	}
+	return o == count;
+}
+
+// Classifies a tile's pixels (packed, `count` bytes) and appends them, coded, when partial.
+// Returns the kind and the bytes appended.
+Coverage encodeTile(const uint8_t* pixels, size_t count, std::vector<uint8_t>& out, uint32_t& size) {
+	const auto [lo, hi] = std::minmax_element(pixels, pixels + count);
+	size = 0;
+	if (*hi == 0) return Coverage::Zero;
+	if (*lo == 255) return Coverage::One;
+	const size_t start = out.size();
+	encodeRuns(pixels, count, out);
+	if (out.size() - start >= count) {
+		// Raw: the decoder tells it apart by its size.
+		out.resize(start);
+		out.insert(out.end(), pixels, pixels + count);
+	}
+	size = uint32_t(out.size() - start);
+	return Coverage::Partial;
+}
+
+// MARK: - Logits
+
+inline uint8_t quantise(float logit) {
+	return uint8_t(std::lrint(255.0f / (1.0f + std::exp(-logit))));
+}
+
+// Pixels x0 ..< x1 of output row y, quantised.
+void upsampleRow(const float* logits, size_t rowFloats, const BilinearTaps& tx, const BilinearTaps& ty, int y, int x0, int x1, uint8_t* out) {
+	constexpr int kSpan = SegmentationMask::kTileSize;
+	float row[kSpan];
+	for (int x = x0; x < x1; x += kSpan) {
+		const int n = std::min(kSpan, x1 - x);
+		upsampleLogitRow(logits, rowFloats, tx, ty, y, x, x + n, row);
+		for (int i = 0; i < n; ++i) out[x - x0 + i] = quantise(row[i]);
+	}
+}
+
+} // namespace
+
+// MARK: - Mask
+
+Rect SegmentationMask::tileRect(int column, int row) const {
+	return Rect{ column * kTileSize, row * kTileSize, kTileSize, kTileSize }.intersect({ 0, 0, width_, height_ });
+}
+
+size_t SegmentationMask::partialTiles() const {
+	return size_t(std::count(tiles_, tiles_ + size_t(columns_) * size_t(rows_), Coverage::Partial));
+}
+
+bool SegmentationMask::attach(const uint8_t* bytes, size_t size) {
+	if (!bytes || size < kVersion1HeaderBytes) return false;
+	SegmentationMaskHeader header{};
+	std::memcpy(&header, bytes, kVersion1HeaderBytes);
+	const size_t headerBytes = header.version == 1 ? kVersion1HeaderBytes : sizeof(header);
+	if (std::memcmp(header.magic, kMagic, 4) != 0 || header.version < 1 || header.version > kVersion ||
+		size < headerBytes || header.tileSize != uint32_t(kTileSize) || header.width == 0 || header.height == 0 ||
+		header.width > uint32_t(kMaxSide) || header.height > uint32_t(kMaxSide)) {
+		return false;
+	}
+	std::memcpy(&header, bytes, headerBytes);
+	const int columns = int((header.width + kTileSize - 1) / kTileSize), rows = int((header.height + kTileSize - 1) / kTileSize);
+	const size_t tiles = size_t(columns) * size_t(rows);
+	const size_t tables = kindsBytes(tiles) + (tiles + 1) * sizeof(uint32_t);
+	if (size < headerBytes + tables || size - headerBytes - tables < header.dataBytes) return false;
+	if (crc32Bytes(bytes + headerBytes, tables) != header.checksum) return false;
+
+	const Coverage* kinds = reinterpret_cast<const Coverage*>(bytes + headerBytes);
+	const uint32_t* offsets = reinterpret_cast<const uint32_t*>(bytes + headerBytes + kindsBytes(tiles));
+	for (size_t i = 0; i < tiles; ++i) {
+		const uint32_t n = offsets[i + 1] - offsets[i];
+		const bool partial = kinds[i] == Coverage::Partial;
+		if (uint8_t(kinds[i]) > uint8_t(Coverage::One) || offsets[i + 1] < offsets[i] || partial != (n > 0) ||
+			n > uint32_t(kTilePixels)) {
+			return false;
+		}
+	}
+	if (offsets[0] != 0 || offsets[tiles] != header.dataBytes) return false;
+
+	bytes_ = bytes;
+	size_ = headerBytes + tables + size_t(header.dataBytes);
+	headerBytes_ = headerBytes;
+	width_ = int(header.width);
+	height_ = int(header.height);
+	originX_ = header.originX;
+	originY_ = header.originY;
+	columns_ = columns;
+	rows_ = rows;
+	tiles_ = kinds;
+	offsets_ = offsets;
+	data_ = bytes + headerBytes + tables;
+	return true;
+}
+
+std::unique_ptr<SegmentationMask> SegmentationMask::assemble(int width, int height, std::vector<Coverage>&& kinds,
+															 std::vector<std::vector<uint8_t>>&& rowData,
+															 std::vector<std::vector<uint32_t>>&& rowSizes) {
+	const size_t tiles = kinds.size();
+	size_t dataBytes = 0;
+	for (const auto& data : rowData) dataBytes += data.size();
+	if (dataBytes > UINT32_MAX) return nullptr;
+
+	std::unique_ptr<SegmentationMask> mask(new SegmentationMask);
+	const size_t tables = kindsBytes(tiles) + (tiles + 1) * sizeof(uint32_t);
+	mask->owned_.assign(sizeof(SegmentationMaskHeader) + tables + dataBytes, 0);
+	uint8_t* bytes = mask->owned_.data();
+
+	std::memcpy(bytes + sizeof(SegmentationMaskHeader), kinds.data(), tiles);
+	uint32_t* offsets = reinterpret_cast<uint32_t*>(bytes + sizeof(SegmentationMaskHeader) + kindsBytes(tiles));
+	uint8_t* data = bytes + sizeof(SegmentationMaskHeader) + tables;
+	uint32_t offset = 0;
+	size_t index = 0;
+	for (size_t r = 0; r < rowData.size(); ++r) {
+		for (uint32_t n : rowSizes[r]) {
+			offsets[index++] = offset;
+			offset += n;
+		}
+		if (!rowData[r].empty()) std::memcpy(data, rowData[r].data(), rowData[r].size());
+		data += rowData[r].size();
+	}
+	offsets[tiles] = offset;
+
+	SegmentationMaskHeader header{};
+	std::memcpy(header.magic, kMagic, 4);
+	header.version = kVersion;
+	header.width = uint32_t(width);
+	header.height = uint32_t(height);
+	header.tileSize = kTileSize;
+	header.checksum = crc32Bytes(bytes + sizeof(header), tables);
+	header.dataBytes = dataBytes;
+	std::memcpy(bytes, &header, sizeof(header));
+
+	if (!mask->attach(bytes, mask->owned_.size())) return nullptr;
+	return mask;
+}
+
+std::unique_ptr<SegmentationMask> SegmentationMask::fromPixels(const uint8_t* pixels, size_t rowBytes, int width, int height) {
+	if (!pixels || width <= 0 || height <= 0 || width > kMaxSide || height > kMaxSide) return nullptr;
+	const int columns = (width + kTileSize - 1) / kTileSize, rows = (height + kTileSize - 1) / kTileSize;
+	std::vector<Coverage> kinds(size_t(columns) * size_t(rows));
+	std::vector<std::vector<uint8_t>> rowData(static_cast<size_t>(rows));
+	std::vector<std::vector<uint32_t>> rowSizes(static_cast<size_t>(rows));
+
+	parallelFor(size_t(rows), [&](size_t r) {
+		uint8_t tile[kTilePixels];
+		rowSizes[r].resize(size_t(columns));
+		const int y0 = int(r) * kTileSize, th = std::min(kTileSize, height - y0);
+		for (int c = 0; c < columns; ++c) {
+			const int x0 = c * kTileSize, tw = std::min(kTileSize, width - x0);
+			for (int y = 0; y < th; ++y) {
+				std::memcpy(tile + y * tw, pixels + size_t(y0 + y) * rowBytes + size_t(x0), size_t(tw));
+			}
+			kinds[r * size_t(columns) + size_t(c)] = encodeTile(tile, size_t(tw) * size_t(th), rowData[r], rowSizes[r][size_t(c)]);
+		}
+	});
+	return assemble(width, height, std::move(kinds), std::move(rowData), std::move(rowSizes));
+}
+
+std::unique_ptr<SegmentationMask> SegmentationMask::fromLogits(const float* logits, size_t logitRowFloats, int logitWidth,
+															   int logitHeight, int width, int height) {
+	if (!logits || logitWidth <= 0 || logitHeight <= 0 || width <= 0 || height <= 0 || width > kMaxSide || height > kMaxSide) {
+		return nullptr;
+	}
+	const int columns = (width + kTileSize - 1) / kTileSize, rows = (height + kTileSize - 1) / kTileSize;
+	const BilinearTaps tx = bilinearTaps(width, logitWidth), ty = bilinearTaps(height, logitHeight);
+	std::vector<Coverage> kinds(size_t(columns) * size_t(rows));
+	std::vector<std::vector<uint8_t>> rowData(static_cast<size_t>(rows));
+	std::vector<std::vector<uint32_t>> rowSizes(static_cast<size_t>(rows));
+
+	parallelFor(size_t(rows), [&](size_t r) {
+		uint8_t tile[kTilePixels];
+		rowSizes[r].resize(size_t(columns));
+		const int y0 = int(r) * kTileSize, th = std::min(kTileSize, height - y0);
+		const int ly0 = ty.i0[size_t(y0)], ly1 = ty.i1[size_t(y0 + th - 1)];
+		for (int c = 0; c < columns; ++c) {
+			const int x0 = c * kTileSize, tw = std::min(kTileSize, width - x0);
+			const size_t index = r * size_t(columns) + size_t(c);
+
+			// Every pixel interpolates logits from this block, so lies within its range.
+			const int lx0 = tx.i0[size_t(x0)], lx1 = tx.i1[size_t(x0 + tw - 1)];
+			float lo = INFINITY, hi = -INFINITY;
+			for (int ly = ly0; ly <= ly1; ++ly) {
+				const float* row = logits + size_t(ly) * logitRowFloats;
+				for (int lx = lx0; lx <= lx1; ++lx) {
+					lo = std::min(lo, row[lx]);
+					hi = std::max(hi, row[lx]);
+				}
+			}
+			if (quantise(hi) == 0) {
+				kinds[index] = Coverage::Zero;
+				continue;
+			}
+			if (quantise(lo) == 255) {
+				kinds[index] = Coverage::One;
+				continue;
+			}
+			for (int y = 0; y < th; ++y) upsampleRow(logits, logitRowFloats, tx, ty, y0 + y, x0, x0 + tw, tile + y * tw);
+			kinds[index] = encodeTile(tile, size_t(tw) * size_t(th), rowData[r], rowSizes[r][size_t(c)]);
+		}
+	});
+	return assemble(width, height, std::move(kinds), std::move(rowData), std::move(rowSizes));
+}
+
+std::unique_ptr<SegmentationMask> SegmentationMask::open(const std::string& path) {
+	std::unique_ptr<SegmentationMask> mask(new SegmentationMask);
+	if (!mask->file_.open(path) || !mask->attach(mask->file_.data(), mask->file_.size())) return nullptr;
+	return mask;
+}
+
+bool SegmentationMask::save(const std::string& path, int originX, int originY) const {
+	// Always written as the current version, with the origin given.
+	SegmentationMaskHeader header{};
+	std::memcpy(&header, bytes_, headerBytes_);
+	header.version = kVersion;
+	header.originX = originX;
+	header.originY = originY;
+	AtomicFileWriter writer(path);
+	return writer.write(&header, sizeof(header)) && writer.write(bytes_ + headerBytes_, size_ - headerBytes_) && writer.commit();
+}
+
+bool SegmentationMask::decodeTile(int column, int row, uint8_t* dst, size_t rowBytes) const {
+	const Rect tile = tileRect(column, row);
+	const size_t index = size_t(row) * size_t(columns_) + size_t(column);
+	const Coverage kind = tiles_[index];
+	if (kind != Coverage::Partial) {
+		const uint8_t value = kind == Coverage::One ? 255 : 0;
+		for (int y = 0; y < tile.height; ++y) std::memset(dst + size_t(y) * rowBytes, value, size_t(tile.width));
+		return true;
+	}
+	const size_t count = size_t(tile.width) * size_t(tile.height);
+	const size_t size = offsets_[index + 1] - offsets_[index];
+	const uint8_t* src = data_ + offsets_[index];
+	uint8_t packed[kTilePixels];
+	if (size == count) {
+		std::memcpy(packed, src, count);
+	} else if (!decodeRuns(src, size, packed, count)) {
+		return false;
+	}
+	for (int y = 0; y < tile.height; ++y) {
+		std::memcpy(dst + size_t(y) * rowBytes, packed + size_t(y) * size_t(tile.width), size_t(tile.width));
+	}
+	return true;
+}
+
+bool SegmentationMask::readRegion(const Rect& region, uint8_t* dst, size_t rowBytes) const {
+	if (!dst || region.empty()) return false;
+	const Rect inside = region.intersect({ 0, 0, width_, height_ });
+	if (inside.area() != region.area()) {
+		for (int y = 0; y < region.height; ++y) std::memset(dst + size_t(y) * rowBytes, 0, size_t(region.width));
+	}
+	if (inside.empty()) return true;
+
+	bool ok = true;
+	uint8_t scratch[kTilePixels];
+	for (int r = inside.y / kTileSize; r <= (inside.bottom() - 1) / kTileSize; ++r) {
+		for (int c = inside.x / kTileSize; c <= (inside.right() - 1) / kTileSize; ++c) {
+			const Rect tile = tileRect(c, r);
+			const Rect part = tile.intersect(inside);
+			uint8_t* out = dst + size_t(part.y - region.y) * rowBytes + size_t(part.x - region.x);
+			if (part.area() == tile.area()) {
+				ok = decodeTile(c, r, out, rowBytes) && ok;
+				continue;
+			}
+			ok = decodeTile(c, r, scratch, size_t(tile.width)) && ok;
+			for (int y = 0; y < part.height; ++y) {
+				const uint8_t* src = scratch + size_t(part.y - tile.y + y) * size_t(tile.width) + size_t(part.x - tile.x);
+				std::memcpy(out + size_t(y) * rowBytes, src, size_t(part.width));
+			}
+		}
+	}
+	return ok;
+}
+
+// MARK: - Benchmark
+
+SegmentationMaskBenchmark benchmarkSegmentationMask(int width, int height, int masks, const std::string& directory) {
+	using Clock = std::chrono::steady_clock;
+	auto seconds = [](Clock::time_point t0) { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+	SegmentationMaskBenchmark result;
+	result.masks = masks;
+	if (width <= 0 || height <= 0 || masks <= 0) return result;
+
+	// SAM-like logits: a few overlapping blobs per mask with edges about three logit cells
+	// wide, saturating well inside and outside, and a little texture.
+	constexpr int kLogits = 256;
+	auto makeLogits = [&](int m) {
+		std::vector<float> logits(static_cast<size_t>(kLogits * kLogits));
+		for (int y = 0; y < kLogits; ++y) {
+			for (int x = 0; x < kLogits; ++x) {
+				float best = -20.0f;
+				for (int b = 0; b < 3; ++b) {
+					const float cx = 128.0f + 80.0f * std::sin(float(m * 3 + b) * 1.7f);
+					const float cy = 128.0f + 80.0f * std::cos(float(m * 5 + b) * 1.3f);
+					const float radius = 18.0f + 10.0f * float((m + b) % 4);
+					const float d = std::hypot(float(x) - cx, float(y) - cy);
+					best = std::max(best, 4.0f * (radius - d));
+				}
+				logits[size_t(y) * kLogits + size_t(x)] = std::clamp(best, -20.0f, 20.0f) + 0.5f * std::sin(float(x * y) * 0.01f);
+			}
+		}
+		return logits;
+	};
+	auto path = [&](int m, const char* extension) {
+		char name[64];
+		std::snprintf(name, sizeof(name), "/segmentation-benchmark-%d.%s", m, extension);
+		return directory + name;
+	};
+
+	std::vector<std::vector<float>> logits;
+	for (int m = 0; m < masks; ++m) logits.push_back(makeLogits(m));
+
+	// Build and store; alongside each, the full-resolution mask as the old per-mask file.
+	const size_t frame = size_t(width) * size_t(height);
+	std::vector<uint8_t> dense(frame);
+	size_t encoded = 0, partial = 0;
+	for (int m = 0; m < masks; ++m) {
+		const auto t0 = Clock::now();
+		auto mask = SegmentationMask::fromLogits(logits[size_t(m)].data(), kLogits, kLogits, kLogits, width, height);
+		result.buildSeconds += seconds(t0);
+		if (!mask || !mask->save(path(m, "cfsm"))) return result;
+		encoded += mask->sizeBytes();
+		partial += mask->partialTiles();
+
+		const BilinearTaps tx = bilinearTaps(width, kLogits), ty = bilinearTaps(height, kLogits);
+		parallelFor(size_t(height), [&](size_t y) {
+			upsampleRow(logits[size_t(m)].data(), kLogits, tx, ty, int(y), 0, width, &dense[y * size_t(width)]);
+		});
+		AtomicFileWriter raw(path(m, "raw"));
+		if (!raw.write(dense.data(), frame) || !raw.commit()) return result;
+	}
+	const size_t tiles = size_t((width + SegmentationMask::kTileSize - 1) / SegmentationMask::kTileSize) *
+						 size_t((height + SegmentationMask::kTileSize - 1) / SegmentationMask::kTileSize);
+	result.rawMegabytes = double(frame) * masks / 1048576.0;
+	result.encodedMegabytes = double(encoded) / 1048576.0;
+	result.partialTileFraction = double(partial) / double(tiles * size_t(masks));
+
+	// Load every mask: the raw files read whole, the stored ones opened.
+	{
+		std::vector<std::vector<uint8_t>> loaded;
+		const auto t0 = Clock::now();
+		for (int m = 0; m < masks; ++m) {
+			std::vector<uint8_t> bytes(frame);
+			if (std::FILE* f = std::fopen(path(m, "raw").c_str(), "rb")) {
+				if (std::fread(bytes.data(), 1, frame, f) != frame) bytes.clear();
+				std::fclose(f);
+			}
+			loaded.push_back(std::move(bytes));
+		}
+		result.rawLoadSeconds = seconds(t0);
+	}
+	std::vector<std::unique_ptr<SegmentationMask>> opened;
+	{
+		const auto t0 = Clock::now();
+		for (int m = 0; m < masks; ++m) opened.push_back(SegmentationMask::open(path(m, "cfsm")));
+		result.loadSeconds = seconds(t0);
+	}
+
+	// Decode the last mask in Core Image-sized regions.
+	if (opened.back()) {
+		constexpr int kRegion = 512;
+		const int bands = (height + kRegion - 1) / kRegion;
+		const auto t0 = Clock::now();
+		parallelFor(size_t(bands), [&](size_t b) {
+			for (int x = 0; x < width; x += kRegion) {
+				const Rect region{ x, int(b) * kRegion, std::min(kRegion, width - x), std::min(kRegion, height - int(b) * kRegion) };
+				opened.back()->readRegion(region, &dense[size_t(region.y) * size_t(width) + size_t(region.x)], size_t(width));
+			}
+		});
+		const double t = seconds(t0);
+		result.decodeMegapixelsPerSecond = double(frame) / 1e6 / std::max(t, 1e-9);
+	}
+
+	for (int m = 0; m < masks; ++m) {
+		std::remove(path(m, "cfsm").c_str());
+		std::remove(path(m, "raw").c_str());
+	}
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeSegmentationMask {
+	std::unique_ptr<forge::SegmentationMask> mask;
+};
+
+namespace {
+
+ForgeSegmentationMask* wrap(std::unique_ptr<forge::SegmentationMask> mask) {
+	return mask ? new ForgeSegmentationMask{ std::move(mask) } : nullptr;
+}
+
+} // namespace
+
+extern "C" {
+	ForgeSegmentationMask* ForgeSegmentationMaskCreate(const uint8_t* pixels, size_t rowBytes, int32_t width, int32_t height) {
+		return wrap(forge::SegmentationMask::fromPixels(pixels, rowBytes, width, height));
+	}
+
+	ForgeSegmentationMask* ForgeSegmentationMaskCreateFromLogits(const float* logits, size_t logitRowBytes, int32_t logitWidth,
+																 int32_t logitHeight, int32_t width, int32_t height) {
+		return wrap(forge::SegmentationMask::fromLogits(logits, logitRowBytes / sizeof(float), logitWidth, logitHeight, width, height));
+	}
+
+	ForgeSegmentationMask* ForgeSegmentationMaskOpen(const char* path) {
+		return path ? wrap(forge::SegmentationMask::open(path)) : nullptr;
+	}
+
+	bool ForgeSegmentationMaskSave(const ForgeSegmentationMask* mask, const char* path, int32_t originX, int32_t originY) {
+		return mask && path && mask->mask->save(path, originX, originY);
+	}
+
+	void ForgeSegmentationMaskRelease(ForgeSegmentationMask* mask) {
+		delete mask;
+	}
+
+	int32_t ForgeSegmentationMaskWidth(const ForgeSegmentationMask* mask) {
+		return mask ? mask->mask->width() : 0;
+	}
+
+	int32_t ForgeSegmentationMaskHeight(const ForgeSegmentationMask* mask) {
+		return mask ? mask->mask->height() : 0;
+	}
+
+	int32_t ForgeSegmentationMaskOriginX(const ForgeSegmentationMask* mask) {
+		return mask ? mask->mask->originX() : 0;
+	}
+
+	int32_t ForgeSegmentationMaskOriginY(const ForgeSegmentationMask* mask) {
+		return mask ? mask->mask->originY() : 0;
+	}
+
+	uint64_t ForgeSegmentationMaskBytes(const ForgeSegmentationMask* mask) {
+		return mask ? mask->mask->sizeBytes() : 0;
+	}
+
+	const uint8_t* ForgeSegmentationMaskTiles(const ForgeSegmentationMask* mask, int32_t* columns, int32_t* rows, int32_t* span) {
+		if (!mask) return nullptr;
+		if (columns) *columns = mask->mask->columns();
+		if (rows) *rows = mask->mask->rows();
+		if (span) *span = forge::SegmentationMask::kTileSize;
+		return reinterpret_cast<const uint8_t*>(mask->mask->tiles());
+	}
+
+	bool ForgeSegmentationMaskReadRegion(const ForgeSegmentationMask* mask, ForgeRect region, uint8_t* dst, size_t rowBytes) {
+		if (!mask || !dst) return false;
+		return mask->mask->readRegion({ region.x, region.y, region.width, region.height }, dst, rowBytes);
+	}
+
+	ForgeSegmentationMaskBenchmark ForgeBenchmarkSegmentationMask(int32_t width, int32_t height, int32_t masks, const char* directory) {
+		const forge::SegmentationMaskBenchmark b = forge::benchmarkSegmentationMask(width, height, masks, directory ? directory : ".");
+		return { b.masks, b.rawMegabytes, b.encodedMegabytes, b.partialTileFraction, b.buildSeconds,
+				 b.rawLoadSeconds, b.loadSeconds, b.decodeMegapixelsPerSecond };
+	}
+}
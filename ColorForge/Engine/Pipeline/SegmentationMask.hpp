@@ -0,0 +1,126 @@
+//
+//  SegmentationMask.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "EngineImage.hpp"
+#include "FileIO.hpp"
+#include "MaskCoverage.hpp"
+
+namespace forge {
+
+/*
+ AI (SAM) masks stored as 64 × 64 tiles that are empty, full or partial, with only the
+ partial tiles holding pixels.
+
+ An AiMask used to be a full-resolution image file decoded whole when the project loaded: a
+ 24 MP mask is 24 MB of pixels per mask whatever it shows, and dozens of them per image is
+ most of a project's load time. SAM masks are large uniform regions with a soft edge, so
+ nearly every tile is all 0 or all 255:
+ - each tile has a kind byte (Coverage: Zero, Partial, One);
+ - a partial tile is 8-bit alpha, run-length coded (PackBits-style: a run of 3-130 equal bytes
+   in two bytes, up to 128 literals behind a count), or stored raw when that is no smaller;
+ - a per-tile offset table gives random access, so a reader decodes only the tiles a region
+   touches, and the tile kinds double as the mask's coverage.
+
+ The in-memory form is byte for byte the file, so save() writes it back behind a header
+ carrying the mask's origin, and open() is a map and a header check; pages of the mapping are
+ read as tiles are. Lossless: readRegion() returns exactly the pixels the mask was built from.
+
+ fromLogits() builds a mask straight from SAM's low-resolution logits: bilinear upsampling
+ (pixel centres aligned, as the model's own resize) and a sigmoid, quantised to 8 bits.
+ Bilinear values lie between the logits around them, so a tile whose neighbourhood of logits
+ quantises to 0 (or 255) throughout is classified without evaluating a pixel; only the tiles
+ along the mask's edge are upsampled.
+
+ Layout: header | tile kinds, padded to 4 bytes | uint32 offsets, one per tile and one past
+ the end | tile data. Offsets are relative to the data; non-partial tiles have no bytes.
+ */
+
+class SegmentationMask {
+public:
+	static constexpr int kTileSize = 64;
+
+	SegmentationMask(const SegmentationMask&) = delete;
+	SegmentationMask& operator=(const SegmentationMask&) = delete;
+
+	// `pixels`: width × height bytes, rows `rowBytes` apart, 255 = one.
+	static std::unique_ptr<SegmentationMask> fromPixels(const uint8_t* pixels, size_t rowBytes, int width, int height);
+	// `logits`: logitWidth × logitHeight floats, rows `logitRowFloats` apart, upsampled to
+	// width × height.
+	static std::unique_ptr<SegmentationMask> fromLogits(const float* logits, size_t logitRowFloats, int logitWidth,
+														int logitHeight, int width, int height);
+	// Null if the file is missing, truncated or not a mask of a known version.
+	static std::unique_ptr<SegmentationMask> open(const std::string& path);
+	// Stores where the mask sits in its image with it; open() restores it.
+	bool save(const std::string& path, int originX = 0, int originY = 0) const;
+
+	int width() const { return width_; }
+	int height() const { return height_; }
+	// As saved; (0, 0) for masks built in memory and files from before it was stored.
+	int originX() const { return originX_; }
+	int originY() const { return originY_; }
+	int columns() const { return columns_; }
+	int rows() const { return rows_; }
+	Rect tileRect(int column, int row) const;
+
+	Coverage tile(int column, int row) const { return tiles_[size_t(row) * size_t(columns_) + size_t(column)]; }
+	// columns() × rows() kinds, row-major.
+	const Coverage* tiles() const { return tiles_; }
+
+	// Pixels of `region` (mask pixels, y down); zero outside the mask. False if a tile is corrupt.
+	bool readRegion(const Rect& region, uint8_t* dst, size_t rowBytes) const;
+
+	// Encoded size: the file, or what the mask holds in memory.
+	size_t sizeBytes() const { return size_; }
+	size_t partialTiles() const;
+
+private:
+	SegmentationMask() = default;
+	static std::unique_ptr<SegmentationMask> assemble(int width, int height, std::vector<Coverage>&& kinds,
+													  std::vector<std::vector<uint8_t>>&& rowData,
+													  std::vector<std::vector<uint32_t>>&& rowSizes);
+	bool attach(const uint8_t* bytes, size_t size);
+	bool decodeTile(int column, int row, uint8_t* dst, size_t rowBytes) const;
+
+	MappedFile file_;
+	std::vector<uint8_t> owned_;
+	const uint8_t* bytes_ = nullptr;
+	size_t size_ = 0;
+	size_t headerBytes_ = 0;
+
+	int width_ = 0, height_ = 0;
+	int originX_ = 0, originY_ = 0;
+	int columns_ = 0, rows_ = 0;
+	const Coverage* tiles_ = nullptr;
+	const uint32_t* offsets_ = nullptr;
+	const uint8_t* data_ = nullptr;
+};
+
+// MARK: - Benchmark
+
+struct SegmentationMaskBenchmark {
+	int masks = 0;
+	double rawMegabytes = 0.0;         // full-resolution 8-bit masks
+	double encodedMegabytes = 0.0;
+	double partialTileFraction = 0.0;
+	double buildSeconds = 0.0;         // fromLogits, all masks
+	double rawLoadSeconds = 0.0;       // reading every raw mask into memory
+	double loadSeconds = 0.0;          // opening every stored mask
+	double decodeMegapixelsPerSecond = 0.0;
+};
+
+// `masks` masks of width × height from synthetic 256 × 256 logits, written to and read back
+// from `directory`.
+SegmentationMaskBenchmark benchmarkSegmentationMask(int width, int height, int masks, const std::string& directory);
+
+} // namespace forge
@@ -0,0 +1,477 @@
+//
+//  ThumbnailEngine.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "ThumbnailEngine.hpp"
+#include "JpegWriter.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace forge {
+
+namespace {
+
+// Area-averaging weights from `source` samples to `target`: output i covers
+// [i·source/target, (i+1)·source/target) and each sample it touches is weighted by its overlap.
+struct AreaTaps {
+	std::vector<int> first;             // per output
+	std::vector<int> offset;            // into weights, per output, plus the end
+	std::vector<float> weights;
+
+	AreaTaps(int source, int target) : first(size_t(target)), offset(size_t(target) + 1) {
+		const double ratio = double(source) / double(target);
+		for (int i = 0; i < target; ++i) {
+			const double a = i * ratio, b = std::min(double(source), (i + 1) * ratio);
+			const int k0 = int(a), k1 = std::min(source, int(std::ceil(b)));
+			first[size_t(i)] = k0;
+			offset[size_t(i)] = int(weights.size());
+			for (int k = k0; k < k1; ++k) {
+				const double overlap = std::min(b, double(k + 1)) - std::max(a, double(k));
+				weights.push_back(float(overlap / ratio));
+			}
+		}
+		offset[size_t(target)] = int(weights.size());
+	}
+
+	int count(int i) const { return offset[size_t(i) + 1] - offset[size_t(i)]; }
+	const float* weightsOf(int i) const { return weights.data() + offset[size_t(i)]; }
+};
+
+// Within a 2×2 quad, numbered dy * 2 + dx: where red and blue sit; green has the other two.
+constexpr int kRedSite[4] = { 0, 3, 1, 2 };
+constexpr int kBlueSite[4] = { 3, 0, 2, 1 };
+
+// As demosaic_linear: one black level (the channels' mean) and a 14- or 16-bit range. Every
+// code value is normalised once into a table, so binning is a load and an add per sample.
+struct Levels {
+	float clip = 1.0f;                  // white level in normalised units
+	std::vector<float> table;
+
+	explicit Levels(const RawMosaic& m) : table(65536) {
+		const float black = (m.blackLevel[0] + m.blackLevel[1] + m.blackLevel[2]) / 3.0f;
+		const float range = m.whiteLevel <= 16384.0f ? 16384.0f : 65535.0f;
+		clip = m.whiteLevel / range;
+		for (size_t v = 0; v < table.size(); ++v) table[v] = std::clamp((float(v) - black) / range, 0.0f, 1.0f);
+	}
+
+	float operator()(uint16_t v) const { return table[v]; }
+};
+
+// One row of quads as normalised RGB into `quads`, then area-averaged across to `taps`.
+void binRow(const RawMosaic& m, const Levels& levels, int qy, const AreaTaps& taps, int width, float* quads, float* out) {
+	const uint16_t* r0 = m.pixels + size_t(2 * qy) * m.rowStride;
+	const uint16_t* r1 = r0 + m.rowStride;
+	const int red = kRedSite[m.cfaPattern & 3], blue = kBlueSite[m.cfaPattern & 3];
+	for (int qx = 0, n = m.width / 2; qx < n; ++qx) {
+		const float quad[4] = { levels(r0[2 * qx]), levels(r0[2 * qx + 1]), levels(r1[2 * qx]), levels(r1[2 * qx + 1]) };
+		quads[qx * 3 + 0] = quad[red];
+		quads[qx * 3 + 1] = (quad[0] + quad[1] + quad[2] + quad[3] - quad[red] - quad[blue]) * 0.5f;
+		quads[qx * 3 + 2] = quad[blue];
+	}
+	for (int x = 0; x < width; ++x) {
+		const float* w = taps.weightsOf(x);
+		const float* q = quads + size_t(taps.first[size_t(x)]) * 3;
+		float sr = 0.0f, sg = 0.0f, sb = 0.0f;
+		for (int k = 0, n = taps.count(x); k < n; ++k, q += 3) {
+			sr += w[k] * q[0];
+			sg += w[k] * q[1];
+			sb += w[k] * q[2];
+		}
+		out[x * 3 + 0] = sr;
+		out[x * 3 + 1] = sg;
+		out[x * 3 + 2] = sb;
+	}
+}
+
+// demosaic_linear's blend_highlights_inline (dcraw's highlight mode 2): clipped channels keep
+// the unclipped luminance with the chroma of the clipped colour.
+void blendHighlights(float cam[3], float clip, float rMul, float bMul) {
+	const float clipped[3] = { std::min(cam[0], clip / rMul), std::min(cam[1], clip), std::min(cam[2], clip / bMul) };
+	auto toLab = [](const float c[3], float lab[3]) {
+		lab[0] = c[0] + c[1] + c[2];
+		lab[1] = 1.7320508f * (c[0] - c[1]);
+		lab[2] = -c[0] - c[1] + 2.0f * c[2];
+	};
+	float lab0[3], lab1[3];
+	toLab(cam, lab0);
+	toLab(clipped, lab1);
+	const float sum0 = lab0[1] * lab0[1] + lab0[2] * lab0[2];
+	const float sum1 = lab1[1] * lab1[1] + lab1[2] * lab1[2];
+	if (sum0 <= 1e-8f) return;
+	const float ratio = std::sqrt(sum1 / sum0);
+	lab0[1] *= ratio;
+	lab0[2] *= ratio;
+	cam[0] = (lab0[0] + 0.8660254f * lab0[1] - 0.5f * lab0[2]) / 3.0f;
+	cam[1] = (lab0[0] - 0.8660254f * lab0[1] - 0.5f * lab0[2]) / 3.0f;
+	cam[2] = (lab0[0] + lab0[2]) / 3.0f;
+}
+
+// demosaic_linear's encodeArriFromSensor: LogC v3 at EI 800 with ARRI's sensor black lift.
+inline float encodeLogC(float x) {
+	const float lift = 0.00390631f, flare = 0.00012207f;
+	const float linear = x * (1.0f - lift) + lift + flare;
+	if (linear > 0.004201f) return 0.247190f * std::log10(200.0f * linear - 0.729169f) + 0.385537f;
+	return 193.235573f * linear - 0.662201f;
+}
+
+inline uint8_t toByte(float v) {
+	return uint8_t(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// MARK: - Grade LUT
+
+void GradeLut::apply(float rgb[3]) const {
+	const int n = dimension;
+	const float scale = float(n - 1);
+	int i[3];
+	float t[3];
+	for (int c = 0; c < 3; ++c) {
+		const float f = std::clamp(rgb[c], 0.0f, 1.0f) * scale;
+		i[c] = std::min(int(f), n - 2);
+		t[c] = f - float(i[c]);
+	}
+	auto at = [&](int r, int g, int b) { return &rgba[((size_t(b) * size_t(n) + size_t(g)) * size_t(n) + size_t(r)) * 4]; };
+	for (int c = 0; c < 3; ++c) {
+		const float c00 = at(i[0], i[1], i[2])[c] + t[0] * (at(i[0] + 1, i[1], i[2])[c] - at(i[0], i[1], i[2])[c]);
+		const float c10 = at(i[0], i[1] + 1, i[2])[c] + t[0] * (at(i[0] + 1, i[1] + 1, i[2])[c] - at(i[0], i[1] + 1, i[2])[c]);
+		const float c01 = at(i[0], i[1], i[2] + 1)[c] + t[0] * (at(i[0] + 1, i[1], i[2] + 1)[c] - at(i[0], i[1], i[2] + 1)[c]);
+		const float c11 = at(i[0], i[1] + 1, i[2] + 1)[c] + t[0] * (at(i[0] + 1, i[1] + 1, i[2] + 1)[c] - at(i[0], i[1] + 1, i[2] + 1)[c]);
+		const float c0 = c00 + t[1] * (c10 - c00), c1 = c01 + t[1] * (c11 - c01);
+		rgb[c] = c0 + t[2] * (c1 - c0);
+	}
+}
+
+GradeLut GradeLut::bake(int dimension, const PointwiseFn& grade) {
+	GradeLut lut;
+	if (dimension < 2) return lut;
+	lut.dimension = dimension;
+	const size_t n = size_t(dimension);
+	lut.rgba.resize(n * n * n * 4);
+	const float step = 1.0f / float(dimension - 1);
+	for (size_t b = 0, k = 0; b < n; ++b) {
+		for (size_t g = 0; g < n; ++g) {
+			for (size_t r = 0; r < n; ++r, k += 4) {
+				lut.rgba[k + 0] = float(r) * step;
+				lut.rgba[k + 1] = float(g) * step;
+				lut.rgba[k + 2] = float(b) * step;
+				lut.rgba[k + 3] = 1.0f;
+			}
+		}
+	}
+	if (grade) grade(lut.rgba.data(), n * n * n);
+	return lut;
+}
+
+// MARK: - Thumbnail
+
+void thumbnailSize(int mosaicWidth, int mosaicHeight, int maxSize, int& width, int& height) {
+	const int qw = mosaicWidth / 2, qh = mosaicHeight / 2;
+	if (qw <= 0 || qh <= 0) {
+		width = height = 0;
+		return;
+	}
+	const double scale = maxSize > 0 ? std::min(1.0, double(maxSize) / double(std::max(qw, qh))) : 1.0;
+	width = std::max(1, int(std::lround(qw * scale)));
+	height = std::max(1, int(std::lround(qh * scale)));
+}
+
+bool renderThumbnail(const RawMosaic& m, const GradeLut* lut, const ThumbnailSettings& settings, Thumbnail& out) {
+	int tw = 0, th = 0;
+	thumbnailSize(m.width, m.height, settings.maxSize, tw, th);
+	if (!m.pixels || tw == 0 || m.rowStride < size_t(m.width)) return false;
+	if (lut && !lut->valid()) lut = nullptr;
+
+	const bool quarterTurn = m.orientation == 5 || m.orientation == 6;
+	out.width = quarterTurn ? th : tw;
+	out.height = quarterTurn ? tw : th;
+	out.rgb.resize(size_t(tw) * size_t(th) * 3);
+
+	const Levels levels(m);
+	const AreaTaps across(m.width / 2, tw), down(m.height / 2, th);
+	std::vector<float> row(size_t(tw) * 3), binned(size_t(tw) * 3), quads(size_t(m.width / 2) * 3);
+	int binnedRow = -1;
+	for (int y = 0; y < th; ++y) {
+		std::fill(row.begin(), row.end(), 0.0f);
+		const float* wy = down.weightsOf(y);
+		for (int k = 0, n = down.count(y); k < n; ++k) {
+			// A quad row on the boundary between two output rows is binned once for both.
+			const int qy = down.first[size_t(y)] + k;
+			if (qy != binnedRow) {
+				binRow(m, levels, qy, across, tw, quads.data(), binned.data());
+				binnedRow = qy;
+			}
+			for (size_t i = 0; i < row.size(); ++i) row[i] += wy[k] * binned[i];
+		}
+
+		for (int x = 0; x < tw; ++x) {
+			float cam[3] = { row[size_t(x) * 3], row[size_t(x) * 3 + 1], row[size_t(x) * 3 + 2] };
+			blendHighlights(cam, levels.clip, m.rMul, m.bMul);
+			const float* M = m.camToAWG3;
+			float rgb[3];
+			for (int c = 0; c < 3; ++c) rgb[c] = encodeLogC(M[c * 3] * cam[0] + M[c * 3 + 1] * cam[1] + M[c * 3 + 2] * cam[2]);
+			if (lut) lut->apply(rgb);
+
+			int ox = x, oy = y;
+			switch (m.orientation) {
+				case 3: ox = tw - 1 - x; oy = th - 1 - y; break;
+				case 5: ox = y; oy = tw - 1 - x; break;
+				case 6: ox = th - 1 - y; oy = x; break;
+				default: break;
+			}
+			uint8_t* p = &out.rgb[(size_t(oy) * size_t(out.width) + size_t(ox)) * 3];
+			p[0] = toByte(rgb[0]);
+			p[1] = toByte(rgb[1]);
+			p[2] = toByte(rgb[2]);
+		}
+	}
+	return true;
+}
+
+// MARK: - Batch
+
+ThumbnailBatchStats renderThumbnailBatch(size_t count, const MosaicLoader& load, const std::vector<std::string>& outputs,
+										 const ThumbnailSettings& settings, const GradeLut* lut, std::vector<uint8_t>* ok) {
+	ThumbnailBatchStats stats;
+	count = std::min(count, outputs.size());
+	if (ok) ok->assign(count, 0);
+	if (count == 0 || !load) return stats;
+
+	std::atomic<int> failed{ 0 };
+	std::atomic<int64_t> loadNanos{ 0 }, renderNanos{ 0 }, encodeNanos{ 0 };
+	auto nanosSince = [](std::chrono::steady_clock::time_point start) {
+		return int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	};
+	const auto start = std::chrono::steady_clock::now();
+	// One file per worker: each thumbnail is too small to be worth splitting, and the raw
+	// decoders behind `load` are single-threaded.
+	parallelFor(count, [&](size_t i) {
+		Thumbnail thumb;
+		bool rendered = false;
+		int64_t renderTime = 0;
+		const auto loadStart = std::chrono::steady_clock::now();
+		const bool loaded = load(i, [&](const RawMosaic& mosaic) {
+			const auto t = std::chrono::steady_clock::now();
+			rendered = renderThumbnail(mosaic, lut, settings, thumb);
+			renderTime = nanosSince(t);
+		});
+		loadNanos += nanosSince(loadStart) - renderTime;
+		renderNanos += renderTime;
+		// The decoder's buffers are gone by now; only the thumbnail is held while it's encoded.
+		bool written = false;
+		if (loaded && rendered) {
+			const auto t = std::chrono::steady_clock::now();
+			JpegInfo info;
+			info.width = thumb.width;
+			info.height = thumb.height;
+			info.quality = settings.quality;
+			written = writeJpeg(outputs[i], thumb.rgb.data(), size_t(thumb.width) * 3, info);
+			encodeNanos += nanosSince(t);
+		}
+		if (ok) (*ok)[i] = written ? 1 : 0;
+		if (!written) ++failed;
+	});
+
+	stats.images = int(count);
+	stats.failed = failed.load();
+	stats.seconds = secondsSince(start);
+	stats.loadSeconds = double(loadNanos.load()) * 1e-9;
+	stats.renderSeconds = double(renderNanos.load()) * 1e-9;
+	stats.encodeSeconds = double(encodeNanos.load()) * 1e-9;
+	stats.imagesPerSecond = stats.seconds > 0.0 ? double(count - size_t(stats.failed)) / stats.seconds : 0.0;
+	return stats;
+}
+
+// MARK: - Benchmark
+
+namespace {
+
+// What the import did before, on the CPU: every sensor pixel demosaiced (demosaic_linear's
+// bilinear), developed, then area-averaged to the same size. Streams rows, so it measures the
+// arithmetic rather than the memory of a full-size frame.
+void demosaicThenDownsample(const RawMosaic& m, int tw, int th, std::vector<float>& out) {
+	const Levels levels(m);
+	const int W = m.width, H = m.height;
+	const AreaTaps across(W, tw), down(H, th);
+	auto site = [&](int x, int y) {
+		const int s = (y & 1) * 2 + (x & 1);
+		return s == kRedSite[m.cfaPattern & 3] ? 0 : s == kBlueSite[m.cfaPattern & 3] ? 2 : 1;
+	};
+	auto raw = [&](int x, int y) {
+		x = std::clamp(x, 0, W - 1);
+		y = std::clamp(y, 0, H - 1);
+		return levels(m.pixels[size_t(y) * m.rowStride + size_t(x)]);
+	};
+	std::vector<float> demosaiced(size_t(W) * 3), row(size_t(tw) * 3);
+	out.assign(size_t(tw) * size_t(th) * 3, 0.0f);
+	for (int y = 0; y < th; ++y) {
+		std::fill(row.begin(), row.end(), 0.0f);
+		const float* wy = down.weightsOf(y);
+		for (int k = 0, n = down.count(y); k < n; ++k) {
+			const int sy = down.first[size_t(y)] + k;
+			for (int x = 0; x < W; ++x) {
+				const float c = raw(x, sy);
+				const float cross = (raw(x - 1, sy) + raw(x + 1, sy) + raw(x, sy - 1) + raw(x, sy + 1)) * 0.25f;
+				const float diagonal = (raw(x - 1, sy - 1) + raw(x + 1, sy - 1) + raw(x - 1, sy + 1) + raw(x + 1, sy + 1)) * 0.25f;
+				const float horizontal = (raw(x - 1, sy) + raw(x + 1, sy)) * 0.5f, vertical = (raw(x, sy - 1) + raw(x, sy + 1)) * 0.5f;
+				float rgb[3];
+				const int s = site(x, sy);
+				if (s == 1) {
+					const bool redRow = site(x + 1, sy) == 0;
+					rgb[0] = redRow ? horizontal : vertical;
+					rgb[1] = c;
+					rgb[2] = redRow ? vertical : horizontal;
+				} else {
+					rgb[s] = c;
+					rgb[1] = cross;
+					rgb[2 - s] = diagonal;
+				}
+				blendHighlights(rgb, levels.clip, m.rMul, m.bMul);
+				for (int ch = 0; ch < 3; ++ch) demosaiced[size_t(x) * 3 + size_t(ch)] = rgb[ch];
+			}
+			for (int x = 0; x < tw; ++x) {
+				const float* wx = across.weightsOf(x);
+				for (int j = 0, nx = across.count(x); j < nx; ++j) {
+					const float* p = &demosaiced[size_t(across.first[size_t(x)] + j) * 3];
+					for (int ch = 0; ch < 3; ++ch) row[size_t(x) * 3 + size_t(ch)] += wy[k] * wx[j] * p[ch];
+				}
+			}
+		}
+		std::copy(row.begin(), row.end(), out.begin() + std::ptrdiff_t(size_t(y) * size_t(tw) * 3));
+	}
+}
+
+} // namespace
+
+ThumbnailBenchmark benchmarkThumbnails(int width, int height, int images, const std::string& directory) {
+	ThumbnailBenchmark result;
+	if (width < 2 || height < 2 || images <= 0) return result;
+	result.images = images;
+	result.megapixels = int(std::lround(double(width) * double(height) / 1e6));
+
+	// A 14-bit RGGB frame: a lit gradient scene with texture, daylight-ish channel balance and a
+	// clipped highlight.
+	RawMosaic mosaic;
+	std::vector<uint16_t> pixels(size_t(width) * size_t(height));
+	parallelFor(size_t(height), [&](size_t y) {
+		uint32_t state = uint32_t(y) * 2654435761u + 7u;
+		for (int x = 0; x < width; ++x) {
+			state = state * 1664525u + 1013904223u;
+			const float u = float(x) / float(width), v = float(y) / float(height);
+			const float scene = 0.02f + 0.4f * u * (1.0f - v) + 0.05f * std::sin(0.02f * float(x)) * std::cos(0.015f * float(y));
+			const float gain[3] = { 0.5f, 1.0f, 0.7f };
+			const int s = int(y & 1) * 2 + (x & 1);
+			const int channel = s == 0 ? 0 : s == 3 ? 2 : 1;
+			const bool highlight = (u - 0.7f) * (u - 0.7f) + (v - 0.3f) * (v - 0.3f) < 0.01f;
+			const float noise = (float(state >> 8) / 16777216.0f - 0.5f) * 0.004f;
+			const float value = highlight ? 1.2f : scene * gain[channel] + noise;
+			pixels[y * size_t(width) + size_t(x)] = uint16_t(std::clamp(512.0f + value * 15871.0f, 0.0f, 16383.0f));
+		}
+	});
+	mosaic.pixels = pixels.data();
+	mosaic.width = width;
+	mosaic.height = height;
+	mosaic.rowStride = size_t(width);
+	mosaic.blackLevel[0] = mosaic.blackLevel[1] = mosaic.blackLevel[2] = 512.0f;
+	mosaic.whiteLevel = 16383.0f;
+	mosaic.rMul = 2.0f;
+	mosaic.bMul = 1.4f;
+	const float camToAWG3[9] = { 1.6f, -0.45f, -0.15f, -0.2f, 1.35f, -0.15f, 0.02f, -0.42f, 1.4f };
+	std::copy(camToAWG3, camToAWG3 + 9, mosaic.camToAWG3);
+
+	// A grade to bake: an exposure, a warming matrix and an S-curve.
+	const float warm[9] = { 1.05f, -0.03f, -0.02f, -0.01f, 1.0f, 0.01f, -0.02f, -0.05f, 0.97f };
+	const PointwiseFn grade = [&](float* rgba, size_t count) {
+		const float gain = std::exp2(0.25f);
+		for (size_t i = 0; i < count; ++i) {
+			float* p = rgba + i * 4;
+			const float r = p[0] * gain, g = p[1] * gain, b = p[2] * gain;
+			const float graded[3] = {
+				warm[0] * r + warm[1] * g + warm[2] * b,
+				warm[3] * r + warm[4] * g + warm[5] * b,
+				warm[6] * r + warm[7] * g + warm[8] * b
+			};
+			for (int c = 0; c < 3; ++c) {
+				p[c] = graded[c] + 0.03f * std::sin(6.2831853f * graded[c]);
+			}
+		}
+	};
+	const GradeLut lut = GradeLut::bake(33, grade);
+
+	// The LUT against the grade run per pixel, over random LogC colours.
+	uint32_t state = 12345u;
+	std::vector<float> samples(4 * 4096);
+	for (int pass = 0; pass < 16; ++pass) {
+		for (float& s : samples) {
+			state = state * 1664525u + 1013904223u;
+			s = float(state >> 8) / 16777216.0f;
+		}
+		std::vector<float> exact = samples;
+		grade(exact.data(), exact.size() / 4);
+		for (size_t i = 0; i < samples.size(); i += 4) {
+			float rgb[3] = { samples[i], samples[i + 1], samples[i + 2] };
+			lut.apply(rgb);
+			for (int c = 0; c < 3; ++c) {
+				result.maxDifference = std::max(result.maxDifference, std::fabs(double(toByte(rgb[c])) - double(toByte(exact[i + size_t(c)]))));
+			}
+		}
+	}
+
+	ThumbnailSettings settings;
+	int tw = 0, th = 0;
+	thumbnailSize(width, height, settings.maxSize, tw, th);
+	std::vector<float> reference;
+	auto t0 = std::chrono::steady_clock::now();
+	demosaicThenDownsample(mosaic, tw, th, reference);
+	result.demosaicSeconds = secondsSince(t0);
+
+	const std::string single = directory + "/forge_thumbnail_benchmark.jpg";
+	t0 = std::chrono::steady_clock::now();
+	Thumbnail thumb;
+	if (renderThumbnail(mosaic, &lut, settings, thumb)) {
+		JpegInfo info;
+		info.width = thumb.width;
+		info.height = thumb.height;
+		info.quality = settings.quality;
+		writeJpeg(single, thumb.rgb.data(), size_t(thumb.width) * 3, info);
+	}
+	result.thumbnailSeconds = secondsSince(t0);
+	std::remove(single.c_str());
+
+	std::vector<std::string> outputs(static_cast<size_t>(images));
+	for (int i = 0; i < images; ++i) outputs[size_t(i)] = directory + "/forge_thumbnail_benchmark_" + std::to_string(i) + ".jpg";
+	const ThumbnailBatchStats stats = renderThumbnailBatch(size_t(images), [&](size_t, const std::function<void(const RawMosaic&)>& use) {
+		use(mosaic);
+		return true;
+	}, outputs, settings, &lut);
+	for (const std::string& path : outputs) std::remove(path.c_str());
+	result.imagesPerSecond = stats.imagesPerSecond;
+	result.projectedSeconds3000 = stats.imagesPerSecond > 0.0 ? 3000.0 / stats.imagesPerSecond : 0.0;
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	ForgeThumbnailBenchmark ForgeBenchmarkThumbnails(int32_t width, int32_t height, int32_t images, const char* directory) {
+		const forge::ThumbnailBenchmark b = forge::benchmarkThumbnails(width, height, images, directory ? directory : ".");
+		return { b.images, b.megapixels, b.demosaicSeconds, b.thumbnailSeconds, b.imagesPerSecond, b.projectedSeconds3000, b.maxDifference };
+	}
+}
@@ -0,0 +1,123 @@
+//
+//  ThumbnailEngine.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace forge {
+
+/*
+ Graded thumbnails straight from the raw mosaic.
+
+ An import used to make each thumbnail the way it makes the editing image: unpack the raw,
+ demosaic every sensor pixel on the GPU, scale the result, run the whole filter pipeline on it
+ and only then shrink it to 500 px, three files at a time. For a thumbnail nearly all of that
+ is thrown away. Here each file goes through one pass over its mosaic:
+ - each 2×2 CFA quad is one RGB pixel (half-size decode: no interpolation, no demosaic), and
+   the quads are area-averaged straight to the thumbnail size in the same pass, so the
+   half-size image is never stored either;
+ - the thumbnail's pixels then get what demosaic_linear does to each sensor pixel (black and
+   white levels, highlight blending, camera → AWG3, ARRI LogC) and the grade, baked into a 3D
+   LUT, so a pipeline of any length costs one trilinear lookup a pixel;
+ - the result is oriented, encoded as a baseline JPEG (JpegWriter) and written atomically.
+ Files are processed in parallel, one per worker, each with its own buffers.
+
+ The highlight blend and the matrix run on the averaged quads rather than on every sensor
+ pixel; at thumbnail size that differs only along clipped edges. Neighbourhood nodes (MTF,
+ grain, halation) and masks don't belong in a LUT and are left out; at 500 px they are all but
+ invisible anyway.
+ */
+
+// The visible area of an unpacked raw, as Demosaic.cpp extracts it.
+struct RawMosaic {
+	const uint16_t* pixels = nullptr;   // top-left of the visible area
+	int width = 0, height = 0;
+	size_t rowStride = 0;               // uint16s
+	int cfaPattern = 0;                 // at the visible origin: 0 RGGB, 1 BGGR, 2 GRBG, 3 GBRG
+	float blackLevel[3] = { 0.0f, 0.0f, 0.0f };   // R, G, B
+	float whiteLevel = 16383.0f;
+	float rMul = 1.0f, bMul = 1.0f;
+	float camToAWG3[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };   // row-major
+	int orientation = 0;                // LibRaw flip: 0, 3 (180°), 5 (90° CCW), 6 (90° CW)
+};
+
+// Transforms `count` RGBA pixels in place.
+using PointwiseFn = std::function<void(float* rgba, size_t count)>;
+
+// A baked pointwise grade: dimension³ RGBA entries, red fastest, then green, then blue, which
+// is CIColorCube's layout (LutModel.readCubeData). Inputs are clamped to [0, 1].
+struct GradeLut {
+	int dimension = 0;
+	std::vector<float> rgba;
+
+	bool valid() const { return dimension >= 2 && rgba.size() == size_t(dimension) * dimension * dimension * 4; }
+	// Trilinear, as CIColorCube samples it.
+	void apply(float rgb[3]) const;
+
+	// Runs `grade` once over the lattice.
+	static GradeLut bake(int dimension, const PointwiseFn& grade);
+};
+
+struct ThumbnailSettings {
+	int maxSize = 500;                  // long edge; never larger than the half-size image
+	int quality = 85;
+};
+
+// An 8-bit RGB thumbnail, oriented.
+struct Thumbnail {
+	int width = 0, height = 0;
+	std::vector<uint8_t> rgb;
+};
+
+// Thumbnail size before orientation, from the mosaic's size.
+void thumbnailSize(int mosaicWidth, int mosaicHeight, int maxSize, int& width, int& height);
+
+// Bins, downsamples, develops and grades `mosaic` into `out`. `lut` may be null: the LogC image.
+bool renderThumbnail(const RawMosaic& mosaic, const GradeLut* lut, const ThumbnailSettings& settings, Thumbnail& out);
+
+// MARK: - Batch
+
+// Decodes file `index` and calls `use` with its mosaic while the decoder's buffers are alive.
+// False if the file couldn't be read.
+using MosaicLoader = std::function<bool(size_t index, const std::function<void(const RawMosaic&)>& use)>;
+
+struct ThumbnailBatchStats {
+	int images = 0;
+	int failed = 0;
+	double seconds = 0.0;
+	double loadSeconds = 0.0;           // summed over workers: decoding the raws
+	double renderSeconds = 0.0;         // binning, downsampling, developing, grading
+	double encodeSeconds = 0.0;         // JPEG and the write
+	double imagesPerSecond = 0.0;
+};
+
+// Renders `count` files to `outputs[i]` in parallel. `ok`, if given, gets a flag per file.
+ThumbnailBatchStats renderThumbnailBatch(size_t count, const MosaicLoader& load, const std::vector<std::string>& outputs,
+										 const ThumbnailSettings& settings, const GradeLut* lut, std::vector<uint8_t>* ok = nullptr);
+
+// MARK: - Benchmark
+
+struct ThumbnailBenchmark {
+	int images = 0;
+	int megapixels = 0;                 // per synthetic raw
+	double demosaicSeconds = 0.0;       // per image: full-size bilinear demosaic, then the same downsample
+	double thumbnailSeconds = 0.0;      // per image: this engine, JPEG included
+	double imagesPerSecond = 0.0;       // this engine over the batch, every core
+	double projectedSeconds3000 = 0.0;  // 3,000 images at that rate, raw decoding excluded
+	double maxDifference = 0.0;         // LUT grade against the grade run per pixel, 8-bit levels
+};
+
+// `images` thumbnails of one synthetic `width` × `height` RGGB mosaic, graded by a baked
+// exposure / contrast / matrix chain; written to and removed from `directory`.
+ThumbnailBenchmark benchmarkThumbnails(int width, int height, int images, const std::string& directory);
+
+} // namespace forge
@@ -0,0 +1,236 @@
+//
+//  Noise.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "Noise.hpp"
+#include "Parallel.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace forge {
+
+namespace {
+
+inline int wrap(int i, int period) {
+	if (period <= 0) return i;
+	const int m = i % period;
+	return m < 0 ? m + period : m;
+}
+
+inline float wrap(float v, int period) {
+	if (period <= 0) return v;
+	const float p = float(period);
+	return v - std::floor(v / p) * p;
+}
+
+// 21 bits per axis; lattices never get near 2^20 cells.
+inline uint64_t latticeCounter(int x, int y, int z = 0) {
+	return (uint64_t(uint32_t(x)) & 0x1FFFFF) | ((uint64_t(uint32_t(y)) & 0x1FFFFF) << 21) |
+		   ((uint64_t(uint32_t(z)) & 0x1FFFFF) << 42);
+}
+
+inline float fade(float t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+// The twelve cube-edge gradients of improved Perlin noise (four repeated to fill 16).
+inline float perlinGradient(uint32_t hash, float x, float y, float z) {
+	const uint32_t h = hash & 15;
+	const float u = h < 8 ? x : y;
+	const float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+	return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+// Sixteen unit directions for simplex gradients.
+struct GradientTable {
+	float x[16], y[16];
+	GradientTable() {
+		for (int i = 0; i < 16; ++i) {
+			x[i] = std::cos(float(i) * 0.392699082f);
+			y[i] = std::sin(float(i) * 0.392699082f);
+		}
+	}
+};
+const GradientTable kSimplexGradients;
+
+constexpr int kLanes = 8;
+constexpr int kMaxOctaves = 12;
+
+struct Octave {
+	uint64_t key;
+	float frequency; // relative to the base lattice
+	int periodX, periodY;
+	float amplitude; // normalised so the amplitudes sum to 1
+};
+
+int octavePlan(const NoiseField& field, int channel, Octave* octaves) {
+	const int count = std::clamp(field.octaves, 1, kMaxOctaves);
+	float frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+	for (int o = 0; o < count; ++o) {
+		Octave& oct = octaves[o];
+		oct.key = squaresKey(field.seed + uint64_t(channel) + (uint64_t(o) << 40));
+		oct.frequency = frequency;
+		oct.periodX = oct.periodY = 0;
+		// Whole cells per period at every octave, so the sum still tiles.
+		if (field.periodX > 0 || field.periodY > 0) {
+			const int base = field.periodX > 0 ? field.periodX : field.periodY;
+			const int period = std::max(1, int(std::lround(float(base) * frequency)));
+			oct.frequency = float(period) / float(base);
+			if (field.periodX > 0) oct.periodX = std::max(1, int(std::lround(float(field.periodX) * oct.frequency)));
+			if (field.periodY > 0) oct.periodY = std::max(1, int(std::lround(float(field.periodY) * oct.frequency)));
+		}
+		oct.amplitude = amplitude;
+		total += amplitude;
+		frequency *= field.lacunarity;
+		amplitude *= field.gain;
+	}
+	for (int o = 0; o < count; ++o) octaves[o].amplitude /= total;
+	return count;
+}
+
+// Adds amplitude × Perlin at x = (x0 + i + 0.5) × step, i < count, to acc. The lattice hashes a
+// run can touch are computed once per row into a table; the lanes then only gather from it.
+void perlinRow(int x0, float step, int count, float y, float z, uint64_t key, int periodX, int periodY,
+			   float amplitude, float* acc) {
+	const float fy = std::floor(y), fz = std::floor(z);
+	const int iy = int(fy), iz = int(fz);
+	y -= fy;
+	z -= fz;
+	const int cy[4] = { wrap(iy, periodY), wrap(iy + 1, periodY), wrap(iy, periodY), wrap(iy + 1, periodY) };
+	const int cz[4] = { wrap(iz, 0), wrap(iz, 0), wrap(iz + 1, 0), wrap(iz + 1, 0) };
+	const float dy[4] = { y, y - 1.0f, y, y - 1.0f };
+	const float dz[4] = { z, z, z - 1.0f, z - 1.0f };
+	const float v = fade(y), w = fade(z);
+
+	const int padded = (count + kLanes - 1) / kLanes * kLanes;
+	const int cellMin = int(std::floor((float(x0) + 0.5f) * step));
+	const int cellMax = int(std::floor((float(x0 + padded - 1) + 0.5f) * step)) + 1;
+	const int cells = cellMax - cellMin + 1;
+	std::vector<uint32_t> hashes(size_t(cells) * 4);
+	for (int c = 0; c < cells; ++c) {
+		const int cx = wrap(cellMin + c, periodX);
+		for (int k = 0; k < 4; ++k) hashes[size_t(k) * size_t(cells) + size_t(c)] = squares32(latticeCounter(cx, cy[k], cz[k]), key);
+	}
+
+	for (int i = 0; i < padded; i += kLanes) {
+		float xf[kLanes], u[kLanes], n[4][kLanes], out[kLanes];
+		int cell[kLanes];
+		for (int l = 0; l < kLanes; ++l) {
+			const float x = (float(x0 + i + l) + 0.5f) * step;
+			const float fx = std::floor(x);
+			cell[l] = int(fx) - cellMin;
+			xf[l] = x - fx;
+			u[l] = fade(xf[l]);
+		}
+		for (int k = 0; k < 4; ++k) {
+			const uint32_t* h = &hashes[size_t(k) * size_t(cells)];
+			for (int l = 0; l < kLanes; ++l) {
+				n[k][l] = lerp(perlinGradient(h[cell[l]], xf[l], dy[k], dz[k]),
+							   perlinGradient(h[cell[l] + 1], xf[l] - 1.0f, dy[k], dz[k]), u[l]);
+			}
+		}
+		for (int l = 0; l < kLanes; ++l) out[l] = lerp(lerp(n[0][l], n[1][l], v), lerp(n[2][l], n[3][l], v), w);
+
+		const int lanes = std::min(kLanes, count - i);
+		for (int l = 0; l < lanes; ++l) acc[i + l] += amplitude * out[l];
+	}
+}
+
+} // namespace
+
+float perlinNoise(float x, float y, float z, uint64_t key, int periodX, int periodY, int periodZ) {
+	const float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+	const int ix = int(fx), iy = int(fy), iz = int(fz);
+	x -= fx;
+	y -= fy;
+	z -= fz;
+
+	const int x0 = wrap(ix, periodX), x1 = wrap(ix + 1, periodX);
+	const int y0 = wrap(iy, periodY), y1 = wrap(iy + 1, periodY);
+	const int z0 = wrap(iz, periodZ), z1 = wrap(iz + 1, periodZ);
+	auto g = [key](int a, int b, int c, float px, float py, float pz) {
+		return perlinGradient(squares32(latticeCounter(a, b, c), key), px, py, pz);
+	};
+
+	const float u = fade(x), v = fade(y), w = fade(z);
+	const float n00 = lerp(g(x0, y0, z0, x, y, z), g(x1, y0, z0, x - 1, y, z), u);
+	const float n10 = lerp(g(x0, y1, z0, x, y - 1, z), g(x1, y1, z0, x - 1, y - 1, z), u);
+	const float n01 = lerp(g(x0, y0, z1, x, y, z - 1), g(x1, y0, z1, x - 1, y, z - 1), u);
+	const float n11 = lerp(g(x0, y1, z1, x, y - 1, z - 1), g(x1, y1, z1, x - 1, y - 1, z - 1), u);
+	return lerp(lerp(n00, n10, v), lerp(n01, n11, v), w);
+}
+
+float simplexNoise(float x, float y, uint64_t key, int periodX, int periodY) {
+	if (periodY > 0) periodY += periodY & 1;
+
+	// Sheared space where the simplices are half-squares of an axis-aligned grid.
+	const float u = x + 0.5f * y, v = y;
+	const float i0u = std::floor(u), i0v = std::floor(v);
+	const bool right = u - i0u > v - i0v;
+	const float o1u = right ? 1.0f : 0.0f, o1v = right ? 0.0f : 1.0f;
+
+	// Corner positions back in x/y.
+	const float vx[3] = { i0u - 0.5f * i0v, i0u - 0.5f * i0v + o1u - 0.5f * o1v, i0u - 0.5f * i0v + 0.5f };
+	const float vy[3] = { i0v, i0v + o1v, i0v + 1.0f };
+
+	float n = 0.0f;
+	for (int k = 0; k < 3; ++k) {
+		const float dx = x - vx[k], dy = y - vy[k];
+		float w = 0.8f - dx * dx - dy * dy;
+		if (w <= 0.0f) continue;
+
+		// Wrap the corner, then map it back to integer lattice coordinates.
+		const float xw = wrap(vx[k], periodX), yw = wrap(vy[k], periodY);
+		const int lu = int(std::floor(xw + 0.5f * yw + 0.5f));
+		const int lv = int(std::floor(yw + 0.5f));
+		const uint32_t h = squares32(latticeCounter(lu, lv), key) & 15;
+
+		w *= w;
+		n += w * w * (kSimplexGradients.x[h] * dx + kSimplexGradients.y[h] * dy);
+	}
+	return 10.9f * n;
+}
+
+void noiseFieldRow(const NoiseField& field, int channel, int x0, int y, int count, float* dst) {
+	if (count <= 0) return;
+	Octave octaves[kMaxOctaves];
+	const int n = octavePlan(field, channel, octaves);
+	const float inv = 1.0f / std::max(field.scale, 1e-3f);
+	std::fill(dst, dst + count, 0.0f);
+
+	for (int o = 0; o < n; ++o) {
+		const Octave& oct = octaves[o];
+		const float step = inv * oct.frequency;
+		const float fy = (float(y) + 0.5f) * step;
+		if (field.kind == NoiseKind::Perlin) {
+			perlinRow(x0, step, count, fy, field.z * oct.frequency, oct.key, oct.periodX, oct.periodY, oct.amplitude, dst);
+		} else {
+			for (int i = 0; i < count; ++i) {
+				const float fx = (float(x0 + i) + 0.5f) * step;
+				dst[i] += oct.amplitude * simplexNoise(fx, fy, oct.key, oct.periodX, oct.periodY);
+			}
+		}
+	}
+}
+
+void renderNoiseField(const NoiseField& field, const ImageView& dst, const Rect& region) {
+	const Rect r = region.intersect(dst.bounds());
+	if (!dst.valid() || r.empty()) return;
+
+	parallelFor(size_t(r.height), [&](size_t row) {
+		const int y = r.y + int(row);
+		std::vector<float> values(size_t(r.width));
+		for (int c = 0; c < dst.channels; ++c) {
+			noiseFieldRow(field, c, r.x, y, r.width, values.data());
+			float* out = dst.pixel(r.x, y) + size_t(c);
+			for (int i = 0; i < r.width; ++i) out[size_t(i) * size_t(dst.channels)] = values[size_t(i)];
+		}
+	});
+}
+
+} // namespace forge
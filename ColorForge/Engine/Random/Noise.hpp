@@ -0,0 +1,65 @@
+//
+//  Noise.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include "EngineImage.hpp"
+
+namespace forge {
+
+/*
+ Gradient noise fields whose lattice gradients come from the Squares counter hash of
+ (seed, lattice point), rather than the mod-289 permutation polynomial of pnoise in
+ PerlinNoise.ci.metal. A field value depends only on its coordinates, so any tile of a field
+ can be rendered on its own.
+
+ Both kinds tile: lattice coordinates are wrapped at the period before hashing, so a field
+ with period P cells repeats every P × scale pixels with no seam.
+
+ - Perlin: improved Perlin noise (Perlin 2002), 3D so a slice (z) can animate or decorrelate.
+ - Simplex: 2D on the lattice of psrdnoise (Gustavson & McEwan 2022), which, unlike the
+   classic skewed simplex grid, tiles for any integer x period and any even y period.
+
+ Octaves sum the field at frequencies scaled by `lacunarity` with amplitudes scaled by `gain`,
+ normalised so the sum stays in about [-1, 1]. For periodic fields each octave's frequency is
+ adjusted so the x period is a whole number of its cells, so the sum still tiles (in y as well
+ when the lacunarity is an integer).
+
+ Perlin rows are evaluated eight x positions at a time, with the lattice, hashing, fades and
+ lerps written lane by lane so the compiler can vectorise them. They match the scalar
+ perlinNoise up to float contraction.
+
+ Values are roughly in [-1, 1], mean zero.
+ */
+
+enum class NoiseKind { Perlin, Simplex };
+
+struct NoiseField {
+	NoiseKind kind = NoiseKind::Perlin;
+	uint64_t seed = 0;
+	float scale = 64.0f; // pixels per lattice cell
+	int periodX = 0;     // lattice cells before the field repeats; 0 = never
+	int periodY = 0;     // simplex rounds this up to even
+	float z = 0.0f;      // Perlin slice
+	int octaves = 1;
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+};
+
+// Lattice coordinates wrap at periods > 0. `key` is squaresKey(seed).
+float perlinNoise(float x, float y, float z, uint64_t key, int periodX = 0, int periodY = 0, int periodZ = 0);
+float simplexNoise(float x, float y, uint64_t key, int periodX = 0, int periodY = 0);
+
+// Pixels [x0, x0 + count) of row y of one channel (the field with seed + channel).
+void noiseFieldRow(const NoiseField& field, int channel, int x0, int y, int count, float* dst);
+
+// Fills `region` of `dst`; channel c is the field with seed + c. Pixel (x, y) samples the
+// field at ((x + 0.5) / scale, (y + 0.5) / scale).
+void renderNoiseField(const NoiseField& field, const ImageView& dst, const Rect& region);
+
+} // namespace forge
@@ -0,0 +1,199 @@
+//
+//  NoiseFieldCache.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "NoiseFieldCache.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace forge {
+
+NoiseFieldCache::NoiseFieldCache(TileStore& store) : store_(store) {}
+
+NoiseFieldCache& NoiseFieldCache::shared() {
+	static NoiseFieldCache cache;
+	return cache;
+}
+
+uint64_t NoiseFieldCache::fieldId(const NoiseField& field, int channel) {
+	uint64_t h = hashCombine(hashString("NoiseField"), uint64_t(field.kind));
+	h = hashCombine(h, field.seed + uint64_t(channel));
+	h = hashCombine(h, (uint64_t(uint32_t(field.periodX)) << 32) | uint32_t(field.periodY));
+	h = hashCombine(h, uint64_t(std::max(field.octaves, 1)));
+	return hashParams(h, field.scale, field.z, field.lacunarity, field.gain);
+}
+
+std::shared_ptr<const HalfTile> NoiseFieldCache::tile(const NoiseField& field, int channel, int tx, int ty) {
+	const TileKey key{ fieldId(field, channel), 0, tx, ty };
+	if (auto cached = store_.find(key)) return cached;
+
+	// Concurrent misses on one tile may both generate it; the results are identical.
+	auto out = std::make_shared<HalfTile>(size_t(kTileSize) * kTileSize);
+	std::vector<float> row(kTileSize);
+	for (int y = 0; y < kTileSize; ++y) {
+		noiseFieldRow(field, channel, tx * kTileSize, ty * kTileSize + y, kTileSize, row.data());
+		floatToHalf(row.data(), &(*out)[size_t(y) * kTileSize], kTileSize);
+	}
+	store_.insert(key, out);
+	return out;
+}
+
+// Calls `copy(tx, ty, tileRect, part)` for every tile overlapping `region`, in parallel.
+template <typename Copy>
+static void forEachTile(const Rect& region, Copy&& copy) {
+	if (region.empty()) return;
+	auto floorTile = [](int v) { return v >= 0 ? v / kTileSize : -((-v + kTileSize - 1) / kTileSize); };
+	const int tx0 = floorTile(region.x), tx1 = floorTile(region.right() - 1);
+	const int ty0 = floorTile(region.y), ty1 = floorTile(region.bottom() - 1);
+	const int across = tx1 - tx0 + 1;
+	const size_t count = size_t(across) * size_t(ty1 - ty0 + 1);
+
+	parallelFor(count, [&](size_t i) {
+		const int tx = tx0 + int(i % size_t(across));
+		const int ty = ty0 + int(i / size_t(across));
+		const Rect tileRect{ tx * kTileSize, ty * kTileSize, kTileSize, kTileSize };
+		copy(tx, ty, tileRect, tileRect.intersect(region));
+	});
+}
+
+void NoiseFieldCache::read(const NoiseField& field, const Rect& region, const ImageView& dst) {
+	if (!dst.valid() || region.empty()) return;
+	const Rect r{ region.x, region.y, std::min(region.width, dst.width), std::min(region.height, dst.height) };
+
+	for (int c = 0; c < dst.channels; ++c) {
+		forEachTile(r, [&](int tx, int ty, const Rect& tileRect, const Rect& part) {
+			const auto t = tile(field, c, tx, ty);
+			std::vector<float> values(size_t(part.width));
+			for (int y = part.y; y < part.bottom(); ++y) {
+				halfToFloat(&(*t)[size_t(y - tileRect.y) * kTileSize + size_t(part.x - tileRect.x)], values.data(), values.size());
+				float* out = dst.pixel(part.x - r.x, y - r.y) + size_t(c);
+				for (int i = 0; i < part.width; ++i) out[size_t(i) * size_t(dst.channels)] = values[size_t(i)];
+			}
+		});
+	}
+}
+
+void NoiseFieldCache::readHalf(const NoiseField& field, int channel, const Rect& region, half_t* dst, size_t dstStride,
+							   float gain, float bias) {
+	if (!dst) return;
+	const bool identity = gain == 1.0f && bias == 0.0f;
+	forEachTile(region, [&](int tx, int ty, const Rect& tileRect, const Rect& part) {
+		const auto t = tile(field, channel, tx, ty);
+		std::vector<float> values(identity ? 0 : size_t(part.width));
+		for (int y = part.y; y < part.bottom(); ++y) {
+			const half_t* src = &(*t)[size_t(y - tileRect.y) * kTileSize + size_t(part.x - tileRect.x)];
+			half_t* out = dst + size_t(y - region.y) * dstStride + size_t(part.x - region.x);
+			if (identity) {
+				std::copy(src, src + part.width, out);
+				continue;
+			}
+			halfToFloat(src, values.data(), values.size());
+			for (float& v : values) v = v * gain + bias;
+			floatToHalf(values.data(), out, values.size());
+		}
+	});
+}
+
+void NoiseFieldCache::remove(const NoiseField& field, int channels) {
+	for (int c = 0; c < channels; ++c) store_.removeImage(fieldId(field, c));
+}
+
+// MARK: - Benchmark
+
+NoiseFieldBenchmark benchmarkNoiseField(int width, int height, int octaves) {
+	using Clock = std::chrono::steady_clock;
+	auto seconds = [](Clock::time_point t0) { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+	const double megapixels = double(width) * double(height) / 1e6;
+	NoiseFieldBenchmark b;
+
+	NoiseField field;
+	field.seed = 1;
+	field.scale = 64.0f;
+	ImageBuffer scalar(width, height, 1), rows(width, height, 1);
+
+	// One octave both ways: per-pixel scalar against the lane evaluator.
+	const uint64_t key = squaresKey(field.seed);
+	auto t0 = Clock::now();
+	parallelFor(size_t(height), [&](size_t y) {
+		float* out = scalar.view().row(int(y));
+		const float fy = (float(y) + 0.5f) / field.scale;
+		for (int x = 0; x < width; ++x) out[x] = perlinNoise((float(x) + 0.5f) / field.scale, fy, 0.0f, key);
+	});
+	b.scalarMegapixelsPerSecond = megapixels / seconds(t0);
+
+	t0 = Clock::now();
+	renderNoiseField(field, rows.view(), rows.view().bounds());
+	b.rowMegapixelsPerSecond = megapixels / seconds(t0);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			b.maxDifference = std::max(b.maxDifference, std::fabs(scalar.view().row(y)[x] - rows.view().row(y)[x]));
+		}
+	}
+
+	// Octave sum through a private store: first read generates the tiles, second only copies.
+	field.octaves = octaves;
+	TileStore store(uint64_t(width + kTileSize) * uint64_t(height + kTileSize) * sizeof(half_t));
+	NoiseFieldCache cache(store);
+	t0 = Clock::now();
+	cache.read(field, rows.view().bounds(), rows.view());
+	b.generateMegapixelsPerSecond = megapixels / seconds(t0);
+	t0 = Clock::now();
+	cache.read(field, rows.view().bounds(), rows.view());
+	b.cachedMegapixelsPerSecond = megapixels / seconds(t0);
+	return b;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+namespace {
+
+forge::NoiseField noiseField(const ForgeNoiseField& field) {
+	forge::NoiseField f;
+	f.kind = field.simplex ? forge::NoiseKind::Simplex : forge::NoiseKind::Perlin;
+	f.seed = field.seed;
+	f.scale = field.scale;
+	f.periodX = field.periodX;
+	f.periodY = field.periodY;
+	f.z = field.z;
+	f.octaves = field.octaves;
+	f.lacunarity = field.lacunarity;
+	f.gain = field.gain;
+	return f;
+}
+
+} // namespace
+
+extern "C" {
+	void ForgeRenderNoiseField(ForgeNoiseField field, float* dst, int32_t width, int32_t height, int32_t channels,
+							   size_t rowBytes, ForgeRect region) {
+		if (!dst) return;
+		const forge::ImageView out{ dst, width, height, channels, rowBytes / sizeof(float) };
+		forge::renderNoiseField(noiseField(field), out, { region.x, region.y, region.width, region.height });
+	}
+
+	void ForgeNoiseFieldReadRegion(ForgeNoiseField field, int32_t channel, ForgeRect region, uint16_t* dst, size_t rowBytes,
+								   float gain, float bias) {
+		if (!dst) return;
+		forge::NoiseFieldCache::shared().readHalf(noiseField(field), channel, { region.x, region.y, region.width, region.height },
+												  dst, rowBytes / sizeof(uint16_t), gain, bias);
+	}
+
+	ForgeNoiseFieldBenchmark ForgeBenchmarkNoiseField(int32_t width, int32_t height, int32_t octaves) {
+		const forge::NoiseFieldBenchmark b = forge::benchmarkNoiseField(width, height, octaves);
+		return { b.scalarMegapixelsPerSecond, b.rowMegapixelsPerSecond, b.generateMegapixelsPerSecond,
+				 b.cachedMegapixelsPerSecond, b.maxDifference };
+	}
+}
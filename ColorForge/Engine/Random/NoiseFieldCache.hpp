@@ -0,0 +1,68 @@
+//
+//  NoiseFieldCache.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "EngineImage.hpp"
+#include "Half.hpp"
+#include "Noise.hpp"
+#include "TilePyramid.hpp"
+
+namespace forge {
+
+/*
+ Generated noise fields kept as fp16 tiles, so texture stages read noise instead of evaluating
+ it per pixel per render.
+
+ perlinNoise, perlinNoiseSmall and friends in PerlinNoise.ci.metal run the full 3D pnoise for
+ every pixel of every render, although the result depends only on the field parameters. Here a
+ field channel is cut into kTileSize² single-channel half tiles held in the shared TileStore
+ (under the same byte budget as the image pyramids). A tile is keyed by the hash of the
+ parameters that determine it (kind, seed + channel, scale, periods, z, octaves) and its
+ position. Output size is not part of the key: values depend only on position, so a field
+ read at two sizes shares the tiles they overlap.
+
+ Tiles are generated on first use with noiseFieldRow, in parallel across the tiles a read
+ needs; fp16 keeps about 3 decimal digits, well below what a texture overlay can show.
+ */
+
+class NoiseFieldCache {
+public:
+	explicit NoiseFieldCache(TileStore& store = TileStore::shared());
+
+	static NoiseFieldCache& shared();
+
+	// Cache identity of one channel of a field.
+	static uint64_t fieldId(const NoiseField& field, int channel);
+
+	std::shared_ptr<const HalfTile> tile(const NoiseField& field, int channel, int tx, int ty);
+
+	// `region` into `dst` as float; dst channel c is field channel c.
+	void read(const NoiseField& field, const Rect& region, const ImageView& dst);
+	// `region` of one channel as halfs of value × gain + bias, `dstStride` halfs per row.
+	void readHalf(const NoiseField& field, int channel, const Rect& region, half_t* dst, size_t dstStride,
+				  float gain = 1.0f, float bias = 0.0f);
+
+	void remove(const NoiseField& field, int channels);
+
+private:
+	TileStore& store_;
+};
+
+struct NoiseFieldBenchmark {
+	double scalarMegapixelsPerSecond = 0;   // perlinNoise per pixel, one octave
+	double rowMegapixelsPerSecond = 0;      // lane evaluator, one octave
+	double generateMegapixelsPerSecond = 0; // first cached read, all octaves
+	double cachedMegapixelsPerSecond = 0;   // repeat read
+	float maxDifference = 0;                // scalar vs lanes
+};
+
+NoiseFieldBenchmark benchmarkNoiseField(int width, int height, int octaves);
+
+} // namespace forge
@@ -0,0 +1,184 @@
+//
+//  Random.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "Random.hpp"
+#include "Parallel.hpp"
+#include "Hash.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace forge {
+
+namespace {
+
+constexpr int kLanes = 8;
+
+// Philox4x32-10 for counters (x0 + lane, y, channel, block), lane by lane in each step so the
+// multiplies vectorise. out[w][lane] is word w of that lane's block.
+inline void philoxLanes(int x0, int y, int channel, uint32_t block, uint32_t k0, uint32_t k1, uint32_t out[4][kLanes]) {
+	uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+	for (int l = 0; l < kLanes; ++l) {
+		c0[l] = uint32_t(x0 + l);
+		c1[l] = uint32_t(y);
+		c2[l] = uint32_t(channel);
+		c3[l] = block;
+	}
+	for (int round = 0; round < 10; ++round) {
+		for (int l = 0; l < kLanes; ++l) {
+			const uint64_t p0 = uint64_t(0xD2511F53u) * c0[l];
+			const uint64_t p1 = uint64_t(0xCD9E8D57u) * c2[l];
+			const uint32_t n0 = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+			const uint32_t n2 = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+			c1[l] = uint32_t(p1);
+			c3[l] = uint32_t(p0);
+			c0[l] = n0;
+			c2[l] = n2;
+		}
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+	for (int l = 0; l < kLanes; ++l) {
+		out[0][l] = c0[l];
+		out[1][l] = c1[l];
+		out[2][l] = c2[l];
+		out[3][l] = c3[l];
+	}
+}
+
+} // namespace
+
+void CounterRandom::uniform(int x0, int y, int channel, uint32_t index, int count, float* dst) const {
+	uint32_t words[4][kLanes];
+	for (int i = 0; i < count; i += kLanes) {
+		philoxLanes(x0 + i, y, channel, index >> 2, k0_, k1_, words);
+		const int n = std::min(kLanes, count - i);
+		for (int l = 0; l < n; ++l) dst[i + l] = unitFloat(words[index & 3][l]);
+	}
+}
+
+void CounterRandom::gaussian(int x0, int y, int channel, uint32_t index, int count, float* dst) const {
+	uint32_t words[4][kLanes];
+	for (int i = 0; i < count; i += kLanes) {
+		philoxLanes(x0 + i, y, channel, index, k0_, k1_, words);
+		const int n = std::min(kLanes, count - i);
+		for (int l = 0; l < n; ++l) dst[i + l] = boxMuller(words[0][l], words[1][l]);
+	}
+}
+
+void CounterRandom::poisson(const float* lambda, int x0, int y, int channel, uint32_t index, int count, int* dst) const {
+	uint32_t words[4][kLanes];
+	for (int i = 0; i < count; i += kLanes) {
+		philoxLanes(x0 + i, y, channel, index, k0_, k1_, words);
+		const int n = std::min(kLanes, count - i);
+		for (int l = 0; l < n; ++l) {
+			const float lam = lambda[i + l];
+			const float normal = lam >= kPoissonInversionLimit ? boxMuller(words[0][l], words[1][l]) : 0.0f;
+			dst[i + l] = poissonVariate(lam, unitFloat(words[2][l]), normal);
+		}
+	}
+}
+
+// MARK: - Benchmark
+
+RandomBenchmark benchmarkRandom(int width, int height) {
+	width = std::max(1, width);
+	height = std::max(1, height);
+	RandomBenchmark result;
+
+	// Random123 kat_vectors: counter, key, expected block.
+	struct KnownAnswer { uint32_t c[4], k[2], out[4]; };
+	const KnownAnswer answers[] = {
+		{ { 0, 0, 0, 0 }, { 0, 0 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+		{ { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff },
+		  { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+		{ { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 },
+		  { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+	};
+	result.knownAnswers = true;
+	for (const auto& a : answers) {
+		const RandomBlock b = philox4x32(a.c[0], a.c[1], a.c[2], a.c[3], a.k[0], a.k[1]);
+		result.knownAnswers = result.knownAnswers && std::memcmp(b.v, a.out, sizeof(a.out)) == 0;
+	}
+
+	// Runs starting off the lane grid and ending mid-lane, negative x included, every index word.
+	const CounterRandom random(0x0123456789ABCDEFull);
+	result.batchMatchesScalar = true;
+	for (const int x0 : { -13, 0, 5 }) {
+		for (const int count : { 1, 7, 8, 29 }) {
+			for (uint32_t index = 0; index < 6; ++index) {
+				float u[29], g[29], lambda[29];
+				int p[29];
+				for (int i = 0; i < count; ++i) lambda[i] = 0.37f * float(i * i); // both Poisson branches
+				random.uniform(x0, 3, 1, index, count, u);
+				random.gaussian(x0, 3, 1, index, count, g);
+				random.poisson(lambda, x0, 3, 1, index, count, p);
+				for (int i = 0; i < count; ++i) {
+					const float su = random.uniform(x0 + i, 3, 1, index);
+					const float sg = random.gaussian(x0 + i, 3, 1, index);
+					const bool same = std::memcmp(&su, &u[i], sizeof(float)) == 0 && std::memcmp(&sg, &g[i], sizeof(float)) == 0 &&
+									  random.poisson(lambda[i], x0 + i, 3, 1, index) == p[i];
+					result.batchMatchesScalar = result.batchMatchesScalar && same;
+				}
+			}
+		}
+	}
+
+	// Whole frame a row at a time, timed.
+	std::vector<float> frame(size_t(width) * size_t(height));
+	const auto start = std::chrono::steady_clock::now();
+	parallelFor(size_t(height), [&](size_t y) {
+		random.gaussian(0, int(y), 2, 7, width, &frame[y * size_t(width)]);
+	});
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.megavariatesPerSecond = seconds > 0.0 ? double(width) * double(height) / seconds / 1e6 : 0.0;
+
+	// The same frame from 61 × 37 tiles, generated in reverse order across the workers.
+	constexpr int kTileW = 61, kTileH = 37;
+	const int across = (width + kTileW - 1) / kTileW;
+	const size_t tiles = size_t(across) * size_t((height + kTileH - 1) / kTileH);
+	std::vector<float> tiled(frame.size());
+	parallelFor(tiles, [&](size_t i) {
+		const size_t t = tiles - 1 - i;
+		const int tx = int(t % size_t(across)) * kTileW, ty = int(t / size_t(across)) * kTileH;
+		const int w = std::min(kTileW, width - tx);
+		for (int y = ty; y < std::min(ty + kTileH, height); ++y) {
+			random.gaussian(tx, y, 2, 7, w, &tiled[size_t(y) * size_t(width) + size_t(tx)]);
+		}
+	});
+	result.tileInvariant = std::memcmp(frame.data(), tiled.data(), frame.size() * sizeof(float)) == 0;
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+extern "C" {
+	void ForgeRandomUniform(uint64_t seed, int32_t x0, int32_t y, int32_t channel, uint32_t index, int32_t count, float* dst) {
+		if (!dst || count <= 0) return;
+		forge::CounterRandom(seed).uniform(x0, y, channel, index, count, dst);
+	}
+
+	void ForgeRandomGaussian(uint64_t seed, int32_t x0, int32_t y, int32_t channel, uint32_t index, int32_t count, float* dst) {
+		if (!dst || count <= 0) return;
+		forge::CounterRandom(seed).gaussian(x0, y, channel, index, count, dst);
+	}
+
+	uint64_t ForgeRandomSeed(const char* key) {
+		return forge::hashString(key ? key : "");
+	}
+
+	ForgeRandomBenchmark ForgeBenchmarkRandom(int32_t width, int32_t height) {
+		const forge::RandomBenchmark b = forge::benchmarkRandom(width, height);
+		return { b.megavariatesPerSecond, b.knownAnswers, b.batchMatchesScalar, b.tileInvariant };
+	}
+}
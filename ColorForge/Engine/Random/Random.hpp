@@ -0,0 +1,172 @@
+//
+//  Random.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace forge {
+
+/*
+ Counter-based random numbers: every value is a pure function of a key (the seed) and a
+ counter (what the value is for), with no state carried from one draw to the next.
+
+ randFromTile (GrainTiling.ci.metal), ditherMask (MaskingKernels.ci.metal) and the Swift
+ Box-Muller helpers either hash pixel coordinates ad hoc or pull from a sequential generator,
+ so a value depends on evaluation order and a tile rendered on its own comes out different.
+ Here the counter is (x, y, channel, index), so any pixel, tile or band can be generated
+ alone, in any order, on any thread, and match a full-frame render bit for bit.
+
+ - Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011) for
+   variates: 10 rounds of two 32×32→64 multiplies, four 32-bit outputs per counter.
+ - Squares (Widynski, 2020) for lattice hashing in the noise fields: four squarings of a
+   64-bit counter, cheaper where statistical quality matters less than speed.
+
+ The batch functions in Random.cpp generate a run of x positions per call with the rounds
+ written over eight lanes side by side, which the compiler turns into vector multiplies.
+ Scalar and batch paths compute identical bits.
+ */
+
+struct RandomBlock {
+	uint32_t v[4];
+};
+
+// One Philox4x32-10 block.
+inline RandomBlock philox4x32(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1) {
+	for (int round = 0; round < 10; ++round) {
+		const uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+		const uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+		const uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+		const uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+		c1 = uint32_t(p1);
+		c3 = uint32_t(p0);
+		c0 = n0;
+		c2 = n2;
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+	return { { c0, c1, c2, c3 } };
+}
+
+// Squares32 with a 64-bit counter. `key` should have well-mixed bits (see squaresKey).
+inline uint32_t squares32(uint64_t counter, uint64_t key) {
+	uint64_t x = counter * key;
+	const uint64_t y = x, z = y + key;
+	x = x * x + y; x = (x >> 32) | (x << 32);
+	x = x * x + z; x = (x >> 32) | (x << 32);
+	x = x * x + y; x = (x >> 32) | (x << 32);
+	return uint32_t((x * x + z) >> 32);
+}
+
+inline uint64_t squaresKey(uint64_t seed) {
+	uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return (z ^ (z >> 31)) | 1;
+}
+
+// [0, 1) with 24 bits, so every value is exact in float.
+inline float unitFloat(uint32_t bits) { return float(bits >> 8) * 0x1p-24f; }
+
+// Box-Muller on two words; u1 is taken in (0, 1] so the log is finite.
+inline float boxMuller(uint32_t a, uint32_t b) {
+	const float u1 = 1.0f - unitFloat(a);
+	const float u2 = unitFloat(b);
+	return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.28318530718f * u2);
+}
+
+// Poisson(lambda) from one uniform and one standard normal. Inversion (exact) below
+// kPoissonInversionLimit; above it the continuity-corrected normal approximation, whose
+// error there is under 1% of a standard deviation.
+constexpr float kPoissonInversionLimit = 32.0f;
+
+inline int poissonVariate(float lambda, float uniform, float normal) {
+	if (!(lambda > 0.0f)) return 0;
+	if (lambda >= kPoissonInversionLimit) {
+		return int(std::max(0.0f, std::floor(lambda + std::sqrt(lambda) * normal + 0.5f)));
+	}
+	double p = std::exp(-double(lambda));
+	double cdf = p;
+	int k = 0;
+	while (double(uniform) > cdf && k < 4 * int(kPoissonInversionLimit)) {
+		++k;
+		p *= double(lambda) / k;
+		cdf += p;
+	}
+	return k;
+}
+
+// Random values addressed by (x, y, channel, index) under a seed.
+class CounterRandom {
+public:
+	explicit CounterRandom(uint64_t seed = 0) : k0_(uint32_t(seed)), k1_(uint32_t(seed >> 32)) {}
+
+	// Words 4·block ..< 4·block + 4 of the sequence at (x, y, channel).
+	RandomBlock block(int x, int y, int channel, uint32_t block) const {
+		return philox4x32(uint32_t(x), uint32_t(y), uint32_t(channel), block, k0_, k1_);
+	}
+
+	uint32_t bits(int x, int y, int channel, uint32_t index) const { return block(x, y, channel, index >> 2).v[index & 3]; }
+	float uniform(int x, int y, int channel, uint32_t index) const { return unitFloat(bits(x, y, channel, index)); }
+
+	// Variate `index` of a kind uses block `index` on its own: the Gaussian takes words 0-1,
+	// the Poisson words 2 (uniform) and 0-1 (its normal).
+	float gaussian(int x, int y, int channel, uint32_t index) const {
+		const RandomBlock b = block(x, y, channel, index);
+		return boxMuller(b.v[0], b.v[1]);
+	}
+	int poisson(float lambda, int x, int y, int channel, uint32_t index) const {
+		const RandomBlock b = block(x, y, channel, index);
+		return poissonVariate(lambda, unitFloat(b.v[2]), lambda >= kPoissonInversionLimit ? boxMuller(b.v[0], b.v[1]) : 0.0f);
+	}
+
+	// Index `index` for x0 ..< x0 + count along row y, identical to the scalar calls.
+	void uniform(int x0, int y, int channel, uint32_t index, int count, float* dst) const;
+	void gaussian(int x0, int y, int channel, uint32_t index, int count, float* dst) const;
+	void poisson(const float* lambda, int x0, int y, int channel, uint32_t index, int count, int* dst) const;
+
+private:
+	uint32_t k0_, k1_;
+};
+
+// Sequential draws for one (x, y, channel), e.g. the variable number of grains in a cell.
+// Draw i is word i of that sequence, so the stream is seekable and order-free across cells.
+class RandomStream {
+public:
+	RandomStream(const CounterRandom& random, int x, int y, int channel)
+		: random_(random), x_(x), y_(y), channel_(channel) {}
+
+	uint32_t bits() {
+		if ((next_ & 3) == 0) block_ = random_.block(x_, y_, channel_, next_ >> 2);
+		return block_.v[next_++ & 3];
+	}
+	float uniform() { return unitFloat(bits()); }
+	float gaussian() {
+		const uint32_t a = bits();
+		return boxMuller(a, bits());
+	}
+
+private:
+	CounterRandom random_;
+	int x_, y_, channel_;
+	uint32_t next_ = 0;
+	RandomBlock block_{};
+};
+
+struct RandomBenchmark {
+	double megavariatesPerSecond = 0.0; // batch Gaussians over the frame
+	bool knownAnswers = false;          // Philox4x32-10 against the Random123 test vectors
+	bool batchMatchesScalar = false;    // uniform, Gaussian and Poisson runs bit for bit against per-pixel calls
+	bool tileInvariant = false;         // the frame from uneven tiles in reverse order equals the frame row by row
+};
+
+// Checks on, and a Gaussian fill of, a `width` × `height` frame.
+RandomBenchmark benchmarkRandom(int width, int height);
+
+} // namespace forge
@@ -0,0 +1,122 @@
+//
+//  Histogram.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace forge {
+
+HistogramEngine::HistogramEngine(int bins, unsigned maxThreads)
+	: bins_(std::clamp(bins, 2, 65536)), slots_(std::max(1u, maxThreads)) {
+	partial_.resize(size_t(slots_) * kChannels * size_t(bins_));
+	scratch_.resize(size_t(slots_) * 3 * kBlock);
+	indices_.resize(size_t(slots_) * kChannels * kBlock);
+}
+
+void HistogramEngine::binRows(const ScopeSource& source, const HistogramOptions& options, unsigned slot, int firstRow, int lastRow) {
+	uint32_t* hist = &partial_[size_t(slot) * kChannels * size_t(bins_)];
+	uint32_t* hr = hist;
+	uint32_t* hg = hist + bins_;
+	uint32_t* hb = hist + 2 * bins_;
+	uint32_t* hy = hist + 3 * bins_;
+
+	float* r = &scratch_[size_t(slot) * 3 * kBlock];
+	float* g = r + kBlock;
+	float* b = g + kBlock;
+	uint16_t* ir = &indices_[size_t(slot) * kChannels * kBlock];
+	uint16_t* ig = ir + kBlock;
+	uint16_t* ib = ig + kBlock;
+	uint16_t* iy = ib + kBlock;
+
+	const int step = options.step;
+	const float lo = options.minValue;
+	const float scale = float(bins_) / (options.maxValue - options.minValue);
+	const float top = float(bins_ - 1);
+	const int columns = (source.width + step - 1) / step;
+
+	for (int row = firstRow; row < lastRow; ++row) {
+		const int y = row * step;
+		for (int c0 = 0; c0 < columns; c0 += kBlock) {
+			const int n = std::min(kBlock, columns - c0);
+			loadRGBRow(source, y, c0 * step, n, step, r, g, b);
+
+			for (int i = 0; i < n; ++i) {
+				ir[i] = scopeBin(r[i], lo, scale, top);
+				ig[i] = scopeBin(g[i], lo, scale, top);
+				ib[i] = scopeBin(b[i], lo, scale, top);
+				iy[i] = scopeBin(kLumaR * r[i] + kLumaG * g[i] + kLumaB * b[i], lo, scale, top);
+			}
+			for (int i = 0; i < n; ++i) {
+				hr[ir[i]]++;
+				hg[ig[i]]++;
+				hb[ib[i]]++;
+				hy[iy[i]]++;
+			}
+		}
+	}
+}
+
+uint64_t HistogramEngine::compute(const ScopeSource& source, const HistogramOptions& options, uint32_t* counts) {
+	const size_t stride = size_t(kChannels) * size_t(bins_);
+	std::fill(counts, counts + stride, 0u);
+	if (!source.valid() || !(options.maxValue > options.minValue)) return 0;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	HistogramOptions opts = options;
+	opts.step = std::max(1, opts.step);
+	const int rows = (source.height + opts.step - 1) / opts.step;
+	const int columns = (source.width + opts.step - 1) / opts.step;
+	const unsigned used = unsigned(std::min<size_t>(slots_, size_t(rows)));
+	std::memset(partial_.data(), 0, size_t(used) * kChannels * size_t(bins_) * sizeof(uint32_t));
+
+	parallelChunks(size_t(rows), used, [&](size_t chunk, size_t begin, size_t end) {
+		binRows(source, opts, unsigned(chunk), int(begin), int(end));
+	});
+
+	for (unsigned s = 0; s < used; ++s) {
+		const uint32_t* p = &partial_[size_t(s) * stride];
+		for (size_t i = 0; i < stride; ++i) counts[i] += p[i];
+	}
+	return uint64_t(rows) * uint64_t(columns);
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeHistogram {
+	forge::HistogramEngine engine;
+	explicit ForgeHistogram(int bins) : engine(bins) {}
+};
+
+extern "C" {
+	ForgeHistogram* ForgeHistogramCreate(int32_t bins) {
+		return new ForgeHistogram(bins);
+	}
+
+	void ForgeHistogramRelease(ForgeHistogram* histogram) {
+		delete histogram;
+	}
+
+	int32_t ForgeHistogramBinCount(const ForgeHistogram* histogram) {
+		return histogram ? histogram->engine.bins() : 0;
+	}
+
+	uint64_t ForgeHistogramCompute(ForgeHistogram* histogram, ForgeScopeSource source, int32_t step,
+								   float minValue, float maxValue, uint32_t* counts) {
+		if (!histogram || !counts) return 0;
+		forge::HistogramOptions options;
+		options.step = step;
+		options.minValue = minValue;
+		options.maxValue = maxValue;
+		return histogram->engine.compute(forgeScopeSource(source), options, counts);
+	}
+}
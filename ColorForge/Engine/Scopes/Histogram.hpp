@@ -0,0 +1,61 @@
+//
+//  Histogram.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "Parallel.hpp"
+#include "ScopeSource.hpp"
+
+namespace forge {
+
+/*
+ CPU histogram of R, G, B and luma in a single pass.
+
+ HistogramModel used to run CIAreaHistogram, read the result back into a float
+ CVPixelBuffer and then walk it once per channel. Here every pixel is loaded once, its four
+ bin indices are computed a block at a time (a loop the compiler vectorises), and the counts
+ go into a private sub-histogram per worker, so threads never share a cache line. The
+ sub-histograms are summed at the end.
+
+ All storage is sized in the constructor; compute() does not allocate.
+ */
+
+struct HistogramOptions {
+	int step = 1;          // bin every step-th pixel of every step-th row (live preview)
+	float minValue = 0.0f; // lower edge of the first bin
+	float maxValue = 1.0f; // upper edge of the last bin; values outside land in the end bins
+};
+
+class HistogramEngine {
+public:
+	static constexpr int kChannels = 4; // R, G, B, luma
+
+	explicit HistogramEngine(int bins = 256, unsigned maxThreads = workerCount());
+
+	int bins() const { return bins_; }
+
+	// Writes kChannels × bins() counts to `counts` (channel c starts at c * bins()) and returns
+	// the number of pixels binned. Calls are serialised.
+	uint64_t compute(const ScopeSource& source, const HistogramOptions& options, uint32_t* counts);
+
+private:
+	static constexpr int kBlock = 256; // pixels unpacked per inner iteration
+
+	void binRows(const ScopeSource& source, const HistogramOptions& options, unsigned slot, int firstRow, int lastRow);
+
+	int bins_;
+	unsigned slots_;
+	std::vector<uint32_t> partial_; // slots_ × kChannels × bins_
+	std::vector<float> scratch_;    // slots_ × 3 × kBlock unpacked samples
+	std::vector<uint16_t> indices_; // slots_ × kChannels × kBlock bin indices
+	std::mutex mutex_;
+};
+
+} // namespace forge
@@ -0,0 +1,246 @@
+//
+//  ScopeEngine.cpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#include "ScopeEngine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace forge {
+
+// Rec. 709 colour difference scaling: Cb = (B - Y) / 1.8556, Cr = (R - Y) / 1.5748.
+static constexpr float kCbScale = 1.0f / (2.0f * (1.0f - kLumaB));
+static constexpr float kCrScale = 1.0f / (2.0f * (1.0f - kLumaR));
+
+ScopeEngine::ScopeEngine(ScopeLayout layout, unsigned maxThreads) : layout_(layout), slots_(std::max(1u, maxThreads)) {
+	layout_.columns = std::clamp(layout_.columns, 1, 65536);
+	layout_.levels = std::clamp(layout_.levels, 2, 65536);
+	layout_.vectorSize = std::clamp(layout_.vectorSize, 2, 65536);
+
+	const size_t vectorCells = size_t(layout_.vectorSize) * size_t(layout_.vectorSize);
+	waveform_.resize(size_t(kWaveformChannels) * size_t(layout_.levels) * size_t(layout_.columns));
+	vectorscope_.resize(vectorCells);
+	vectorPartial_.resize(size_t(slots_) * vectorCells);
+	scratch_.resize(size_t(slots_) * 3 * kBlock);
+	binScratch_.resize(size_t(slots_) * kBins * kBlock);
+}
+
+const uint32_t* ScopeEngine::waveform(int channel) const {
+	channel = std::clamp(channel, 0, kWaveformChannels - 1);
+	return &waveform_[size_t(channel) * size_t(layout_.levels) * size_t(layout_.columns)];
+}
+
+// Sampled column x falls in waveform column floor(x * columns / sampledWidth).
+int ScopeEngine::firstSampleOfColumn(int column) const {
+	return int((int64_t(column) * sampledWidth_ + layout_.columns - 1) / layout_.columns);
+}
+
+void ScopeEngine::accumulate(const ScopeSource& source) {
+	const int columns = layout_.columns;
+	const int levels = layout_.levels;
+	const int vsize = layout_.vectorSize;
+	const size_t plane = size_t(levels) * size_t(columns);
+	const size_t vectorCells = size_t(vsize) * size_t(vsize);
+
+	const int step = options_.step;
+	const float lo = options_.minValue;
+	const float levelScale = float(levels) / (options_.maxValue - options_.minValue);
+	const float levelTop = float(levels - 1);
+	const float vrange = options_.vectorRange;
+	const float vectorScale = float(vsize) / (2.0f * vrange);
+	const float vectorTop = float(vsize - 1);
+
+	// Waveform columns with no samples (an image narrower than the scope) need no strip.
+	const int usedColumns = std::min(columns, sampledWidth_);
+	const unsigned used = unsigned(std::min<size_t>(slots_, size_t(usedColumns)));
+
+	parallelChunks(size_t(columns), used, [&](size_t slot, size_t begin, size_t end) {
+		const int x0 = firstSampleOfColumn(int(begin));
+		const int x1 = std::min(sampledWidth_, firstSampleOfColumn(int(end)));
+		if (x0 >= x1) return;
+
+		uint32_t* vs = &vectorPartial_[slot * vectorCells];
+		float* r = &scratch_[slot * 3 * kBlock];
+		float* g = r + kBlock;
+		float* b = g + kBlock;
+		uint16_t* bins[kBins];
+		for (int c = 0; c < kBins; ++c) bins[c] = &binScratch_[(slot * kBins + size_t(c)) * kBlock];
+
+		for (int sy = 0; sy < sampledHeight_; ++sy) {
+			for (int bx = x0; bx < x1; bx += kBlock) {
+				const int n = std::min(kBlock, x1 - bx);
+				loadRGBRow(source, sy * step, bx * step, n, step, r, g, b);
+
+				for (int i = 0; i < n; ++i) {
+					const float y = kLumaR * r[i] + kLumaG * g[i] + kLumaB * b[i];
+					bins[0][i] = scopeBin(r[i], lo, levelScale, levelTop);
+					bins[1][i] = scopeBin(g[i], lo, levelScale, levelTop);
+					bins[2][i] = scopeBin(b[i], lo, levelScale, levelTop);
+					bins[3][i] = scopeBin(y, lo, levelScale, levelTop);
+					bins[4][i] = scopeBin((b[i] - y) * kCbScale, -vrange, vectorScale, vectorTop);
+					bins[5][i] = scopeBin((r[i] - y) * kCrScale, -vrange, vectorScale, vectorTop);
+				}
+
+				int column = int(int64_t(bx) * columns / sampledWidth_);
+				int nextColumnAt = firstSampleOfColumn(column + 1);
+				for (int i = 0; i < n; ++i) {
+					const int sx = bx + i;
+					while (sx >= nextColumnAt) nextColumnAt = firstSampleOfColumn(++column + 1);
+					uint32_t* wf = &waveform_[size_t(column)];
+					for (int c = 0; c < kWaveformChannels; ++c) wf[size_t(c) * plane + size_t(levels - 1 - bins[c][i]) * size_t(columns)]++;
+					vs[size_t(vsize - 1 - bins[5][i]) * size_t(vsize) + bins[4][i]]++;
+				}
+			}
+		}
+	});
+
+	// Fold the per-worker vectorscopes in and leave the partials zeroed for next time.
+	for (unsigned s = 0; s < used; ++s) {
+		uint32_t* p = &vectorPartial_[size_t(s) * vectorCells];
+		for (size_t i = 0; i < vectorCells; ++i) vectorscope_[i] += p[i];
+		std::memset(p, 0, vectorCells * sizeof(uint32_t));
+	}
+}
+
+void ScopeEngine::compute(const ScopeSource& source, const ScopeOptions& options) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::fill(waveform_.begin(), waveform_.end(), 0u);
+	std::fill(vectorscope_.begin(), vectorscope_.end(), 0u);
+	sampledWidth_ = sampledHeight_ = 0;
+	if (!source.valid() || !(options.maxValue > options.minValue) || !(options.vectorRange > 0.0f)) return;
+
+	options_ = options;
+	options_.step = std::max(1, options.step);
+	sampledWidth_ = (source.width + options_.step - 1) / options_.step;
+	sampledHeight_ = (source.height + options_.step - 1) / options_.step;
+
+	accumulate(source);
+}
+
+static void logNormalise(const uint32_t* counts, size_t n, float* dst) {
+	uint32_t peak = 0;
+	for (size_t i = 0; i < n; ++i) peak = std::max(peak, counts[i]);
+	if (peak == 0) {
+		std::fill(dst, dst + n, 0.0f);
+		return;
+	}
+	// Counts repeat a lot (most cells are 0 or small), so a short table beats calling log per cell.
+	const float inv = 1.0f / std::log1p(float(peak));
+	float table[64];
+	for (int i = 0; i < 64; ++i) table[i] = std::log1p(float(i)) * inv;
+	for (size_t i = 0; i < n; ++i) {
+		const uint32_t c = counts[i];
+		dst[i] = c < 64 ? table[c] : std::log1p(float(c)) * inv;
+	}
+}
+
+void ScopeEngine::waveformImage(int channel, float* dst) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	logNormalise(waveform(channel), size_t(layout_.levels) * size_t(layout_.columns), dst);
+}
+
+void ScopeEngine::vectorscopeImage(float* dst) const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	logNormalise(vectorscope_.data(), vectorscope_.size(), dst);
+}
+
+// MARK: - Benchmark
+
+ScopesBenchmark benchmarkScopes(int width, int height, int step) {
+	using Clock = std::chrono::steady_clock;
+	width = std::max(1, width);
+	height = std::max(1, height);
+
+	const size_t stride = size_t(width) * 4;
+	std::vector<half_t> pixels(stride * size_t(height));
+	for (int y = 0; y < height; ++y) {
+		half_t* row = &pixels[size_t(y) * stride];
+		for (int x = 0; x < width; ++x) {
+			const float u = float(x) / float(width), v = float(y) / float(height);
+			row[x * 4 + 0] = floatToHalf(u);
+			row[x * 4 + 1] = floatToHalf(v);
+			row[x * 4 + 2] = floatToHalf(std::fmod(u * v * 3.0f, 1.0f));
+			row[x * 4 + 3] = floatToHalf(1.0f);
+		}
+	}
+
+	ScopeSource source;
+	source.data = pixels.data();
+	source.width = width;
+	source.height = height;
+	source.rowBytes = stride * sizeof(half_t);
+	source.type = SampleType::Float16;
+
+	ScopeOptions options;
+	options.step = std::max(1, step);
+	const ScopeLayout layout;
+	std::vector<float> image(size_t(std::max(layout.columns * layout.levels, layout.vectorSize * layout.vectorSize)));
+	auto readout = [&](const ScopeEngine& e) {
+		for (int c = 0; c < ScopeEngine::kWaveformChannels; ++c) e.waveformImage(c, image.data());
+		e.vectorscopeImage(image.data());
+	};
+
+	ScopeEngine engine(layout);
+	ScopesBenchmark result;
+	result.computeSeconds = 1e9;
+	constexpr int kRuns = 10;
+	for (int i = 0; i < kRuns; ++i) {
+		const auto start = Clock::now();
+		engine.compute(source, options);
+		readout(engine);
+		result.computeSeconds = std::min(result.computeSeconds, std::chrono::duration<double>(Clock::now() - start).count());
+	}
+
+	return result;
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+struct ForgeScopes {
+	forge::ScopeEngine engine;
+	explicit ForgeScopes(forge::ScopeLayout layout) : engine(layout) {}
+};
+
+extern "C" {
+	ForgeScopes* ForgeScopesCreate(int32_t waveformColumns, int32_t waveformLevels, int32_t vectorscopeSize) {
+		forge::ScopeLayout layout;
+		layout.columns = waveformColumns;
+		layout.levels = waveformLevels;
+		layout.vectorSize = vectorscopeSize;
+		return new ForgeScopes(layout);
+	}
+
+	void ForgeScopesRelease(ForgeScopes* scopes) {
+		delete scopes;
+	}
+
+	void ForgeScopesCompute(ForgeScopes* scopes, ForgeScopeSource source, int32_t step) {
+		if (!scopes) return;
+		forge::ScopeOptions options;
+		options.step = step;
+		scopes->engine.compute(forgeScopeSource(source), options);
+	}
+
+	void ForgeScopesWaveformImage(const ForgeScopes* scopes, int32_t channel, float* dst) {
+		if (scopes && dst) scopes->engine.waveformImage(channel, dst);
+	}
+
+	void ForgeScopesVectorscopeImage(const ForgeScopes* scopes, float* dst) {
+		if (scopes && dst) scopes->engine.vectorscopeImage(dst);
+	}
+
+	ForgeScopesBenchmark ForgeBenchmarkScopes(int32_t width, int32_t height, int32_t step) {
+		const forge::ScopesBenchmark b = forge::benchmarkScopes(width, height, step);
+		return { b.computeSeconds };
+	}
+}
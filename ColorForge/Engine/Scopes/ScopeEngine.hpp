@@ -0,0 +1,96 @@
+//
+//  ScopeEngine.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "EngineImage.hpp"
+#include "Parallel.hpp"
+#include "ScopeSource.hpp"
+
+namespace forge {
+
+/*
+ Waveform (R, G, B and luma, column × level) and vectorscope (Rec. 709 Cb/Cr density) from
+ one pass over a subsampled image.
+
+ Work is split into vertical strips that line up with waveform columns, so every worker
+ owns its waveform columns outright; only the vectorscope needs per-worker grids, merged at
+ the end.
+
+ Memory is allocated by the constructor; compute() and the image readouts never allocate.
+ */
+
+struct ScopeLayout {
+	int columns = 256;    // waveform width
+	int levels = 256;     // waveform height
+	int vectorSize = 256; // vectorscope is vectorSize²
+};
+
+struct ScopeOptions {
+	int step = 1;          // sample every step-th pixel of every step-th row
+	float minValue = 0.0f; // waveform floor
+	float maxValue = 1.0f; // waveform ceiling
+	float vectorRange = 0.5f; // |Cb|, |Cr| at the vectorscope edge (0.5 covers the full gamut)
+};
+
+class ScopeEngine {
+public:
+	static constexpr int kWaveformChannels = 4; // R, G, B, luma
+
+	explicit ScopeEngine(ScopeLayout layout = {}, unsigned maxThreads = workerCount());
+
+	const ScopeLayout& layout() const { return layout_; }
+
+	// Rebuilds both scopes from the whole source.
+	void compute(const ScopeSource& source, const ScopeOptions& options = {});
+
+	// Raw counts. Waveform plane c is levels × columns in image orientation (top row = maxValue);
+	// the vectorscope is vectorSize² with +Cr up and +Cb right.
+	const uint32_t* waveform(int channel) const;
+	const uint32_t* vectorscope() const { return vectorscope_.data(); }
+
+	// Log-scaled densities in [0, 1]: log(1 + n) / log(1 + max).
+	void waveformImage(int channel, float* dst) const;
+	void vectorscopeImage(float* dst) const;
+
+	uint64_t samples() const { return uint64_t(sampledWidth_) * uint64_t(sampledHeight_); }
+
+private:
+	static constexpr int kBlock = 256;
+	static constexpr int kBins = 6; // r, g, b, luma level; Cb, Cr bin
+
+	void accumulate(const ScopeSource& source);
+	int firstSampleOfColumn(int column) const;
+
+	ScopeLayout layout_;
+	unsigned slots_;
+	ScopeOptions options_;
+	int sampledWidth_ = 0;
+	int sampledHeight_ = 0;
+
+	std::vector<uint32_t> waveform_;     // kWaveformChannels × levels × columns
+	std::vector<uint32_t> vectorscope_;  // vectorSize²
+	std::vector<uint32_t> vectorPartial_; // slots_ × vectorSize²
+	std::vector<float> scratch_;          // slots_ × 3 × kBlock
+	std::vector<uint16_t> binScratch_;    // slots_ × kBins × kBlock
+
+	mutable std::mutex mutex_;
+};
+
+struct ScopesBenchmark {
+	// Best of several runs, each including the log-scaled readouts the views draw.
+	double computeSeconds = 0.0;
+};
+
+// Default-layout scopes over a synthetic RGBA half `width` × `height` frame sampled every
+// `step`th pixel, as HistogramModel renders it.
+ScopesBenchmark benchmarkScopes(int width, int height, int step);
+
+} // namespace forge
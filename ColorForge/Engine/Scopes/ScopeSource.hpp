@@ -0,0 +1,113 @@
+//
+//  ScopeSource.hpp
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Half.hpp"
+
+namespace forge {
+
+enum class SampleType : uint8_t { Float32, Float16 };
+enum class SampleLayout : uint8_t { Interleaved, Planar };
+
+// Read-only pixels handed to the scopes. Interleaved sources are RGB(A) with `channels`
+// samples per pixel; planar sources keep R, G and B in separate planes `planeBytes` apart.
+// Either way the scopes only look at the first three channels.
+struct ScopeSource {
+	const void* data = nullptr;
+	int width = 0;
+	int height = 0;
+	int channels = 4;
+	size_t rowBytes = 0;
+	size_t planeBytes = 0;
+	SampleType type = SampleType::Float32;
+	SampleLayout layout = SampleLayout::Interleaved;
+
+	bool valid() const {
+		return data && width > 0 && height > 0 && rowBytes > 0 &&
+			   (layout == SampleLayout::Planar ? planeBytes > 0 : channels >= 3);
+	}
+};
+
+// Luma weights used by every scope (Rec. 709, as the Swift histogram always used).
+static constexpr float kLumaR = 0.2126f;
+static constexpr float kLumaG = 0.7152f;
+static constexpr float kLumaB = 0.0722f;
+
+// Bin for `v` in [lo, lo + bins / scale), clamped to [0, top]. Branch-free so block loops
+// vectorise; NaN fails the first comparison and lands in bin 0.
+inline uint16_t scopeBin(float v, float lo, float scale, float top) {
+	float f = (v - lo) * scale;
+	f = f > 0.0f ? f : 0.0f;
+	f = f < top ? f : top;
+	return uint16_t(f);
+}
+
+namespace detail {
+
+template <typename T>
+inline float loadSample(const T* p) { return float(*p); }
+
+template <>
+inline float loadSample<half_t>(const half_t* p) { return halfToFloat(*p); }
+
+template <typename T>
+inline void loadRGBRow(const ScopeSource& s, int y, int x0, int count, int step, float* r, float* g, float* b) {
+	const auto* base = static_cast<const uint8_t*>(s.data) + size_t(y) * s.rowBytes;
+	if (s.layout == SampleLayout::Interleaved) {
+		const T* p = reinterpret_cast<const T*>(base) + size_t(x0) * size_t(s.channels);
+		const size_t stride = size_t(step) * size_t(s.channels);
+		for (int i = 0; i < count; ++i, p += stride) {
+			r[i] = loadSample(p);
+			g[i] = loadSample(p + 1);
+			b[i] = loadSample(p + 2);
+		}
+	} else {
+		const T* pr = reinterpret_cast<const T*>(base) + x0;
+		const T* pg = reinterpret_cast<const T*>(base + s.planeBytes) + x0;
+		const T* pb = reinterpret_cast<const T*>(base + 2 * s.planeBytes) + x0;
+		for (int i = 0; i < count; ++i) {
+			const size_t o = size_t(i) * size_t(step);
+			r[i] = loadSample(pr + o);
+			g[i] = loadSample(pg + o);
+			b[i] = loadSample(pb + o);
+		}
+	}
+}
+
+} // namespace detail
+
+// Unpacks `count` pixels of row `y`, starting at column `x0` and taking every `step`th one,
+// into separate float R, G and B arrays.
+inline void loadRGBRow(const ScopeSource& s, int y, int x0, int count, int step, float* r, float* g, float* b) {
+	if (s.type == SampleType::Float16) {
+		detail::loadRGBRow<half_t>(s, y, x0, count, step, r, g, b);
+	} else {
+		detail::loadRGBRow<float>(s, y, x0, count, step, r, g, b);
+	}
+}
+
+} // namespace forge
+
+// MARK: - Bridge
+
+#include "EngineBridge.h"
+
+inline forge::ScopeSource forgeScopeSource(const ForgeScopeSource& s) {
+	forge::ScopeSource out;
+	out.data = s.data;
+	out.width = s.width;
+	out.height = s.height;
+	out.channels = s.channels;
+	out.rowBytes = s.rowBytes;
+	out.planeBytes = s.planeBytes;
+	out.type = s.isHalf ? forge::SampleType::Float16 : forge::SampleType::Float32;
+	out.layout = s.isPlanar ? forge::SampleLayout::Planar : forge::SampleLayout::Interleaved;
+	return out;
+}
@@ -23,16 +23,6 @@ extension CIImage {
 		seed: Int
 	) -> CIImage {
 		
-		// Helper function to generate Gaussian random numbers using Box-Muller transform
-		func generateGaussianRandom(mean: Float, stdDev: Float) -> Float {
-			let u1 = Float.random(in: 0.0...1.0)
-			let u2 = Float.random(in: 0.0...1.0)
-			
-			let z0 = sqrt(-2.0 * log(u1)) * cos(2.0 * Float.pi * u2)
-			// Adjust for mean and standard deviation
-			return z0 * stdDev + mean
-		}
-		
 		let width = Int(self.extent.width)
 		let height = Int(self.extent.height)
 		
@@ -64,9 +54,18 @@ extension CIImage {
 		var x_gaussian = [Float](repeating: 0.0, count: numIterations)
 		var y_gaussian = [Float](repeating: 0.0, count: numIterations)
 		
+		// Offsets from the counter-based generator (Engine/Random), so the same seed gives the same grain
+		if numIterations > 0 {
+			x_gaussian.withUnsafeMutableBufferPointer {
+				ForgeRandomGaussian(UInt64(truncatingIfNeeded: seed), 0, 0, 0, 0, Int32(numIterations), $0.baseAddress!)
+			}
+			y_gaussian.withUnsafeMutableBufferPointer {
+				ForgeRandomGaussian(UInt64(truncatingIfNeeded: seed), 0, 0, 1, 0, Int32(numIterations), $0.baseAddress!)
+			}
+		}
 		for i in 0..<numIterations {
-			x_gaussian[i] = generateGaussianRandom(mean: 0.0, stdDev: sigma)
-			y_gaussian[i] = generateGaussianRandom(mean: 0.0, stdDev: sigma)
+			x_gaussian[i] *= sigma
+			y_gaussian[i] *= sigma
 		}
 		print("\n\n Realistic Film Grain Kernel Debug:\n First 5 xGaussian: \(x_gaussian.prefix(5))")
 		print("\n\n Realistic Film Grain Kernel Debug:\n First 5 yGaussian: \(y_gaussian.prefix(5))")
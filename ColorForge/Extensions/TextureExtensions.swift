@@ -165,23 +165,20 @@ extension CIImage {
 		return result
 	}
 	
-	func smallPerlin() -> CIImage {
-		let kernel = CIColorKernelCache.shared.perlinNoiseSmall
-		let length = max(self.extent.width, self.extent.height)
-		let randomX = Float.random(in: 0...50)
-		let randomY = Float.random(in: 0...50)
-        let randomWave = Float.random(in: 0.005...0.1)
-		let width = self.extent.width
-		let height = self.extent.height
+	// Perlin texture with a wavelength of 0.5–10% of the long side, chosen by `seed` (use the
+	// item's textureSeed so each image gets its own). Read from the engine's noise cache instead
+	// of the perlinNoiseSmall kernel: the field depends only on the seed and the wavelength, so
+	// repeat renders at the same size just copy cached tiles.
+	func smallPerlin(seed: UInt64) -> CIImage {
+		let length = Float(max(self.extent.width, self.extent.height))
+		var wave: Float = 0
+		ForgeRandomUniform(seed, 0, 0, 0, 0, 1, &wave)
+		let wavePx = max(1.5, (0.005 + 0.095 * wave) * length)
 		
-		guard let result = kernel.apply(
-			extent: self.extent,
-			roiCallback: { $1 },
-			arguments: [self, length, randomX, randomY, width, height, randomWave]
-		) else {
-			print("Failed to apply \(kernel)")
-			return self}
-		return result.cropped(to: self.extent)
+		// perlinNoiseSmall multiplied its cells across by 1.037, a non-integer tweak so the lattice
+		// never lines up with the pixel grid; dividing the cell size keeps the same texture scale.
+		let field = ForgeNoiseField.perlin(seed: seed, scale: wavePx / 1.037)
+		return CIImage.noiseField(field, extent: self.extent)
 	}
 	
 	func createNoiseAndCrop() -> CIImage {
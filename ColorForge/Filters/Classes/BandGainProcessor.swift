@@ -0,0 +1,63 @@
+//
+//  BandGainProcessor.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Per-octave detail gains through the engine's Laplacian pyramid
+// (ColorForge/Engine/Filters/LaplacianPyramid). Core Image hands over tiles; each asks for its
+// input grown by the pyramid apron, so tiled output matches a full-frame pass.
+final class BandGainProcessor: CIImageProcessorKernel {
+    override class var outputFormat: CIFormat { .RGBAf }
+
+    override class func formatForInput(at input: Int32) -> CIFormat { .RGBAf }
+
+    override class func roi(forInput input: Int32, arguments: [String: Any]?, outputRect: CGRect) -> CGRect {
+        let apron = CGFloat(arguments?["apron"] as? Int32 ?? 0)
+        return outputRect.insetBy(dx: -apron, dy: -apron)
+    }
+
+    override class func process(with inputs: [CIImageProcessorInput]?, arguments: [String: Any]?,
+                                output: CIImageProcessorOutput) throws {
+        guard let input = inputs?.first,
+              let levels = arguments?["levels"] as? Int32,
+              let gains = arguments?["gains"] as? [Float] else { return }
+
+        // Buffers run top to bottom, so rows are addressed as -maxY + row: the same position for
+        // a pixel whichever tile it falls in, which keeps the pyramid grid aligned across tiles.
+        let src = input.region, dst = output.region
+        gains.withUnsafeBufferPointer { g in
+            ForgeApplyBandGains(levels, g.baseAddress!,
+                                input.baseAddress.assumingMemoryBound(to: Float.self),
+                                Int32(src.minX), -Int32(src.maxY), Int32(src.width), Int32(src.height), input.bytesPerRow,
+                                output.baseAddress.assumingMemoryBound(to: Float.self),
+                                Int32(dst.minX), -Int32(dst.maxY), Int32(dst.width), Int32(dst.height), output.bytesPerRow,
+                                4)
+        }
+    }
+}
+
+extension CIImage {
+    // Film MTF response for `pixelsPerMM` (frame pixels per mm of gate), over `extent`.
+    func mtfBands(pixelsPerMM: Float, extent: CGRect) -> CIImage {
+        var gains = [Float](repeating: 1, count: 40)
+        let levels = ForgeMTFBandGains(MTFParameters.bandResponse, pixelsPerMM, Int32(extent.width), Int32(extent.height), &gains)
+        guard levels > 0 else { return self }
+
+        let arguments: [String: Any] = [
+            "levels": levels,
+            "gains": Array(gains.prefix(Int(levels) * 4)),
+            "apron": ForgeBandGainApron(levels)
+        ]
+        do {
+            return try BandGainProcessor.apply(withExtent: extent, inputs: [self], arguments: arguments)
+        } catch {
+            print("MTF band gains failed: \(error)")
+            return self
+        }
+    }
+}
@@ -0,0 +1,81 @@
+//
+//  GuidedFilterProcessor.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Guided-filter mask refinement through the engine (ColorForge/Engine/Filters/GuidedFilter).
+// Inputs are [guide, mask]; each tile asks for both grown by the filter apron, so tiled output
+// matches a full-frame pass.
+final class GuidedFilterProcessor: CIImageProcessorKernel {
+    override class var outputFormat: CIFormat { .RGBAf }
+
+    override class func formatForInput(at input: Int32) -> CIFormat { .RGBAf }
+
+    override class func roi(forInput input: Int32, arguments: [String: Any]?, outputRect: CGRect) -> CGRect {
+        let apron = CGFloat(arguments?["apron"] as? Int32 ?? 0)
+        return outputRect.insetBy(dx: -apron, dy: -apron)
+    }
+
+    override class func process(with inputs: [CIImageProcessorInput]?, arguments: [String: Any]?,
+                                output: CIImageProcessorOutput) throws {
+        guard let inputs, inputs.count == 2,
+              let radius = arguments?["radius"] as? Int32,
+              let epsilon = arguments?["epsilon"] as? Float,
+              let subsample = arguments?["subsample"] as? Int32,
+              let colorGuide = arguments?["colorGuide"] as? Bool else { return }
+
+        let guide = inputs[0], mask = inputs[1]
+        guard guide.region == mask.region else { return }
+
+        // Rows are addressed as -maxY + row, as in BandGainProcessor, so the subsample grid
+        // lands on the same pixels in every tile.
+        let params = ForgeGuidedFilterParams(radius: radius, epsilon: epsilon, subsample: subsample, colorGuide: colorGuide)
+        let src = guide.region, dst = output.region
+        ForgeGuidedFilter(params,
+                          guide.baseAddress.assumingMemoryBound(to: Float.self), 4, guide.bytesPerRow,
+                          mask.baseAddress.assumingMemoryBound(to: Float.self), 4, mask.bytesPerRow,
+                          Int32(src.minX), -Int32(src.maxY), Int32(src.width), Int32(src.height),
+                          output.baseAddress.assumingMemoryBound(to: Float.self), 4, output.bytesPerRow,
+                          Int32(dst.minX), -Int32(dst.maxY), Int32(dst.width), Int32(dst.height))
+    }
+}
+
+extension GuidedFilterProcessor {
+    static func params(radius: Int, epsilon: Float = 1e-3, colorGuide: Bool = false, fast: Bool) -> ForgeGuidedFilterParams {
+        ForgeGuidedFilterParams(radius: Int32(radius), epsilon: epsilon, subsample: fast ? 4 : 1, colorGuide: colorGuide)
+    }
+
+    // How far refinement can move a mask edge, in pixels.
+    static func apron(radius: Int, fast: Bool) -> Int32 {
+        ForgeGuidedFilterApron(params(radius: radius, fast: fast))
+    }
+}
+
+extension CIImage {
+    // Snaps this mask (red channel) to the edges of `guide`. `radius` is in pixels, `epsilon`
+    // in guide units squared; `fast` subsamples the fit by 4 for interactive preview.
+    func refinedMask(guide: CIImage, radius: Int, epsilon: Float = 1e-3, colorGuide: Bool = false, fast: Bool) -> CIImage {
+        let extent = self.extent.intersection(guide.extent)
+        guard !extent.isEmpty, !extent.isInfinite, radius > 0 else { return self }
+
+        let params = GuidedFilterProcessor.params(radius: radius, epsilon: epsilon, colorGuide: colorGuide, fast: fast)
+        let arguments: [String: Any] = [
+            "radius": params.radius,
+            "epsilon": params.epsilon,
+            "subsample": params.subsample,
+            "colorGuide": params.colorGuide,
+            "apron": ForgeGuidedFilterApron(params)
+        ]
+        do {
+            return try GuidedFilterProcessor.apply(withExtent: extent, inputs: [guide, self], arguments: arguments)
+        } catch {
+            print("Guided filter failed: \(error)")
+            return self
+        }
+    }
+}
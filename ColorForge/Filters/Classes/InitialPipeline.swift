@@ -174,8 +174,23 @@ class InitialPipeline {
     // MARK: - Convenience Methods
     
     func processImage(_ item: ImageItem, _ inImage: CIImage) throws -> CIImage {
-        let wbModel = WhiteBalanceModel.shared
+        let params = self.params(for: item)
         
+        // Convert CVPixelBuffer to MTLTexture
+        let inputTexture = try createTexture(from: inImage)
+        
+        // Create output texture
+        let outputTexture = try createOutputTexture(matching: inputTexture)
+        
+        // Process with Metal
+        try processMetal(inputTexture: inputTexture, outputTexture: outputTexture, params: params)
+        
+        // Convert MTLTexture back to CIImage
+        return CIImage(mtlTexture: outputTexture, options: nil)!
+    }
+    
+    // What processImage hands the kernel for `item`
+    func params(for item: ImageItem) -> PipelineParams {
         let initTemp = item.initTemp
         let initTint = item.initTint
         let temp = item.temp
@@ -225,17 +240,7 @@ class InitialPipeline {
             yellowHue: (item.yellowHue / 2.0) * hueScalar, yellowSaturation: (item.yellowHue / 200) + 1, yellowDensity: item.yellowDen / 200
         )
         
-        // Convert CVPixelBuffer to MTLTexture
-        let inputTexture = try createTexture(from: inImage)
-        
-        // Create output texture
-        let outputTexture = try createOutputTexture(matching: inputTexture)
-        
-        // Process with Metal
-        try processMetal(inputTexture: inputTexture, outputTexture: outputTexture, params: params)
-        
-        // Convert MTLTexture back to CIImage
-        return CIImage(mtlTexture: outputTexture, options: nil)!
+        return params
     }
     
     
@@ -0,0 +1,95 @@
+//
+//  MaskCompositeProcessor.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Linear and radial gradient masks blended in one engine pass
+// (ColorForge/Engine/Pipeline/MaskCompositor). Inputs are [base, node output per mask]; each
+// node output is only asked for over its mask's bounds, so Core Image never evaluates a
+// masked node where its mask is zero, and no mask image is built.
+final class MaskCompositeProcessor: CIImageProcessorKernel {
+    override class var outputFormat: CIFormat { .RGBAf }
+
+    override class func formatForInput(at input: Int32) -> CIFormat { .RGBAf }
+
+    override class func roi(forInput input: Int32, arguments: [String: Any]?, outputRect: CGRect) -> CGRect {
+        guard input > 0, let bounds = arguments?["bounds"] as? [CIVector], Int(input) <= bounds.count else { return outputRect }
+        return outputRect.intersection(bounds[Int(input) - 1].cgRectValue)
+    }
+
+    override class func process(with inputs: [CIImageProcessorInput]?, arguments: [String: Any]?,
+                                output: CIImageProcessorOutput) throws {
+        guard let inputs, let base = inputs.first, let data = arguments?["masks"] as? Data else { return }
+        let masks = data.withUnsafeBytes { Array($0.bindMemory(to: ForgeAnalyticMask.self)) }
+        guard masks.count == inputs.count - 1 else { return }
+
+        // Engine rects are y-down: rows are addressed as -maxY, as in the other processors.
+        func rect(_ r: CGRect) -> ForgeRect {
+            ForgeRect(x: Int32(r.minX), y: -Int32(r.maxY), width: Int32(r.width), height: Int32(r.height))
+        }
+        let layers = inputs.dropFirst()
+        let pointers: [UnsafePointer<Float>?] = layers.map {
+            $0.region.isEmpty ? nil : UnsafePointer($0.baseAddress.assumingMemoryBound(to: Float.self))
+        }
+        let rects = layers.map { $0.region.isEmpty ? ForgeRect(x: 0, y: 0, width: 0, height: 0) : rect($0.region) }
+        let rowBytes = layers.map { $0.bytesPerRow }
+
+        ForgeCompositeMasks(base.baseAddress.assumingMemoryBound(to: Float.self), rect(base.region), base.bytesPerRow,
+                            masks, pointers, rects, rowBytes, Int32(masks.count),
+                            output.baseAddress.assumingMemoryBound(to: Float.self), rect(output.region), output.bytesPerRow, 4)
+    }
+}
+
+// Masks in engine coordinates (y negated) from the normalised parameters the mask settings
+// store, placed as applyLinearGradientAndBlend and applyRadialMask place them.
+extension ForgeAnalyticMask {
+    static func linear(_ startNorm: CGPoint, _ endNorm: CGPoint, extent: CGRect) -> ForgeAnalyticMask {
+        let shape = ForgeLinearMaskShape(x0: Float(startNorm.x * extent.width), y0: -Float(startNorm.y * extent.height),
+                                         x1: Float(endNorm.x * extent.width), y1: -Float(endNorm.y * extent.height))
+        return ForgeAnalyticMask(radial: false, linear: shape, ellipse: ForgeRadialMaskShape())
+    }
+
+    // Feather and opacity 0–100. Radial masks have no rotation in the settings yet; one given
+    // here would be negated along with y.
+    static func radial(_ startNorm: CGPoint, _ widthNorm: CGFloat, _ heightNorm: CGFloat, feather: Float,
+                       invert: Bool, opacity: Float, extent: CGRect) -> ForgeAnalyticMask {
+        let shape = ForgeRadialMaskShape(cx: Float(startNorm.x * extent.width), cy: -Float(startNorm.y * extent.height),
+                                         rx: Float(widthNorm * extent.width / 2), ry: Float(heightNorm * extent.height / 2),
+                                         rotation: 0, feather: feather / 100, opacity: opacity / 100, invert: invert)
+        return ForgeAnalyticMask(radial: true, linear: ForgeLinearMaskShape(), ellipse: shape)
+    }
+
+    // Where the mask can be non-zero, in Core Image coordinates.
+    func bounds(in extent: CGRect) -> CGRect {
+        let e = extent.integral
+        let frame = ForgeRect(x: Int32(e.minX), y: -Int32(e.maxY), width: Int32(e.width), height: Int32(e.height))
+        let r = ForgeAnalyticMaskBounds(self, frame)
+        guard r.width > 0, r.height > 0 else { return .null }
+        return CGRect(x: CGFloat(r.x), y: -CGFloat(r.y + r.height), width: CGFloat(r.width), height: CGFloat(r.height))
+    }
+}
+
+extension CIImage {
+    // Blends each layer's image under its mask over this image, in order, in one pass.
+    func compositingMasks(_ layers: [(mask: ForgeAnalyticMask, image: CIImage)]) -> CIImage {
+        let live = layers.filter { !$0.mask.bounds(in: extent).isNull }
+        guard !live.isEmpty else { return self }
+
+        let masks = live.map(\.mask)
+        let arguments: [String: Any] = [
+            "masks": masks.withUnsafeBytes { Data($0) },
+            "bounds": live.map { CIVector(cgRect: $0.mask.bounds(in: extent)) }
+        ]
+        do {
+            return try MaskCompositeProcessor.apply(withExtent: extent, inputs: [self] + live.map(\.image), arguments: arguments)
+        } catch {
+            print("Mask composite failed: \(error)")
+            return self
+        }
+    }
+}
@@ -68,6 +68,18 @@ extension CGPoint {
     }
 }
 
+extension CIImage {
+    // The rect a zoomed render shows. Its input extends past it by the viewport apron
+    // (FilterPipeline.viewportSource), so nodes that scale with the frame measure this instead
+    // of the extent. Otherwise the extent.
+    var viewportFrame: CGRect {
+        let viewModel = ImageViewModel.shared
+        let rect = viewModel.zoomRect
+        guard viewModel.isZoomed, rect.width > 0, rect.height > 0 else { return extent }
+        return CGRect(origin: .zero, size: rect.size)
+    }
+}
+
 extension FilterPipeline {
     
     
@@ -88,6 +100,16 @@ extension FilterPipeline {
         let ai = item.maskSettings.aiMasks.map { AnyGradientMask.ai($0) }
         let relevantMasks = linear + radial + ai
         
+        // Consecutive linear and radial masks are blended together in one pass; anything that
+        // reads the running result first flushes them. All of them are placed in the frame of the
+        // image they are composited onto.
+        let maskFrame = result.viewportFrame
+        var pending: [(mask: ForgeAnalyticMask, image: CIImage)] = []
+        func flushAnalyticMasks() {
+            result = result.compositingMasks(pending)
+            pending.removeAll()
+        }
+        
         for mask in relevantMasks {
             let maskId: UUID
             let start: CGPoint
@@ -149,46 +171,44 @@ extension FilterPipeline {
             switch mask {
             case .linear:
                 if start == end {
-                    
+                    flushAnalyticMasks()
                     result = maskNode.apply(to: result)
                 } else {
-                
-                    let maskedOutput = maskNode.apply(to: baseImage)
-                    result = maskedOutput.applyLinearGradientAndBlend(start, end, result)
+                    let layer = ForgeAnalyticMask.linear(start, end, extent: maskFrame)
+                    pending.append((layer, maskNode.apply(to: baseImage)))
                 }
                 
             case .radial:
                 
                 if start == end {
+                    flushAnalyticMasks()
                     result = maskNode.apply(to: result)
                 } else {
-
-                    let maskedOutput = maskNode.apply(to: baseImage)
-                    result = maskedOutput.applyRadialMask(
-                        result,
-                        start,
-                        width,
-                        height,
-                        feather,
-                        invert,
-                        opacity
-                    )
+                    let layer = ForgeAnalyticMask.radial(start, width, height, feather: feather, invert: invert,
+                                                         opacity: opacity, extent: maskFrame)
+                    pending.append((layer, maskNode.apply(to: baseImage)))
                 }
                 
             case .ai:
- 
+                flushAnalyticMasks()
 
                 let maskedOutput = maskNode.apply(to: baseImage)
 //                    debugSave(maskImage, "PiplineMaskImage")
 //                result = result.applyAiMask(maskImage, maskedOutput, feather, invert)
-                result = result.blendWithMask(maskImage, maskedOutput)
+                // Snap the segmentation edge to the image; subsampled while editing.
+                let radius = max(4, Int(min(maskImage.extent.width, maskImage.extent.height) / 256))
+                let fast = !item.isExport
+                let refined = maskImage.refinedMask(guide: baseImage, radius: radius, fast: fast)
+                let blended = result.blendWithMask(refined, maskedOutput)
+                if let coverage = MaskCoverage.raster(maskImage, spread: GuidedFilterProcessor.apron(radius: radius, fast: fast)) {
+                    result = result.compositing(blended: blended, masked: maskedOutput, within: coverage)
+                } else {
+                    result = blended
+                }
                 
             }
         }
-        
-        let cachedResult = result.insertingIntermediate(cache: true)
-        
-        result = cachedResult
+        flushAnalyticMasks()
         
         return result
     }
@@ -278,7 +298,7 @@ extension FilterPipeline {
                     result = node.apply(to: result)
                 } else {
                     let masked = node.apply(to: baseImage)
-                    result = masked.applyLinearGradientAndBlend(start, end, result).insertingIntermediate(cache: true)
+                    result = masked.applyLinearGradientAndBlend(start, end, result)
                 }
                 
             case .radial:
@@ -295,7 +315,7 @@ extension FilterPipeline {
                         feather,
                         invert,
                         opacity
-                    ).insertingIntermediate(cache: true)
+                    )
                 }
                 
             case .ai:
@@ -496,10 +516,85 @@ class FilterPipeline: ObservableObject {
     }
     
     // MARK: - Cache
-    private var cachedEnlargerExp: Float = 0.0
-    private var cachedCyan: Float = 0.0
-    private var cachedMagenta: Float = 0.0
-    private var cachedYellow: Float = 0.0
+    
+    // One node of applyPipelineV2Sync's chain: what its output depends on besides its input, and
+    // whether that output is worth keeping in RenderCache.
+    private struct RenderStage {
+        let params: String
+        let checkpoint: Bool
+        let apply: (CIImage) throws -> CIImage
+        // The stage as a per-pixel colour transform, for baking into a LUT (applyThumbnailGrade);
+        // nil when it reads neighbouring pixels or other images
+        private(set) var pointwise: ((CIImage) throws -> CIImage)?
+        
+        init(_ params: String, checkpoint: Bool = false, pointwise: Bool = false, _ apply: @escaping (CIImage) throws -> CIImage) {
+            self.params = params
+            self.checkpoint = checkpoint
+            self.apply = apply
+            self.pointwise = pointwise ? apply : nil
+        }
+        
+        init(_ node: FilterNode, checkpoint: Bool = false, pointwise: Bool = false) {
+            self.init(String(describing: node), checkpoint: checkpoint, pointwise: pointwise) { node.apply(to: $0) }
+        }
+        
+        // The same stage, baked as `colour` instead
+        func withPointwise(_ colour: @escaping (CIImage) throws -> CIImage) -> RenderStage {
+            var stage = self
+            stage.pointwise = colour
+            return stage
+        }
+    }
+    
+    // Runs `stages` over `input`. With a key (that of `input`), each stage's output is keyed on its
+    // params chained with those before it; the run resumes from the deepest checkpoint RenderCache
+    // holds and stores the ones it passes. A stage that throws is skipped and ends the storing.
+    private func evaluate(_ stages: [RenderStage], _ input: CIImage, _ key: RenderCache.Key?) -> CIImage {
+        var chains: [Int] = []
+        var chain = key?.chain ?? 0
+        for stage in stages {
+            var hasher = Hasher()
+            hasher.combine(chain)
+            hasher.combine(stage.params)
+            chain = hasher.finalize()
+            chains.append(chain)
+        }
+        
+        var result = input
+        var start = 0
+        if let key {
+            for index in stages.indices.reversed() where stages[index].checkpoint {
+                if let cached = RenderCache.shared.get(key.chained(chains[index])) {
+                    result = cached
+                    start = index + 1
+                    break
+                }
+            }
+        }
+        
+        var memoise = key != nil
+        for index in start..<stages.count {
+            do {
+                result = try stages[index].apply(result)
+            } catch {
+                print("Error processing image: \(error)")
+                memoise = false
+                continue
+            }
+            if memoise, stages[index].checkpoint, let key {
+                result = RenderCache.shared.store(result, for: key.chained(chains[index]))
+            }
+        }
+        return result
+    }
+    
+    // The item's masks and their settings, for the params of the stages that composite them
+    private func maskParams(_ item: ImageItem) -> String {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = .sortedKeys
+        guard let data = try? encoder.encode(item.maskSettings) else { return "" }
+        return String(decoding: data, as: UTF8.self)
+    }
     
     @Published var flashColor: CIColor = .white
     
@@ -680,6 +775,7 @@ class FilterPipeline: ObservableObject {
         
         var result: CIImage
         var hald: CIImage
+        var viewportVisible: CGRect? = nil
         
 
         
@@ -708,6 +804,9 @@ class FilterPipeline: ObservableObject {
 					print("Failed to unwrap image")
 					return nil }
 				result = base
+				if viewModel.isZoomed {
+					viewportVisible = base.viewportFrame
+				}
                 
 			} else {
 				guard let input = inputImage else { return nil}
@@ -723,15 +822,139 @@ class FilterPipeline: ObservableObject {
             hald = result
         }
         
-        let ip = InitialPipeline.shared
-        let tempResult = result
+        var halated = CIImage.empty()
+        let flashNode = makeFlashNode(item)
+        let stages = renderStages(item, flashNode) { halated = $0 }
+        
+        
+        // Edits resume from the deepest stage they leave unchanged. Exports, LUT saves and log
+        // renders run the whole chain.
+        var cacheKey: RenderCache.Key? = nil
+        if inputImage == nil, !logMode, !item.isExport, isSavingLut != true {
+            let zoomed = viewModel.isZoomed
+            let origin = zoomed ? viewModel.zoomRect.origin : .zero
+            var seed = Hasher()
+            seed.combine(tiffScanMode)
+            seed.combine(LutModel.shared.cubeDataCache.count)
+            cacheKey = RenderCache.Key(source: item.id, chain: seed.finalize(),
+                                       roi: result.extent.offsetBy(dx: origin.x, dy: origin.y),
+                                       scale: zoomed ? viewModel.zoomScale : 1)
+        }
+        
+        result = evaluate(stages, result, cacheKey)
+        
+        var flashPreview = halated
+        if item.previewFlash {
+            flashPreview = flashNode.apply(to: halated)
+        }
 
-        do {
-            result = try ip.processImage(item, result)
-        } catch {
-            print("Error processing image: \(error)")
-            result = tempResult
+  
+		
+        
+//        if item.applyTHOG {
+//            
+//            result = thogResult
+//            
+//        }
+
+        
+        // A zoomed render's source carried its viewport apron this far
+        if let visible = viewportVisible {
+            result = result.cropped(to: visible)
+            flashPreview = flashPreview.cropped(to: visible)
         }
+        
+        let finalFlash = flashPreview
+        
+        let finalImage = result
+        
+        if !item.isExport {
+            
+            if item.previewFlash {
+                
+                
+                DispatchQueue.main.async {
+                    ImageViewModel.shared.imageToRender = finalFlash
+                    
+                    if let renderer = RenderingManager.shared.renderer {
+                        renderer.updateImage(finalFlash)
+                    } else {
+                        print("No renderer to send result to")
+                    }
+                }
+                
+            } else {
+    
+                
+                DispatchQueue.main.async {
+                    self.processedImage = finalImage
+                    self.currentResult = finalImage
+                    
+                    if let initBool = isFirstLoad {
+                        if !initBool {
+                            
+                            
+                            ImageViewModel.shared.renderSumbitted.toggle()
+                            ImageViewModel.shared.imageToRender = finalImage
+                            
+                            if viewModel.imageViewActive {
+                                
+                                if let renderer = RenderingManager.shared.renderer {
+                                    renderer.updateImage(finalImage)
+                                } else {
+                                    print("No renderer to send result to")
+                                }
+                                
+                                // Update item
+                                dataModel.updateItem(id: id) { item in
+                                    item.processImage = finalImage
+                                }
+        
+                            } else {
+                                
+                                
+                                    self.processThumb(finalImage, id, dataModel, RenderingManager.shared.mainImageContext)
+
+                               
+
+                            }
+							
+							HistogramModel.shared.generateDataDebounced(finalImage)
+							
+                        } else {
+                            self.processThumb(finalImage, id, dataModel, RenderingManager.shared.mainImageContext)
+                            
+                            dataModel.updateItem(id: id) { item in
+                                item.processImage = finalImage
+                            }
+                            
+                        }
+                    }
+                    
+ 
+                    
+                    
+                }
+            }
+        } else {
+            return finalImage
+        }
+        
+        return finalImage
+    }
+
+
+    // applyPipelineV2Sync's chain for `item`. `onHalated` gets the image the flash is exposed
+    // from, for the flash preview.
+    private func renderStages(_ item: ImageItem, _ flashNode: FlashNode, onHalated: @escaping (CIImage) -> Void) -> [RenderStage] {
+        let ip = InitialPipeline.shared
+        let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
+        let masks = maskParams(item)
+        var stages: [RenderStage] = []
+
+        stages.append(RenderStage(String(describing: ip.params(for: item)), checkpoint: true, pointwise: true) { input in
+            try ip.processImage(item, input)
+        })
 
 
 	
@@ -955,13 +1178,8 @@ class FilterPipeline: ObservableObject {
             */
             
             
-            // Convert to neg gamma 2.2
-            result = result.cineonToNeg()
-            result = result.encodeGamma22()
-            
-            // MTFCurveNode
-            let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
-            result = MTFCurveNode(
+            // MTFCurveNode, on the negative at gamma 2.2
+            let mtfNode = MTFCurveNode(
                 applyMTF: item.applyMTF,
                 mtfAmount: item.mtfBlend,
                 format: item.selectedGateWidth,
@@ -970,88 +1188,81 @@ class FilterPipeline: ObservableObject {
                 nativeLongEdge: nativeLongEdge,
                 isExport: item.isExport,
                 uiScale: item.uiScale
-            ).apply(to: result)
-            
-            // Convert back
-            result = result.decodeGamma22()
-            result = result.negToCineon()
-            
+            )
+            stages.append(RenderStage(String(describing: mtfNode), checkpoint: item.applyMTF) { input in
+                mtfNode.apply(to: input.cineonToNeg().encodeGamma22()).decodeGamma22().negToCineon()
+            })
             
-            result = NoiseGrainNode(
+            // The grain plate loads after the first render
+            let grainNode = NoiseGrainNode(
                 isExport: item.isExport, applyGrain: item.applyGrain
-            ).apply(to: result)
+            )
+            stages.append(RenderStage("\(grainNode) plate: \(GrainModel.shared.initialGrainPlate2048 != nil)") { input in
+                grainNode.apply(to: input)
+            })
             
 
             // FilmStockNode
-            result = FilmStockNode(
+            stages.append(RenderStage(FilmStockNode(
                 stockChoice: item.stockChoice,
                 convertToNeg: item.convertToNeg
-            ).apply(to: result)
+            ), pointwise: true))
             
         
         
         // DecodeNegativeNode
-        result = DecodeNegativeNode(
+        stages.append(RenderStage(DecodeNegativeNode(
             convertToNeg: item.convertToNeg,
             applyScanMode: item.applyScanMode,
             stockChoice: item.stockChoice
-        ).apply(to: result)
+        ), pointwise: true))
         
         } // end of tiff scan mode
         
         
         if tiffScanMode {
-            result = result.decodeGamma22()
+            stages.append(RenderStage("decodeGamma22", pointwise: true) { $0.decodeGamma22() })
         }
         
-//        if item.applyTHOG {
-//            result = thogResult
-//        }
-        result = PaperNode(
+        stages.append(RenderStage(PaperNode(
             convertToNeg: item.convertToNeg,
             showPaperMask: item.showPaperMask,
             imageScale: item.borderImgScale,
             maskScale: item.borderScale,
             maskXshift: item.borderXshift,
             maskYshift: item.borderYshift
-        ).apply(to: result)
-        
-//        if item.applyTHOG {
-//            thogResult = result
-//        }
+        )))
         
 
             
             // OffsetNode (can be made maskable later if needed)
-            let offsetNode = OffsetNode(
+            stages.append(RenderStage(OffsetNode(
                 neg: item.convertToNeg,
                 applyScanMode: item.applyScanMode,
                 offsetRGB: item.offsetRGB,
                 offsetRed: item.offsetRed,
                 offsetGreen: item.offsetGreen,
                 offsetBlue: item.offsetBlue
-            )
-            result = offsetNode.apply(to: result)
+            ), pointwise: true))
             
             // Kodak2383Node   ScanLutNode
         
-        result = ScanLutNode(
+        stages.append(RenderStage(ScanLutNode(
             neg: item.convertToNeg,
             blend: item.lutBlend,
             applyScanMode: item.applyScanMode,
             applyPFE: item.applyPFE,
             apply2383: item.apply2383,
             apply3513: item.apply3513
-        ).apply(to: result)
+        ), pointwise: true))
 
             
             // ScanContrastNode
-            let scanContrastNode = ScanContrastNode(
+            stages.append(RenderStage(ScanContrastNode(
                 neg: item.convertToNeg,
                 applyScanMode: item.applyScanMode,
                 scanContrast: item.scanContrast
-            )
-            result = scanContrastNode.apply(to: result)
+            ), pointwise: true))
             
             
         
@@ -1079,217 +1290,156 @@ class FilterPipeline: ObservableObject {
             useLegacy: false
         )
         
-        result = enlargerNode.apply(to: result)
+        stages.append(RenderStage(String(describing: enlargerNode), pointwise: true) { enlargerNode.apply(to: $0) })
         
         if tiffScanMode {
-            result = result.encodeGamma22()
+            stages.append(RenderStage("encodeGamma22", pointwise: true) { $0.encodeGamma22() })
         }
         
         // EnlargerV2Node (maskable)
-        result = applyEnlargerV2MaskNodeWithMasks(
-            baseImage: result,
-            item: item
-        )
+        stages.append(RenderStage("EnlargerV2MaskNode \(masks)") { input in
+            self.applyEnlargerV2MaskNodeWithMasks(
+                baseImage: input,
+                item: item
+            )
+        })
         
         
-        let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
         // PrintHalationNode (maskable)
-        result = applyNodeWithMasks(
-            baseImage: result,
-            item: item,
-            nodeType: "PrintHalationNode",
-            globalNode: PrintHalationV2Node(
-                nativeWidth: nativeLongEdge,
-                printHalation_size: item.printHalation_size,
-                printHalation_amount: item.printHalation_amount,
-                printHalation_darkenMode: item.printHalation_darkenMode,
-                printHalation_apply: item.printHalation_apply,
-                isExport: item.isExport
-            ),
-            maskBuilder: { mask in
-                PrintHalationV2Node(
-                    nativeWidth: nativeLongEdge,
-                    printHalation_size: mask.printHalation_size,
-                    printHalation_amount: mask.printHalation_amount,
-                    printHalation_darkenMode: mask.printHalation_darkenMode,
-                    printHalation_apply: item.printHalation_apply,
-                    isExport: item.isExport
-                )
-            }
+        let halationNode = PrintHalationV2Node(
+            nativeWidth: nativeLongEdge,
+            printHalation_size: item.printHalation_size,
+            printHalation_amount: item.printHalation_amount,
+            printHalation_darkenMode: item.printHalation_darkenMode,
+            printHalation_apply: item.printHalation_apply,
+            isExport: item.isExport
         )
+        stages.append(RenderStage("\(halationNode) \(masks)", checkpoint: true) { input in
+            self.applyNodeWithMasks(
+                baseImage: input,
+                item: item,
+                nodeType: "PrintHalationNode",
+                globalNode: halationNode,
+                maskBuilder: { mask in
+                    PrintHalationV2Node(
+                        nativeWidth: nativeLongEdge,
+                        printHalation_size: mask.printHalation_size,
+                        printHalation_amount: mask.printHalation_amount,
+                        printHalation_darkenMode: mask.printHalation_darkenMode,
+                        printHalation_apply: item.printHalation_apply,
+                        isExport: item.isExport
+                    )
+                }
+            )
+        })
         
 
         
         
-        var flash = result
-        var flashPreview = result
-        
-        if item.previewFlash {
-            flashPreview = FlashNode(
-                applyPrintMode: item.applyPrintMode,
-                previewFlash: item.previewFlash,
-                applyFlash: item.applyFlash,
-                flashEV: item.flashEV,
-                flashFStop: item.flashFStop,
-                flashCyan: item.flashCyan,
-                flashMagenta: item.flashMagenta,
-                flashYellow: item.flashYellow,
-                hand: handImage).apply(to: result)
-            
-        } else {
-            flash = FlashNode(
+        // PrintGamutNode, exposed with the flash
+        let gamutParams = "PrintGamutNode(\(tiffScanMode), \(item.convertToNeg), \(item.applyPrintMode), \(item.bwMode), \(item.useLegacy), \(item.applyFlash))"
+        let gamutStage = RenderStage("\(flashNode) \(gamutParams)") { input in
+            onHalated(input)
+            let printGamutNode = PrintGamutNode(
+                tiffScanMode: self.tiffScanMode,
+                convertToNeg: item.convertToNeg,
                 applyPrintMode: item.applyPrintMode,
-                previewFlash: item.previewFlash,
+                bwMode: item.bwMode,
+                useLegacy: item.useLegacy,
                 applyFlash: item.applyFlash,
-                flashEV: item.flashEV,
-                flashFStop: item.flashFStop,
-                flashCyan: item.flashCyan,
-                flashMagenta: item.flashMagenta,
-                flashYellow: item.flashYellow,
-                hand: handImage).apply(to: result)
+                flash: item.previewFlash ? input : flashNode.apply(to: input)
+            )
+            return printGamutNode.apply(to: input)
         }
+        // Baked without the flash, which reads the hand image
+        stages.append(gamutStage.withPointwise { input in
+            PrintGamutNode(
+                tiffScanMode: self.tiffScanMode,
+                convertToNeg: item.convertToNeg,
+                applyPrintMode: item.applyPrintMode,
+                bwMode: item.bwMode,
+                useLegacy: item.useLegacy,
+                applyFlash: false,
+                flash: input
+            ).apply(to: input)
+        })
         
-        
-        // PrintGamutNode
-        let printGamutNode = PrintGamutNode(
-            tiffScanMode: tiffScanMode,
-            convertToNeg: item.convertToNeg,
+        // BlackAndWhiteEnlargerNode (maskable)
+        let bwNode = BlackAndWhiteEnlargerNode(
             applyPrintMode: item.applyPrintMode,
+            convertToNeg: item.convertToNeg,
+            evSeconds: item.enlargerExp,
+            fstop: item.enlargerFStop,
+            magenta: item.magenta,
             bwMode: item.bwMode,
-            useLegacy: item.useLegacy,
-            applyFlash: item.applyFlash,
-            flash: flash
-        )
-        
-        result = printGamutNode.apply(to: result)
-        
-        // BlackAndWhiteEnlargerNode (maskable)
-        result = applyNodeWithMasks(
-            baseImage: result,
-            item: item,
-            nodeType: "BlackAndWhiteEnlargerNode",
-            globalNode: BlackAndWhiteEnlargerNode(
-                applyPrintMode: item.applyPrintMode,
-                convertToNeg: item.convertToNeg,
-                evSeconds: item.enlargerExp,
-                fstop: item.enlargerFStop,
-                magenta: item.magenta,
-                bwMode: item.bwMode,
-                useLegacy: item.useLegacy
-            ),
-            maskBuilder: { mask in
-                BlackAndWhiteEnlargerNode(
-                    applyPrintMode: item.applyPrintMode,
-                    convertToNeg: item.convertToNeg,
-                    evSeconds: mask.enlargerExp,
-                    fstop: mask.enlargerFStop,
-                    magenta: mask.magenta,
-                    bwMode: item.bwMode,
-                    useLegacy: item.useLegacy
-                )
-            }
+            useLegacy: item.useLegacy
         )
+        // Baked without its masks
+        let bwStage = RenderStage("\(bwNode) \(masks)") { input in
+            self.applyNodeWithMasks(
+                baseImage: input,
+                item: item,
+                nodeType: "BlackAndWhiteEnlargerNode",
+                globalNode: bwNode,
+                maskBuilder: { mask in
+                    BlackAndWhiteEnlargerNode(
+                        applyPrintMode: item.applyPrintMode,
+                        convertToNeg: item.convertToNeg,
+                        evSeconds: mask.enlargerExp,
+                        fstop: mask.enlargerFStop,
+                        magenta: mask.magenta,
+                        bwMode: item.bwMode,
+                        useLegacy: item.useLegacy
+                    )
+                }
+            )
+        }
+        stages.append(bwStage.withPointwise { bwNode.apply(to: $0) })
         
         
         if !tiffScanMode {
             // ApplyAdobeCameraRawCurveNode
-            result = ApplyAdobeCameraRawCurveNode(
+            stages.append(RenderStage(ApplyAdobeCameraRawCurveNode(
                 convertToNeg: item.convertToNeg
-            ).apply(to: result)
+            ), pointwise: true))
             
-            result = AddPaperBlackNode(apply: item.applyPrintMode).apply(to: result)
+            stages.append(RenderStage(AddPaperBlackNode(apply: item.applyPrintMode), pointwise: true))
         }
-
-  
-		
-        
-//        if item.applyTHOG {
-//            
-//            result = thogResult
-//            
-//        }
-
         
-        let finalFlash = flashPreview
-        
-        let finalImage = result
-        
-        if !item.isExport {
-            
-            if item.previewFlash {
-                
-                
-                DispatchQueue.main.async {
-                    ImageViewModel.shared.imageToRender = finalFlash
-                    
-                    if let renderer = RenderingManager.shared.renderer {
-                        renderer.updateImage(finalFlash)
-                    } else {
-                        print("No renderer to send result to")
-                    }
-                }
-                
-            } else {
+        return stages
+    }
     
-                
-                DispatchQueue.main.async {
-                    self.processedImage = finalImage
-                    self.currentResult = finalImage
-                    
-                    if let initBool = isFirstLoad {
-                        if !initBool {
-                            
-                            
-                            ImageViewModel.shared.renderSumbitted.toggle()
-                            ImageViewModel.shared.imageToRender = finalImage
-                            
-                            if viewModel.imageViewActive {
-                                
-                                if let renderer = RenderingManager.shared.renderer {
-                                    renderer.updateImage(finalImage)
-                                } else {
-                                    print("No renderer to send result to")
-                                }
-                                
-                                // Update item
-                                dataModel.updateItem(id: id) { item in
-                                    item.processImage = finalImage
-                                }
-        
-                            } else {
-                                
-                                
-                                    self.processThumb(finalImage, id, dataModel, RenderingManager.shared.mainImageContext)
+    // The print is exposed with the flash, the preview shows the flash on its own
+    private func makeFlashNode(_ item: ImageItem) -> FlashNode {
+        FlashNode(
+            applyPrintMode: item.applyPrintMode,
+            previewFlash: item.previewFlash,
+            applyFlash: item.applyFlash,
+            flashEV: item.flashEV,
+            flashFStop: item.flashFStop,
+            flashCyan: item.flashCyan,
+            flashMagenta: item.flashMagenta,
+            flashYellow: item.flashYellow,
+            hand: handImage)
+    }
 
-                               
 
-                            }
-							
-							HistogramModel.shared.generateDataDebounced(finalImage)
-							
-                        } else {
-                            self.processThumb(finalImage, id, dataModel, RenderingManager.shared.mainImageContext)
-                            
-                            dataModel.updateItem(id: id) { item in
-                                item.processImage = finalImage
-                            }
-                            
-                        }
-                    }
-                    
- 
-                    
-                    
-                }
+    // The pointwise stages of applyPipelineV2Sync's chain for `item` run over `input`, for baking
+    // into the import thumbnails' LUT (ThumbnailEngine). `input` is LogC, as demosaic_linear
+    // leaves it. MTF, grain, the paper border, halation, flash and masks are left out.
+    func applyThumbnailGrade(_ item: ImageItem, _ input: CIImage) -> CIImage {
+        var result = input
+        for case let apply? in renderStages(item, makeFlashNode(item), onHalated: { _ in }).map(\.pointwise) {
+            do {
+                result = try apply(result)
+            } catch {
+                print("Error processing thumbnail grade: \(error)")
             }
-        } else {
-            return finalImage
         }
-        
-        return finalImage
+        return result
     }
-    
-    
+
+
     private var lastThumbnailRenderTime: Date = .distantPast
     private let thumbnailThrottleInterval: TimeInterval = 0.1
     
@@ -1333,20 +1483,16 @@ class FilterPipeline: ObservableObject {
         let rect = viewModel.zoomRect
         
         if isZoomed, rect.width > 0, rect.height > 0 {
-            guard let smlBuffer = PixelBufferCache.shared.get(item.id) else { return nil }
-
-            var highRes = CIImage(cvPixelBuffer: smlBuffer)
-            let scaleUp = viewModel.zoomScale
-            highRes = highRes.transformed(by: CGAffineTransform(scaleX: scaleUp, y: scaleUp))
-
-            if let buffer = PixelBufferHRCache.shared.get(item.id) {
-                // Use HR buffer if available
-                highRes = CIImage(cvPixelBuffer: buffer)
-            }
-            // If no HR buffer, highRes is already the scaled-up small buffer
+            // The item's pyramid is over the HR buffer once getHR has made it, the display
+            // buffer until then
+            let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
+            guard let frame = TilePyramidCache.shared.frame(item.id, nativeLongEdge: nativeLongEdge) else { return nil }
 
-            let clamped = clampedRect(rect, in: highRes.extent)
-            let zoomed = highRes.cropped(to: clamped)
+            let clamped = clampedRect(rect, in: frame)
+            // Fetched with the apron MTF and halation read past the screen's edge; the result is
+            // cropped back to the visible rect at the end of applyPipelineV2Sync.
+            guard let zoomed = TilePyramidCache.shared.image(item.id, region: viewportSource(clamped, in: frame, item),
+                                                             nativeLongEdge: nativeLongEdge, scale: 1) else { return nil }
             let translated = zoomed.transformed(by: .init(
                 translationX: -rect.origin.x,
                 y: -rect.origin.y
@@ -1379,28 +1525,11 @@ class FilterPipeline: ObservableObject {
             }
             
         } else if ImageViewModel.shared.imageViewActive == false {
-
-            if item.thumbBuffer == nil {
-                if let medBuffer = item.debayeredBuffer {
-                    let ciImage = CIImage(cvPixelBuffer: medBuffer)
-                    let scale = 500.0 / max(ciImage.extent.width, ciImage.extent.height)
-                    let scaled = ciImage.transformed(by: CGAffineTransform(scaleX: scale, y: scale))
-                    guard let smlBuffer = scaled.convertDebayeredToBufferSync() else {return nil}
-                    
-                    DispatchQueue.main.async {
-                        dataModel.updateItem(id: item.id) {item in
-                            item.thumbBuffer = smlBuffer
-                        }
-                    }
-                    return CIImage(cvPixelBuffer: smlBuffer)
-                }
-                
-                
-            } else {
-                if let buffer = item.thumbBuffer {
-                    return CIImage(cvPixelBuffer: buffer)
-                }
-
+            // The thumbnail strip, 500 px on the long edge, from the pyramid's nearest level
+            let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
+            if let frame = TilePyramidCache.shared.frame(item.id, nativeLongEdge: nativeLongEdge) {
+                return TilePyramidCache.shared.image(item.id, region: frame, nativeLongEdge: nativeLongEdge,
+                                                     scale: 500.0 / CGFloat(nativeLongEdge))
             }
         } else {
 			if let debayeredBuffer = PixelBufferCache.shared.get(item.id) {
@@ -1433,6 +1562,37 @@ class FilterPipeline: ObservableObject {
         return nil
     }
     
+    // MARK: - Viewport
+    
+    // `visible` grown by what the item's neighbourhood nodes read past it (the MTF pyramid and the
+    // halation blur), walked back through the chain by ForgeViewportSourceRegion and clamped to
+    // `frame`. Without it a zoomed render clamps at the screen's edge where the full render
+    // doesn't.
+    private func viewportSource(_ visible: CGRect, in frame: CGRect, _ item: ImageItem) -> CGRect {
+        let visible = visible.integral
+        let viewport = CGRect(origin: .zero, size: visible.size)
+        let nativeLongEdge = max(item.nativeWidth, item.nativeHeight)
+        
+        var radii: [Int32] = []
+        if item.applyMTF, !tiffScanMode {
+            radii.append(MTFCurveNode.apron(item.selectedGateWidth, viewport, item.uiScale))
+        }
+        if item.printHalation_apply, nativeLongEdge > 0 {
+            radii.append(PrintHalationV2Node.apron(item.printHalation_size, nativeLongEdge, viewport))
+        }
+        guard radii.contains(where: { $0 > 0 }) else { return visible }
+        
+        // The engine's rects run top down
+        let region = radii.withUnsafeBufferPointer {
+            ForgeViewportSourceRegion(Int32(frame.width), Int32(frame.height),
+                                      ForgeRect(x: Int32(visible.minX - frame.minX), y: Int32(frame.maxY - visible.maxY),
+                                                width: Int32(visible.width), height: Int32(visible.height)),
+                                      1, $0.baseAddress, Int32($0.count))
+        }
+        return CGRect(x: frame.minX + CGFloat(region.x), y: frame.maxY - CGFloat(region.y + region.height),
+                      width: CGFloat(region.width), height: CGFloat(region.height))
+    }
+    
     private func clampedRect(_ rect: CGRect, in bounds: CGRect) -> CGRect {
         var newRect = rect
         
@@ -1458,20 +1618,3 @@ class FilterPipeline: ObservableObject {
     
     
 }
-
-
-extension FilterPipeline {
-    /// Applies the pipeline to all selected IDs in ThumbnailViewModel.
-    func applyPipelineForSelectedItems(_ dataModel: DataModel) async {
-        let selectedIDs = ThumbnailViewModel.shared.selectedIDs
-        
-        guard !selectedIDs.isEmpty else {
-            print("No selected items to process")
-            return
-        }
-        
-        for id in selectedIDs {
-             applyPipelineV2Sync(id, dataModel)
-        }
-    }
-}
@@ -102,6 +102,14 @@ struct MTFParameters {
 	static let bGain_50LPM: Float = 0.55
 	static let bGain_100LPM: Float = 0.30
 	
+	// The gains above as the engine's band response: [r, g, b] at 100, 50, 20 and 10 LP/mm.
+	static let bandResponse: [Float] = [
+		rGain_100LPM, gGain_100LPM, bGain_100LPM,
+		rGain_50LPM, gGain_50LPM, bGain_50LPM,
+		rGain_20LPM, gGain_20LPM, bGain_20LPM,
+		rGain_10LPM, gGain_10LPM, bGain_10LPM,
+	]
+	
 	// Sensor widths (in mm)
     static let largeFormat54Width: CGFloat = 127.0 // 5x4 - 9
 	static let mediumFormatWidth: CGFloat = 60.0 // 0
@@ -126,212 +134,51 @@ struct MTFCurveNode: FilterNode {
 	let isExport: Bool
 	let uiScale: Float
 	
-	func apply(to input: CIImage) -> CIImage {
-		if applyMTF {
-			
-			var zoomScalar = ImageViewModel.shared.zoomScale
-			
-			
-			let gateWidth: CGFloat
-			switch format {
-			case 0: gateWidth = MTFParameters.mediumFormatWidth              // 60.0 mm
-			case 1: gateWidth = MTFParameters.cropMediumSensorWidth          // 43.8 mm
-			case 2: gateWidth = MTFParameters.thirtyFiveWidth                // 36.0 mm
-			case 3: gateWidth = MTFParameters.halfFrameWidth                 // 18.0 mm
-			case 4: gateWidth = MTFParameters.motionStandard35mm             // 21.95 mm
-			case 5: gateWidth = MTFParameters.motionSuper35mm                // 24.89 mm
-			case 6: gateWidth = MTFParameters.motion16mm                     // 10.26 mm
-			case 7: gateWidth = MTFParameters.motion8mm                      // 4.8 mm
-			case 8: gateWidth = MTFParameters.motionSuper8                   // 5.79 mm
-			case 9: gateWidth = MTFParameters.largeFormat54Width             // 127.0 mm
-            case 10: gateWidth = 107.95
-			default: gateWidth = MTFParameters.mediumFormatWidth             // Fallback
-			}
-			
-
-			
-            let safeInput = input.clampedToExtent()
-			
-			// Target size used for tests
-			let targetPPMWidth: CGFloat = 600
-			
-			// Calculate the input MM size in pixels based on gatewidth
-			let inputPPM = max(input.extent.width, input.extent.height) / gateWidth
-			
-			// Scale the input ppm to match that of the test target
-			var imageScalar = targetPPMWidth / inputPPM
-			
-			if ImageViewModel.shared.isZoomed {
-				imageScalar /= CGFloat(uiScale)
-			}
-			
-			// Apply the scalar clamping at 1.0 to avoid upscaling
-			let scalar100: CGFloat = min(max(0.4 * imageScalar, 0.0), 1.0)
-			let scalar50:  CGFloat = min(max(0.2 * imageScalar, 0.0), 1.0)
-			let scalar25:  CGFloat = min(max(0.12 * imageScalar, 0.0), 1.0)
-			let scalar10:  CGFloat = min(max(0.05 * imageScalar, 0.0), 1.0)
-
-			print("""
-
-			Line Pairs Per MM Scalars:
-			  100 LP/mm: \(scalar100)
-			   50 LP/mm: \(scalar50)
-			   25 LP/mm: \(scalar25)
-			   10 LP/mm: \(scalar10)
-
-			""")
-			
-			
-			
-	
-			let scalar = (max(input.extent.width, input.extent.height) / CGFloat(nativeLongEdge)) * zoomScalar
-			print("MTF Scalar = \(scalar)")
-            
-			
-			if isExport {
-				zoomScalar = 1.0
-			}
-			
-            
-            
-			
-			
-			let linesPerPixel = (CGFloat(nativeLongEdge) / gateWidth) * scalar
-
-            var lpmm10  =    linesPerPixel / 10.0 * 2.0
-            var lpmm20  =    linesPerPixel / 20.0 * 2.0
-            var lpmm50  =    linesPerPixel / 50.0 * 2.0
-            var lpmm100 =    linesPerPixel / 100.0 * 2.0
-            
-            let epsilon: CGFloat = 0.0001  // very small number to avoid division by zero
-
-            lpmm10  = min(1.0 / max(lpmm10, epsilon), 1.0)
-            lpmm20  = min(1.0 / max(lpmm20, epsilon), 1.0)
-            lpmm50  = min(1.0 / max(lpmm50, epsilon), 1.0)
-            lpmm100 = min(1.0 / max(lpmm100, epsilon), 1.0)
-
-            if format == 10 {
-                lpmm10 = (lpmm10 + lpmm20) / 2.0
-                lpmm20 = lpmm10
-                lpmm50 = lpmm10
-                lpmm100 = lpmm10
-            }
-
-			
-            print("""
-                
-                Native Long Edge:
-                
-                \(nativeLongEdge)
-                
-                Scalar:
-                
-                \(scalar)
-                
-                Lines Per Pixel:
-                
-                \(linesPerPixel)
-                
-                LPMM:
-                
-                10  =  \(lpmm10)
-                20  =  \(lpmm20)
-                50  =  \(lpmm50)
-                100 =  \(lpmm100)
-                
-                """)
-
-			
-            
-            
-			// Concurrent blur creation
-			let group = DispatchGroup()
-			let queue = DispatchQueue.global(qos: .userInitiated)
-			
-			var blur10 = CIImage.clear
-			var blur20 = CIImage.clear
-			var blur50 = CIImage.clear
-			var blur100 = CIImage.clear
-
-			
-			
-			// Gaussian Blur
-			group.enter()
-			queue.async {
-                blur100 = safeInput.downAndUp(scalar100)
-				group.leave()
-			}
-			
-			group.enter()
-			queue.async {
+	static func gateWidth(_ format: Int) -> CGFloat {
+		let gateWidth: CGFloat
+		switch format {
+		case 0: gateWidth = MTFParameters.mediumFormatWidth              // 60.0 mm
+		case 1: gateWidth = MTFParameters.cropMediumSensorWidth          // 43.8 mm
+		case 2: gateWidth = MTFParameters.thirtyFiveWidth                // 36.0 mm
+		case 3: gateWidth = MTFParameters.halfFrameWidth                 // 18.0 mm
+		case 4: gateWidth = MTFParameters.motionStandard35mm             // 21.95 mm
+		case 5: gateWidth = MTFParameters.motionSuper35mm                // 24.89 mm
+		case 6: gateWidth = MTFParameters.motion16mm                     // 10.26 mm
+		case 7: gateWidth = MTFParameters.motion8mm                      // 4.8 mm
+		case 8: gateWidth = MTFParameters.motionSuper8                   // 5.79 mm
+		case 9: gateWidth = MTFParameters.largeFormat54Width             // 127.0 mm
+		case 10: gateWidth = 107.95
+		default: gateWidth = MTFParameters.mediumFormatWidth             // Fallback
+		}
+		return gateWidth
+	}
 
-				blur50 = safeInput.downAndUp(scalar50)
-				group.leave()
-			}
-			
-			group.enter()
-			queue.async {
-				blur20 = safeInput.downAndUp(scalar25)
-				group.leave()
-			}
-			
-			group.enter()
-			queue.async {
-				blur10 = safeInput.downAndUp(scalar10)
-				group.leave()
-			}
-			
-			group.wait() // Wait for blurs to complete
-			
+	// Pixels per mm of gate across `frame`; a zoomed preview shows fewer mm per pixel.
+	static func pixelsPerMM(_ format: Int, _ frame: CGRect, _ uiScale: Float) -> CGFloat {
+		var pixelsPerMM = max(frame.width, frame.height) / gateWidth(format)
+		if ImageViewModel.shared.isZoomed {
+			pixelsPerMM *= CGFloat(uiScale)
+		}
+		return pixelsPerMM
+	}
 
+	// How far past a pixel the band pass reads, for the zoomed render's source region.
+	static func apron(_ format: Int, _ frame: CGRect, _ uiScale: Float) -> Int32 {
+		var gains = [Float](repeating: 1, count: 40)
+		let levels = ForgeMTFBandGains(MTFParameters.bandResponse, Float(pixelsPerMM(format, frame, uiScale)),
+										Int32(frame.width), Int32(frame.height), &gains)
+		return levels > 0 ? ForgeBandGainApron(levels) : 0
+	}
 
+	func apply(to input: CIImage) -> CIImage {
+		if applyMTF {
+            let safeInput = input.clampedToExtent()
+			let pixelsPerMM = MTFCurveNode.pixelsPerMM(format, input.viewportFrame, uiScale)
 			
-			let bandKernel = CIColorKernelCache.shared.mtfBandKernel
-			
-			var rGain100 = MTFParameters.rGain_100LPM
-			var gGain100 = MTFParameters.gGain_100LPM
-			var bGain100 = MTFParameters.bGain_100LPM
-			
-			if applyGrain {
-				rGain100 += (1.0 - rGain100) / 2.0
-				gGain100 += (1.0 - gGain100) / 2.0
-				bGain100 += (1.0 - bGain100) / 2.0
-			}
-			
-			var result = safeInput
-			
-			result = bandKernel.apply(
-				extent: safeInput.extent,
-				roiCallback: {$1},
-				arguments: [
-					result, blur100, MTFParameters.rGain_100LPM, MTFParameters.gGain_100LPM, MTFParameters.bGain_100LPM
-				]
-			) ?? input
-			
-			result = bandKernel.apply(
-				extent: safeInput.extent,
-				roiCallback: { $1 },
-				arguments: [
-					result, blur50, MTFParameters.rGain_50LPM, MTFParameters.gGain_50LPM, MTFParameters.bGain_50LPM
-				]
-			) ?? result
-			
-			result = bandKernel.apply(
-				extent: safeInput.extent,
-				roiCallback: {  $1 },
-				arguments: [
-					result, blur20, MTFParameters.rGain_20LPM, MTFParameters.gGain_20LPM, MTFParameters.bGain_20LPM
-				]
-			) ?? result
-			
-			result = bandKernel.apply(
-				extent: safeInput.extent,
-				roiCallback: {  $1 },
-				arguments: [
-					result, blur10, MTFParameters.rGain_10LPM, MTFParameters.gGain_10LPM, MTFParameters.bGain_10LPM
-				]
-			) ?? result
-			
+			// One pyramid pass with per-octave gains, instead of four down-and-up copies
+			// (100, 50, 25, 10 LP/mm) blended through mtfBandKernel. Like that cascade it works
+			// on the gamma 2.2 negative it is handed.
+			let result = safeInput.mtfBands(pixelsPerMM: Float(pixelsPerMM), extent: input.extent)
 			
 			let blended = safeInput.blendWithOpacityPercent(result, mtfAmount)
 			
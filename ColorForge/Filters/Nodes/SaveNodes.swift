@@ -17,36 +17,7 @@ func saveImage(_ item: ImageItem, _ image: CIImage, _ originalUrl: URL, _ saveDe
 
     
     DispatchQueue.global(qos: .userInitiated).async {
-        let context = RenderingManager.shared.exportContext
-        let width = image.extent.width
-        let height = image.extent.height
         let outputColorSpace = CGColorSpace(name: CGColorSpace.adobeRGB1998)!
-        let bitmapInfo: CGBitmapInfo = CGBitmapInfo(rawValue: CGImageAlphaInfo.noneSkipLast.rawValue)
-
-        guard let cgImage = context.createCGImage(image, from: image.extent) else {
-            print("Failed to create CGImage.")
-            return
-        }
-
-        guard let cgContext = CGContext(
-            data: nil,
-            width: Int(width),
-            height: Int(height),
-            bitsPerComponent: 16,
-            bytesPerRow: 0,
-            space: outputColorSpace,
-            bitmapInfo: bitmapInfo.rawValue
-        ) else {
-            print("Failed to create CGContext.")
-            return
-        }
-
-        cgContext.draw(cgImage, in: CGRect(x: 0, y: 0, width: CGFloat(width), height: CGFloat(height)))
-
-        guard let outputCGImage = cgContext.makeImage() else {
-            print("Failed to create output CGImage.")
-            return
-        }
 
         // Get safe, sanitized filename
         let originalFilename = originalUrl.deletingPathExtension().lastPathComponent
@@ -61,45 +32,11 @@ func saveImage(_ item: ImageItem, _ image: CIImage, _ originalUrl: URL, _ saveDe
             outputFileURL = saveDestination
         }
 
-        // Prepare TIFF output with DPI settings using CGImageDestination
-        let dpi: Int = 300
-        
-        var properties: [CFString: Any] = [
-            kCGImagePropertyDPIWidth: dpi,
-            kCGImagePropertyDPIHeight: dpi
-        ]
-
-        // Always include an empty TIFF dictionary (required)
-        properties[kCGImagePropertyTIFFDictionary] = [:]
-
-        // Conditionally include metadata if present
-        if let exif = item.exifDict {
-            properties[kCGImagePropertyExifDictionary] = exif
-        }
-        if let gps = item.gpsDict {
-            properties[kCGImagePropertyGPSDictionary] = gps
-        }
-        if let iptc = item.iptcDict {
-            properties[kCGImagePropertyIPTCDictionary] = iptc
-        }
-        
-        let mutableData = NSMutableData()
-        guard let destination = CGImageDestinationCreateWithData(mutableData, kUTTypeTIFF, 1, nil) else {
-            print("Failed to create CGImageDestination")
-            return
-        }
-
-        CGImageDestinationAddImage(destination, outputCGImage, properties as CFDictionary)
-
-        if CGImageDestinationFinalize(destination) {
-            do {
-                try mutableData.write(to: outputFileURL, options: .atomic)
-                print("Saved TIFF image to: \(outputFileURL.path)")
-            } catch {
-                print("Failed to write TIFF file: \(error)")
-            }
+        // Rendered and written band by band, with the source's EXIF, GPS and IPTC, at 300 dpi
+        if TiffExport.write(image, item: item, to: outputFileURL, colorSpace: outputColorSpace) {
+            print("Saved TIFF image to: \(outputFileURL.path)")
         } else {
-            print("Failed to finalize image destination.")
+            print("Failed to write TIFF file: \(outputFileURL.path)")
         }
     }
 }
@@ -256,53 +193,14 @@ public func debugSave(_ image: CIImage, _ suffix: String) {
 	}
 }
 
+// Pipeline images are scene-linear AWG3: written unmanaged, tagged with AWG3 primaries.
 public func saveImage32BitDebug(_ image: CIImage) {
     let context = CIContext(options: [
+        .workingColorSpace: NSNull(),
         .outputPremultiplied: false,
         .useSoftwareRenderer: false
     ])
 
-    let width = Int(image.extent.width)
-    let height = Int(image.extent.height)
-    let rowBytes = width * 4 * MemoryLayout<Float>.size // 4 channels × float
-
-    let byteCount = rowBytes * height
-    let rawData = UnsafeMutableRawPointer.allocate(byteCount: byteCount, alignment: MemoryLayout<Float>.alignment)
-    defer { rawData.deallocate() }
-
-    let colorSpace = CGColorSpace(name: CGColorSpace.linearSRGB)!
-
-    context.render(
-        image,
-        toBitmap: rawData,
-        rowBytes: rowBytes,
-        bounds: image.extent,
-        format: .RGBAf,
-        colorSpace: colorSpace
-    )
-
-    guard let provider = CGDataProvider(dataInfo: nil, data: rawData, size: byteCount, releaseData: { _,_,_ in }) else {
-        print("Failed to create data provider.")
-        return
-    }
-
-    guard let cgImage = CGImage(
-        width: width,
-        height: height,
-        bitsPerComponent: 32,
-        bitsPerPixel: 128,
-        bytesPerRow: rowBytes,
-        space: colorSpace,
-        bitmapInfo: CGBitmapInfo(rawValue: CGImageAlphaInfo.noneSkipLast.rawValue),
-        provider: provider,
-        decode: nil,
-        shouldInterpolate: false,
-        intent: .defaultIntent
-    ) else {
-        print("Failed to create CGImage.")
-        return
-    }
-
     let fileManager = FileManager.default
     let sandboxURL = fileManager.urls(for: .documentDirectory, in: .userDomainMask).first!
     let outputFolderURL = sandboxURL.appendingPathComponent("DebugOutput")
@@ -310,11 +208,11 @@ public func saveImage32BitDebug(_ image: CIImage) {
     do {
         try fileManager.createDirectory(at: outputFolderURL, withIntermediateDirectories: true, attributes: nil)
 
-        // Find next available debugNNN_32bit.tiff filename
+        // Find next available debugNNN_half.exr filename
         let existingFiles = (try? fileManager.contentsOfDirectory(at: outputFolderURL, includingPropertiesForKeys: nil)) ?? []
         let existingNumbers = existingFiles.compactMap { url -> Int? in
             let name = url.deletingPathExtension().lastPathComponent
-            let pattern = #"^debug(\d{3})(?:_32bit)?$"#
+            let pattern = #"^debug(\d{3})(?:_32bit|_half)?$"#
             if let match = name.range(of: pattern, options: .regularExpression) {
                 return Int(name[match].suffix(3))
             }
@@ -322,102 +220,44 @@ public func saveImage32BitDebug(_ image: CIImage) {
         }
         let nextNumber = (existingNumbers.max() ?? 0) + 1
         let numberStr = String(format: "%03d", nextNumber)
-        let outputFileURL = outputFolderURL.appendingPathComponent("debug\(numberStr)_32bit.tiff")
-
-        guard let dest = CGImageDestinationCreateWithURL(outputFileURL as CFURL, UTType.tiff.identifier as CFString, 1, nil) else {
-            print("Failed to create TIFF destination.")
-            return
-        }
-
-        CGImageDestinationAddImage(dest, cgImage, [
-            kCGImagePropertyTIFFCompression as String: 1
-        ] as CFDictionary)
+        let outputFileURL = outputFolderURL.appendingPathComponent("debug\(numberStr)_half.exr")
 
-        if CGImageDestinationFinalize(dest) {
-            print("Saved 32-bit TIFF to: \(outputFileURL.path)")
+        // Half float, ZIP-compressed tiles, written band by band
+        if ExrExport.write(image, to: outputFileURL, colorSpace: nil, chromaticities: ExrExport.awg3Chromaticities,
+                           context: context) {
+            print("Saved half-float EXR to: \(outputFileURL.path)")
         } else {
-            print("Failed to finalize TIFF image.")
+            print("Failed to write EXR image.")
         }
     } catch {
-        print("Failed to save TIFF image: \(error)")
+        print("Failed to save EXR image: \(error)")
     }
 }
 
+// As saveImage32BitDebug: unmanaged values, AWG3 primaries.
 public func saveImage32BitFloat(_ image: CIImage) {
 	let context = CIContext(options: [
+		.workingColorSpace: NSNull(),
 		.outputPremultiplied: false,
 		.useSoftwareRenderer: false
 	])
 
-	let width = Int(image.extent.width)
-	let height = Int(image.extent.height)
-	let rowBytes = width * 4 * MemoryLayout<Float>.size // 4 channels x float
-
-	// Create raw buffer
-	let byteCount = rowBytes * height
-	let rawData = UnsafeMutableRawPointer.allocate(byteCount: byteCount, alignment: MemoryLayout<Float>.alignment)
-	defer { rawData.deallocate() }
-
-	let colorSpace = CGColorSpace(name: CGColorSpace.linearSRGB)!
-
-	// Render to float buffer
-	context.render(
-		image,
-		toBitmap: rawData,
-		rowBytes: rowBytes,
-		bounds: image.extent,
-		format: .RGBAf,
-		colorSpace: colorSpace
-	)
-
-	// Create CGDataProvider
-	guard let provider = CGDataProvider(dataInfo: nil, data: rawData, size: byteCount, releaseData: { _,_,_ in }) else {
-		print("Failed to create data provider.")
-		return
-	}
-
-	// Create CGImage manually from buffer
-	guard let cgImage = CGImage(
-		width: width,
-		height: height,
-		bitsPerComponent: 32,
-		bitsPerPixel: 128,
-		bytesPerRow: rowBytes,
-		space: colorSpace,
-		bitmapInfo: CGBitmapInfo(rawValue: CGImageAlphaInfo.noneSkipLast.rawValue),
-		provider: provider,
-		decode: nil,
-		shouldInterpolate: false,
-		intent: .defaultIntent
-	) else {
-		print("Failed to create CGImage.")
-		return
-	}
-
-	// Write TIFF using Image I/O
+	// Write a half-float EXR, rendered and compressed band by band
 	let fileManager = FileManager.default
 	let sandboxURL = fileManager.urls(for: .documentDirectory, in: .userDomainMask).first!
 	let outputFolderURL = sandboxURL.appendingPathComponent("UnitTestOutput")
-	let outputFileURL = outputFolderURL.appendingPathComponent("unitTest_float32.tiff")
+	let outputFileURL = outputFolderURL.appendingPathComponent("unitTest_half.exr")
 
 	do {
 		try fileManager.createDirectory(at: outputFolderURL, withIntermediateDirectories: true, attributes: nil)
 
-		guard let dest = CGImageDestinationCreateWithURL(outputFileURL as CFURL, UTType.tiff.identifier as CFString, 1, nil) else {
-			print("Failed to create TIFF destination.")
-			return
-		}
-
-		CGImageDestinationAddImage(dest, cgImage, [
-			kCGImagePropertyTIFFCompression as String: 1, // No compression
-		] as CFDictionary)
-
-		if CGImageDestinationFinalize(dest) {
-			print("Saved 32-bit TIFF to: \(outputFileURL.path)")
+		if ExrExport.write(image, to: outputFileURL, colorSpace: nil, chromaticities: ExrExport.awg3Chromaticities,
+						   context: context) {
+			print("Saved half-float EXR to: \(outputFileURL.path)")
 		} else {
-			print("Failed to finalize TIFF image.")
+			print("Failed to write EXR image.")
 		}
 	} catch {
-		print("Failed to save TIFF image: \(error)")
+		print("Failed to save EXR image: \(error)")
 	}
 }
@@ -92,8 +92,6 @@ struct PrintHalationV2Node: FilterNode {
         guard printHalation_apply else {return input}
 //        guard !ImageViewModel.shared.isZoomed else {return input}
 
-        let zoomScalar = ImageViewModel.shared.zoomScale
-        
         let isDarken: Int
         if printHalation_darkenMode {
             isDarken = 0
@@ -101,9 +99,7 @@ struct PrintHalationV2Node: FilterNode {
             isDarken = 1
         }
         
-        let uiScalar = max(input.extent.width, input.extent.height) / CGFloat(nativeWidth)
-
-        let sizeScaled = (printHalation_size * Float(uiScalar)) * Float(zoomScalar)
+        let sizeScaled = PrintHalationV2Node.scaledSize(printHalation_size, nativeWidth, input.viewportFrame)
         
         let downScaleVal = CGFloat((Float(nativeWidth) / sizeScaled) / Float(nativeWidth))
         
@@ -127,7 +123,17 @@ struct PrintHalationV2Node: FilterNode {
         return cachedResult.crop(input.extent)
     }
     
+    // Halation size in pixels of `frame`.
+    static func scaledSize(_ size: Float, _ nativeWidth: Int, _ frame: CGRect) -> Float {
+        let uiScalar = max(frame.width, frame.height) / CGFloat(nativeWidth)
+        return size * Float(uiScalar) * Float(ImageViewModel.shared.zoomScale)
+    }
     
+    // How far past a pixel the halation reads: downAndUp's bicubic taps reach two low-res pixels
+    // each way going down and again coming up.
+    static func apron(_ size: Float, _ nativeWidth: Int, _ frame: CGRect) -> Int32 {
+        Int32((4 * scaledSize(size, nativeWidth, frame)).rounded(.up))
+    }
 }
 
 
@@ -160,6 +166,8 @@ struct RealisticFilmGrainNode: FilterNode {
     let grain6mm_high: CIImage?
     let gateWidth: Int
     let amount: Float
+    // Re-renders once a full-size field this node had to pass through on is built
+    let fieldReady: @MainActor () -> Void
     
     func apply(to input: CIImage) -> CIImage {
         print("[GrainNode] Starting apply() – applyGrain: \(applyGrain), isExport: \(isExport)")
@@ -174,29 +182,19 @@ struct RealisticFilmGrainNode: FilterNode {
         var g_high: CIImage = input
         var g_low: CIImage = input
         
-        var finalImage: CIImage = input
-        let semaphore = DispatchSemaphore(value: 0)
-        
         var scalar = 1.0
         
         if isExport {
-            Task.detached(priority: .userInitiated) { @MainActor in
-                // Make this a Void-returning task
-                let (low, high) = await GrainModel.shared.loadFullSizePlate(input, gateWidth)
-                g_high = high
-                g_low = low
-
-
-                finalImage = input.mixGrainAndApply(g_low, g_high, amount)
-
-                semaphore.signal()
+            // A gate and size seen before come straight from GrainFieldCache. Otherwise the input
+            // passes through while the field is built, and fieldReady renders again once it is.
+            guard let (low, high) = GrainFieldCache.shared.storedPlates(for: input.extent, gate: gateWidth) else {
+                let gate = gateWidth
+                GrainFieldCache.shared.fill(for: input.extent, gate: gate,
+                                            plates: { await GrainModel.shared.scaledPlates(input, gate) },
+                                            ready: fieldReady)
+                return input
             }
-
-            print("[GrainNode] Waiting for plates to finish")
-            semaphore.wait()  // Wait until the detached task signals completion
-            print("[GrainNode] Finished apply()")
-
-            return finalImage.cropped(to: input.extent)
+            return input.mixGrainAndApply(low, high, amount).cropped(to: input.extent)
         } else {
 
             switch gateWidth {
@@ -399,8 +397,8 @@ struct NoiseGrainNode: FilterNode {
     func apply(to input: CIImage) -> CIImage {
 		guard applyGrain else {return input}
 		
-		let width = input.extent.width
-		let height = input.extent.height
+		let width = input.viewportFrame.width
+		let height = input.viewportFrame.height
 		
 		let gray = CIImage(color: .gray).cropped(to: input.extent)
 		
@@ -442,10 +440,11 @@ struct NoiseGrainNodeV2: FilterNode {
     let isExport: Bool
     let uiScale: Float
     let id: UUID
+    let seed: UInt64    // item.textureSeed
     
     func apply(to input: CIImage) -> CIImage {
         
-        let grain = GrainModel.shared.generateGrain(id, input, 1.0, uiScale, isExport: isExport)
+        let grain = GrainModel.shared.generateGrain(id, seed, input, 1.0, uiScale, isExport: isExport)
         
         let blend = input.arriSoftLight(grain)
         
@@ -71,43 +71,26 @@ class BatchRenderer {
 	}
 	
 	
-	// Converts a batch of CIImages into NSImages using 4 CIContexts concurrently.
+	// Converts a batch of CIImages into NSImages, as many at once as the batch memory and thread
+	// budget admits (BatchScheduler), each on a context of its own.
 	// Returns an array of (UUID, NSImage?) in the same order as input.
 	func batchConvertToNSImage(_ images: [(UUID, CIImage)]) async -> [(UUID, NSImage?)] {
-		await withTaskGroup(of: [(UUID, NSImage?)].self) { group in
-			let chunkSize = max(1, (images.count + 3) / 4) // Split evenly into 4 batches
-			let batches = stride(from: 0, to: images.count, by: chunkSize).map {
-				Array(images[$0 ..< min($0 + chunkSize, images.count)])
-			}
-			
-			let contexts = [context1, context2, context3, context4]
-			let context = context1
-			
-			// Add one task per batch
-			for (index, batch) in batches.enumerated() {
-				
-				
-				group.addTask() {
-					var results: [(UUID, NSImage?)] = []
-					for (id, ciImage) in batch {
-						let nsImage = await self.convertToNSImage(ciImage, context)
-						results.append((id, nsImage))
-					}
-					return results
-				}
-			}
-			
-			// Collect results from all batches
-			var allResults: [(UUID, NSImage?)] = []
-			for await batchResults in group {
-				allResults.append(contentsOf: batchResults)
-			}
-			
-			// Preserve the original order of input images
-			return images.map { id, _ in
-				allResults.first(where: { $0.0 == id }) ?? (id, nil)
-			}
+		let contexts = [context1, context2, context3, context4, context5, context6, context7, context8]
+		let budget = Preferences.batchThreadBudget
+		let scheduler = BatchScheduler("batchConvertToNSImage", threads: min(budget > 0 ? budget : contexts.count, contexts.count))
+		for (_, ciImage) in images {
+			scheduler.add(BatchScheduler.spec(for: ciImage))
 		}
+
+		let results = ConvertedImages(count: images.count)
+		await scheduler.run { job, slot in
+			let nsImage = await self.convertToNSImage(images[job].1, contexts[slot])
+			results.set(job, nsImage)
+			return nsImage != nil
+		}
+
+		// Job indices are input positions, so the order is preserved
+		return images.enumerated().map { index, image in (image.0, results.get(index)) }
 	}
 
 	// Convert a single CIImage to NSImage using the given CIContext.
@@ -122,6 +105,24 @@ class BatchRenderer {
 	
 }
 
+// Results written from the scheduler's tasks.
+private final class ConvertedImages: @unchecked Sendable {
+	private let lock = NSLock()
+	private var images: [NSImage?]
 
+	init(count: Int) {
+		images = Array(repeating: nil, count: count)
+	}
 
+	func set(_ index: Int, _ image: NSImage?) {
+		lock.lock()
+		images[index] = image
+		lock.unlock()
+	}
 
+	func get(_ index: Int) -> NSImage? {
+		lock.lock()
+		defer { lock.unlock() }
+		return images[index]
+	}
+}
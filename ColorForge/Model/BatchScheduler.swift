@@ -0,0 +1,114 @@
+//
+//  BatchScheduler.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Runs a batch under the engine's memory-budgeted scheduler (ColorForge/Engine/Pipeline/
+// BatchScheduler): each job is started only once its estimated peak working set fits beside the
+// running ones, on one of `threads` slots, so a batch of 100 MP scans doesn't swap and a batch of
+// small frames still fills every slot. With a checkpoint, jobs finished by an interrupted run are
+// skipped.
+final class BatchScheduler {
+    private let scheduler: OpaquePointer
+    private let name: String
+
+    // 0 for either budget: the engine's default (half of RAM, one thread per core). Overridden by
+    // Preferences.batchMemoryBudget / batchThreadBudget.
+    init(_ name: String, memoryBytes: UInt64 = Preferences.batchMemoryBudget, threads: Int = Preferences.batchThreadBudget,
+         checkpoint: URL? = nil) {
+        self.name = name
+        if let checkpoint {
+            scheduler = checkpoint.withUnsafeFileSystemRepresentation { ForgeBatchSchedulerCreate(memoryBytes, Int32(threads), $0) }
+        } else {
+            scheduler = ForgeBatchSchedulerCreate(memoryBytes, Int32(threads), nil)
+        }
+    }
+
+    deinit {
+        ForgeBatchSchedulerRelease(scheduler)
+    }
+
+    var threads: Int { Int(ForgeBatchSchedulerThreads(scheduler)) }
+    var progress: ForgeBatchProgress { ForgeBatchSchedulerGetProgress(scheduler) }
+
+    // The job's index. `key` names it in the checkpoint.
+    @discardableResult
+    func add(_ spec: ForgeBatchJobSpec, key: String = "") -> Int {
+        Int(ForgeBatchSchedulerAdd(scheduler, key, spec))
+    }
+
+    // True if an earlier run of the batch finished the job.
+    func resumed(_ job: Int) -> Bool {
+        ForgeBatchSchedulerResumed(scheduler, Int32(job))
+    }
+
+    // The job's output is safely written.
+    func checkpoint(_ job: Int) {
+        ForgeBatchSchedulerCheckpoint(scheduler, Int32(job))
+    }
+
+    func clearCheckpoint() {
+        ForgeBatchSchedulerClearCheckpoint(scheduler)
+    }
+
+    // Runs every job not yet done through `body(job, slot)` as the budget admits it; `slot` is in
+    // 0..<threads, unique among the jobs running, for picking a context. `body` returns once the
+    // job's working set is released, with false if the job failed.
+    func run(_ body: @escaping (Int, Int) async -> Bool) async {
+        await withTaskGroup(of: (Int32, Int, Bool).self) { group in
+            var freeSlots = Array((0..<threads).reversed())
+            while true {
+                if let slot = freeSlots.last {
+                    let job = ForgeBatchSchedulerNext(scheduler)
+                    if job >= 0 {
+                        freeSlots.removeLast()
+                        group.addTask { (job, slot, await body(Int(job), slot)) }
+                        continue
+                    }
+                }
+                // Nothing fits (or nothing is left) until a running job finishes.
+                guard let (done, slot, ok) = await group.next() else { break }
+                ForgeBatchSchedulerFinish(scheduler, done, ok)
+                freeSlots.append(slot)
+                report()
+            }
+        }
+    }
+
+    private func report() {
+        let p = progress
+        let done = Int(p.completed + p.failed + p.resumed)
+        print(String(format: "%@: %d/%d (%d failed) — %.2f images/s, %.0f MP/s, %.1f GB in flight, ETA %.0fs",
+                     name, done, p.total, p.failed, p.imagesPerSecond, p.megapixelsPerSecond,
+                     Double(p.bytesInFlight) / 1_073_741_824, p.etaSeconds))
+    }
+
+    // MARK: - Estimates
+
+    // A job's shape from its item: the frame at native size, the nodes that cache a full-frame
+    // intermediate (the graph's base, MTF, each mask), and the grain and halation blurs.
+    static func spec(for item: ImageItem, extent: CGRect? = nil, outputScale: Float? = nil,
+                     outputBytesPerPixel: Int32 = 8) -> ForgeBatchJobSpec {
+        let width = item.nativeWidth > 0 ? item.nativeWidth : Int(extent?.width ?? 0)
+        let height = item.nativeHeight > 0 ? item.nativeHeight : Int(extent?.height ?? 0)
+        let masks = item.maskSettings.linearGradients.count + item.maskSettings.radialGradients.count
+            + item.maskSettings.aiMasks.count
+        return ForgeBatchJobSpec(width: Int32(width), height: Int32(height), outputScale: outputScale ?? item.saveScale,
+                                 cachedNodes: Int32(1 + (item.applyMTF ? 1 : 0) + masks),
+                                 grainRadius: item.applyGrain ? 5 : 0,
+                                 halationRadius: item.printHalation_apply ? item.printHalation_size : 0,
+                                 outputBytesPerPixel: outputBytesPerPixel)
+    }
+
+    // A rendered image with nothing else known about it.
+    static func spec(for image: CIImage, outputBytesPerPixel: Int32 = 4) -> ForgeBatchJobSpec {
+        let extent = image.extent.isInfinite ? .zero : image.extent
+        return ForgeBatchJobSpec(width: Int32(extent.width), height: Int32(extent.height), outputScale: 1, cachedNodes: 0,
+                                 grainRadius: 0, halationRadius: 0, outputBytesPerPixel: outputBytesPerPixel)
+    }
+}
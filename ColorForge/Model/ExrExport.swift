@@ -0,0 +1,59 @@
+//
+//  ExrExport.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Scene-linear exports through the streaming EXR writer (ColorForge/Engine/IO/ExrWriter): half
+// float RGB, ZIP-compressed tiles, rendered and written one band at a time, so an archive frame
+// never exists as a full 32-bit buffer and its tiles compress on every core.
+enum ExrExport {
+    // Core Image renders four channels per pixel; the writer drops the alpha.
+    private static let renderChannels = 4
+
+    // ARRI Wide Gamut 3 red, green, blue and white (D65) CIE xy, the pipeline's working primaries.
+    static let awg3Chromaticities: [Float] = [0.6840, 0.3130, 0.2210, 0.8480, 0.0861, -0.1020, 0.3127, 0.3290]
+
+    // `image` rendered in `colorSpace` (scene-linear, for an archive) as an EXR at `url`; a nil
+    // `colorSpace` writes the values as they are, for pipeline intermediates. `chromaticities`
+    // are the primaries' and white's CIE xy (8 values) when they aren't Rec.709, as for an AWG3
+    // intermediate. The file appears only once it is complete.
+    static func write(_ image: CIImage, to url: URL, colorSpace: CGColorSpace?, chromaticities: [Float]? = nil,
+                      context: CIContext = RenderingManager.shared.exportContext) -> Bool {
+        let extent = image.extent.integral
+        guard !extent.isEmpty, !extent.isInfinite else { return false }
+
+        let width = Int(extent.width), height = Int(extent.height)
+        let info = ForgeExrInfo(width: Int32(width), height: Int32(height), channels: 3, compression: 1, tileSize: 0)
+        let created: OpaquePointer?
+        if let chromaticities, chromaticities.count == 8 {
+            created = chromaticities.withUnsafeBufferPointer { ForgeExrWriterCreate(url.path, info, $0.baseAddress, "ColorForge") }
+        } else {
+            created = ForgeExrWriterCreate(url.path, info, nil, "ColorForge")
+        }
+        guard let writer = created else { return false }
+        defer { ForgeExrWriterRelease(writer) }
+
+        let bandRows = Int(ForgeExrWriterBandRows(writer))
+        let rowBytes = width * renderChannels * MemoryLayout<UInt16>.size
+        var band = [UInt16](repeating: 0, count: width * renderChannels * bandRows)
+        var row = 0
+        while row < height {
+            let rows = min(bandRows, height - row)
+            // Core Image is y-up: this band's top is `row` rows below the top of the extent.
+            let bounds = CGRect(x: extent.minX, y: extent.maxY - CGFloat(row + rows), width: extent.width, height: CGFloat(rows))
+            let appended = band.withUnsafeMutableBytes { buffer -> Bool in
+                context.render(image, toBitmap: buffer.baseAddress!, rowBytes: rowBytes, bounds: bounds,
+                               format: .RGBAh, colorSpace: colorSpace)
+                return ForgeExrWriterAppendRows(writer, buffer.baseAddress!, rowBytes, Int32(rows), Int32(renderChannels))
+            }
+            guard appended else { return false }
+            row += rows
+        }
+        return ForgeExrWriterFinish(writer)
+    }
+}
@@ -0,0 +1,145 @@
+//
+//  GrainFieldCache.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Frame-sized grain fields prebuilt by the C++ store (ColorForge/Engine/Grain/GrainFieldStore)
+// and kept on disk as mmapped fp16, one per gate and output size. Core Image pulls tiles through
+// GrainFieldProvider, so a render only reads the rows it draws.
+class GrainFieldCache {
+    static let shared = GrainFieldCache()
+
+    // Bump when the plate assets or their scaling change; stored fields are keyed on it.
+    private let plateVersion: UInt64 = 3 // *_4x_v3.png
+    private let capacityBytes: UInt64 = 4 << 30
+    private let seed: UInt32 = 1
+
+    // Gates and sizes being built by fill(for:gate:plates:ready:)
+    private let lock = NSLock()
+    private var filling: Set<String> = []
+
+    init() {
+        let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        let directory = caches.appendingPathComponent("ColorForge/GrainFields", isDirectory: true)
+        ForgeGrainFieldStoreConfigure(directory.path, capacityBytes)
+    }
+
+    // Shadow and highlight grain images covering `extent`, building the field from the scaled
+    // plates first if this gate and size have not been seen. Nil if the store is unusable.
+    func plates(for extent: CGRect, gate: Int, low: CIImage, high: CIImage) -> (CIImage, CIImage)? {
+        guard let key = key(extent, gate) else { return nil }
+
+        if let field = ForgeGrainFieldOpen(key) {
+            return images(field, extent)
+        }
+        guard let field = build(key, low, high) else { return nil }
+        return images(field, extent)
+    }
+
+    // The stored field for this gate and size, without building anything; nil on a miss.
+    func storedPlates(for extent: CGRect, gate: Int) -> (CIImage, CIImage)? {
+        guard let key = key(extent, gate), let field = ForgeGrainFieldOpen(key) else { return nil }
+        return images(field, extent)
+    }
+
+    // Builds the field for this gate and size in the background from the scaled `plates`, once
+    // however often it is asked for while that runs, then calls `ready` on the main actor.
+    func fill(for extent: CGRect, gate: Int, plates: @escaping () async -> (CIImage, CIImage)?,
+              ready: @escaping @MainActor () -> Void) {
+        let name = "\(gate) \(Int(extent.width.rounded()))x\(Int(extent.height.rounded()))"
+        lock.lock()
+        let started = filling.insert(name).inserted
+        lock.unlock()
+        guard started else { return }
+
+        Task.detached(priority: .userInitiated) {
+            if let (low, high) = await plates() {
+                _ = self.plates(for: extent, gate: gate, low: low, high: high)
+            }
+            self.lock.lock()
+            self.filling.remove(name)
+            self.lock.unlock()
+            await MainActor.run(body: ready)
+        }
+    }
+
+    private func key(_ extent: CGRect, _ gate: Int) -> ForgeGrainFieldKey? {
+        let width = Int32(extent.width.rounded()), height = Int32(extent.height.rounded())
+        guard width > 0, height > 0 else { return nil }
+        return ForgeGrainFieldKey(plates: plateVersion, gate: Int32(gate), width: width, height: height, seed: seed)
+    }
+
+    private func build(_ key: ForgeGrainFieldKey, _ low: CIImage, _ high: CIImage) -> OpaquePointer? {
+        let bounds = low.extent.integral
+        guard bounds == high.extent.integral, bounds.width > 1, bounds.height > 1 else { return nil }
+
+        let width = Int(bounds.width), height = Int(bounds.height)
+        let rowBytes = width * MemoryLayout<Float>.stride
+        var lowPixels = [Float](repeating: 0, count: width * height)
+        var highPixels = [Float](repeating: 0, count: width * height)
+
+        let context = RenderingManager.shared.exportContext
+        lowPixels.withUnsafeMutableBytes {
+            context.render(low, toBitmap: $0.baseAddress!, rowBytes: rowBytes, bounds: bounds, format: .Rf, colorSpace: nil)
+        }
+        highPixels.withUnsafeMutableBytes {
+            context.render(high, toBitmap: $0.baseAddress!, rowBytes: rowBytes, bounds: bounds, format: .Rf, colorSpace: nil)
+        }
+
+        return lowPixels.withUnsafeBufferPointer { lowBuffer in
+            highPixels.withUnsafeBufferPointer { highBuffer in
+                ForgeGrainFieldBuild(key, lowBuffer.baseAddress!, highBuffer.baseAddress!, Int32(width), Int32(height), rowBytes)
+            }
+        }
+    }
+
+    // Takes ownership of `field`; the providers keep it mapped while either image is alive.
+    private func images(_ field: OpaquePointer, _ extent: CGRect) -> (CIImage, CIImage) {
+        let handle = GrainFieldHandle(field)
+        let size = (Int(extent.width.rounded()), Int(extent.height.rounded()))
+        let options: [CIImageOption: Any] = [.providerTileSize: [512, 512]]
+
+        func image(_ channel: Int32) -> CIImage {
+            let provider = GrainFieldProvider(handle, channel: channel)
+            return CIImage(imageProvider: provider, size: size.0, size.1, format: .Lh, colorSpace: nil, options: options)
+                .transformed(by: CGAffineTransform(translationX: extent.minX, y: extent.minY))
+        }
+        return (image(0), image(1))
+    }
+}
+
+final class GrainFieldHandle {
+    let field: OpaquePointer
+
+    init(_ field: OpaquePointer) {
+        self.field = field
+    }
+
+    deinit {
+        ForgeGrainFieldRelease(field)
+    }
+}
+
+// Supplies Core Image tiles of one channel (0 shadow, 1 highlight) straight from the mapping.
+final class GrainFieldProvider: NSObject {
+    private let handle: GrainFieldHandle
+    private let channel: Int32
+
+    init(_ handle: GrainFieldHandle, channel: Int32) {
+        self.handle = handle
+        self.channel = channel
+    }
+
+    @objc func provideImageData(_ data: UnsafeMutableRawPointer, bytesPerRow rowbytes: Int,
+                                origin x: Int, _ y: Int, size width: Int, _ height: Int, userInfo info: Any?) {
+        let region = ForgeRect(x: Int32(x), y: Int32(y), width: Int32(width), height: Int32(height))
+        _ = ForgeGrainFieldReadRegion(handle.field, channel, region, data.assumingMemoryBound(to: UInt16.self), rowbytes)
+        // Tiles are requested band by band; start paging in the next one.
+        ForgeGrainFieldPrefetchRows(handle.field, Int32(y + height), Int32(height))
+    }
+}
@@ -57,7 +57,7 @@ class GrainModel {
     private var lastID: UUID? = nil
     
     
-    func generateGrain(_ id: UUID, _ input: CIImage, _ grainSize: CGFloat, _ uiScale: Float, isExport: Bool) -> CIImage {
+    func generateGrain(_ id: UUID, _ seed: UInt64, _ input: CIImage, _ grainSize: CGFloat, _ uiScale: Float, isExport: Bool) -> CIImage {
         var finalGrain = CIImage(color: .gray).cropped(to: input.extent)
         
         if let prevPlate = lastGrainPlate {
@@ -86,7 +86,7 @@ class GrainModel {
         
 
         
-        func buildNoise(_ scalar: CGFloat, _ image: CIImage) -> (CIImage, CIImage) {
+        func buildNoise(_ scalar: CGFloat, _ image: CIImage, _ layer: UInt64) -> (CIImage, CIImage) {
             
             let scalarMin = scalar - (scalar * 0.05)
             let scalarMax = scalar + (scalar * 0.05)
@@ -122,7 +122,7 @@ class GrainModel {
             noise = noise.mixGrain(blurNoise, 0.3)
             
             
-            let perlin = image.smallPerlin()
+            let perlin = image.smallPerlin(seed: seed &+ layer)
             
             return (noise, perlin)
         }
@@ -174,19 +174,19 @@ class GrainModel {
         
         group.enter()
         queue.async {
-            (grain1, perlin1) = buildNoise(noiseScalar, input)
+            (grain1, perlin1) = buildNoise(noiseScalar, input, 0)
             group.leave()
         }
         
         group.enter()
         queue.async {
-            (grain2, perlin2) = buildNoise(noiseScalar, input)
+            (grain2, perlin2) = buildNoise(noiseScalar, input, 1)
             group.leave()
         }
         
         group.enter()
         queue.async {
-            (grain3, perlin3) = buildNoise(noiseScalar, input)
+            (grain3, perlin3) = buildNoise(noiseScalar, input, 2)
             group.leave()
         }
     
@@ -843,80 +843,20 @@ class GrainModel {
     
     // ************* Full Size Plate ******************** //
     
-    func loadFullSizePlate(_ img: CIImage, _ choice: Int) async -> (CIImage, CIImage) {
+    // Shadow and highlight plates scaled for the gate. Lazy: nothing is rendered until they are drawn.
+    func scaledPlates(_ img: CIImage, _ choice: Int) async -> (CIImage, CIImage)? {
         switch choice {
-        case 9: // Large format 5x4 (127mm)
-            let (grainLow54, grainHigh54) = await self.scaleFor54(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow54, grainHigh54)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 0: // Medium format (60mm)
-            let (grainLow60, grainHigh60) = await self.scaleForMediumFormat(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow60, grainHigh60)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 1: // Crop medium format (43.8mm)
-            let (grainLow53, grainHigh53) = await self.scaleForCropMediumFormat(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow53, grainHigh53)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 2: // Standard 35mm (36mm width)
-            let (grainLow36, grainHigh36) = await self.scaleFor36mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow36, grainHigh36)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 5: // Motion Super35 (24.89mm)
-            let (grainLow25, grainHigh25) = await self.scaleFor25mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow25, grainHigh25)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 4: // Motion Standard 35mm (21.95mm)
-            let (grainLow21, grainHigh21) = await self.scaleFor21mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow21, grainHigh21)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 3: // Half Frame (18mm)
-            let (grainLow18, grainHigh18) = await self.scaleFor18mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow18, grainHigh18)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 6: // Motion 16mm (10.26mm)
-            let (grainLow10, grainHigh10) = await self.scaleFor10mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow10, grainHigh10)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 7: // Motion 8mm (4.8mm)
-            let (grainLow5, grainHigh5) = await self.scaleFor8mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow5, grainHigh5)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        case 8: // Motion Super8 (5.79mm)
-            let (grainLow6, grainHigh6) = await self.scaleFor5mm(img)
-            let (plateL, plateH) = await self.tileAndRotateFromPlate(img, grainLow6, grainHigh6)
-            
-            print("HighRes Plates Complete")
-            return (plateL, plateH)
-
-        default:
-            return (.clear, .clear)
+        case 9: return await scaleFor54(img) // Large format 5x4 (127mm)
+        case 0: return await scaleForMediumFormat(img) // Medium format (60mm)
+        case 1: return await scaleForCropMediumFormat(img) // Crop medium format (43.8mm)
+        case 2: return await scaleFor36mm(img) // Standard 35mm (36mm width)
+        case 5: return await scaleFor25mm(img) // Motion Super35 (24.89mm)
+        case 4: return await scaleFor21mm(img) // Motion Standard 35mm (21.95mm)
+        case 3: return await scaleFor18mm(img) // Half Frame (18mm)
+        case 6: return await scaleFor10mm(img) // Motion 16mm (10.26mm)
+        case 7: return await scaleFor8mm(img) // Motion 8mm (4.8mm)
+        case 8: return await scaleFor5mm(img) // Motion Super8 (5.79mm)
+        default: return nil
         }
     }
         
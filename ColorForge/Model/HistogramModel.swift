@@ -23,150 +23,145 @@ class HistogramModel: ObservableObject {
     @Published var green: [HistogramBin] = []
     @Published var blue: [HistogramBin] = []
     @Published var luminance: [HistogramBin] = []
+    @Published var waveform: CGImage?
+    @Published var vectorscope: CGImage?
     
     
     private var debounceTask: Task<Void, Never>?
     private var processingTask: Task<Void, Never>? // <- track active histogram generation
 
+    // Single-pass C++ histogram (ColorForge/Engine/Scopes). 32 bins, as CIAreaHistogram used.
+    private let binCount: Int32 = 32
+    private let engine: OpaquePointer = ForgeHistogramCreate(32)
+    // Waveform and vectorscope from the same buffer and step (ScopeEngine), 256 × 256 each.
+    private let scopeSize = 256
+    private let scopes: OpaquePointer = ForgeScopesCreate(256, 256, 256)
+    private var bufferPool: CVPixelBufferPool?
+    private var poolSize: CGSize = .zero
+    private let poolLock = NSLock()
+
+    deinit {
+        ForgeHistogramRelease(engine)
+        ForgeScopesRelease(scopes)
+    }
+
+    // Called while sliders are dragged, so it samples every other pixel.
     func generateDataDebounced(_ input: CIImage) {
         debounceTask?.cancel()
 
         debounceTask = Task { [weak self] in
             try? await Task.sleep(nanoseconds: 50_000_000)
             guard !Task.isCancelled else { return }
-            self?.generateData(input)
+            self?.generateData(input, step: 2)
         }
     }
     
 
-    func generateData(_ input: CIImage) {
+    func generateData(_ input: CIImage, step: Int32 = 1) {
 
         processingTask?.cancel()
 
         processingTask = Task(priority: .userInitiated) {
-            let startTime = DispatchTime.now()
-            
-            let rgbaBins = histogramBin(input)
-
+            guard let buffer = self.renderToPixelBuffer(input) else { return }
 
             guard !Task.isCancelled else { return }
 
-            let buffer = await self.convertToPixelBuffer(rgbaBins)
-
-            guard !Task.isCancelled else { return }
-
-            async let redBins = self.histogramBins(buffer, channel: 0)
-            async let greenBins = self.histogramBins(buffer, channel: 1)
-            async let blueBins = self.histogramBins(buffer, channel: 2)
-            async let lumBins = self.histogramBins(buffer, channel: 3)
-
-            let (r, g, b, y) = await (redBins, greenBins, blueBins, lumBins)
+            let bins = Int(self.binCount)
+            var counts = [UInt32](repeating: 0, count: bins * 4)
+
+            CVPixelBufferLockBaseAddress(buffer, .readOnly)
+            let source = ForgeScopeSource(
+                data: CVPixelBufferGetBaseAddress(buffer),
+                rowBytes: CVPixelBufferGetBytesPerRow(buffer),
+                planeBytes: 0,
+                width: Int32(CVPixelBufferGetWidth(buffer)),
+                height: Int32(CVPixelBufferGetHeight(buffer)),
+                channels: 4,
+                isHalf: true,
+                isPlanar: false
+            )
+            counts.withUnsafeMutableBufferPointer {
+                _ = ForgeHistogramCompute(self.engine, source, step, 0, 1, $0.baseAddress!)
+            }
+            ForgeScopesCompute(self.scopes, source, step)
+            CVPixelBufferUnlockBaseAddress(buffer, .readOnly)
+            let (waveformImage, vectorscopeImage) = self.scopeImages()
 
             guard !Task.isCancelled else { return }
 
-            let binCount = r.count
-            let binWidth = 256.0 / Double(binCount)
-
-            let redMapped = r.enumerated().map { HistogramBin(id: Int(Double($0.offset) * binWidth), value: $0.element) }
-            let greenMapped = g.enumerated().map { HistogramBin(id: Int(Double($0.offset) * binWidth), value: $0.element) }
-            let blueMapped = b.enumerated().map { HistogramBin(id: Int(Double($0.offset) * binWidth), value: $0.element) }
-            let lumMapped = y.enumerated().map { HistogramBin(id: Int(Double($0.offset) * binWidth), value: $0.element) }
-
+            let binWidth = 256.0 / Double(bins)
+            func mapped(_ channel: Int) -> [HistogramBin] {
+                (0..<bins).map { HistogramBin(id: Int(Double($0) * binWidth), value: Int(counts[channel * bins + $0])) }
+            }
+            let redMapped = mapped(0)
+            let greenMapped = mapped(1)
+            let blueMapped = mapped(2)
+            let lumMapped = mapped(3)
 
             await MainActor.run {
                 self.red = redMapped
                 self.green = greenMapped
                 self.blue = blueMapped
                 self.luminance = lumMapped
-
-                let endTime = DispatchTime.now()
-                let elapsed = Double(endTime.uptimeNanoseconds - startTime.uptimeNanoseconds) / 1_000_000
+                self.waveform = waveformImage
+                self.vectorscope = vectorscopeImage
             }
         }
     }
-    
-    func histogramBin(_ input: CIImage) -> CIImage {
-        let filter = CIFilter.areaHistogram()
-        filter.inputImage = input
-        filter.count = 32
-        filter.scale = 256
-        filter.extent = input.extent
-        guard let output = filter.outputImage else { return input }
-        
-        return output
-    }
 
-    func histogramBins(_ buffer: CVPixelBuffer, channel: Int) async -> [Int] {
-        precondition(channel >= 0 && channel <= 3, "Channel must be 0 (R), 1 (G), 2 (B), or 3 (Luminance)")
-        
-        CVPixelBufferLockBaseAddress(buffer, .readOnly)
-        defer { CVPixelBufferUnlockBaseAddress(buffer, .readOnly) }
-
-        guard CVPixelBufferGetPixelFormatType(buffer) == kCVPixelFormatType_128RGBAFloat else {
-            fatalError("Unsupported pixel format. Expected 128-bit RGBA float.")
+    // R, G and B waveforms overlaid in their own colours, and the vectorscope in grey.
+    private func scopeImages() -> (CGImage?, CGImage?) {
+        let cells = scopeSize * scopeSize
+        var density = [Float](repeating: 0, count: cells)
+        var waveformPixels = [UInt8](repeating: 255, count: cells * 4)
+        for channel in 0..<3 {
+            ForgeScopesWaveformImage(scopes, Int32(channel), &density)
+            for i in 0..<cells {
+                waveformPixels[i * 4 + channel] = UInt8(min(max(density[i], 0), 1) * 255)
+            }
         }
 
-        let width = CVPixelBufferGetWidth(buffer) // ← binCount
-        let baseAddress = CVPixelBufferGetBaseAddress(buffer)!.assumingMemoryBound(to: Float.self)
-        let floatsPerPixel = 4 // RGBA
-
-        var bins = [Int](repeating: 0, count: width)
-
-        for i in 0..<width {
-            let offset = i * floatsPerPixel
-
-            let r = baseAddress[offset + 0]
-            let g = baseAddress[offset + 1]
-            let b = baseAddress[offset + 2]
-
-            let value: Float = switch channel {
-            case 0: r
-            case 1: g
-            case 2: b
-            case 3: 0.2126 * r + 0.7152 * g + 0.0722 * b
-            default: 0
-            }
+        ForgeScopesVectorscopeImage(scopes, &density)
+        let vectorscopePixels = density.map { UInt8(min(max($0, 0), 1) * 255) }
 
-            bins[i] = Int(value)
-        }
+        return (scopeImage(waveformPixels, components: 4), scopeImage(vectorscopePixels, components: 1))
+    }
 
-        return bins
+    private func scopeImage(_ pixels: [UInt8], components: Int) -> CGImage? {
+        guard let provider = CGDataProvider(data: Data(pixels) as CFData) else { return nil }
+        let space = components == 1 ? CGColorSpaceCreateDeviceGray() : CGColorSpaceCreateDeviceRGB()
+        let info = CGBitmapInfo(rawValue: components == 1 ? CGImageAlphaInfo.none.rawValue : CGImageAlphaInfo.noneSkipLast.rawValue)
+        return CGImage(width: scopeSize, height: scopeSize, bitsPerComponent: 8, bitsPerPixel: 8 * components,
+                       bytesPerRow: scopeSize * components, space: space, bitmapInfo: info, provider: provider,
+                       decode: nil, shouldInterpolate: true, intent: .defaultIntent)
     }
-    
-    
-   private func convertToPixelBuffer(_ image: CIImage) async -> CVPixelBuffer {
-        
-        let backgroundContext = RenderingManager.shared.scopeContext
-        
-        let width = Int(image.extent.width)
-        let height = Int(image.extent.height)
-
-        let attrs: [CFString: Any] = [
-            kCVPixelBufferMetalCompatibilityKey: true,
-            kCVPixelBufferCGImageCompatibilityKey: true,
-            kCVPixelBufferCGBitmapContextCompatibilityKey: true
-        ]
 
-        var pixelBuffer: CVPixelBuffer?
-        let status = CVPixelBufferCreate(
-            kCFAllocatorDefault,
-            width,
-            height,
-            kCVPixelFormatType_128RGBAFloat, // matches RGBAf format
-            attrs as CFDictionary,
-            &pixelBuffer
-        )
-
-        guard status == kCVReturnSuccess, let buffer = pixelBuffer else {
-            fatalError("Failed to create CVPixelBuffer")
+    // Renders into a pooled RGBA half buffer so repeated updates don't allocate.
+    private func renderToPixelBuffer(_ image: CIImage) -> CVPixelBuffer? {
+        let extent = image.extent.integral
+        guard !extent.isInfinite, extent.width > 0, extent.height > 0 else { return nil }
+
+        poolLock.lock()
+        if bufferPool == nil || poolSize != extent.size {
+            let attrs: [CFString: Any] = [
+                kCVPixelBufferPixelFormatTypeKey: kCVPixelFormatType_64RGBAHalf,
+                kCVPixelBufferWidthKey: Int(extent.width),
+                kCVPixelBufferHeightKey: Int(extent.height),
+                kCVPixelBufferMetalCompatibilityKey: true,
+                kCVPixelBufferIOSurfacePropertiesKey: [:] as CFDictionary
+            ]
+            bufferPool = nil
+            CVPixelBufferPoolCreate(kCFAllocatorDefault, nil, attrs as CFDictionary, &bufferPool)
+            poolSize = extent.size
         }
+        let pool = bufferPool
+        poolLock.unlock()
 
-        // Lock base address for writing
-        CVPixelBufferLockBaseAddress(buffer, [])
-        backgroundContext.render(image, to: buffer, bounds: image.extent, colorSpace: nil)
-        CVPixelBufferUnlockBaseAddress(buffer, [])
-
+        var pixelBuffer: CVPixelBuffer?
+        guard let pool, CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &pixelBuffer) == kCVReturnSuccess,
+              let buffer = pixelBuffer else { return nil }
 
+        RenderingManager.shared.scopeContext.render(image, to: buffer, bounds: extent, colorSpace: nil)
         return buffer
     }
 }
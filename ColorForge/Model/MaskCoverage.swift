@@ -0,0 +1,119 @@
+//
+//  MaskCoverage.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Where a mask is zero, partial or one, tile by tile (ColorForge/Engine/Pipeline/MaskCoverage),
+// so applyNodeWithMasks only pulls the node's output where the mask shows. The engine works
+// y-down, so Core Image rects and points go over with y negated, as the processors do.
+final class MaskCoverage {
+    static let tileSize: Int32 = 256
+
+    private let handle: OpaquePointer
+    let support: CGRect
+    let partialRects: [CGRect]
+    let oneRects: [CGRect]
+
+    private init(_ handle: OpaquePointer) {
+        self.handle = handle
+        func rect(_ r: ForgeRect) -> CGRect {
+            CGRect(x: CGFloat(r.x), y: -CGFloat(r.y + r.height), width: CGFloat(r.width), height: CGFloat(r.height))
+        }
+        func regions(one: Bool) -> [CGRect] {
+            (0..<ForgeMaskCoverageRegionCount(handle, one)).map { rect(ForgeMaskCoverageRegion(handle, one, $0)) }
+        }
+        support = rect(ForgeMaskCoverageSupport(handle))
+        partialRects = regions(one: false)
+        oneRects = regions(one: true)
+    }
+
+    deinit {
+        ForgeMaskCoverageRelease(handle)
+    }
+
+    // Zero everywhere: the node need not run at all.
+    var isEmpty: Bool { partialRects.isEmpty && oneRects.isEmpty }
+    // Share of the frame the node is evaluated over.
+    var fraction: Double { ForgeMaskCoverageFraction(handle) }
+
+    private static func bounds(_ extent: CGRect) -> ForgeRect {
+        let e = extent.integral
+        return ForgeRect(x: Int32(e.minX), y: -Int32(e.maxY), width: Int32(e.width), height: Int32(e.height))
+    }
+
+    // Normalised centre and size, feather and opacity 0–100, as applyRadialMask takes them.
+    static func radial(_ startNorm: CGPoint, _ widthNorm: CGFloat, _ heightNorm: CGFloat, feather: Float,
+                       invert: Bool, opacity: Float, extent: CGRect) -> MaskCoverage {
+        let mask = ForgeAnalyticMask.radial(startNorm, widthNorm, heightNorm, feather: feather, invert: invert,
+                                            opacity: opacity, extent: extent)
+        return MaskCoverage(ForgeMaskCoverageCreateRadial(mask.ellipse, bounds(extent), tileSize, 0))
+    }
+
+    // Coverage of a rendered mask (red channel), widened by `spread` pixels for filtering that
+    // follows. Rendered once per mask image and spread; nil for masks without a finite extent.
+    // Stored masks (SegmentationMaskStore) are classified from their tile kinds instead.
+    static func raster(_ mask: CIImage, spread: Int32) -> MaskCoverage? {
+        let extent = mask.extent.integral
+        guard !extent.isEmpty, !extent.isInfinite else { return nil }
+
+        rasterLock.lock()
+        defer { rasterLock.unlock() }
+        if let cached = rasterCache.object(forKey: mask), cached.spread == spread {
+            return cached.coverage
+        }
+        if let stored = SegmentationMaskStore.handle(for: mask) {
+            var columns: Int32 = 0, rows: Int32 = 0, span: Int32 = 0
+            let tiles = ForgeSegmentationMaskTiles(stored.mask, &columns, &rows, &span)
+            let coverage = MaskCoverage(ForgeMaskCoverageCreateTiled(tiles, columns, rows, span, bounds(extent), tileSize, spread))
+            rasterCache.setObject(RasterEntry(coverage, spread), forKey: mask)
+            return coverage
+        }
+
+        let width = Int(extent.width), height = Int(extent.height)
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        pixels.withUnsafeMutableBytes {
+            RenderingManager.shared.exportContext.render(mask, toBitmap: $0.baseAddress!, rowBytes: width,
+                                                         bounds: extent, format: .R8, colorSpace: nil)
+        }
+        let coverage = pixels.withUnsafeBufferPointer {
+            MaskCoverage(ForgeMaskCoverageCreateRaster($0.baseAddress, width, bounds(extent), tileSize, spread))
+        }
+        rasterCache.setObject(RasterEntry(coverage, spread), forKey: mask)
+        return coverage
+    }
+
+    private final class RasterEntry {
+        let coverage: MaskCoverage
+        let spread: Int32
+
+        init(_ coverage: MaskCoverage, _ spread: Int32) {
+            self.coverage = coverage
+            self.spread = spread
+        }
+    }
+
+    // Keyed weakly on the mask image, so an entry goes when the mask is replaced.
+    private static let rasterCache = NSMapTable<CIImage, RasterEntry>.weakToStrongObjects()
+    private static let rasterLock = NSLock()
+}
+
+extension CIImage {
+    // This image with `blended` over the partial regions of `coverage` and `masked` over the
+    // regions where the mask is one; elsewhere it is left as is and neither input is evaluated.
+    // Working images are opaque, so source-over replaces the pixels.
+    func compositing(blended: CIImage, masked: CIImage, within coverage: MaskCoverage) -> CIImage {
+        var result = self
+        for rect in coverage.partialRects {
+            result = blended.cropped(to: rect).composited(over: result)
+        }
+        for rect in coverage.oneRects {
+            result = masked.cropped(to: rect).composited(over: result)
+        }
+        return result
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  MaskDistanceCache.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// Signed distance fields of AI masks (ColorForge/Engine/Filters/DistanceTransform), one per
+// mask and kept while the mask they were built from is unchanged. Feathering is then a single
+// remap of the field into an 8-bit mask, whatever the feather width, so dragging the feather,
+// invert or opacity of a mask never re-renders or re-blurs it.
+final class MaskDistanceCache {
+    static let shared = MaskDistanceCache()
+
+    private let capacity = 4
+
+    // `mask` (red channel, ≥ 0.5 inside) feathered by `remap`, as a stored mask over the same
+    // extent. Nil if the mask has no finite extent.
+    func feathered(_ mask: CIImage, maskId: UUID, remap: ForgeFeatherRemap) -> CIImage? {
+        guard let entry = entry(for: mask, maskId: maskId) else { return nil }
+        let width = Int(entry.extent.width), height = Int(entry.extent.height)
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        pixels.withUnsafeMutableBufferPointer {
+            ForgeDistanceFieldRemap(entry.field.field, remap, $0.baseAddress!, width)
+        }
+        return pixels.withUnsafeBufferPointer {
+            SegmentationMaskStore.image($0.baseAddress!, rowBytes: width, width: width, height: height,
+                                        origin: entry.extent.origin)
+        }
+    }
+
+    private struct Entry {
+        let maskId: UUID
+        let source: CIImage
+        let extent: CGRect
+        let field: DistanceFieldHandle
+    }
+
+    // Most recently used last.
+    private var entries: [Entry] = []
+    private let lock = NSLock()
+
+    private func entry(for mask: CIImage, maskId: UUID) -> Entry? {
+        lock.lock()
+        if let index = entries.firstIndex(where: { $0.maskId == maskId && $0.source === mask }) {
+            let entry = entries.remove(at: index)
+            entries.append(entry)
+            lock.unlock()
+            return entry
+        }
+        lock.unlock()
+
+        guard let entry = build(mask, maskId: maskId) else { return nil }
+        lock.lock()
+        entries.removeAll { $0.maskId == maskId }
+        entries.append(entry)
+        if entries.count > capacity { entries.removeFirst(entries.count - capacity) }
+        lock.unlock()
+        return entry
+    }
+
+    private func build(_ mask: CIImage, maskId: UUID) -> Entry? {
+        let extent = mask.extent.integral
+        guard !extent.isEmpty, !extent.isInfinite else { return nil }
+
+        let width = Int(extent.width), height = Int(extent.height)
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        pixels.withUnsafeMutableBytes {
+            RenderingManager.shared.exportContext.render(mask, toBitmap: $0.baseAddress!, rowBytes: width,
+                                                         bounds: extent, format: .R8, colorSpace: nil)
+        }
+        let field = pixels.withUnsafeBufferPointer {
+            ForgeDistanceFieldCreate($0.baseAddress!, width, Int32(width), Int32(height))
+        }
+        guard let field else { return nil }
+        return Entry(maskId: maskId, source: mask, extent: extent, field: DistanceFieldHandle(field))
+    }
+}
+
+final class DistanceFieldHandle {
+    let field: OpaquePointer
+
+    init(_ field: OpaquePointer) {
+        self.field = field
+    }
+
+    deinit {
+        ForgeDistanceFieldRelease(field)
+    }
+}
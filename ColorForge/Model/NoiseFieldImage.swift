@@ -0,0 +1,50 @@
+//
+//  NoiseFieldImage.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+extension ForgeNoiseField {
+    // Single-octave Perlin, `scale` pixels per lattice cell.
+    static func perlin(seed: UInt64, scale: Float, octaves: Int32 = 1) -> ForgeNoiseField {
+        ForgeNoiseField(simplex: false, seed: seed, scale: scale, periodX: 0, periodY: 0, z: 0,
+                        octaves: octaves, lacunarity: 2, gain: 0.5)
+    }
+}
+
+extension CIImage {
+    // Grey image of a noise field over `extent`, value × gain + bias. Tiles come from the engine's
+    // fp16 noise cache (ColorForge/Engine/Random/NoiseFieldCache), so repeat renders only copy.
+    static func noiseField(_ field: ForgeNoiseField, extent: CGRect, gain: Float = 0.5, bias: Float = 0.5) -> CIImage {
+        let provider = NoiseFieldProvider(field, origin: (Int32(extent.minX.rounded()), Int32(extent.minY.rounded())),
+                                          gain: gain, bias: bias)
+        let options: [CIImageOption: Any] = [.providerTileSize: [256, 256]]
+        return CIImage(imageProvider: provider, size: Int(extent.width.rounded()), Int(extent.height.rounded()),
+                       format: .Lh, colorSpace: nil, options: options)
+            .transformed(by: CGAffineTransform(translationX: extent.minX, y: extent.minY))
+    }
+}
+
+final class NoiseFieldProvider: NSObject {
+    private let field: ForgeNoiseField
+    private let origin: (Int32, Int32)
+    private let gain: Float
+    private let bias: Float
+
+    init(_ field: ForgeNoiseField, origin: (Int32, Int32), gain: Float, bias: Float) {
+        self.field = field
+        self.origin = origin
+        self.gain = gain
+        self.bias = bias
+    }
+
+    @objc func provideImageData(_ data: UnsafeMutableRawPointer, bytesPerRow rowbytes: Int,
+                                origin x: Int, _ y: Int, size width: Int, _ height: Int, userInfo info: Any?) {
+        let region = ForgeRect(x: origin.0 + Int32(x), y: origin.1 + Int32(y), width: Int32(width), height: Int32(height))
+        ForgeNoiseFieldReadRegion(field, 0, region, data.assumingMemoryBound(to: UInt16.self), rowbytes, gain, bias)
+    }
+}
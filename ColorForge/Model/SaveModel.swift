@@ -64,56 +64,76 @@ class SaveModel {
             return
         }
 
-        let numContexts = ciContexts.count
-        let viewModel = ThumbnailViewModel.shared
-        let maxGroupSize = viewModel.colCount
+        // Admitted against the batch memory budget, one job per context at most. Files already
+        // written by an interrupted run of the same batch (listed in the checkpoint) are skipped.
+        let budget = Preferences.batchThreadBudget
+        let threads = min(budget > 0 ? budget : ciContexts.count, ciContexts.count)
+        let scheduler = BatchScheduler("batchSave", threads: threads, checkpoint: checkpointURL(destination))
+        for item in items {
+            scheduler.add(BatchScheduler.spec(for: item), key: checkpointKey(item))
+        }
 
-        let groupedItems = items.enumerated().reduce(into: Array(repeating: [ImageItem](), count: numContexts)) { result, pair in
-            let (index, item) = pair
-            result[index % numContexts].append(item)
+        let resumed = items.indices.filter { scheduler.resumed($0) }.map { items[$0].id }
+        if !resumed.isEmpty {
+            print("batchSave: \(resumed.count) items already saved by an earlier run")
+            await MainActor.run {
+                for id in resumed {
+                    dataModel.updateItem(id: id) { item in
+                        item.isSaved = true
+                    }
+                }
+            }
         }
 
-        await withTaskGroup(of: Void.self) { group in
-            for (index, groupItems) in groupedItems.enumerated() {
-                let context = ciContexts[index]
-
-                group.addTask {
-                    for item in groupItems {
-                        let id = item.id
-                        let url = item.url
-                        
-                        if let cachedPixelBuffer = PixelBufferHRCache.shared.get(item.id) {
-                            // Use cached high-res image
-                            let ciImage = CIImage(cvPixelBuffer: cachedPixelBuffer)
-                            // Use ciImage here
-                        } else {
-                            // No cached version, generate it
-                            await dataModel.getHR(item)
-                            try? await Task.sleep(nanoseconds: 50_000_000)
-                        }
-                        
-                        
-
-                        if let hrImage = FilterPipeline.shared.applyPipelineV2Sync(id, dataModel) {
-                            
-                            let scaled = hrImage.scaleToValue(CGFloat(item.saveScale))
-                            
-                            await self.saveImageTiff(item, scaled, url, destination, context)
-                            
-                            await MainActor.run {
-                                dataModel.updateItem(id: id) { item in
-                                    item.isSaved = true
-                                }
-                            }
-                            
-                        } else {
-                            print("Failed to generate image for item \(id)")
-                        }
+        await scheduler.run { job, slot in
+            let item = items[job]
+            let id = item.id
+            let url = item.url
+            let context = self.ciContexts[slot]
+
+            if let cachedPixelBuffer = PixelBufferHRCache.shared.get(item.id) {
+                // Use cached high-res image
+                let ciImage = CIImage(cvPixelBuffer: cachedPixelBuffer)
+                // Use ciImage here
+            } else {
+                // No cached version, generate it
+                await dataModel.getHR(item)
+                try? await Task.sleep(nanoseconds: 50_000_000)
+            }
+
+            guard let hrImage = FilterPipeline.shared.applyPipelineV2Sync(id, dataModel) else {
+                print("Failed to generate image for item \(id)")
+                return false
+            }
+
+            let scaled = hrImage.scaleToValue(CGFloat(item.saveScale))
+
+            // Returns once rendered, releasing the job's memory; the pipeline converts, encodes
+            // and writes the file while the next item renders, and it is checkpointed once written
+            return await self.saveImageTiff(item, scaled, url, destination, context) { saved in
+                guard saved else { return }
+                scheduler.checkpoint(job)
+                Task { @MainActor in
+                    dataModel.updateItem(id: id) { item in
+                        item.isSaved = true
                     }
                 }
             }
         }
 
+        // Every image has rendered; wait for the last files to be written
+        let written = await TiffExport.drain()
+        if !written {
+            print("batchSave: some TIFF files failed to write")
+        }
+        TiffExport.logStats()
+
+        // All done: the next batch to this destination starts afresh
+        let progress = scheduler.progress
+        if written && progress.failed == 0 {
+            scheduler.clearCheckpoint()
+        }
+
         // Now that all image saves have completed, mark all as not exporting
         await MainActor.run {
             
@@ -148,38 +168,11 @@ class SaveModel {
         _ image: CIImage,
         _ originalUrl: URL,
         _ saveDestination: URL,
-        _ context: CIContext
-    ) async {
+        _ context: CIContext,
+        _ completion: @escaping (Bool) -> Void
+    ) async -> Bool {
         await Task(priority: .userInitiated) {
-            let width = image.extent.width
-            let height = image.extent.height
             let outputColorSpace = CGColorSpace(name: CGColorSpace.adobeRGB1998)!
-            let bitmapInfo: CGBitmapInfo = CGBitmapInfo(rawValue: CGImageAlphaInfo.noneSkipLast.rawValue)
-            
-            guard let cgImage = context.createCGImage(image, from: image.extent) else {
-                print("Failed to create CGImage.")
-                return
-            }
-            
-            guard let cgContext = CGContext(
-                data: nil,
-                width: Int(width),
-                height: Int(height),
-                bitsPerComponent: item.bitDepth,
-                bytesPerRow: 0,
-                space: outputColorSpace,
-                bitmapInfo: bitmapInfo.rawValue
-            ) else {
-                print("Failed to create CGContext.")
-                return
-            }
-            
-            cgContext.draw(cgImage, in: CGRect(x: 0, y: 0, width: CGFloat(width), height: CGFloat(height)))
-            
-            guard let outputCGImage = cgContext.makeImage() else {
-                print("Failed to create output CGImage.")
-                return
-            }
             
             // Get safe, sanitized filename
             let originalFilename = originalUrl.deletingPathExtension().lastPathComponent
@@ -194,44 +187,35 @@ class SaveModel {
                 outputFileURL = saveDestination
             }
             
-            // Prepare TIFF output with DPI settings
-            let dpi: Int = 300
-            var properties: [CFString: Any] = [
-                kCGImagePropertyDPIWidth: dpi,
-                kCGImagePropertyDPIHeight: dpi,
-                kCGImagePropertyTIFFDictionary: [:]
-            ]
-            
-            if let exif = item.exifDict {
-                properties[kCGImagePropertyExifDictionary] = exif
+            // Streamed to disk band by band, with DPI and the source's EXIF, GPS and IPTC
+            let started = TiffExport.enqueue(image, item: item, to: outputFileURL, colorSpace: outputColorSpace,
+                                             bitDepth: item.bitDepth, context: context) { saved in
+                print(saved ? "Saved TIFF image to: \(outputFileURL.path)" : "Failed to write TIFF file: \(outputFileURL.path)")
+                completion(saved)
             }
-            if let gps = item.gpsDict {
-                properties[kCGImagePropertyGPSDictionary] = gps
-            }
-            if let iptc = item.iptcDict {
-                properties[kCGImagePropertyIPTCDictionary] = iptc
-            }
-            
-            let mutableData = NSMutableData()
-            guard let destination = CGImageDestinationCreateWithData(mutableData, kUTTypeTIFF, 1, nil) else {
-                print("Failed to create CGImageDestination")
-                return
-            }
-            
-            CGImageDestinationAddImage(destination, outputCGImage, properties as CFDictionary)
-            
-            if CGImageDestinationFinalize(destination) {
-                do {
-                    try mutableData.write(to: outputFileURL, options: .atomic)
-                    print("Saved TIFF image to: \(outputFileURL.path)")
-                } catch {
-                    print("Failed to write TIFF file: \(error)")
-                }
-            } else {
-                print("Failed to finalize image destination.")
+            if !started {
+                print("Failed to write TIFF file: \(outputFileURL.path)")
             }
+            return started
         }.value
     }
+
+    // The file and a hash of everything it is saved with (its SaveItem: edits, scale, bit depth,
+    // type), so a file saved before its settings changed is written again.
+    private func checkpointKey(_ item: ImageItem) -> String {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = .sortedKeys
+        let settings = (try? encoder.encode(item.toSaveItem())) ?? Data()
+        let hash = settings.withUnsafeBytes { ForgeBatchSettingsHash($0.baseAddress, $0.count) }
+        return "\(item.url.path)|\(String(hash, radix: 16))"
+    }
+
+    // Beside the files a batch writes.
+    private func checkpointURL(_ destination: URL) -> URL {
+        let isDirectory = (try? destination.resourceValues(forKeys: [.isDirectoryKey]))?.isDirectory == true
+        let folder = isDirectory ? destination : destination.deletingLastPathComponent()
+        return folder.appendingPathComponent(".colorforge-batch")
+    }
     
     
 }
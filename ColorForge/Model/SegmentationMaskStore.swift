@@ -0,0 +1,118 @@
+//
+//  SegmentationMaskStore.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+
+// AI masks kept as empty, full and run-length coded partial tiles
+// (ColorForge/Engine/Pipeline/SegmentationMask), one .cfsm file per mask in the mask cache.
+// Loading maps the file and wraps it in a CIImage whose tiles are decoded as Core Image asks
+// for them, so a project with dozens of masks holds a few hundred KB per mask, not a decoded
+// full-resolution image. The tile kinds also give the mask's coverage without rendering it.
+enum SegmentationMaskStore {
+    static let fileExtension = "cfsm"
+
+    static func url(for maskId: UUID) -> URL {
+        AppDataManager.shared.maskCacheFolder.appendingPathComponent("\(maskId.uuidString).\(fileExtension)")
+    }
+
+    // Renders `mask` (red channel) once, stores it at `url` and returns the stored mask as an
+    // image over the same extent. Nil if the mask has no finite extent or can't be written.
+    static func write(_ mask: CIImage, to url: URL) -> CIImage? {
+        // Already stored (a feathered mask from MaskDistanceCache): save it as it is.
+        if let handle = handle(for: mask) {
+            let origin = mask.extent.integral.origin
+            return ForgeSegmentationMaskSave(handle.mask, url.path, Int32(origin.x), Int32(origin.y)) ? mask : nil
+        }
+
+        let extent = mask.extent.integral
+        guard !extent.isEmpty, !extent.isInfinite else { return nil }
+
+        let width = Int(extent.width), height = Int(extent.height)
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        pixels.withUnsafeMutableBytes {
+            RenderingManager.shared.exportContext.render(mask, toBitmap: $0.baseAddress!, rowBytes: width,
+                                                         bounds: extent, format: .R8, colorSpace: nil)
+        }
+        let stored = pixels.withUnsafeBufferPointer {
+            ForgeSegmentationMaskCreate($0.baseAddress!, width, Int32(width), Int32(height))
+        }
+        guard let stored else { return nil }
+        let handle = SegmentationMaskHandle(stored)
+        guard ForgeSegmentationMaskSave(stored, url.path, Int32(extent.minX), Int32(extent.minY)) else { return nil }
+        return image(handle, origin: extent.origin)
+    }
+
+    // An 8-bit mask of `width` × `height` pixels stored in memory and placed at `origin`.
+    static func image(_ pixels: UnsafePointer<UInt8>, rowBytes: Int, width: Int, height: Int,
+                      origin: CGPoint) -> CIImage? {
+        guard let stored = ForgeSegmentationMaskCreate(pixels, rowBytes, Int32(width), Int32(height)) else { return nil }
+        return image(SegmentationMaskHandle(stored), origin: origin)
+    }
+
+    // The stored mask at `url`, placed where it was when written; nil if the file is missing
+    // or unreadable.
+    static func load(_ url: URL) -> CIImage? {
+        guard let mask = ForgeSegmentationMaskOpen(url.path) else { return nil }
+        let origin = CGPoint(x: Int(ForgeSegmentationMaskOriginX(mask)), y: Int(ForgeSegmentationMaskOriginY(mask)))
+        return image(SegmentationMaskHandle(mask), origin: origin)
+    }
+
+    // The stored mask behind an image made here, for coverage.
+    static func handle(for image: CIImage) -> SegmentationMaskHandle? {
+        lock.lock()
+        defer { lock.unlock() }
+        return images.object(forKey: image)
+    }
+
+    private static func image(_ handle: SegmentationMaskHandle, origin: CGPoint) -> CIImage {
+        let provider = SegmentationMaskProvider(handle)
+        let options: [CIImageOption: Any] = [.providerTileSize: [512, 512]]
+        let image = CIImage(imageProvider: provider, size: Int(handle.width), Int(handle.height), format: .L8,
+                            colorSpace: nil, options: options)
+            .transformed(by: CGAffineTransform(translationX: origin.x, y: origin.y))
+        lock.lock()
+        images.setObject(handle, forKey: image)
+        lock.unlock()
+        return image
+    }
+
+    // Keyed weakly on the image, so an entry goes with the mask it was loaded for.
+    private static let images = NSMapTable<CIImage, SegmentationMaskHandle>.weakToStrongObjects()
+    private static let lock = NSLock()
+}
+
+final class SegmentationMaskHandle {
+    let mask: OpaquePointer
+    let width: Int32
+    let height: Int32
+
+    init(_ mask: OpaquePointer) {
+        self.mask = mask
+        width = ForgeSegmentationMaskWidth(mask)
+        height = ForgeSegmentationMaskHeight(mask)
+    }
+
+    deinit {
+        ForgeSegmentationMaskRelease(mask)
+    }
+}
+
+// Supplies Core Image tiles decoded from the stored mask's own tiles.
+final class SegmentationMaskProvider: NSObject {
+    private let handle: SegmentationMaskHandle
+
+    init(_ handle: SegmentationMaskHandle) {
+        self.handle = handle
+    }
+
+    @objc func provideImageData(_ data: UnsafeMutableRawPointer, bytesPerRow rowbytes: Int,
+                                origin x: Int, _ y: Int, size width: Int, _ height: Int, userInfo info: Any?) {
+        let region = ForgeRect(x: Int32(x), y: Int32(y), width: Int32(width), height: Int32(height))
+        _ = ForgeSegmentationMaskReadRegion(handle.mask, region, data.assumingMemoryBound(to: UInt8.self), rowbytes)
+    }
+}
@@ -0,0 +1,89 @@
+//
+//  ThumbnailEngine.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+import ImageIO
+
+// Graded import thumbnails from the engine (ColorForge/Engine/Pipeline/ThumbnailEngine): each
+// raw's mosaic is binned and downsampled straight to 500 px, developed as demosaic_linear does and
+// graded through a baked LUT, in parallel, without a GPU demosaic or a pipeline run per file. The
+// JPEGs go to Caches/ColorForge/Thumbnails; the per-item pipeline replaces them once it gets there.
+class ThumbnailEngine {
+    static let shared = ThumbnailEngine()
+
+    private let lutSize = 32
+    private let directory: URL
+
+    init() {
+        let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        directory = caches.appendingPathComponent("ColorForge/Thumbnails", isDirectory: true)
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    // The pointwise part of `item`'s grade (FilterPipeline.applyThumbnailGrade) as CIColorCube
+    // data. Nil if Core Image can't render the cube.
+    func bakeGrade(_ item: ImageItem, _ pipeline: FilterPipeline) -> [Float]? {
+        guard let cube = LutModel.shared.generateFloatCubeImage(size: lutSize) else { return nil }
+        let graded = pipeline.applyThumbnailGrade(item, cube)
+
+        guard let data = LutModel.shared.readCubeData(from: graded, size: lutSize) else { return nil }
+        return data.withUnsafeBytes { Array($0.bindMemory(to: Float.self)) }
+    }
+
+    // Thumbnails of `items`, all graded by `lut` (bakeGrade); items that fail (non-Bayer raws,
+    // cameras LibRaw can't open) are left out.
+    func render(_ items: [ImageItem], lut: [Float]?) -> [UUID: CGImage] {
+        guard !items.isEmpty else { return [:] }
+
+        let outputs = items.map { directory.appendingPathComponent("\($0.id.uuidString).jpg") }
+        let (stats, results) = renderFiles(items.map(\.url), to: outputs, lut: lut)
+        print(String(format: "Thumbnails: %d of %d in %.2fs (%.1f/s)",
+                     stats.images - stats.failed, stats.images, stats.seconds, stats.imagesPerSecond))
+
+        // Decoded here, off the main thread, rather than on the grid's first draw
+        let options = [kCGImageSourceShouldCacheImmediately: true] as CFDictionary
+        var images: [UUID: CGImage] = [:]
+        for (index, item) in items.enumerated() where results[index] {
+            guard let source = CGImageSourceCreateWithURL(outputs[index] as CFURL, nil),
+                  let image = CGImageSourceCreateImageAtIndex(source, 0, options) else { continue }
+            images[item.id] = image
+        }
+        return images
+    }
+
+    // Renders each raw to the JPEG at the same index; the stats time the LibRaw decode too.
+    func renderFiles(_ raws: [URL], to outputs: [URL], lut: [Float]?) -> (ForgeThumbnailBatchStats, [Bool]) {
+        guard !raws.isEmpty, raws.count == outputs.count else { return (ForgeThumbnailBatchStats(), []) }
+
+        let rawPaths = raws.map { strdup($0.path) }
+        let outputPaths = outputs.map { strdup($0.path) }
+        defer {
+            rawPaths.forEach { free($0) }
+            outputPaths.forEach { free($0) }
+        }
+
+        var results = [Bool](repeating: false, count: raws.count)
+        let settings = ForgeThumbnailSettings(maxSize: 500, quality: 85)
+
+        let stats = rawPaths.map { UnsafePointer($0!) }.withUnsafeBufferPointer { raws in
+            outputPaths.map { UnsafePointer($0!) }.withUnsafeBufferPointer { outs in
+                results.withUnsafeMutableBufferPointer { flags in
+                    if let lut {
+                        return lut.withUnsafeBufferPointer {
+                            RenderRawThumbnails(raws.baseAddress!, outs.baseAddress!, Int32(rawPaths.count), settings,
+                                                $0.baseAddress, Int32(lutSize), flags.baseAddress)
+                        }
+                    }
+                    return RenderRawThumbnails(raws.baseAddress!, outs.baseAddress!, Int32(rawPaths.count), settings,
+                                               nil, 0, flags.baseAddress)
+                }
+            }
+        }
+        return (stats, results)
+    }
+}
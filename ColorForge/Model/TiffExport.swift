@@ -0,0 +1,311 @@
+//
+//  TiffExport.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import CoreImage
+import ImageIO
+
+// Exports through the overlapped export pipeline (ColorForge/Engine/IO/ExportPipeline): the image
+// is rendered one band at a time and each band is converted, compressed in parallel and appended to
+// the file on the pipeline's own threads, so the next band (or the next image) renders while the
+// last one is still being encoded and written. Metadata from the source goes into the file's EXIF,
+// GPS and IPTC directories.
+enum TiffExport {
+    // One pipeline for every export, so the images of a batch share its bands and overlap.
+    private static let pipeline = ForgeExportPipelineCreate(2)
+
+    // `image` as an RGB TIFF of `bitDepth` (8 or 16) bits per sample in `colorSpace`, deflate
+    // compressed. Returns once the file is at `url`; false if it couldn't be written.
+    static func write(_ image: CIImage, item: ImageItem, to url: URL, colorSpace: CGColorSpace,
+                      bitDepth: Int = 16, dpi: Double = 300, context: CIContext = RenderingManager.shared.exportContext) -> Bool {
+        guard let job = render(image, item: item, to: url, colorSpace: colorSpace, bitDepth: bitDepth, dpi: dpi, context: context) else {
+            return false
+        }
+        return ForgeExportPipelineWait(pipeline, job)
+    }
+
+    // As write, but returns once the image has rendered: `completion` runs on a global queue when the
+    // file is written. False (and no completion) if the export couldn't start.
+    @discardableResult
+    static func enqueue(_ image: CIImage, item: ImageItem, to url: URL, colorSpace: CGColorSpace,
+                        bitDepth: Int = 16, dpi: Double = 300, context: CIContext = RenderingManager.shared.exportContext,
+                        completion: @escaping (Bool) -> Void) -> Bool {
+        guard let job = render(image, item: item, to: url, colorSpace: colorSpace, bitDepth: bitDepth, dpi: dpi, context: context) else {
+            return false
+        }
+        DispatchQueue.global(qos: .userInitiated).async {
+            completion(ForgeExportPipelineWait(pipeline, job))
+        }
+        return true
+    }
+
+    // Waits for every export begun so far. False if any failed.
+    static func drain() async -> Bool {
+        await withCheckedContinuation { continuation in
+            DispatchQueue.global(qos: .userInitiated).async {
+                continuation.resume(returning: ForgeExportPipelineDrain(pipeline))
+            }
+        }
+    }
+
+    // Busy time per stage since the first export; the stage near 100% is the one to speed up.
+    static func logStats() {
+        let stats = ForgeExportPipelineGetStats(pipeline)
+        func stage(_ name: String, _ s: ForgeExportStageStats) -> String {
+            String(format: "%@ %.1fs (%.0f%%)", name, s.busySeconds, s.utilisation * 100)
+        }
+        print("Export pipeline: \(stats.images) images, \(stats.failed) failed, \(stats.bytesWritten / 1_048_576) MB in "
+              + String(format: "%.1fs", stats.seconds) + " — "
+              + [stage("render", stats.render), stage("convert", stats.convert),
+                 stage("encode", stats.encode), stage("write", stats.write)].joined(separator: ", "))
+    }
+
+    // Renders every band of `image` into the pipeline: the job, or nil if the file can't be started.
+    private static func render(_ image: CIImage, item: ImageItem, to url: URL, colorSpace: CGColorSpace,
+                               bitDepth: Int, dpi: Double, context: CIContext) -> Int32? {
+        let extent = image.extent.integral
+        guard !extent.isEmpty, !extent.isInfinite else { return nil }
+
+        let width = Int(extent.width), height = Int(extent.height)
+        let info = ForgeTiffInfo(width: Int32(width), height: Int32(height), channels: 3, bitsPerSample: bitDepth == 8 ? 8 : 16,
+                                 compression: 1, predictor: true, tiled: false, blockSize: 0, dpi: dpi, bigTiff: false)
+        let job = ForgeExportPipelineBegin(pipeline, url.path, info)
+        guard job >= 0 else { return nil }
+
+        if let icc = colorSpace.copyICCData() as Data? {
+            icc.withUnsafeBytes { ForgeExportPipelineSetICCProfile(pipeline, job, $0.bindMemory(to: UInt8.self).baseAddress, $0.count) }
+        }
+        addMetadata(item, to: job)
+
+        let bandRows = Int(ForgeExportPipelineBandRows(pipeline, job))
+        var row = 0
+        while row < height, let band = ForgeExportPipelineAcquire(pipeline, job) {
+            let rows = min(bandRows, height - row)
+            var rowBytes = 0
+            let pixels = ForgeExportBandPixels(band, &rowBytes)
+            // Core Image is y-up: this band's top is `row` rows below the top of the extent. Rendered
+            // as float so the convert stage quantises exactly as an RGBA16 render would.
+            let bounds = CGRect(x: extent.minX, y: extent.maxY - CGFloat(row + rows), width: extent.width, height: CGFloat(rows))
+            context.render(image, toBitmap: pixels, rowBytes: rowBytes, bounds: bounds, format: .RGBAf, colorSpace: colorSpace)
+            ForgeExportPipelineSubmit(pipeline, band, Int32(rows))
+            row += rows
+        }
+        // Short of rows, the pipeline drops the file rather than writing a truncated one.
+        ForgeExportPipelineEnd(pipeline, job)
+        return job
+    }
+
+    // MARK: - Metadata
+
+    private enum Directory: Int32 {
+        case image = 0, exif, gps
+    }
+
+    // TIFF field types.
+    private static let byte: UInt16 = 1, ascii: UInt16 = 2, short: UInt16 = 3, long: UInt16 = 4,
+                       rational: UInt16 = 5, undefined: UInt16 = 7, srational: UInt16 = 10
+
+    private static let tiffTags: [(CFString, UInt16, UInt16)] = [
+        (kCGImagePropertyTIFFMake, 271, ascii),
+        (kCGImagePropertyTIFFModel, 272, ascii),
+        (kCGImagePropertyTIFFArtist, 315, ascii),
+        (kCGImagePropertyTIFFCopyright, 33432, ascii),
+    ]
+
+    private static let exifTags: [(CFString, UInt16, UInt16)] = [
+        (kCGImagePropertyExifExposureTime, 33434, rational),
+        (kCGImagePropertyExifFNumber, 33437, rational),
+        (kCGImagePropertyExifExposureProgram, 34850, short),
+        (kCGImagePropertyExifISOSpeedRatings, 34855, short),
+        (kCGImagePropertyExifDateTimeOriginal, 36867, ascii),
+        (kCGImagePropertyExifDateTimeDigitized, 36868, ascii),
+        (kCGImagePropertyExifOffsetTimeOriginal, 36881, ascii),
+        (kCGImagePropertyExifShutterSpeedValue, 37377, srational),
+        (kCGImagePropertyExifApertureValue, 37378, rational),
+        (kCGImagePropertyExifExposureBiasValue, 37380, srational),
+        (kCGImagePropertyExifMaxApertureValue, 37381, rational),
+        (kCGImagePropertyExifMeteringMode, 37383, short),
+        (kCGImagePropertyExifFlash, 37385, short),
+        (kCGImagePropertyExifFocalLength, 37386, rational),
+        (kCGImagePropertyExifSubsecTimeOriginal, 37521, ascii),
+        (kCGImagePropertyExifExposureMode, 41986, short),
+        (kCGImagePropertyExifWhiteBalance, 41987, short),
+        (kCGImagePropertyExifFocalLenIn35mmFilm, 41989, short),
+        (kCGImagePropertyExifSceneCaptureType, 41990, short),
+        (kCGImagePropertyExifBodySerialNumber, 42033, ascii),
+        (kCGImagePropertyExifLensSpecification, 42034, rational),
+        (kCGImagePropertyExifLensMake, 42035, ascii),
+        (kCGImagePropertyExifLensModel, 42036, ascii),
+        (kCGImagePropertyExifLensSerialNumber, 42037, ascii),
+    ]
+
+    private static let gpsTags: [(CFString, UInt16, UInt16)] = [
+        (kCGImagePropertyGPSLatitudeRef, 1, ascii),
+        (kCGImagePropertyGPSLongitudeRef, 3, ascii),
+        (kCGImagePropertyGPSAltitudeRef, 5, byte),
+        (kCGImagePropertyGPSAltitude, 6, rational),
+        (kCGImagePropertyGPSSpeedRef, 12, ascii),
+        (kCGImagePropertyGPSSpeed, 13, rational),
+        (kCGImagePropertyGPSImgDirectionRef, 16, ascii),
+        (kCGImagePropertyGPSImgDirection, 17, rational),
+        (kCGImagePropertyGPSDateStamp, 29, ascii),
+    ]
+
+    // IPTC-IIM application record (2) datasets.
+    private static let iptcDatasets: [(CFString, UInt8)] = [
+        (kCGImagePropertyIPTCObjectName, 5),
+        (kCGImagePropertyIPTCKeywords, 25),
+        (kCGImagePropertyIPTCSpecialInstructions, 40),
+        (kCGImagePropertyIPTCDateCreated, 55),
+        (kCGImagePropertyIPTCByline, 80),
+        (kCGImagePropertyIPTCCity, 90),
+        (kCGImagePropertyIPTCCountryPrimaryLocationName, 101),
+        (kCGImagePropertyIPTCHeadline, 105),
+        (kCGImagePropertyIPTCCredit, 110),
+        (kCGImagePropertyIPTCSource, 115),
+        (kCGImagePropertyIPTCCopyrightNotice, 116),
+        (kCGImagePropertyIPTCCaptionAbstract, 120),
+    ]
+
+    private static func addMetadata(_ item: ImageItem, to job: Int32) {
+        if let tiff = item.tiffDict {
+            for (key, tag, type) in tiffTags {
+                if let value = tiff[key] { add(job, .image, tag, type, value) }
+            }
+        }
+
+        if let exif = item.exifDict {
+            add(job, .exif, 36864, undefined, Array("0232".utf8))
+            for (key, tag, type) in exifTags {
+                if let value = exif[key] { add(job, .exif, tag, type, value) }
+            }
+        }
+
+        if let gps = item.gpsDict {
+            add(job, .gps, 0, byte, [2, 2, 0, 0] as [UInt8])
+            for (key, tag, type) in gpsTags {
+                if let value = gps[key] { add(job, .gps, tag, type, value) }
+            }
+            // Decimal degrees and "hh:mm:ss" in the dictionary; degrees, minutes, seconds in the file.
+            for (key, tag) in [(kCGImagePropertyGPSLatitude, UInt16(2)), (kCGImagePropertyGPSLongitude, 4)] {
+                guard let degrees = numbers(gps[key]).first else { continue }
+                let d = abs(degrees), minutes = (d - d.rounded(.down)) * 60
+                add(job, .gps, tag, rational, [d.rounded(.down), minutes.rounded(.down), (minutes - minutes.rounded(.down)) * 60])
+            }
+            if let time = gps[kCGImagePropertyGPSTimeStamp] as? String {
+                let parts = time.split(separator: ":").compactMap { Double($0) }
+                if parts.count == 3 { add(job, .gps, 7, rational, parts) }
+            }
+        }
+
+        if let iptc = item.iptcDict {
+            let records = iptcRecords(iptc)
+            if !records.isEmpty {
+                records.withUnsafeBufferPointer { ForgeExportPipelineSetIPTC(pipeline, job, $0.baseAddress, $0.count) }
+            }
+        }
+    }
+
+    private static func add(_ job: Int32, _ directory: Directory, _ tag: UInt16, _ type: UInt16, _ value: Any) {
+        guard let (count, bytes) = encode(value, type), count > 0 else { return }
+        bytes.withUnsafeBytes {
+            ForgeExportPipelineAddTag(pipeline, job, directory.rawValue, tag, type, UInt64(count), $0.baseAddress, $0.count)
+        }
+    }
+
+    // `value` as `type`: the count of values and their little-endian bytes.
+    private static func encode(_ value: Any, _ type: UInt16) -> (Int, [UInt8])? {
+        var bytes: [UInt8] = []
+        func append<T: FixedWidthInteger>(_ v: T) {
+            withUnsafeBytes(of: v.littleEndian) { bytes.append(contentsOf: $0) }
+        }
+
+        switch type {
+        case ascii:
+            guard let string = value as? String ?? (value as? NSNumber)?.stringValue else { return nil }
+            bytes = Array(string.utf8) + [0]
+            return (bytes.count, bytes)
+        case byte, undefined:
+            if let raw = value as? [UInt8] { return (raw.count, raw) }
+            let values = numbers(value)
+            return (values.count, values.map { UInt8(clamping: Int($0)) })
+        case short:
+            let values = numbers(value)
+            values.forEach { append(UInt16(clamping: Int($0))) }
+            return (values.count, bytes)
+        case long:
+            let values = numbers(value)
+            values.forEach { append(UInt32(clamping: Int($0))) }
+            return (values.count, bytes)
+        case rational, srational:
+            let values = numbers(value)
+            for v in values {
+                let (numerator, denominator) = fraction(v, signed: type == srational)
+                if type == srational {
+                    append(Int32(clamping: numerator))
+                    append(Int32(clamping: denominator))
+                } else {
+                    append(UInt32(clamping: numerator))
+                    append(UInt32(clamping: denominator))
+                }
+            }
+            return (values.count, bytes)
+        default:
+            return nil
+        }
+    }
+
+    private static func numbers(_ value: Any?) -> [Double] {
+        if let number = value as? NSNumber { return [number.doubleValue] }
+        if let array = value as? [Any] { return array.compactMap { ($0 as? NSNumber)?.doubleValue } }
+        if let doubles = value as? [Double] { return doubles }
+        if let string = value as? String, let number = Double(string) { return [number] }
+        return []
+    }
+
+    // Exposure times as 1/n where they are; otherwise four decimals, fewer if the value is large.
+    private static func fraction(_ value: Double, signed: Bool) -> (Int64, Int64) {
+        guard value.isFinite else { return (0, 1) }
+        if value != 0, abs(value) < 1 {
+            let inverse = 1 / abs(value)
+            if abs(inverse - inverse.rounded()) < 1e-6 { return (value < 0 ? -1 : 1, Int64(inverse.rounded())) }
+        }
+        let limit = signed ? Double(Int32.max) : Double(UInt32.max)
+        var denominator: Int64 = 10_000
+        while denominator > 1 && abs(value) * Double(denominator) > limit { denominator /= 10 }
+        return (Int64((value * Double(denominator)).rounded()), denominator)
+    }
+
+    // Record 1 declares UTF-8, then one record 2 dataset per value (arrays repeat the dataset).
+    private static func iptcRecords(_ iptc: [CFString: Any]) -> [UInt8] {
+        var records: [UInt8] = []
+        func dataset(_ record: UInt8, _ number: UInt8, _ data: [UInt8]) {
+            let length = min(data.count, 0x7FFF)
+            records += [0x1C, record, number, UInt8(length >> 8), UInt8(length & 0xFF)]
+            records += data.prefix(length)
+        }
+
+        for (key, number) in iptcDatasets {
+            let strings: [String]
+            if let array = iptc[key] as? [String] {
+                strings = array
+            } else if let string = iptc[key] as? String {
+                strings = [string]
+            } else {
+                continue
+            }
+            for string in strings where !string.isEmpty {
+                if records.isEmpty {
+                    dataset(1, 90, [0x1B, 0x25, 0x47])
+                    dataset(2, 0, [0, 4])
+                }
+                dataset(2, number, Array(string.utf8))
+            }
+        }
+        return records
+    }
+}
@@ -163,26 +163,59 @@ class SAM2: ObservableObject {
 
             // Extract best mask and ignore the others
             let lowFeatureMask = bestMask(for: output)
+            return postProcessedMask(lowFeatureMask, size: original_size)?.maskedToAlpha()?.samTinted()
+        }
+        return nil
+    }
+
+    // Upsampling, threshold at logit 0 and clean-up of the low-resolution logits in the engine
+    // (ColorForge/Engine/Pipeline/SegmentationKernels). Specks and holes under eight logit cells
+    // are dropped, as SAM 2's own post-processing does.
+    private func postProcessedMask(_ logits: MLMultiArray, size: CGSize) -> CIImage? {
+        let width = Int(size.width.rounded()), height = Int(size.height.rounded())
+        guard width > 0, height > 0, let grid = logitGrid(logits) else { return nil }
 
-            // TODO: optimization
-            // Preserve range for upsampling
-            var minValue: Double = 9999
-            var maxValue: Double = -9999
-            for i in 0..<lowFeatureMask.count {
-                let v = lowFeatureMask[i].doubleValue
-                if v > maxValue { maxValue = v }
-                if v < minValue { minValue = v }
+        let cellArea = Double(width * height) / Double(grid.width * grid.height)
+        let params = ForgeSegmentationParams(threshold: true, minComponentArea: Int64(8 * cellArea),
+                                             maxHoleArea: Int64(8 * cellArea), feather: 0)
+        var mask = [Float](repeating: 0, count: width * height)
+        let rowBytes = width * MemoryLayout<Float>.stride
+        grid.values.withUnsafeBufferPointer { src in
+            mask.withUnsafeMutableBufferPointer { dst in
+                ForgeSegmentationPostProcess(src.baseAddress!, grid.width * MemoryLayout<Float>.stride,
+                                             Int32(grid.width), Int32(grid.height), params,
+                                             dst.baseAddress!, rowBytes, Int32(width), Int32(height))
             }
-            let threshold = -minValue / (maxValue - minValue)
+        }
+        let data = mask.withUnsafeBufferPointer { Data(buffer: $0) }
+        return CIImage(bitmapData: data, bytesPerRow: rowBytes, size: CGSize(width: width, height: height),
+                       format: .Lf, colorSpace: nil)
+    }
+
+    // The last two dimensions of `array` as packed floats.
+    private func logitGrid(_ array: MLMultiArray) -> (values: [Float], width: Int, height: Int)? {
+        let rank = array.shape.count
+        guard rank >= 2 else { return nil }
+        let height = array.shape[rank - 2].intValue, width = array.shape[rank - 1].intValue
+        let rowStride = array.strides[rank - 2].intValue, columnStride = array.strides[rank - 1].intValue
+        var values = [Float](repeating: 0, count: width * height)
 
-            // Resize first, then threshold
-            if let maskcgImage = lowFeatureMask.cgImage(min: minValue, max: maxValue) {
-                let ciImage = CIImage(cgImage: maskcgImage, options: [.colorSpace: NSNull()])
-                let resizedImage = try resizeImage(ciImage, to: original_size, applyingThreshold: Float(threshold))
-                return resizedImage?.maskedToAlpha()?.samTinted()
+        func copy<T>(_ type: T.Type, _ convert: (T) -> Float) {
+            array.withUnsafeBufferPointer(ofType: type) { src in
+                for y in 0..<height {
+                    for x in 0..<width {
+                        values[y * width + x] = convert(src[y * rowStride + x * columnStride])
+                    }
+                }
             }
         }
-        return nil
+        switch array.dataType {
+        case .float16: copy(Float16.self) { Float($0) }
+        case .float32: copy(Float.self) { $0 }
+        case .double: copy(Double.self) { Float($0) }
+        default: return nil
+        }
+        return (values, width, height)
     }
 
     private func transformCoords(_ coords: [CGPoint], normalize: Bool = false, origHW: CGSize) throws -> [CGPoint] {
@@ -199,12 +232,6 @@ class SAM2: ObservableObject {
             return CGPoint(x: normalizedX * width, y: normalizedY * height)
         }
     }
-    
-    private func resizeImage(_ image: CIImage, to size: CGSize, applyingThreshold threshold: Float = 1) throws -> CIImage? {
-        let scale = CGAffineTransform(scaleX: size.width / image.extent.width,
-                                      y: size.height / image.extent.height)
-        return image.transformed(by: scale).applyingThreshold(threshold)
-    }
 }
 
 extension CIImage {
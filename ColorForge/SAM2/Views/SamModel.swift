@@ -138,13 +138,21 @@ class SamModel: ObservableObject {
             return
         }
         
-        let finalMask = mask
+        // Rendered once into the mask store: the pipeline then reads tiles from the stored
+        // mask rather than re-running the add, clamp and soften chain on every render.
+        let maskUrl = SegmentationMaskStore.url(for: maskId)
+        let storedMask = SegmentationMaskStore.write(mask, to: maskUrl)
+        let finalMask = storedMask ?? mask
         
         print("Committing mask to mask ID: \(maskId)")
         
         dataModel.updateItem(id: id) { item in
             if let maskIndex = item.maskSettings.aiMasks.firstIndex(where: { $0.id == maskId }) {
                 item.maskSettings.aiMasks[maskIndex].maskImage = finalMask
+                if storedMask != nil {
+                    item.maskSettings.aiMasks[maskIndex].maskUrl = maskUrl
+                    item.maskSettings.aiMasks[maskIndex].maskImageLoaded = true
+                }
             } else {
                 print(" Mask ID not found in updateItem")
             }
@@ -195,14 +203,9 @@ class SamModel: ObservableObject {
         let invert = item.maskSettings.aiMasks[maskIndex].invert
         let opacity = item.maskSettings.aiMasks[maskIndex].opacity
         
-        func featherMask(_ image: CIImage, _ value: CGFloat) -> CIImage {
-            guard value != 0.0 else {
-                var result = image
-                if invert {
-                    result = image.applyingFilter("CIColorInvert")
-                }
-                return result
-            }
+        // Nil when there is no feather (or the mask can't be measured): inverted as it is.
+        func featherMask(_ image: CIImage, _ value: CGFloat) -> CIImage? {
+            guard value != 0.0 else { return nil }
             
             lastSoftenVal = Float(value)
             
@@ -211,36 +214,18 @@ class SamModel: ObservableObject {
             let featherScaled = scaleBlurRadius(CGFloat(value))
             let featherNorm = (targetMax / 100.0) * CGFloat(featherScaled)
             
-            let safeMask = image.clampedToExtent()
-            
-            // Expand slightly
-            let maximum = CIFilter.morphologyMaximum()
-            maximum.inputImage = safeMask
-            maximum.radius = Float(featherNorm) / 2.0
-            guard let expanded = maximum.outputImage else {return mask}
-            
-            let filter = CIFilter.gaussianBlur()
-            filter.inputImage = expanded
-            filter.radius = Float(featherNorm) // <-- use stored feather
-            
-            guard var result = filter.outputImage else {
-                return image
-            }
-            
-            if invert {
-                result = result.applyingFilter("CIColorInvert")
-            }
-            
-            let croppedResult = result.cropped(to: image.extent)
-            let cachedResult = croppedResult.insertingIntermediate(cache: true)
-            
-            return cachedResult
+            // Grown by half the feather and ramped across twice it: one remap of the mask's
+            // cached distance field, however wide the feather.
+            let remap = ForgeFeatherRemap(offset: Float(featherNorm) / 2.0, radius: Float(featherNorm) * 2.0,
+                                          opacity: min(max(opacity / 100.0, 0.0), 1.0), invert: invert)
+            return MaskDistanceCache.shared.feathered(image, maskId: maskId, remap: remap)
         }
         
-        var result = featherMask(mask, CGFloat(featherVal))
-        
-
+        if let feathered = featherMask(mask, CGFloat(featherVal)) {
+            return feathered
+        }
         
+        var result = invert ? mask.applyingFilter("CIColorInvert") : mask
         result = blackCanvas.blendWithOpacityPercent(result, opacity)
         
         
@@ -0,0 +1,350 @@
+//
+//  EngineBenchmarks.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+
+// Benchmarks for the C++ engine (ColorForge/Engine). Call from a debug view or the debugger:
+//     runEngineBenchmarks()
+// `raws`, real raw files, time the import thumbnails with LibRaw's decode included.
+// Correctness of the histogram, scopes, segmentation masks, distance field, mask compositor and
+// demosaic disk cache is covered by the EngineTests target; those below only time.
+
+public func runEngineBenchmarks(width: Int32 = 11648, height: Int32 = 8736, raws: [URL] = []) {
+    print("Running engine benchmarks at \(width)x\(height)...")
+    benchmarkViewport(width: width, height: height)
+    benchmarkTilePyramid()
+    benchmarkDemosaicDiskCache()
+    benchmarkGrainFieldStore()
+    benchmarkScopes()
+    benchmarkRecursiveBlur(width: width, height: height)
+    benchmarkSummedAreaTable(width: width, height: height)
+    benchmarkBandGains(width: width, height: height)
+    benchmarkGuidedFilter(width: width, height: height)
+    benchmarkMaskCoverage(width: width, height: height)
+    benchmarkMaskComposite(width: width, height: height)
+    benchmarkSegmentationMask(width: width, height: height)
+    benchmarkSegmentation(width: width, height: height)
+    benchmarkDistanceField(width: width, height: height)
+    benchmarkFilmGrain()
+    benchmarkRandom(width: width, height: height)
+    benchmarkNoiseField(width: width, height: height)
+    benchmarkTiffWriter(width: width, height: height)
+    benchmarkExportPipeline(width: width, height: height)
+    benchmarkExrWriter(width: width, height: height)
+    benchmarkBatchScheduler()
+    benchmarkThumbnails()
+    benchmarkRawThumbnails(raws)
+}
+
+// MARK: - Viewport
+
+// Views in the middle, on each edge and in the corners, each rendered from only the source region
+// ForgeViewportSourceRegion's planner gives, against crops of the full render. Only rounding
+// differs; a missing apron shows as tenths.
+func benchmarkViewport(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkViewport(width, height)
+    let status = b.maxError < 1e-3 ? "ok" : "FAIL"
+    print(String(format: "Viewport (%d views): full %.3fs  quarter view %.3fs from %.1f%% of the frame  max error %.1e  %@",
+                 b.viewports, b.fullSeconds, b.viewportSeconds, b.sourceFraction * 100, b.maxError, status))
+}
+
+// MARK: - Tile pyramid
+
+// Every level fetched from a cold store against a float 2×2 downsample of the base; odd sizes
+// exercise the edge clamp. The tiles are fp16, so ~5e-4; a wrong child tile is off by tenths.
+func benchmarkTilePyramid(width: Int32 = 3001, height: Int32 = 2003) {
+    let b = ForgeBenchmarkTilePyramid(width, height)
+    let status = b.levels > 1 && b.maxError < 1e-3 && b.unaligned ? "ok" : "FAIL"
+    print(String(format: "Tile pyramid (%d levels): %.3fs  max error %.1e  %@",
+                 b.levels, b.seconds, b.maxError, status))
+}
+
+// MARK: - Demosaic disk cache
+
+// A full frame stored as compressed tiles, then opened and decoded back.
+func benchmarkDemosaicDiskCache(width: Int32 = 4000, height: Int32 = 3000) {
+    let b = ForgeBenchmarkDemosaicDiskCache(width, height)
+    print(String(format: "Demosaic disk cache: store %.3fs  read %.3fs", b.storeSeconds, b.readSeconds))
+}
+
+// MARK: - Grain field store
+
+// A field built by one store must reopen from another over the same directory (a relaunch) and
+// match the rows synthesised directly; a rebuild must be identical, and a truncated file must miss.
+func benchmarkGrainFieldStore(width: Int32 = 6000, height: Int32 = 4000) {
+    let b = ForgeBenchmarkGrainFieldStore(width, height)
+    let status = b.reopened && b.rebuilt && b.corruption ? "ok" : "FAIL"
+    print(String(format: "Grain field store: build %.3fs  reopen %.2fms  %@",
+                 b.buildSeconds, b.openSeconds * 1000, status))
+}
+
+// MARK: - Scopes
+
+// At preview size, sampled as HistogramModel samples while sliders move (step 2) and when idle.
+// Each time includes the log-scaled readouts.
+func benchmarkScopes(width: Int32 = 2000, height: Int32 = 1333) {
+    for step: Int32 in [2, 1] {
+        let b = ForgeBenchmarkScopes(width, height, step)
+        print(String(format: "Scopes (step %d): %.2fms", step, b.computeSeconds * 1000))
+    }
+}
+
+// MARK: - Recursive blur
+
+// Throughput should stay flat across radii. maxError is against direct convolution on a frame
+// with hard edges; the third-order Gaussian is within ~1.5% of a true Gaussian at any radius.
+func benchmarkRecursiveBlur(width: Int32, height: Int32) {
+    let radii: [Float] = [2, 5, 10, 25, 50, 100, 250, 500]
+    let tolerance: [Bool: Float] = [false: 0.02, true: 1e-4]
+
+    for exponential in [false, true] {
+        print(exponential ? "Exponential blur:" : "Gaussian blur:")
+        for radius in radii {
+            let b = ForgeBenchmarkRecursiveBlur(width, height, radius, exponential)
+            let status = b.maxError <= tolerance[exponential]! ? "ok" : "FAIL"
+            print(String(format: "  r=%5.0f  %7.1f MP/s  %.3fs  max error %.5f  %@",
+                         b.radius, b.megapixelsPerSecond, b.seconds, b.maxError, status))
+        }
+    }
+}
+
+// MARK: - Summed-area table
+
+// maxError is the radius 1 and 16 box blurs and the plain and masked means against direct sums,
+// bottom rows included; the double table keeps it at float rounding (~1e-7).
+func benchmarkSummedAreaTable(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkSummedAreaTable(width, height)
+    let megapixels = Double(width) * Double(height) / 1_000_000
+    let status = b.maxError < 1e-5 ? "ok" : "FAIL"
+    print(String(format: "Summed-area table (RGB + mask): build %.1f ms  r16 blur %.1f ms for %.0f MP  max error %.1e  %@",
+                 b.buildSeconds * 1000, b.blurSeconds * 1000, megapixels, b.maxError, status))
+}
+
+// MARK: - MTF band gains
+
+// Full frame at the 35mm gate. Tiles with aprons must match the full-frame pass exactly, and
+// flat gains must return the input unchanged; a response with no bands compares nothing and fails.
+func benchmarkBandGains(width: Int32, height: Int32) {
+    let pixelsPerMM = Float(max(width, height)) / 36.0
+    let b = ForgeBenchmarkBandGains(MTFParameters.bandResponse, width, height, pixelsPerMM)
+    let status = b.levels > 0 && b.tilesMatch && b.identity ? "ok" : "FAIL"
+    print(String(format: "MTF band gains: %d bands  %.3fs  %.1f MP/s  scratch %.0f%% of frame  tiles %@  %@",
+                 b.levels, b.seconds, b.megapixelsPerSecond, b.scratchFraction * 100,
+                 b.tilesMatch ? "exact" : "differ", status))
+}
+
+// MARK: - Guided filter
+
+// Full is the export path, fast (subsample 4) the preview. Edge share is the fraction of a soft
+// test mask's variation lying across the true edge of the guide; refinement should raise it.
+func benchmarkGuidedFilter(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkGuidedFilter(width, height, 8)
+    let status = b.edgeFractionAfter > b.edgeFractionBefore ? "ok" : "FAIL"
+    print(String(format: "Guided filter (r 8): full %.3fs  %.1f MP/s  fast %.3fs  %.1f MP/s  edge share %.0f%% -> %.0f%%  %@",
+                 b.fullSeconds, b.fullMegapixelsPerSecond, b.fastSeconds, b.fastMegapixelsPerSecond,
+                 b.edgeFractionBefore * 100, b.edgeFractionAfter * 100, status))
+}
+
+// MARK: - Mask coverage
+
+// Node evaluations per render for n small radial masks, in frames: applyNodeWithMasks used to
+// run the node over the whole frame once per mask.
+func benchmarkMaskCoverage(width: Int32, height: Int32) {
+    let extent = CGRect(x: 0, y: 0, width: Int(width), height: Int(height))
+    for count in [1, 5, 16] {
+        var frames = 0.0
+        for i in 0..<count {
+            let centre = CGPoint(x: 0.1 + 0.8 * Double(i % 4) / 3, y: 0.15 + 0.7 * Double(i / 4) / 3)
+            let coverage = MaskCoverage.radial(centre, 0.12, 0.12, feather: 50, invert: false, opacity: 100, extent: extent)
+            frames += coverage.fraction
+        }
+        print(String(format: "Mask coverage: %2d radial masks  node over %.2f frames (was %d)", count, frames, count))
+    }
+}
+
+// MARK: - Mask compositor
+
+// Fused is one pass over every analytic mask; separate rasterises each mask and blends it in
+// its own full-frame pass, as applyNodeWithMasks used to.
+func benchmarkMaskComposite(width: Int32, height: Int32) {
+    print("Mask compositor (\(width)x\(height)):")
+    for masks: Int32 in [1, 4, 16] {
+        let b = ForgeBenchmarkMaskComposite(width, height, masks)
+        print(String(format: "  %2d masks: fused %.3fs  %.0f MP/s  separate %.3fs  %.1fx",
+                     b.masks, b.fusedSeconds, b.fusedMegapixelsPerSecond, b.separateSeconds,
+                     b.separateSeconds / max(b.fusedSeconds, 1e-9)))
+    }
+}
+
+// MARK: - Segmentation masks
+
+// A project's worth of AI masks built from SAM-sized logits: size against full-resolution 8-bit
+// masks, loading every one against reading every raw mask, and decoding one in Core Image-sized
+// regions.
+func benchmarkSegmentationMask(width: Int32, height: Int32) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkSegmentationMask(width, height, 24, directory)
+    print(String(format: "Segmentation masks (%d): %.0f MB -> %.1f MB  %.1f%% partial tiles  build %.3fs  load %.4fs (raw %.3fs)  decode %.0f MP/s",
+                 b.masks, b.rawMegabytes, b.encodedMegabytes, b.partialTileFraction * 100, b.buildSeconds,
+                 b.loadSeconds, b.rawLoadSeconds, b.decodeMegapixelsPerSecond))
+}
+
+// MARK: - Segmentation post-processing
+
+// SAM-sized logits with planted specks and holes: every speck must be removed and every hole
+// filled, and the feather must match a brute-force distance field on a small frame.
+func benchmarkSegmentation(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkSegmentation(width, height, 24)
+    let status = b.componentsRemoved == b.specks && b.holesFilled == b.holes && b.distancesExact ? "ok" : "FAIL"
+    print(String(format: "Segmentation: upsample %.0f MP/s  activate %.0f MP/s  components %.0f MP/s  feather (r 24) %.0f MP/s  specks %d/%d  holes %d/%d  %@",
+                 b.upsampleMegapixelsPerSecond, b.activateMegapixelsPerSecond, b.componentsMegapixelsPerSecond,
+                 b.featherMegapixelsPerSecond, b.componentsRemoved, b.specks, b.holesFilled, b.holes, status))
+}
+
+// MARK: - Distance field
+
+// The field is built once per mask; each feather is a remap, whose cost must not depend on the
+// radius.
+func benchmarkDistanceField(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkDistanceField(width, height)
+    print(String(format: "Distance field: build %.3fs (%.0f MP/s, %.0f MB)  remap r 2 %.3fs  r 400 %.3fs",
+                 b.buildSeconds, b.buildMegapixelsPerSecond, b.megabytes, b.narrowRemapSeconds, b.wideRemapSeconds))
+}
+
+// MARK: - Film grain
+
+// Grain rendering costs scale with samples per pixel and cells per pixel, not with the frame, so
+// this runs on a fixed 1536x1024 ramp. The second render uses a different tiling on one thread
+// and must match the first exactly; meanError is the drift of mean output from mean input.
+func benchmarkFilmGrain() {
+    let radii: [(Float, Float)] = [(0.1, 0), (0.1, 0.05), (0.5, 0.1), (2.0, 0.5)]
+
+    print("Film grain (1536x1024, 64 samples):")
+    for (muR, sigmaR) in radii {
+        let params = ForgeFilmGrainParams(muR: muR, sigmaR: sigmaR, sigmaFilter: 0.8, samples: 64,
+                                          zoom: 1, seed: 1, monochrome: true)
+        let b = ForgeBenchmarkFilmGrain(params, 1536, 1024)
+        let status = b.deterministic && b.meanError < 0.01 ? "ok" : "FAIL"
+        print(String(format: "  mu_r=%.2f sigma_r=%.2f  %6.2f MP/s  %.3fs  mean error %.4f  %@  %@",
+                     muR, sigmaR, b.megapixelsPerSecond, b.seconds, b.meanError,
+                     b.deterministic ? "bit-identical" : "tiling differs", status))
+    }
+}
+
+// MARK: - Random numbers
+
+// Philox4x32-10 must reproduce the Random123 test vectors; the batch paths must equal the
+// per-pixel calls bit for bit, and a frame built from uneven tiles in any order the full frame.
+func benchmarkRandom(width: Int32, height: Int32) {
+    let b = ForgeBenchmarkRandom(width, height)
+    let status = b.knownAnswers && b.batchMatchesScalar && b.tileInvariant ? "ok" : "FAIL"
+    print(String(format: "Random (Philox): %.0f M Gaussians/s  known answers %@  batch == scalar %@  tiles == frame %@  %@",
+                 b.megavariatesPerSecond, b.knownAnswers ? "ok" : "FAIL", b.batchMatchesScalar ? "ok" : "FAIL",
+                 b.tileInvariant ? "ok" : "FAIL", status))
+}
+
+// MARK: - Noise fields
+
+// Lanes and scalar must agree exactly; the cached rate is a repeat read of tiles already built.
+func benchmarkNoiseField(width: Int32, height: Int32) {
+    print("Noise field (\(width)x\(height), Perlin):")
+    for octaves: Int32 in [1, 4] {
+        let b = ForgeBenchmarkNoiseField(width, height, octaves)
+        let status = b.maxDifference < 1e-5 ? "ok" : "FAIL"
+        print(String(format: "  octaves=%d  scalar %6.1f MP/s  lanes %6.1f MP/s  generate %6.1f MP/s  cached %7.1f MP/s  max diff %.2g  %@",
+                     octaves, b.scalarMegapixelsPerSecond, b.rowMegapixelsPerSecond, b.generateMegapixelsPerSecond,
+                     b.cachedMegapixelsPerSecond, b.maxDifference, status))
+    }
+}
+
+// MARK: - TIFF export
+
+// 16-bit RGB through the streaming writer: uncompressed (as BigTIFF), deflate and LZW strips,
+// and deflate tiles. Each file is read back and must match; the serial rate is the same deflate
+// strips on one thread, so deflate / serial is the scaling across cores.
+func benchmarkTiffWriter(width: Int32, height: Int32) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkTiffWriter(width, height, directory)
+    let status = b.exact ? "ok" : "FAIL"
+    print(String(format: "TIFF writer (%.0f MB): none %.0f MB/s  deflate %.0f MB/s (serial %.0f, ratio %.2f)  LZW %.0f MB/s (ratio %.2f)  band %.1f MB  %@",
+                 b.megabytes, b.uncompressedMegabytesPerSecond, b.deflateMegabytesPerSecond, b.deflateSerialMegabytesPerSecond,
+                 b.deflateRatio, b.lzwMegabytesPerSecond, b.lzwRatio, b.bandMegabytes, status))
+}
+
+// MARK: - Export pipeline
+
+// Pipelined time should approach the busiest stage's, not the sum of all four (serial).
+func benchmarkExportPipeline(width: Int32, height: Int32, images: Int32 = 8) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkExportPipeline(width, height, images, directory)
+    let status = b.identical ? "ok" : "FAIL"
+    print(String(format: "Export pipeline (%d images, %.0f MB): serial %.3fs  pipelined %.3fs  %@",
+                 b.images, b.megabytes, b.serialSeconds, b.pipelinedSeconds, status))
+    for (name, stage) in [("render", b.stats.render), ("convert", b.stats.convert), ("encode", b.stats.encode), ("write", b.stats.write)] {
+        print(String(format: "  %@ busy %.3fs  utilisation %3.0f%%", name.padding(toLength: 8, withPad: " ", startingAt: 0),
+                     stage.busySeconds, stage.utilisation * 100))
+    }
+}
+
+// MARK: - EXR writer
+
+// Against the bytes the float32 TIFF path wrote, streamed to disk with no encode at all.
+func benchmarkExrWriter(width: Int32, height: Int32) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkExrWriter(width, height, directory)
+    let status = b.exact ? "ok" : "FAIL"
+    print(String(format: "EXR writer: float32 %.0f MB in %.3fs  half ZIP %.0f MB (%.0f%%) in %.3fs (serial encode %.3fs)  %@",
+                 b.float32Megabytes, b.float32Seconds, b.exrMegabytes, b.sizeRatio * 100, b.exrSeconds, b.exrSerialSeconds, status))
+}
+
+// MARK: - Batch scheduler
+
+// Simulated 500-image batch (mostly 24 MP, some 45 MP with grain, every tenth a 100 MP scan with
+// grain and halation) on four threads against a 16 GB budget.
+func benchmarkBatchScheduler(jobs: Int32 = 500) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkBatchScheduler(jobs, directory)
+    let status = b.withinBudget && b.resumes ? "ok" : "FAIL"
+    print(String(format: "Batch scheduler (%d jobs, %.0f GB budget): fixed peak %.1f GB in %.3fs  scheduled peak %.1f GB in %.3fs  resumes %@  %@",
+                 b.jobs, b.budgetMegabytes / 1024, b.fixedPeakMegabytes / 1024, b.fixedSeconds,
+                 b.scheduledPeakMegabytes / 1024, b.scheduledSeconds, b.resumes ? "yes" : "no", status))
+}
+
+// MARK: - Thumbnails
+
+// A synthetic 24 MP RGGB raw against a full bilinear demosaic and the same downsample; the raw
+// decode itself is left out of both (benchmarkRawThumbnails includes it). maxDifference is the baked LUT against the grade run per
+// pixel, in 8-bit levels.
+func benchmarkThumbnails(width: Int32 = 6000, height: Int32 = 4000, images: Int32 = 32) {
+    let directory = FileManager.default.temporaryDirectory.path
+    let b = ForgeBenchmarkThumbnails(width, height, images, directory)
+    let status = b.maxDifference <= 2 ? "ok" : "FAIL"
+    print(String(format: "Thumbnails (%d MP, %d images): demosaic %.3fs  thumbnail %.3fs (%.1fx)  %.1f images/s, 3000 in %.0fs  LUT max diff %.0f  %@",
+                 b.megapixels, b.images, b.demosaicSeconds, b.thumbnailSeconds, b.demosaicSeconds / max(b.thumbnailSeconds, 1e-9),
+                 b.imagesPerSecond, b.projectedSeconds3000, b.maxDifference, status))
+}
+
+// The import path on real raws, LibRaw decode included (load is summed over workers), and the
+// 3000-image projection at that rate against the under-a-minute target.
+func benchmarkRawThumbnails(_ raws: [URL]) {
+    guard !raws.isEmpty else {
+        print("Raw thumbnails: no raws given, skipped")
+        return
+    }
+    let directory = FileManager.default.temporaryDirectory.appendingPathComponent("ColorForgeThumbnailBenchmark")
+    try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: directory) }
+
+    let outputs = raws.indices.map { directory.appendingPathComponent("\($0).jpg") }
+    let (s, _) = ThumbnailEngine.shared.renderFiles(raws, to: outputs, lut: nil)
+    let done = max(Int(s.images - s.failed), 1)
+    let projected = s.imagesPerSecond > 0 ? 3000 / s.imagesPerSecond : .infinity
+    let status = s.failed == 0 && projected < 60 ? "ok" : "FAIL"
+    print(String(format: "Raw thumbnails (%d raws, %d failed): %.2fs  per image decode %.3fs  render %.3fs  encode %.3fs  %.1f images/s, 3000 in %.0fs  %@",
+                 s.images, s.failed, s.seconds, s.loadSeconds / Double(done), s.renderSeconds / Double(done),
+                 s.encodeSeconds / Double(done), s.imagesPerSecond, projected, status))
+}
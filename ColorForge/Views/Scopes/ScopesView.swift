@@ -0,0 +1,43 @@
+//
+//  ScopesView.swift
+//  ColorForge
+//
+//  Created by admin on 19/10/2026.
+//
+
+import SwiftUI
+
+// Waveform and vectorscope beside each other, refreshed with the histogram.
+struct ScopesView: View {
+    @EnvironmentObject var histogramModel: HistogramModel
+    @State private var isCollapsed = true
+
+    var body: some View {
+        SubSectionHistogram(
+            title: "Scopes",
+            isCollapsed: $isCollapsed,
+            content: {
+                HStack(spacing: 10) {
+                    scope(histogramModel.waveform, "Waveform")
+                    scope(histogramModel.vectorscope, "Vectorscope")
+                }
+                .frame(height: 120)
+                .padding(5)
+                .frame(maxWidth: .infinity)
+            }
+        )
+    }
+
+    @ViewBuilder
+    private func scope(_ image: CGImage?, _ label: String) -> some View {
+        if let image {
+            Image(decorative: image, scale: 1)
+                .resizable()
+                .aspectRatio(1, contentMode: .fit)
+                .border(Color("MenuAccent"), width: 2)
+        } else {
+            Text("\(label) not available")
+                .foregroundColor(.gray)
+        }
+    }
+}
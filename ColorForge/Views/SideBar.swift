@@ -78,8 +78,8 @@ struct SidebarView: View {
         
         VStack (spacing: 0) {
             
-            // Histogram / VectorScope to go here
             HistogramView()
+            ScopesView()
 //                .frame(width: viewModel.sideBarWidth)
 //                .padding(.horizontal, 25) // or whatever spacing you intended
             
@@ -0,0 +1,134 @@
+//
+//  DemosaicDiskCacheTests.swift
+//  EngineTests
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import Testing
+
+// The engine's shared cache, pointed at a scratch directory for each test and disabled after.
+// Entries are TileCodec-compressed fp16 tiles, so a round trip is also one through the codec.
+@Suite(.serialized)
+struct DemosaicDiskCacheTests {
+	// 2 × 1 tiles of 256, both cut short
+	private let width = 300
+	private let height = 200
+	private let metadata = Data(#"{"orientation":6,"chromaticityX":0.3127,"chromaticityY":0.329}"#.utf8)
+
+	// Smooth gradients with a fine pattern on top, like a demosaic.
+	private func makePixels() -> [Float16] {
+		var pixels = [Float16](repeating: 1, count: width * height * 4)
+		for y in 0..<height {
+			for x in 0..<width {
+				let i = (y * width + x) * 4
+				pixels[i] = Float16(Float(x) / Float(width) + Float((x * 7 + y * 13) % 17) * 1e-3)
+				pixels[i + 1] = Float16(Float(y) / Float(height))
+				pixels[i + 2] = Float16(Float((x / 8 + y / 8) % 3) * 0.3)
+			}
+		}
+		return pixels
+	}
+
+	private func withScratchCache(_ body: (URL) throws -> Void) rethrows {
+		let directory = FileManager.default.temporaryDirectory.appendingPathComponent("EngineTests-\(UUID().uuidString)", isDirectory: true)
+		try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+		ForgeDemosaicDiskCacheConfigure(directory.path, 1 << 40)
+		defer {
+			ForgeDemosaicDiskCacheConfigure("", 0)
+			try? FileManager.default.removeItem(at: directory)
+		}
+		try body(directory)
+	}
+
+	private func store(_ pixels: [Float16], content: UInt64) -> Bool {
+		metadata.withUnsafeBytes { info in
+			ForgeDemosaicDiskCacheStore(content, 1, pixels, width * 4 * MemoryLayout<Float16>.stride, Int32(width), Int32(height),
+										true, info.baseAddress, info.count)
+		}
+	}
+
+	private func contains(_ content: UInt64) -> Bool {
+		ForgeDemosaicDiskCacheLookup(content, 1, nil, nil, nil, 0, nil)
+	}
+
+	private func entries(_ directory: URL) -> [URL] {
+		let files = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: [.fileSizeKey])) ?? []
+		return files.filter { $0.pathExtension == "cfdc" }
+	}
+
+	@Test
+	func roundTripIsExact() {
+		let pixels = makePixels()
+		withScratchCache { _ in
+			#expect(store(pixels, content: 1))
+
+			var w: Int32 = 0, h: Int32 = 0
+			var info = [UInt8](repeating: 0, count: 256)
+			var infoSize = 0
+			#expect(ForgeDemosaicDiskCacheLookup(1, 1, &w, &h, &info, info.count, &infoSize))
+			#expect(w == Int32(width) && h == Int32(height))
+			#expect(Data(info.prefix(infoSize)) == metadata)
+
+			var half = [Float16](repeating: 0, count: pixels.count)
+			#expect(ForgeDemosaicDiskCacheRead(1, 1, &half, width * 4 * MemoryLayout<Float16>.stride, true))
+			#expect(half == pixels)
+
+			var float = [Float](repeating: 0, count: pixels.count)
+			#expect(ForgeDemosaicDiskCacheRead(1, 1, &float, width * 4 * MemoryLayout<Float>.stride, false))
+			#expect(float == pixels.map { Float($0) })
+		}
+	}
+
+	@Test
+	func damagedEntriesAreDropped() throws {
+		let pixels = makePixels()
+		try withScratchCache { directory in
+			// A flipped byte in the tiles, then an entry cut short.
+			for truncated in [false, true] {
+				#expect(store(pixels, content: 2))
+				let url = try #require(entries(directory).first)
+				let handle = try FileHandle(forUpdating: url)
+				let size = try handle.seekToEnd()
+				if truncated {
+					try handle.truncate(atOffset: size / 2)
+				} else {
+					try handle.seek(toOffset: size / 2)
+					let byte = try #require(try handle.read(upToCount: 1)?.first)
+					try handle.seek(toOffset: size / 2)
+					try handle.write(contentsOf: [byte ^ 0x5A])
+				}
+				try handle.close()
+
+				var read = [Float16](repeating: 0, count: pixels.count)
+				let served = contains(2) && ForgeDemosaicDiskCacheRead(2, 1, &read, width * 4 * MemoryLayout<Float16>.stride, true)
+				#expect(!served)
+				#expect(!contains(2))
+				#expect(entries(directory).isEmpty)
+			}
+		}
+	}
+
+	@Test
+	func leastRecentlyUsedEntryGoesFirst() throws {
+		let pixels = makePixels()
+		try withScratchCache { directory in
+			#expect(store(pixels, content: 3))
+			let entryBytes = try #require(try entries(directory).first?.resourceValues(forKeys: [.fileSizeKey]).fileSize)
+
+			// Room for two; the first is used again before the third arrives.
+			ForgeDemosaicDiskCacheConfigure(directory.path, UInt64(entryBytes * 5 / 2))
+			Thread.sleep(forTimeInterval: 0.01)
+			#expect(store(pixels, content: 4))
+			Thread.sleep(forTimeInterval: 0.01)
+			#expect(contains(3))
+			Thread.sleep(forTimeInterval: 0.01)
+			#expect(store(pixels, content: 5))
+
+			#expect(!contains(4))
+			#expect(contains(3) && contains(5))
+			#expect(entries(directory).count == 2)
+		}
+	}
+}
@@ -0,0 +1,67 @@
+//
+//  DistanceFieldTests.swift
+//  EngineTests
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import Testing
+
+struct DistanceFieldTests {
+	// Stripes and a disc, so every pixel has neighbours on the other side at many distances.
+	private let width = 64
+	private let height = 48
+
+	private func makeMask() -> [UInt8] {
+		var mask = [UInt8](repeating: 0, count: width * height)
+		for y in 0..<height {
+			for x in 0..<width {
+				let inside = (x / 9 + y / 7) % 3 == 0 || hypot(Double(x) - 32, Double(y) - 24) < 12
+				mask[y * width + x] = inside ? 255 : 0
+			}
+		}
+		return mask
+	}
+
+	// Brute force: distance to the nearest pixel on the other side less half a pixel, positive
+	// inside.
+	private func signedDistances(_ mask: [UInt8]) -> [Double] {
+		var distances = [Double](repeating: 0, count: mask.count)
+		for y in 0..<height {
+			for x in 0..<width {
+				let inside = mask[y * width + x] >= 128
+				var best = Int.max
+				for yy in 0..<height {
+					for xx in 0..<width where (mask[yy * width + xx] >= 128) != inside {
+						best = min(best, (x - xx) * (x - xx) + (y - yy) * (y - yy))
+					}
+				}
+				let d = Double(best).squareRoot() - 0.5
+				distances[y * width + x] = inside ? d : -d
+			}
+		}
+		return distances
+	}
+
+	// A hard edge at `offset` keeps exactly the pixels whose distance plus the offset is positive.
+	// The offsets put the edge at 1.5, 2.5, 3.5 and 5.5 pixels, at least 0.02 from any distance
+	// a pixel grid has, far more than the fp16 field's rounding.
+	@Test
+	func hardEdgesMatchBruteForceDistances() throws {
+		let mask = makeMask()
+		let distances = signedDistances(mask)
+		let field = try #require(ForgeDistanceFieldCreate(mask, width, Int32(width), Int32(height)))
+		defer { ForgeDistanceFieldRelease(field) }
+
+		var out = [UInt8](repeating: 0, count: width * height)
+		for offset: Float in [-3, -1, 0, 1, 2, 5] {
+			ForgeDistanceFieldRemap(field, ForgeFeatherRemap(offset: offset, radius: 0, opacity: 1, invert: false), &out, width)
+			let want = distances.map { $0 + Double(offset) > 0 ? UInt8(255) : 0 }
+			#expect(out == want, "offset \(offset)")
+		}
+
+		ForgeDistanceFieldRemap(field, ForgeFeatherRemap(offset: 0, radius: 0, opacity: 1, invert: true), &out, width)
+		#expect(out == mask.map { 255 - $0 })
+	}
+}
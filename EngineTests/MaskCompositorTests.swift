@@ -0,0 +1,102 @@
+//
+//  MaskCompositorTests.swift
+//  EngineTests
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import Testing
+
+struct MaskCompositorTests {
+	private let width = 160
+	private let height = 120
+	private var rowBytes: Int { width * 4 * MemoryLayout<Float>.stride }
+	private var frame: ForgeRect { ForgeRect(x: 0, y: 0, width: Int32(width), height: Int32(height)) }
+
+	// A linear gradient and radial masks rotated, feathered, faded and inverted, overlapping.
+	private let masks: [ForgeAnalyticMask] = [
+		ForgeAnalyticMask(radial: false, linear: ForgeLinearMaskShape(x0: 80, y0: 20, x1: 100, y1: 70), ellipse: ForgeRadialMaskShape()),
+		ForgeAnalyticMask(radial: true, linear: ForgeLinearMaskShape(),
+						  ellipse: ForgeRadialMaskShape(cx: 50, cy: 40, rx: 30, ry: 18, rotation: 0.4, feather: 0.5, opacity: 1, invert: false)),
+		ForgeAnalyticMask(radial: true, linear: ForgeLinearMaskShape(),
+						  ellipse: ForgeRadialMaskShape(cx: 110, cy: 80, rx: 25, ry: 25, rotation: 0, feather: 1, opacity: 0.6, invert: false)),
+		ForgeAnalyticMask(radial: true, linear: ForgeLinearMaskShape(),
+						  ellipse: ForgeRadialMaskShape(cx: 70, cy: 60, rx: 40, ry: 20, rotation: -0.8, feather: 0.2, opacity: 0.8, invert: true)),
+	]
+
+	private func makeImage(_ phase: Float) -> [Float] {
+		var pixels = [Float](repeating: 1, count: width * height * 4)
+		for y in 0..<height {
+			for x in 0..<width {
+				let i = (y * width + x) * 4
+				pixels[i] = 0.5 + 0.4 * sin(Float(x) * 0.05 + phase)
+				pixels[i + 1] = 0.5 + 0.4 * cos(Float(y) * 0.07 + phase)
+				pixels[i + 2] = Float((x + y) & 31) / 31
+			}
+		}
+		return pixels
+	}
+
+	// `rect` of a frame-sized image, as a buffer of its own.
+	private func crop(_ image: [Float], _ rect: ForgeRect) -> [Float] {
+		var out = [Float]()
+		for y in Int(rect.y)..<Int(rect.y + rect.height) {
+			let start = (y * width + Int(rect.x)) * 4
+			out += image[start..<(start + Int(rect.width) * 4)]
+		}
+		return out
+	}
+
+	// One full-frame pass per mask, each blending the node over the result of the last, as
+	// applyNodeWithMasks used to.
+	private func separate(_ base: [Float], _ node: [Float]) -> [Float] {
+		var current = base
+		var next = base
+		node.withUnsafeBufferPointer { layer in
+			for mask in masks {
+				ForgeCompositeMasks(current, frame, rowBytes, [mask], [layer.baseAddress], [frame], [rowBytes], 1,
+									&next, frame, rowBytes, 4)
+				swap(&current, &next)
+			}
+		}
+		return current
+	}
+
+	// Every mask in one pass, each layer only covering its mask's bounds.
+	private func fused(_ base: [Float], _ node: [Float], into dstRect: ForgeRect) -> [Float] {
+		let rects = masks.map { ForgeAnalyticMaskBounds($0, frame) }
+		let packed = rects.flatMap { crop(node, $0) }
+		var dst = [Float](repeating: 0, count: Int(dstRect.width * dstRect.height) * 4)
+		packed.withUnsafeBufferPointer { all in
+			var offset = 0
+			let layers: [UnsafePointer<Float>?] = rects.map { rect in
+				defer { offset += Int(rect.width * rect.height) * 4 }
+				return all.baseAddress! + offset
+			}
+			let layerRowBytes = rects.map { Int($0.width) * 4 * MemoryLayout<Float>.stride }
+			ForgeCompositeMasks(base, frame, rowBytes, masks, layers, rects, layerRowBytes, Int32(masks.count),
+								&dst, dstRect, Int(dstRect.width) * 4 * MemoryLayout<Float>.stride, 4)
+		}
+		return dst
+	}
+
+	private func maxDifference(_ a: [Float], _ b: [Float]) -> Float {
+		zip(a, b).reduce(0) { max($0, abs($1.0 - $1.1)) }
+	}
+
+	@Test
+	func fusedPassMatchesOnePassPerMask() {
+		let base = makeImage(0)
+		let node = makeImage(1.7)
+		let want = separate(base, node)
+		#expect(want != base)
+
+		let whole = fused(base, node, into: frame)
+		#expect(maxDifference(whole, want) < 1e-5)
+
+		// A region of the frame, as Core Image asks for one tile at a time.
+		let region = ForgeRect(x: 37, y: 29, width: 70, height: 50)
+		#expect(maxDifference(fused(base, node, into: region), crop(want, region)) < 1e-5)
+	}
+}
@@ -0,0 +1,161 @@
+//
+//  ScopesTests.swift
+//  EngineTests
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Testing
+
+// Each pixel's R, G and B sit at bin centres of a 32-bin split, and luma, Cb and Cr land at
+// least 0.0018 of a bin from an edge, so float rounding can't move any of them.
+private func palette(_ i: Int) -> (r: Float, g: Float, b: Float) {
+	((Float(i % 32) + 0.5) / 32, (Float((i * 7 + 3) % 32) + 0.5) / 32, (Float((i * 13 + 5) % 32) + 0.5) / 32)
+}
+
+private func luma(_ r: Float, _ g: Float, _ b: Float) -> Double {
+	0.2126 * Double(r) + 0.7152 * Double(g) + 0.0722 * Double(b)
+}
+
+// Bin of `v` in [lo, hi) split into `bins`, values outside in the end bins.
+private func bin(_ v: Double, _ bins: Int, lo: Double = 0, hi: Double = 1) -> Int {
+	min(max(Int(((v - lo) * Double(bins) / (hi - lo)).rounded(.down)), 0), bins - 1)
+}
+
+struct HistogramTests {
+	private let width = 96
+	private let height = 40
+	private let bins = 32
+
+	// Every 37th pixel has R below the range and B above it.
+	private func pixel(_ i: Int) -> (r: Float, g: Float, b: Float) {
+		let p = palette(i)
+		return i % 37 == 0 ? (-0.25, p.g, 1.75) : p
+	}
+
+	private func expected(step: Int) -> (counts: [UInt32], pixels: UInt64) {
+		var counts = [UInt32](repeating: 0, count: 4 * bins)
+		var pixels: UInt64 = 0
+		for y in stride(from: 0, to: height, by: step) {
+			for x in stride(from: 0, to: width, by: step) {
+				let p = pixel(y * width + x)
+				counts[bin(Double(p.r), bins)] += 1
+				counts[bins + bin(Double(p.g), bins)] += 1
+				counts[2 * bins + bin(Double(p.b), bins)] += 1
+				counts[3 * bins + bin(luma(p.r, p.g, p.b), bins)] += 1
+				pixels += 1
+			}
+		}
+		return (counts, pixels)
+	}
+
+	private func compute(_ source: ForgeScopeSource, step: Int) -> (counts: [UInt32], pixels: UInt64) {
+		let histogram = ForgeHistogramCreate(Int32(bins))
+		defer { ForgeHistogramRelease(histogram) }
+		var counts = [UInt32](repeating: 0, count: 4 * bins)
+		let pixels = ForgeHistogramCompute(histogram, source, Int32(step), 0, 1, &counts)
+		return (counts, pixels)
+	}
+
+	@Test(arguments: [1, 2, 3])
+	func floatInterleavedCountsMatchPerPixelBinning(step: Int) {
+		var rgba = [Float](repeating: 1, count: width * height * 4)
+		for i in 0..<(width * height) {
+			let p = pixel(i)
+			rgba[i * 4] = p.r
+			rgba[i * 4 + 1] = p.g
+			rgba[i * 4 + 2] = p.b
+		}
+		let result = rgba.withUnsafeBytes {
+			compute(ForgeScopeSource(data: $0.baseAddress, rowBytes: width * 4 * MemoryLayout<Float>.stride, planeBytes: 0,
+									 width: Int32(width), height: Int32(height), channels: 4, isHalf: false, isPlanar: false),
+					step: step)
+		}
+		let want = expected(step: step)
+		#expect(result.pixels == want.pixels)
+		#expect(result.counts == want.counts)
+	}
+
+	@Test(arguments: [1, 2])
+	func halfPlanarCountsMatchPerPixelBinning(step: Int) {
+		// Every value here is exact in half.
+		let plane = width * height
+		var planes = [Float16](repeating: 0, count: plane * 3)
+		for i in 0..<plane {
+			let p = pixel(i)
+			planes[i] = Float16(p.r)
+			planes[plane + i] = Float16(p.g)
+			planes[2 * plane + i] = Float16(p.b)
+		}
+		let result = planes.withUnsafeBytes {
+			compute(ForgeScopeSource(data: $0.baseAddress, rowBytes: width * MemoryLayout<Float16>.stride,
+									 planeBytes: plane * MemoryLayout<Float16>.stride,
+									 width: Int32(width), height: Int32(height), channels: 3, isHalf: true, isPlanar: true),
+					step: step)
+		}
+		let want = expected(step: step)
+		#expect(result.pixels == want.pixels)
+		#expect(result.counts == want.counts)
+	}
+}
+
+struct ScopesTests {
+	// Column x of the frame is one colour top to bottom, so with one waveform column per frame
+	// column each channel lights exactly one level per column.
+	private let columns = 64
+	private let levels = 32
+	private let vectorSize = 32
+	private let height = 16
+
+	// Lit cells of a log-scaled readout (zero counts read back as exactly 0).
+	private func lit(_ image: [Float]) -> Set<Int> {
+		Set(image.indices.filter { image[$0] > 0 })
+	}
+
+	@Test(arguments: [1, 2])
+	func waveformAndVectorscopeBinEverySampledPixel(step: Int) {
+		var rgba = [Float](repeating: 1, count: columns * height * 4)
+		for y in 0..<height {
+			for x in 0..<columns {
+				let p = palette(x)
+				let i = (y * columns + x) * 4
+				rgba[i] = p.r
+				rgba[i + 1] = p.g
+				rgba[i + 2] = p.b
+			}
+		}
+
+		let scopes = ForgeScopesCreate(Int32(columns), Int32(levels), Int32(vectorSize))
+		defer { ForgeScopesRelease(scopes) }
+		rgba.withUnsafeBytes {
+			let source = ForgeScopeSource(data: $0.baseAddress, rowBytes: columns * 4 * MemoryLayout<Float>.stride, planeBytes: 0,
+										  width: Int32(columns), height: Int32(height), channels: 4, isHalf: false, isPlanar: false)
+			ForgeScopesCompute(scopes, source, Int32(step))
+		}
+
+		// Sampled column sx lands in waveform column sx × columns / sampled width.
+		let sampledWidth = (columns + step - 1) / step
+		var waveform = [Set<Int>](repeating: [], count: 4)
+		var vectorscope = Set<Int>()
+		for x in stride(from: 0, to: columns, by: step) {
+			let p = palette(x)
+			let y = luma(p.r, p.g, p.b)
+			let column = (x / step) * columns / sampledWidth
+			for (c, v) in [Double(p.r), Double(p.g), Double(p.b), y].enumerated() {
+				waveform[c].insert((levels - 1 - bin(v, levels)) * columns + column)
+			}
+			let cb = bin((Double(p.b) - y) / (2 * (1 - 0.0722)), vectorSize, lo: -0.5, hi: 0.5)
+			let cr = bin((Double(p.r) - y) / (2 * (1 - 0.2126)), vectorSize, lo: -0.5, hi: 0.5)
+			vectorscope.insert((vectorSize - 1 - cr) * vectorSize + cb)
+		}
+
+		var image = [Float](repeating: 0, count: levels * columns)
+		for c in 0..<4 {
+			ForgeScopesWaveformImage(scopes, Int32(c), &image)
+			#expect(lit(image) == waveform[c], "waveform channel \(c)")
+		}
+		image = [Float](repeating: 0, count: vectorSize * vectorSize)
+		ForgeScopesVectorscopeImage(scopes, &image)
+		#expect(lit(image) == vectorscope)
+	}
+}
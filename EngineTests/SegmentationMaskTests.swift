@@ -0,0 +1,78 @@
+//
+//  SegmentationMaskTests.swift
+//  EngineTests
+//
+//  Created by admin on 19/10/2026.
+//
+
+import Foundation
+import Testing
+
+struct SegmentationMaskTests {
+	// 4 × 3 tiles of 64, the last column and row cut short. A disc with a soft edge gives full,
+	// empty and run-coded tiles; noise in the bottom-right corner forces a tile stored raw.
+	private let width = 200
+	private let height = 150
+
+	private func makePixels() -> [UInt8] {
+		var pixels = [UInt8](repeating: 0, count: width * height)
+		for y in 0..<height {
+			for x in 0..<width {
+				let d = hypot(Double(x) - 96, Double(y) - 96)
+				var v = UInt8(min(max((80 - d) * 64, 0), 255))
+				if x >= 192 && y >= 128 { v = UInt8((x * 37 + y * 11) & 255) }
+				pixels[y * width + x] = v
+			}
+		}
+		return pixels
+	}
+
+	private func read(_ mask: OpaquePointer, _ region: ForgeRect) -> [UInt8]? {
+		var out = [UInt8](repeating: 0xAA, count: Int(region.width * region.height))
+		guard ForgeSegmentationMaskReadRegion(mask, region, &out, Int(region.width)) else { return nil }
+		return out
+	}
+
+	@Test
+	func decodesEveryTileKindExactly() throws {
+		let pixels = makePixels()
+		let mask = try #require(ForgeSegmentationMaskCreate(pixels, width, Int32(width), Int32(height)))
+		defer { ForgeSegmentationMaskRelease(mask) }
+
+		var columns: Int32 = 0, rows: Int32 = 0, span: Int32 = 0
+		let tiles = try #require(ForgeSegmentationMaskTiles(mask, &columns, &rows, &span))
+		#expect(columns == 4 && rows == 3 && span == 64)
+		#expect(Set(UnsafeBufferPointer(start: tiles, count: Int(columns * rows))) == [0, 1, 2])
+		#expect(ForgeSegmentationMaskBytes(mask) < UInt64(width * height))
+
+		#expect(read(mask, ForgeRect(x: 0, y: 0, width: Int32(width), height: Int32(height))) == pixels)
+
+		// Across tile corners and off the right and bottom edges, which read as zero.
+		let region = ForgeRect(x: 150, y: 100, width: 80, height: 70)
+		var want = [UInt8](repeating: 0, count: 80 * 70)
+		for y in 0..<70 where 100 + y < height {
+			for x in 0..<80 where 150 + x < width {
+				want[y * 80 + x] = pixels[(100 + y) * width + 150 + x]
+			}
+		}
+		#expect(read(mask, region) == want)
+	}
+
+	@Test
+	func reopensFromDiskWithItsOrigin() throws {
+		let pixels = makePixels()
+		let path = FileManager.default.temporaryDirectory.appendingPathComponent("EngineTests-\(UUID().uuidString).cfsm").path
+		defer { try? FileManager.default.removeItem(atPath: path) }
+
+		let built = try #require(ForgeSegmentationMaskCreate(pixels, width, Int32(width), Int32(height)))
+		let saved = ForgeSegmentationMaskSave(built, path, 12, -7)
+		ForgeSegmentationMaskRelease(built)
+		#expect(saved)
+
+		let mask = try #require(ForgeSegmentationMaskOpen(path))
+		defer { ForgeSegmentationMaskRelease(mask) }
+		#expect(ForgeSegmentationMaskWidth(mask) == Int32(width) && ForgeSegmentationMaskHeight(mask) == Int32(height))
+		#expect(ForgeSegmentationMaskOriginX(mask) == 12 && ForgeSegmentationMaskOriginY(mask) == -7)
+		#expect(read(mask, ForgeRect(x: 0, y: 0, width: Int32(width), height: Int32(height))) == pixels)
+	}
+}